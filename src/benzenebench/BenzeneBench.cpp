@@ -0,0 +1,409 @@
+//----------------------------------------------------------------------------
+/** @file BenzeneBench.cpp */
+//----------------------------------------------------------------------------
+
+#include "SgSystem.h"
+#include "SgTime.h"
+
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include "config.h"
+#include "BenzeneBench.hpp"
+#include "BitsetIterator.hpp"
+#include "DfpnSolver.hpp"
+#include "EndgameUtil.hpp"
+#include "Game.hpp"
+#include "Groups.hpp"
+#include "HexBoard.hpp"
+#include "HexState.hpp"
+#include "MoHexPlayer.hpp"
+#include "MoHexPlayoutPolicy.hpp"
+#include "PatternState.hpp"
+#include "Resistance.hpp"
+
+using namespace benzene;
+
+//----------------------------------------------------------------------------
+
+namespace {
+
+/** Seed for the position generator; changing it invalidates all
+    previously recorded results. */
+const boost::uint32_t POSITION_SEED = 20100101;
+
+/** Benchmark run repeatedly over a set of positions; returns the
+    number of operations performed in one pass. */
+class BenchPass
+{
+public:
+    virtual ~BenchPass() { }
+
+    virtual std::size_t operator()() = 0;
+};
+
+/** Runs pass until at least minTime seconds have elapsed. */
+void RunTimed(BenchPass& pass, double minTime, double& count,
+              double& seconds)
+{
+    count = 0;
+    double start = SgTime::Get();
+    do {
+        count += static_cast<double>(pass());
+        seconds = SgTime::Get() - start;
+    } while (seconds < minTime);
+}
+
+class ComputeAllPass : public BenchPass
+{
+public:
+    ComputeAllPass(HexBoard& brd, const std::vector<StoneBoard>& positions)
+        : m_brd(brd),
+          m_positions(positions)
+    { }
+
+    std::size_t operator()()
+    {
+        for (std::size_t i = 0; i < m_positions.size(); ++i)
+        {
+            m_brd.GetPosition().SetPosition(m_positions[i]);
+            m_brd.ComputeAll(m_positions[i].WhoseTurn());
+        }
+        return m_positions.size();
+    }
+
+private:
+    HexBoard& m_brd;
+
+    const std::vector<StoneBoard>& m_positions;
+};
+
+class PatternUpdatePass : public BenchPass
+{
+public:
+    PatternUpdatePass(StoneBoard& brd, PatternState& pastate,
+                      const std::vector<StoneBoard>& positions)
+        : m_brd(brd),
+          m_pastate(pastate),
+          m_positions(positions)
+    { }
+
+    std::size_t operator()()
+    {
+        for (std::size_t i = 0; i < m_positions.size(); ++i)
+        {
+            m_brd.SetPosition(m_positions[i]);
+            m_pastate.Update();
+        }
+        return m_positions.size();
+    }
+
+private:
+    StoneBoard& m_brd;
+
+    PatternState& m_pastate;
+
+    const std::vector<StoneBoard>& m_positions;
+};
+
+/** Pattern states are built once outside the timed loop; only
+    MatchOnBoard() is measured. */
+class PatternMatchPass : public BenchPass
+{
+public:
+    PatternMatchPass(const std::vector<boost::shared_ptr<StoneBoard> >& brds,
+                     const std::vector<boost::shared_ptr<PatternState> >& pa,
+                     const MoHexSharedPolicy& policy)
+        : m_brds(brds),
+          m_pastates(pa),
+          m_policy(policy)
+    { }
+
+    std::size_t operator()()
+    {
+        for (std::size_t i = 0; i < m_brds.size(); ++i)
+        {
+            const StoneBoard& brd = *m_brds[i];
+            m_pastates[i]->MatchOnBoard(brd.GetEmpty(),
+                   m_policy.HashedPlayPatterns(brd.WhoseTurn()));
+        }
+        return m_brds.size();
+    }
+
+private:
+    const std::vector<boost::shared_ptr<StoneBoard> >& m_brds;
+
+    const std::vector<boost::shared_ptr<PatternState> >& m_pastates;
+
+    const MoHexSharedPolicy& m_policy;
+};
+
+class ResistancePass : public BenchPass
+{
+public:
+    ResistancePass(const std::vector<boost::shared_ptr<HexBoard> >& brds)
+        : m_brds(brds)
+    { }
+
+    std::size_t operator()()
+    {
+        for (std::size_t i = 0; i < m_brds.size(); ++i)
+        {
+            Resistance resist;
+            resist.Evaluate(*m_brds[i]);
+        }
+        return m_brds.size();
+    }
+
+private:
+    const std::vector<boost::shared_ptr<HexBoard> >& m_brds;
+};
+
+} // namespace
+
+//----------------------------------------------------------------------------
+
+BenzeneBench::BenzeneBench(const BenzeneBenchProgram& program,
+                           std::ostream& out)
+    : m_program(program),
+      m_out(out),
+      m_ice(),
+      m_param()
+{
+}
+
+BenzeneBench::~BenzeneBench()
+{
+}
+
+void BenzeneBench::Run()
+{
+    const std::vector<int>& sizes = m_program.Sizes();
+    for (std::size_t i = 0; i < sizes.size(); ++i)
+    {
+        int size = sizes[i];
+        std::vector<StoneBoard> positions 
+            = Positions(size, m_program.NumPositions());
+        LogInfo() << "Benchmarking " << size << "x" << size << " on "
+                  << positions.size() << " positions\n";
+        BenchComputeAll(size, positions, true, false, "vc");
+        BenchComputeAll(size, positions, false, true, "ice");
+        BenchPatterns(size, positions);
+        BenchResistance(size, positions);
+        BenchMoHex(size, positions);
+        BenchDfpn(size, positions);
+    }
+    if (!sizes.empty())
+        BenchStateDB(sizes.back());
+}
+
+std::vector<StoneBoard> BenzeneBench::Positions(int size, int count) const
+{
+    boost::mt19937 random(POSITION_SEED + static_cast<boost::uint32_t>(size));
+    const int numStones = size * size / 4;
+    std::vector<StoneBoard> positions;
+    while (static_cast<int>(positions.size()) < count)
+    {
+        StoneBoard brd(size, size);
+        for (int i = 0; i < numStones; ++i)
+        {
+            std::vector<HexPoint> empty;
+            for (BitsetIterator p(brd.GetEmpty()); p; ++p)
+                empty.push_back(*p);
+            std::size_t index = static_cast<std::size_t>(random()) 
+                % empty.size();
+            brd.PlayMove(brd.WhoseTurn(), empty[index]);
+        }
+        Groups groups;
+        GroupBuilder::Build(brd, groups);
+        if (!groups.IsGameOver())
+            positions.push_back(brd);
+    }
+    return positions;
+}
+
+void BenzeneBench::BenchComputeAll(int size, 
+                                   const std::vector<StoneBoard>& positions,
+                                   bool useVCs, bool useICE, const char* name)
+{
+    HexBoard brd(size, size, m_ice, m_param);
+    brd.SetUseVCs(useVCs);
+    brd.SetUseICE(useICE);
+    ComputeAllPass pass(brd, positions);
+    double count, seconds;
+    RunTimed(pass, m_program.MinTime(), count, seconds);
+    Report(name, size, 1, count, seconds);
+}
+
+void BenzeneBench::BenchPatterns(int size, 
+                                 const std::vector<StoneBoard>& positions)
+{
+    double count, seconds;
+    {
+        StoneBoard brd(size, size);
+        PatternState pastate(brd);
+        PatternUpdatePass pass(brd, pastate, positions);
+        RunTimed(pass, m_program.MinTime(), count, seconds);
+        Report("pattern-update", size, 1, count, seconds);
+    }
+    {
+        MoHexSharedPolicy policy;
+        std::vector<boost::shared_ptr<StoneBoard> > brds;
+        std::vector<boost::shared_ptr<PatternState> > pastates;
+        for (std::size_t i = 0; i < positions.size(); ++i)
+        {
+            brds.push_back(boost::shared_ptr<StoneBoard>
+                           (new StoneBoard(positions[i])));
+            pastates.push_back(boost::shared_ptr<PatternState>
+                               (new PatternState(*brds.back())));
+            pastates.back()->Update();
+        }
+        PatternMatchPass pass(brds, pastates, policy);
+        RunTimed(pass, m_program.MinTime(), count, seconds);
+        Report("pattern-match", size, 1, count, seconds);
+    }
+}
+
+void BenzeneBench::BenchResistance(int size, 
+                                   const std::vector<StoneBoard>& positions)
+{
+    std::vector<boost::shared_ptr<HexBoard> > brds;
+    for (std::size_t i = 0; i < positions.size(); ++i)
+    {
+        brds.push_back(boost::shared_ptr<HexBoard>
+                       (new HexBoard(size, size, m_ice, m_param)));
+        brds.back()->GetPosition().SetPosition(positions[i]);
+        brds.back()->ComputeAll(positions[i].WhoseTurn());
+    }
+    ResistancePass pass(brds);
+    double count, seconds;
+    RunTimed(pass, m_program.MinTime(), count, seconds);
+    Report("resistance", size, 1, count, seconds);
+}
+
+/** Reports playouts per second; count is the number of playouts.
+    Fillin, VCs and the moves to consider are computed before the
+    search is called and are not timed. Positions the player decides
+    without searching (game over after fillin, or a determined state)
+    are skipped. Count and seconds are taken from the statistics of
+    each search. */
+void BenzeneBench::BenchMoHex(int size, 
+                              const std::vector<StoneBoard>& positions)
+{
+    const std::vector<int>& threads = m_program.Threads();
+    for (std::size_t t = 0; t < threads.size(); ++t)
+    {
+        MoHexPlayer player;
+        player.SetPerformPreSearch(false);
+        player.SetUseTimeManagement(false);
+        player.SetMaxTime(m_program.MoHexTime());
+        player.SetMaxGames(std::numeric_limits<int>::max());
+        player.Search().SetNumberThreads(threads[t]);
+#if HAVE_GCC_ATOMIC_BUILTINS
+        player.Search().SetLockFree(threads[t] > 1);
+#endif
+        HexBoard brd(size, size, m_ice, m_param);
+        double count = 0;
+        double seconds = 0;
+        std::size_t searched = 0;
+        for (std::size_t i = 0; i < positions.size(); ++i)
+        {
+            const HexColor color = positions[i].WhoseTurn();
+            brd.GetPosition().SetPosition(positions[i]);
+            brd.ComputeAll(color);
+            if (brd.GetGroups().IsGameOver()
+                || EndgameUtil::IsDeterminedState(brd, color))
+                continue;
+            bitset_t consider = EndgameUtil::MovesToConsider(brd, color);
+            StoneBoard gameBrd(size, size);
+            Game game(gameBrd);
+            HexState state(positions[i], color);
+            std::vector<HexPoint> moves;
+            std::vector<double> scores;
+            player.FindTopMoves(1, state, game, brd, consider,
+                                m_program.MoHexTime(), moves, scores);
+            const SgUctSearchStat& stat = player.Search().Statistics();
+            count += stat.m_gamesPerSecond * stat.m_time;
+            seconds += stat.m_time;
+            ++searched;
+        }
+        LogInfo() << "mohex-playouts: searched " << searched << " of "
+                  << positions.size() << " positions\n";
+        Report("mohex-playouts", size, threads[t], count, seconds);
+    }
+}
+
+/** Reports DFPN nodes (calls to MID()) per second. Uses only a
+    hashtable so the database does not influence the result. */
+void BenzeneBench::BenchDfpn(int size, 
+                             const std::vector<StoneBoard>& positions)
+{
+    DfpnSolver solver;
+    solver.SetTimelimit(m_program.DfpnTime());
+    boost::scoped_ptr<DfpnHashTable> hashTable(new DfpnHashTable(1 << 20));
+    boost::scoped_ptr<DfpnDB> db(0);
+    SolverDBParameters param;
+    DfpnStates states(hashTable, db, param);
+    double count = 0;
+    double seconds = 0;
+    for (std::size_t i = 0; i < positions.size(); ++i)
+    {
+        hashTable->Clear();
+        HexBoard brd(size, size, m_ice, m_param);
+        HexState state(positions[i], positions[i].WhoseTurn());
+        PointSequence pv;
+        double start = SgTime::Get();
+        solver.StartSearch(state, brd, states, pv);
+        seconds += SgTime::Get() - start;
+        count += static_cast<double>(solver.NumMIDcalls());
+    }
+    Report("dfpn-nodes", size, 1, count, seconds);
+}
+
+/** Writes and then reads back DBEntries() entries of DfpnData. */
+void BenzeneBench::BenchStateDB(int size)
+{
+    const std::string& filename = m_program.DBFile();
+    std::remove(filename.c_str());
+    std::vector<StoneBoard> positions = Positions(size, m_program.DBEntries());
+    DfpnData data(DfpnBounds(1, 1), DfpnChildren(), INVALID_POINT, 1,
+                  bitset_t(), 0.0f);
+    {
+        DfpnDB db(filename);
+        double start = SgTime::Get();
+        for (std::size_t i = 0; i < positions.size(); ++i)
+            db.Put(HexState(positions[i], positions[i].WhoseTurn()), data);
+        db.Flush();
+        Report("statedb-put", size, 1, static_cast<double>(positions.size()),
+               SgTime::Get() - start);
+
+        start = SgTime::Get();
+        std::size_t found = 0;
+        for (std::size_t i = 0; i < positions.size(); ++i)
+            if (db.Get(HexState(positions[i], positions[i].WhoseTurn()), data))
+                ++found;
+        Report("statedb-get", size, 1, static_cast<double>(found),
+               SgTime::Get() - start);
+    }
+    std::remove(filename.c_str());
+}
+
+void BenzeneBench::Report(const char* name, int size, int threads,
+                          double count, double seconds)
+{
+    double rate = (seconds > 0) ? count / seconds : 0.0;
+    m_out << std::fixed << std::setprecision(3)
+          << "{\"benchmark\":\"" << name << '"'
+          << ",\"boardsize\":" << size
+          << ",\"threads\":" << threads
+          << ",\"count\":" << std::setprecision(0) << count
+          << ",\"seconds\":" << std::setprecision(3) << seconds
+          << ",\"rate\":" << rate << '}' << std::endl;
+}
+
+//----------------------------------------------------------------------------
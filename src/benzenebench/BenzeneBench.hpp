@@ -0,0 +1,77 @@
+//----------------------------------------------------------------------------
+/** @file BenzeneBench.hpp */
+//----------------------------------------------------------------------------
+
+#ifndef BENZENEBENCH_HPP
+#define BENZENEBENCH_HPP
+
+#include <iosfwd>
+#include <vector>
+
+#include "BenzeneBenchProgram.hpp"
+#include "ICEngine.hpp"
+#include "StoneBoard.hpp"
+#include "VCBuilder.hpp"
+
+_BEGIN_BENZENE_NAMESPACE_
+
+//----------------------------------------------------------------------------
+
+/** Runs the benchmarks.
+
+    Each board size uses a fixed set of positions generated from a
+    seeded random number generator, so results are comparable across
+    runs and releases. Every benchmark writes one line of JSON to the
+    output stream:
+
+    @verbatim
+    {"benchmark":"vc","boardsize":11,"threads":1,"count":120,
+     "seconds":1.02,"rate":117.6}
+    @endverbatim
+
+    where rate is count / seconds. */
+class BenzeneBench
+{
+public:
+    BenzeneBench(const BenzeneBenchProgram& program, std::ostream& out);
+
+    ~BenzeneBench();
+
+    /** Runs all benchmarks. */
+    void Run();
+
+private:
+    const BenzeneBenchProgram& m_program;
+
+    std::ostream& m_out;
+
+    ICEngine m_ice;
+
+    VCBuilderParam m_param;
+
+    /** Returns count positions on a size x size board that are not
+        game over. Same sequence for the same arguments. */
+    std::vector<StoneBoard> Positions(int size, int count) const;
+
+    void BenchComputeAll(int size, const std::vector<StoneBoard>& positions,
+                         bool useVCs, bool useICE, const char* name);
+
+    void BenchPatterns(int size, const std::vector<StoneBoard>& positions);
+
+    void BenchResistance(int size, const std::vector<StoneBoard>& positions);
+
+    void BenchMoHex(int size, const std::vector<StoneBoard>& positions);
+
+    void BenchDfpn(int size, const std::vector<StoneBoard>& positions);
+
+    void BenchStateDB(int size);
+
+    void Report(const char* name, int size, int threads,
+                double count, double seconds);
+};
+
+//----------------------------------------------------------------------------
+
+_END_BENZENE_NAMESPACE_
+
+#endif // BENZENEBENCH_HPP
@@ -0,0 +1,53 @@
+//----------------------------------------------------------------------------
+/** @file BenzeneBenchMain.cpp */
+//----------------------------------------------------------------------------
+
+#include "SgSystem.h"
+
+#include <iostream>
+
+#include "config.h"
+#include "BenzeneBench.hpp"
+#include "BenzeneBenchProgram.hpp"
+#include "Misc.hpp"
+
+using namespace benzene;
+
+//----------------------------------------------------------------------------
+
+/** @page benzenebenchmainpage BenzeneBench
+
+    @section overview Overview
+
+    Measures the speed of the core engines on fixed position sets:
+    VC and ICE computation, pattern updates and matching, resistance
+    evaluation, MoHex playouts per thread count, DFPN nodes and
+    StateDB throughput. Results are written to stdout as one JSON
+    object per line so they can be compared between releases.
+
+    Run <tt>benzene-bench --help</tt> for the list of options.
+*/
+
+//----------------------------------------------------------------------------
+
+namespace {
+
+const char* build_date = __DATE__;
+
+}
+
+//----------------------------------------------------------------------------
+
+int main(int argc, char** argv)
+{
+    MiscUtil::FindProgramDir(argc, argv);
+    BenzeneBenchProgram program(VERSION, build_date);
+    BenzeneEnvironment::Get().RegisterProgram(program);
+    program.Initialize(argc, argv);
+    BenzeneBench bench(program, std::cout);
+    bench.Run();
+    program.Shutdown();
+    return 0;
+}
+
+//----------------------------------------------------------------------------
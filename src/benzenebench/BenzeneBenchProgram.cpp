@@ -0,0 +1,107 @@
+//----------------------------------------------------------------------------
+/** @file BenzeneBenchProgram.cpp */
+//----------------------------------------------------------------------------
+
+#include "BenzeneBenchProgram.hpp"
+
+#include <sstream>
+#include "HexPoint.hpp"
+#include <boost/program_options/cmdline.hpp>
+#include <boost/program_options/variables_map.hpp>
+#include <boost/program_options/parsers.hpp>
+
+namespace po = boost::program_options;
+
+using namespace benzene;
+
+//----------------------------------------------------------------------------
+
+namespace {
+
+/** Parses a whitespace separated list of integers in [min, max];
+    other values are dropped with a warning. */
+std::vector<int> ParseIntList(const std::string& str, int min, int max)
+{
+    std::vector<int> ret;
+    std::istringstream is(str);
+    int value;
+    while (is >> value)
+    {
+        if (min <= value && value <= max)
+            ret.push_back(value);
+        else
+            LogWarning() << "Ignoring value " << value << " (not in ["
+                         << min << ", " << max << "])\n";
+    }
+    return ret;
+}
+
+} // namespace
+
+//----------------------------------------------------------------------------
+
+BenzeneBenchProgram::BenzeneBenchProgram(std::string version,
+                                         std::string buildDate)
+{
+    SetInfo("BenzeneBench", version, buildDate);
+    RegisterCmdLineArguments();
+}
+
+BenzeneBenchProgram::~BenzeneBenchProgram()
+{
+}
+
+//----------------------------------------------------------------------------
+
+void BenzeneBenchProgram::RegisterCmdLineArguments()
+{
+    CommonProgram::RegisterCmdLineArguments();
+    m_options_desc.add_options()
+        ("bench-sizes",
+         po::value<std::string>(&m_sizesString)->default_value("7 9 11"),
+         "Board sizes to benchmark.")
+        ("bench-positions",
+         po::value<int>(&m_numPositions)->default_value(10),
+         "Number of positions per board size.")
+        ("bench-threads",
+         po::value<std::string>(&m_threadsString)->default_value("1 2 4"),
+         "Thread counts for the MoHex benchmark.")
+        ("bench-min-time",
+         po::value<double>(&m_minTime)->default_value(1.0),
+         "Minimum seconds for each of the fast benchmarks.")
+        ("bench-mohex-time",
+         po::value<double>(&m_mohexTime)->default_value(1.0),
+         "Seconds per position for the MoHex benchmark.")
+        ("bench-dfpn-time",
+         po::value<double>(&m_dfpnTime)->default_value(1.0),
+         "Seconds per position for the DFPN benchmark.")
+        ("bench-db-file",
+         po::value<std::string>(&m_dbFile)->default_value("benzene-bench.db"),
+         "Scratch file for the StateDB benchmark; removed afterwards.")
+        ("bench-db-entries",
+         po::value<int>(&m_dbEntries)->default_value(10000),
+         "Number of entries written in the StateDB benchmark.");
+}
+
+void BenzeneBenchProgram::HandleCmdLineArguments()
+{
+    CommonProgram::HandleCmdLineArguments();
+    m_sizes = ParseIntList(m_sizesString, 1, MAX_WIDTH);
+    m_threads = ParseIntList(m_threadsString, 1, 64);
+    if (m_numPositions < 1)
+        m_numPositions = 1;
+}
+
+void BenzeneBenchProgram::InitializeSystem()
+{
+    LogConfig() << "BenzeneBenchProgram:: InitializeSystem()\n";
+    CommonProgram::InitializeSystem();
+}
+
+void BenzeneBenchProgram::ShutdownSystem()
+{ 
+    LogConfig() << "BenzeneBenchProgram:: ShutdownSystem()\n";
+    CommonProgram::ShutdownSystem();
+}
+
+//----------------------------------------------------------------------------
@@ -0,0 +1,126 @@
+//----------------------------------------------------------------------------
+/** @file BenzeneBenchProgram.hpp */
+//----------------------------------------------------------------------------
+
+#ifndef BENZENEBENCHPROGRAM_HPP
+#define BENZENEBENCHPROGRAM_HPP
+
+#include <vector>
+#include "CommonProgram.hpp"
+
+_BEGIN_BENZENE_NAMESPACE_
+
+//----------------------------------------------------------------------------
+
+/** Starts up a BenzeneBench program. */
+class BenzeneBenchProgram : public CommonProgram
+{
+public:
+    BenzeneBenchProgram(std::string version, std::string buildDate);
+
+    virtual ~BenzeneBenchProgram();
+
+    //-----------------------------------------------------------------------
+
+    virtual void RegisterCmdLineArguments();
+
+    virtual void HandleCmdLineArguments();
+
+    virtual void InitializeSystem();
+
+    virtual void ShutdownSystem();
+
+    //-----------------------------------------------------------------------
+
+    /** Board sizes to benchmark. */
+    const std::vector<int>& Sizes() const;
+
+    /** Number of positions per board size. */
+    int NumPositions() const;
+
+    /** Thread counts to run the MoHex benchmark with. */
+    const std::vector<int>& Threads() const;
+
+    /** Minimum seconds spent on each of the fast benchmarks; the
+        position set is repeated until this much time has passed. */
+    double MinTime() const;
+
+    /** Seconds per position for the MoHex benchmark. */
+    double MoHexTime() const;
+
+    /** Seconds per position for the DFPN benchmark. */
+    double DfpnTime() const;
+
+    /** File for the StateDB benchmark. */
+    const std::string& DBFile() const;
+
+    /** Number of entries written in the StateDB benchmark. */
+    int DBEntries() const;
+
+private:
+    std::string m_sizesString;
+
+    std::string m_threadsString;
+
+    std::vector<int> m_sizes;
+
+    int m_numPositions;
+
+    std::vector<int> m_threads;
+
+    double m_minTime;
+
+    double m_mohexTime;
+
+    double m_dfpnTime;
+
+    std::string m_dbFile;
+
+    int m_dbEntries;
+};
+
+inline const std::vector<int>& BenzeneBenchProgram::Sizes() const
+{
+    return m_sizes;
+}
+
+inline int BenzeneBenchProgram::NumPositions() const
+{
+    return m_numPositions;
+}
+
+inline const std::vector<int>& BenzeneBenchProgram::Threads() const
+{
+    return m_threads;
+}
+
+inline double BenzeneBenchProgram::MinTime() const
+{
+    return m_minTime;
+}
+
+inline double BenzeneBenchProgram::MoHexTime() const
+{
+    return m_mohexTime;
+}
+
+inline double BenzeneBenchProgram::DfpnTime() const
+{
+    return m_dfpnTime;
+}
+
+inline const std::string& BenzeneBenchProgram::DBFile() const
+{
+    return m_dbFile;
+}
+
+inline int BenzeneBenchProgram::DBEntries() const
+{
+    return m_dbEntries;
+}
+
+//----------------------------------------------------------------------------
+
+_END_BENZENE_NAMESPACE_
+
+#endif // BENZENEBENCHPROGRAM_HPP
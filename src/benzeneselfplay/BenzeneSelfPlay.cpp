@@ -0,0 +1,387 @@
+//----------------------------------------------------------------------------
+/** @file BenzeneSelfPlay.cpp */
+//----------------------------------------------------------------------------
+
+#include "SgSystem.h"
+#include "SgTime.h"
+
+#include <algorithm>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <boost/shared_ptr.hpp>
+
+#include "BenzeneSelfPlay.hpp"
+#include "Game.hpp"
+#include "TaskScheduler.hpp"
+#include "VCPattern.hpp"
+
+using namespace benzene;
+
+//----------------------------------------------------------------------------
+
+namespace {
+
+//----------------------------------------------------------------------------
+
+std::string TimeString(const char* format)
+{
+    std::time_t now = std::time(0);
+    char buffer[128];
+    if (std::strftime(buffer, sizeof(buffer), format,
+                      std::localtime(&now)) == 0)
+        return "";
+    return buffer;
+}
+
+/** Escapes text for an sgf property value. */
+std::string SgfText(const std::string& s)
+{
+    std::string text;
+    for (std::size_t i = 0; i < s.size(); ++i)
+    {
+        if (s[i] == '\\' || s[i] == ']')
+            text += '\\';
+        text += s[i];
+    }
+    return text;
+}
+
+std::string GameName(const std::string& directory, int index)
+{
+    std::ostringstream os;
+    os << directory << '/' << std::setw(4) << std::setfill('0') << index;
+    return os.str();
+}
+
+//----------------------------------------------------------------------------
+
+/** Plays games on its own players and work boards. */
+class GameWorker
+{
+public:
+    GameWorker(BenzeneSelfPlay& selfPlay, SelfPlaySide& p1,
+               SelfPlaySide& p2, std::size_t numWorkers);
+
+    bool operator()(const int& index);
+
+private:
+    BenzeneSelfPlay* m_selfPlay;
+
+    boost::shared_ptr<SelfPlayer> m_player[2];
+
+    boost::shared_ptr<HexBoard> m_brd[2];
+};
+
+GameWorker::GameWorker(BenzeneSelfPlay& selfPlay, SelfPlaySide& p1,
+                       SelfPlaySide& p2, std::size_t numWorkers)
+    : m_selfPlay(&selfPlay)
+{
+    m_player[0] = p1.CreatePlayer(numWorkers);
+    m_player[1] = p2.CreatePlayer(numWorkers);
+    m_brd[0].reset(new HexBoard(p1.PlayerBoard()));
+    m_brd[1].reset(new HexBoard(p2.PlayerBoard()));
+}
+
+bool GameWorker::operator()(const int& index)
+{
+    SelfPlayResult result = m_selfPlay->PlayGame(index,
+                                                 *m_player[0], *m_brd[0],
+                                                 *m_player[1], *m_brd[1]);
+    m_selfPlay->AddResult(result);
+    return !result.error;
+}
+
+//----------------------------------------------------------------------------
+
+} // namespace
+
+//----------------------------------------------------------------------------
+
+BenzeneSelfPlay::BenzeneSelfPlay(const BenzeneSelfPlayProgram& program)
+    : m_program(program),
+      m_resultsName(program.Directory() + "/results"),
+      m_nextResult(0)
+{
+    for (int i = 0; i < 2; ++i)
+        m_side[i].reset(SelfPlaySide::Create(program.PlayerType(i),
+                                             program.PlayerName(i),
+                                             program.PlayerConfig(i),
+                                             program.BoardSize()));
+    LoadOpenings();
+}
+
+BenzeneSelfPlay::~BenzeneSelfPlay()
+{
+}
+
+//----------------------------------------------------------------------------
+
+void BenzeneSelfPlay::Run()
+{
+    int last;
+    if (FindLastIndex(last))
+        WriteTimeStamp();
+    else
+    {
+        last = -1;
+        WriteHeader();
+    }
+    const int gamesPerRound = 2 * static_cast<int>(m_openings.size());
+    const int numGames = m_program.Rounds() * gamesPerRound;
+    m_nextResult = last + 1;
+    std::vector<int> work;
+    for (int i = last + 1; i < numGames; ++i)
+        work.push_back(i);
+    if (work.empty())
+    {
+        LogInfo() << "BenzeneSelfPlay: all " << numGames
+                  << " games already played\n";
+        return;
+    }
+    // Build the pattern tables before the threads need them
+    VCPattern::GetPatterns(m_program.BoardSize(), m_program.BoardSize(),
+                           BLACK);
+    std::vector<GameWorker> workers;
+    const int numWorkers = std::min(m_program.Games(),
+                                    static_cast<int>(work.size()));
+    for (int i = 0; i < numWorkers; ++i)
+        workers.push_back(GameWorker(*this, *m_side[0], *m_side[1],
+                                     numWorkers));
+    LogInfo() << "BenzeneSelfPlay: playing " << work.size() << " games, "
+              << numWorkers << " at a time\n";
+    std::vector<std::pair<int, bool> > output;
+    {
+        TaskWorker<int, bool, GameWorker> taskWorker(workers);
+        taskWorker.DoWork(work, output);
+    }
+}
+
+//----------------------------------------------------------------------------
+
+SelfPlayResult BenzeneSelfPlay::PlayGame(int index,
+                                         SelfPlayer& p1, HexBoard& p1Brd,
+                                         SelfPlayer& p2, HexBoard& p2Brd) const
+{
+    const int gamesPerRound = 2 * static_cast<int>(m_openings.size());
+    const bool p1IsBlack = (index % 2) == 0;
+    SelfPlayResult result;
+    result.index = index;
+    result.round = index / gamesPerRound;
+    result.opening = m_openings[(index % gamesPerRound) / 2];
+    result.black = m_side[p1IsBlack ? 0 : 1]->Name();
+    result.white = m_side[p1IsBlack ? 1 : 0]->Name();
+    result.result = "?";
+    result.length = 0;
+    result.elapsed[BLACK] = 0.0;
+    result.elapsed[WHITE] = 0.0;
+    result.error = false;
+    result.resigned = EMPTY;
+
+    SelfPlayer* player[BLACK_AND_WHITE];
+    HexBoard* brd[BLACK_AND_WHITE];
+    player[BLACK] = p1IsBlack ? &p1 : &p2;
+    brd[BLACK] = p1IsBlack ? &p1Brd : &p2Brd;
+    player[WHITE] = p1IsBlack ? &p2 : &p1;
+    brd[WHITE] = p1IsBlack ? &p2Brd : &p1Brd;
+
+    StoneBoard board(m_program.BoardSize(), m_program.BoardSize());
+    Game game(board);
+    game.SetAllowSwap(false);
+    HexColor color = FIRST_TO_PLAY;
+    std::istringstream is(result.opening);
+    std::string token;
+    while (is >> token)
+    {
+        HexPoint move = HexPointUtil::FromString(token);
+        if (game.PlayMove(color, move) != Game::VALID_MOVE)
+        {
+            result.error = true;
+            result.errorMessage = "invalid opening move " + token;
+            return result;
+        }
+        result.moves.push_back(move);
+        color = !color;
+    }
+    try {
+        while (true)
+        {
+            double start = SgTime::Get();
+            HexPoint move = player[color]->GenMove(game, color, *brd[color]);
+            double elapsed = SgTime::Get() - start;
+            result.elapsed[color] += elapsed;
+            game.SetTimeRemaining(color, game.TimeRemaining(color) - elapsed);
+            if (move == RESIGN)
+            {
+                result.resigned = color;
+                result.result = (color == BLACK) ? "W+" : "B+";
+                break;
+            }
+            if (game.PlayMove(color, move) != Game::VALID_MOVE)
+            {
+                result.error = true;
+                result.errorMessage = std::string(color == BLACK ? "B" : "W")
+                    + ": illegal move " + HexPointUtil::ToString(move);
+                break;
+            }
+            result.moves.push_back(move);
+            color = !color;
+        }
+    }
+    catch (const BenzeneException& e) {
+        result.error = true;
+        result.errorMessage = std::string(color == BLACK ? "B" : "W")
+            + ": " + e.what();
+    }
+    result.length = static_cast<int>(result.moves.size());
+    return result;
+}
+
+void BenzeneSelfPlay::AddResult(const SelfPlayResult& result)
+{
+    SaveGame(result);
+    LogInfo() << "Game " << result.index << ": " << result.black << " vs "
+              << result.white << ' '
+              << (result.error ? result.errorMessage : result.result) << '\n';
+    boost::mutex::scoped_lock lock(m_resultsMutex);
+    m_pending[result.index] = result;
+    std::map<int, SelfPlayResult>::iterator it;
+    while ((it = m_pending.find(m_nextResult)) != m_pending.end())
+    {
+        WriteResult(it->second);
+        m_pending.erase(it);
+        ++m_nextResult;
+    }
+}
+
+//----------------------------------------------------------------------------
+
+void BenzeneSelfPlay::LoadOpenings()
+{
+    std::ifstream in(m_program.Openings().c_str());
+    if (!in)
+        throw BenzeneException() << "Cannot open openings file '"
+                                 << m_program.Openings() << "'";
+    std::string line;
+    while (std::getline(in, line))
+    {
+        std::istringstream is(line);
+        std::string token;
+        std::string opening;
+        while (is >> token)
+            opening += (opening.empty() ? "" : " ") + token;
+        if (!opening.empty())
+            m_openings.push_back(opening);
+    }
+    if (m_openings.empty())
+        throw BenzeneException() << "No openings in '"
+                                 << m_program.Openings() << "'";
+}
+
+bool BenzeneSelfPlay::FindLastIndex(int& last) const
+{
+    std::ifstream in(m_resultsName.c_str());
+    if (!in)
+        return false;
+    last = -1;
+    std::string line;
+    while (std::getline(in, line))
+    {
+        if (line.empty() || line[0] == '#')
+            continue;
+        std::istringstream is(line);
+        int index;
+        if (is >> index)
+            last = index;
+    }
+    return true;
+}
+
+void BenzeneSelfPlay::WriteHeader() const
+{
+    std::ofstream out(m_resultsName.c_str());
+    if (!out)
+        throw BenzeneException() << "Cannot write '" << m_resultsName << "'";
+    out << "# Game results file generated by benzene-selfplay.\n"
+        << "#\n"
+        << "# p1name: " << m_side[0]->Name() << '\n'
+        << "# p1cmd: " << m_side[0]->Description() << '\n'
+        << "# p2name: " << m_side[1]->Name() << '\n'
+        << "# p2cmd: " << m_side[1]->Description() << '\n'
+        << "# Boardsize: " << m_program.BoardSize() << '\n'
+        << "# Rounds: " << m_program.Rounds() << '\n'
+        << "# Openings: " << m_program.Openings() << '\n'
+        << "# Directory: " << m_program.Directory() << '\n'
+        << "# Start Date: " << TimeString("%Y-%m-%d %X %Z") << '\n'
+        << "#\n"
+        << "# GAME\tROUND\tOPENING\tBLACK\tWHITE\tRES_B\tRES_W\tLENGTH"
+        << "\tTIME_B\tTIME_W\tERR\tERR_MSG\n"
+        << "#\n";
+    out.close();
+    WriteTimeStamp();
+}
+
+void BenzeneSelfPlay::WriteTimeStamp() const
+{
+    std::ofstream out(m_resultsName.c_str(), std::ios::app);
+    out << "# Date: " << TimeString("%Y-%m-%d %X %Z") << '\n';
+}
+
+void BenzeneSelfPlay::WriteResult(const SelfPlayResult& result) const
+{
+    std::ofstream out(m_resultsName.c_str(), std::ios::app);
+    if (!out)
+    {
+        LogWarning() << "Cannot write '" << m_resultsName << "'\n";
+        return;
+    }
+    out << std::setw(4) << std::setfill('0') << result.index
+        << std::setfill(' ') << '\t' << result.round
+        << '\t' << result.opening
+        << '\t' << result.black << '\t' << result.white
+        << '\t' << result.result << '\t' << result.result
+        << '\t' << result.length
+        << std::fixed << std::setprecision(1)
+        << '\t' << result.elapsed[BLACK] << '\t' << result.elapsed[WHITE]
+        << '\t' << (result.error ? 1 : 0) << '\t' << result.errorMessage
+        << '\n';
+}
+
+void BenzeneSelfPlay::SaveGame(const SelfPlayResult& result) const
+{
+    std::string name = GameName(m_program.Directory(), result.index);
+    std::string sgfName = name + ".sgf";
+    std::ofstream out(sgfName.c_str());
+    if (!out)
+    {
+        LogWarning() << "Cannot write '" << sgfName << "'\n";
+        return;
+    }
+    const std::size_t black = (result.index % 2) == 0 ? 0 : 1;
+    out << "(\n;"
+        << "GM[11]SZ[" << m_program.BoardSize() << "]"
+        << "PB[" << SgfText(result.black) << "]"
+        << "PW[" << SgfText(result.white) << "]\n"
+        << "RE[" << result.result << "]DT[" << TimeString("%Y-%m-%d")
+        << "]GN[" << name << "]US[benzene-selfplay]\n"
+        << "GC[Generated by benzene-selfplay.\n"
+        << "Black Cmd: " << SgfText(m_side[black]->Description()) << '\n'
+        << "White Cmd: " << SgfText(m_side[1 - black]->Description()) << '\n'
+        << "Time: " << SgfText(TimeString("%Y-%m-%d %X %Z")) << '\n'
+        << "Result according to B: " << result.result << '\n'
+        << "Result according to W: " << result.result << "]\n";
+    HexColor color = FIRST_TO_PLAY;
+    for (std::size_t i = 0; i < result.moves.size(); ++i)
+    {
+        out << ';' << (color == BLACK ? 'B' : 'W') << '['
+            << result.moves[i] << "]\n";
+        color = !color;
+    }
+    if (result.resigned != EMPTY)
+        out << ';' << (result.resigned == BLACK ? 'B' : 'W')
+            << "[resign]\n";
+    out << ")\n";
+}
+
+//----------------------------------------------------------------------------
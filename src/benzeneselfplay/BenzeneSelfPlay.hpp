@@ -0,0 +1,122 @@
+//----------------------------------------------------------------------------
+/** @file BenzeneSelfPlay.hpp */
+//----------------------------------------------------------------------------
+
+#ifndef BENZENESELFPLAY_HPP
+#define BENZENESELFPLAY_HPP
+
+#include <map>
+#include <string>
+#include <vector>
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include "BenzeneSelfPlayProgram.hpp"
+#include "SelfPlaySide.hpp"
+
+_BEGIN_BENZENE_NAMESPACE_
+
+//----------------------------------------------------------------------------
+
+/** Result of a single self-play game. */
+struct SelfPlayResult
+{
+    int index;
+
+    int round;
+
+    std::string opening;
+
+    std::string black;
+
+    std::string white;
+
+    /** "B+", "W+" or "?" if the game had an error. */
+    std::string result;
+
+    /** Number of moves, including the opening. */
+    int length;
+
+    double elapsed[BLACK_AND_WHITE];
+
+    bool error;
+
+    std::string errorMessage;
+
+    /** Moves of the game, excluding the final resign. */
+    std::vector<HexPoint> moves;
+
+    /** Color that resigned; EMPTY if the game had an error. */
+    HexColor resigned;
+};
+
+//----------------------------------------------------------------------------
+
+/** Plays an iterative tournament between two programs in one
+    process, with several games running at the same time.
+
+    In each round both programs take black once with every opening.
+    Results are appended to the file "results" in the output
+    directory, in the format written by tournament.py, so the
+    existing summary scripts work unchanged; each game is saved as
+    an sgf file named after its index. An existing results file is
+    continued after its last game.
+
+    Swap is not allowed in these games. */
+class BenzeneSelfPlay
+{
+public:
+    BenzeneSelfPlay(const BenzeneSelfPlayProgram& program);
+
+    ~BenzeneSelfPlay();
+
+    /** Plays all remaining games. */
+    void Run();
+
+    /** Plays game index with a player for each side and their work
+        boards. Called from the game threads. */
+    SelfPlayResult PlayGame(int index,
+                            SelfPlayer& p1, HexBoard& p1Brd,
+                            SelfPlayer& p2, HexBoard& p2Brd) const;
+
+    /** Saves the game and adds it to the results file once all games
+        before it have been added. Called from the game threads. */
+    void AddResult(const SelfPlayResult& result);
+
+private:
+    const BenzeneSelfPlayProgram& m_program;
+
+    boost::scoped_ptr<SelfPlaySide> m_side[2];
+
+    std::vector<std::string> m_openings;
+
+    std::string m_resultsName;
+
+    /** Index of the next game to go into the results file. */
+    int m_nextResult;
+
+    /** Finished games waiting for earlier games. */
+    std::map<int, SelfPlayResult> m_pending;
+
+    boost::mutex m_resultsMutex;
+
+    void LoadOpenings();
+
+    /** Sets last to the index of the last game in the results file;
+        returns false if there is no results file yet. */
+    bool FindLastIndex(int& last) const;
+
+    void WriteHeader() const;
+
+    void WriteTimeStamp() const;
+
+    void WriteResult(const SelfPlayResult& result) const;
+
+    void SaveGame(const SelfPlayResult& result) const;
+};
+
+//----------------------------------------------------------------------------
+
+_END_BENZENE_NAMESPACE_
+
+#endif // BENZENESELFPLAY_HPP
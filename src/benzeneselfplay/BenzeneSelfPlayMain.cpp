@@ -0,0 +1,63 @@
+//----------------------------------------------------------------------------
+/** @file BenzeneSelfPlayMain.cpp */
+//----------------------------------------------------------------------------
+
+#include "SgSystem.h"
+
+#include <iostream>
+
+#include "config.h"
+#include "BenzeneSelfPlay.hpp"
+#include "BenzeneSelfPlayProgram.hpp"
+#include "Misc.hpp"
+
+using namespace benzene;
+
+//----------------------------------------------------------------------------
+
+/** @page benzeneselfplaymainpage BenzeneSelfPlay
+
+    @section overview Overview
+
+    Plays a tournament between two configurations of MoHex or Wolve
+    inside a single process, running several games at the same time.
+    The players of each side share their read-only data (MoHex
+    patterns, ICE patterns, the opening book), so many games fit in
+    the memory of one process. Results and games are written in the
+    same format as tournament.py, so the scripts in the tournament
+    directory (summary.py, statistics.py) can be used on them.
+
+    Run <tt>benzene-selfplay --help</tt> for the list of options.
+*/
+
+//----------------------------------------------------------------------------
+
+namespace {
+
+const char* build_date = __DATE__;
+
+}
+
+//----------------------------------------------------------------------------
+
+int main(int argc, char** argv)
+{
+    MiscUtil::FindProgramDir(argc, argv);
+    BenzeneSelfPlayProgram program(VERSION, build_date);
+    BenzeneEnvironment::Get().RegisterProgram(program);
+    program.Initialize(argc, argv);
+    try
+    {
+        BenzeneSelfPlay selfPlay(program);
+        selfPlay.Run();
+    }
+    catch (const BenzeneException& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    program.Shutdown();
+    return 0;
+}
+
+//----------------------------------------------------------------------------
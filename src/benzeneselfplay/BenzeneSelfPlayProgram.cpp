@@ -0,0 +1,133 @@
+//----------------------------------------------------------------------------
+/** @file BenzeneSelfPlayProgram.cpp */
+//----------------------------------------------------------------------------
+
+#include "BenzeneException.hpp"
+#include "BenzeneSelfPlayProgram.hpp"
+
+#include <sstream>
+#include <boost/program_options/cmdline.hpp>
+#include <boost/program_options/variables_map.hpp>
+#include <boost/program_options/parsers.hpp>
+
+namespace po = boost::program_options;
+
+using namespace benzene;
+
+//----------------------------------------------------------------------------
+
+namespace {
+
+/** Returns the type followed by the base name of the config file,
+    as the tournament scripts name their programs. */
+std::string DefaultName(const std::string& type, const std::string& config)
+{
+    if (config.empty())
+        return type;
+    std::string base = config;
+    std::string::size_type slash = base.rfind('/');
+    if (slash != std::string::npos)
+        base = base.substr(slash + 1);
+    std::string::size_type dot = base.rfind('.');
+    if (dot != std::string::npos && dot > 0)
+        base = base.substr(0, dot);
+    return type + "-" + base;
+}
+
+} // namespace
+
+//----------------------------------------------------------------------------
+
+BenzeneSelfPlayProgram::BenzeneSelfPlayProgram(std::string version,
+                                               std::string buildDate)
+{
+    SetInfo("BenzeneSelfPlay", version, buildDate);
+    RegisterCmdLineArguments();
+}
+
+BenzeneSelfPlayProgram::~BenzeneSelfPlayProgram()
+{
+}
+
+//----------------------------------------------------------------------------
+
+void BenzeneSelfPlayProgram::RegisterCmdLineArguments()
+{
+    CommonProgram::RegisterCmdLineArguments();
+    m_options_desc.add_options()
+        ("selfplay-p1",
+         po::value<std::string>(&m_playerType[0])->default_value("mohex"),
+         "Type of the first player (mohex or wolve).")
+        ("selfplay-p1-config",
+         po::value<std::string>(&m_playerConfig[0])->default_value(""),
+         "HTP file that configures the first player.")
+        ("selfplay-p1-name",
+         po::value<std::string>(&m_playerName[0])->default_value(""),
+         "Name of the first player in the results.")
+        ("selfplay-p2",
+         po::value<std::string>(&m_playerType[1])->default_value("mohex"),
+         "Type of the second player (mohex or wolve).")
+        ("selfplay-p2-config",
+         po::value<std::string>(&m_playerConfig[1])->default_value(""),
+         "HTP file that configures the second player.")
+        ("selfplay-p2-name",
+         po::value<std::string>(&m_playerName[1])->default_value(""),
+         "Name of the second player in the results.")
+        ("selfplay-openings",
+         po::value<std::string>(&m_openings)->default_value(""),
+         "Openings file (default: tournament/openings/NxN-all-1ply).")
+        ("selfplay-rounds",
+         po::value<int>(&m_rounds)->default_value(10),
+         "Number of rounds to play.")
+        ("selfplay-games",
+         po::value<int>(&m_games)->default_value(2),
+         "Number of games played at the same time.")
+        ("selfplay-dir",
+         po::value<std::string>(&m_directory)->default_value("."),
+         "Directory for the results file and the games.");
+}
+
+void BenzeneSelfPlayProgram::HandleCmdLineArguments()
+{
+    CommonProgram::HandleCmdLineArguments();
+    for (int i = 0; i < 2; ++i)
+    {
+        if (m_playerType[i] != "mohex" && m_playerType[i] != "wolve")
+            throw BenzeneException() << "Unknown player type '"
+                                     << m_playerType[i] << "'";
+        if (m_playerName[i].empty())
+            m_playerName[i] = DefaultName(m_playerType[i], m_playerConfig[i]);
+    }
+    // Distinguish between the instances so the results can be told
+    // apart, as the tournament scripts do.
+    if (m_playerName[0] == m_playerName[1])
+    {
+        m_playerName[0] += "-a";
+        m_playerName[1] += "-b";
+    }
+    if (m_openings.empty())
+    {
+        std::ostringstream os;
+        os << ABS_TOP_SRCDIR << "/tournament/openings/"
+           << BoardSize() << 'x' << BoardSize() << "-all-1ply";
+        m_openings = os.str();
+    }
+    if (m_rounds < 1)
+        m_rounds = 1;
+    if (m_games < 1)
+        m_games = 1;
+}
+
+void BenzeneSelfPlayProgram::InitializeSystem()
+{
+    LogConfig() << "BenzeneSelfPlayProgram:: InitializeSystem()\n";
+    CommonProgram::InitializeSystem();
+}
+
+void BenzeneSelfPlayProgram::ShutdownSystem()
+{
+    LogConfig() << "BenzeneSelfPlayProgram:: ShutdownSystem()\n";
+    CommonProgram::ShutdownSystem();
+}
+
+//----------------------------------------------------------------------------
@@ -0,0 +1,111 @@
+//----------------------------------------------------------------------------
+/** @file BenzeneSelfPlayProgram.hpp */
+//----------------------------------------------------------------------------
+
+#ifndef BENZENESELFPLAYPROGRAM_HPP
+#define BENZENESELFPLAYPROGRAM_HPP
+
+#include "CommonProgram.hpp"
+
+_BEGIN_BENZENE_NAMESPACE_
+
+//----------------------------------------------------------------------------
+
+/** Starts up a BenzeneSelfPlay program. */
+class BenzeneSelfPlayProgram : public CommonProgram
+{
+public:
+    BenzeneSelfPlayProgram(std::string version, std::string buildDate);
+
+    virtual ~BenzeneSelfPlayProgram();
+
+    //-----------------------------------------------------------------------
+
+    virtual void RegisterCmdLineArguments();
+
+    virtual void HandleCmdLineArguments();
+
+    virtual void InitializeSystem();
+
+    virtual void ShutdownSystem();
+
+    //-----------------------------------------------------------------------
+
+    /** Type of player i (0 or 1): "mohex" or "wolve". */
+    const std::string& PlayerType(int i) const;
+
+    /** HTP file configuring player i; empty for default settings. */
+    const std::string& PlayerConfig(int i) const;
+
+    /** Name of player i in the results file. */
+    const std::string& PlayerName(int i) const;
+
+    /** File with one opening per line. */
+    const std::string& Openings() const;
+
+    /** Number of rounds; in each round both players take black once
+        with every opening. */
+    int Rounds() const;
+
+    /** Number of games played at the same time. */
+    int Games() const;
+
+    /** Directory for the results file and the sgf files. */
+    const std::string& Directory() const;
+
+private:
+    std::string m_playerType[2];
+
+    std::string m_playerConfig[2];
+
+    std::string m_playerName[2];
+
+    std::string m_openings;
+
+    int m_rounds;
+
+    int m_games;
+
+    std::string m_directory;
+};
+
+inline const std::string& BenzeneSelfPlayProgram::PlayerType(int i) const
+{
+    return m_playerType[i];
+}
+
+inline const std::string& BenzeneSelfPlayProgram::PlayerConfig(int i) const
+{
+    return m_playerConfig[i];
+}
+
+inline const std::string& BenzeneSelfPlayProgram::PlayerName(int i) const
+{
+    return m_playerName[i];
+}
+
+inline const std::string& BenzeneSelfPlayProgram::Openings() const
+{
+    return m_openings;
+}
+
+inline int BenzeneSelfPlayProgram::Rounds() const
+{
+    return m_rounds;
+}
+
+inline int BenzeneSelfPlayProgram::Games() const
+{
+    return m_games;
+}
+
+inline const std::string& BenzeneSelfPlayProgram::Directory() const
+{
+    return m_directory;
+}
+
+//----------------------------------------------------------------------------
+
+_END_BENZENE_NAMESPACE_
+
+#endif // BENZENESELFPLAYPROGRAM_HPP
@@ -0,0 +1,257 @@
+//----------------------------------------------------------------------------
+/** @file SelfPlaySide.cpp */
+//----------------------------------------------------------------------------
+
+#include "SgSystem.h"
+
+#include "MoHexEngine.hpp"
+#include "MoHexPlayer.hpp"
+#include "SelfPlaySide.hpp"
+#include "WolveEngine.hpp"
+#include "WolvePlayer.hpp"
+#include "WolveTimeControl.hpp"
+
+#include <boost/thread/mutex.hpp>
+
+using namespace benzene;
+
+//----------------------------------------------------------------------------
+
+namespace {
+
+//----------------------------------------------------------------------------
+
+std::string Description(const std::string& type, const std::string& config)
+{
+    if (config.empty())
+        return type;
+    return type + " " + config;
+}
+
+//----------------------------------------------------------------------------
+
+class MoHexSide : public SelfPlaySide
+{
+public:
+    MoHexSide(const std::string& name, const std::string& config,
+              int boardsize);
+
+    const HexBoard& PlayerBoard() const;
+
+    boost::shared_ptr<SelfPlayer> CreatePlayer(std::size_t numPlayers);
+
+    /** The player configured by the HTP file. */
+    MoHexPlayer& Prototype();
+
+    /** Book move for state; the book is shared by all games. */
+    HexPoint BookMove(const HexState& state);
+
+private:
+    MoHexPlayer m_prototype;
+
+    MoHexEngine m_engine;
+
+    boost::mutex m_bookMutex;
+};
+
+/** MoHex player that shares the patterns of the prototype. */
+class MoHexSelfPlayer : public SelfPlayer
+{
+public:
+    MoHexSelfPlayer(MoHexSide& side, std::size_t numPlayers);
+
+    HexPoint GenMove(const Game& game, HexColor color, HexBoard& brd);
+
+private:
+    MoHexSide& m_side;
+
+    MoHexPlayer m_player;
+};
+
+MoHexSide::MoHexSide(const std::string& name, const std::string& config,
+                     int boardsize)
+    : SelfPlaySide(name, Description("mohex", config)),
+      m_prototype(),
+      m_engine(boardsize, m_prototype)
+{
+    if (!config.empty())
+        m_engine.ExecuteFile(config);
+}
+
+const HexBoard& MoHexSide::PlayerBoard() const
+{
+    return m_engine.PlayerBoard();
+}
+
+boost::shared_ptr<SelfPlayer> MoHexSide::CreatePlayer(std::size_t numPlayers)
+{
+    return boost::shared_ptr<SelfPlayer>
+        (new MoHexSelfPlayer(*this, numPlayers));
+}
+
+MoHexPlayer& MoHexSide::Prototype()
+{
+    return m_prototype;
+}
+
+HexPoint MoHexSide::BookMove(const HexState& state)
+{
+    boost::mutex::scoped_lock lock(m_bookMutex);
+    return m_engine.BookMove(state);
+}
+
+MoHexSelfPlayer::MoHexSelfPlayer(MoHexSide& side, std::size_t numPlayers)
+    : m_side(side),
+      m_player(side.Prototype().SharedPolicy())
+{
+    m_player.CopySettingsFrom(side.Prototype(), numPlayers);
+    m_player.SetReuseSubtree(side.Prototype().ReuseSubtree());
+    // Games would interleave their gfx output
+    m_player.Search().SetLiveGfx(false);
+}
+
+HexPoint MoHexSelfPlayer::GenMove(const Game& game, HexColor color,
+                                  HexBoard& brd)
+{
+    HexState state(game.Board(), color);
+    HexPoint bookMove = m_side.BookMove(state);
+    if (bookMove != INVALID_POINT)
+        return bookMove;
+    double maxTime = m_player.MaxTime();
+    if (m_player.UseTimeManagement())
+        maxTime = game.TimeRemaining(color) * 0.08;
+    double score;
+    brd.GetPosition().SetPosition(game.Board());
+    return m_player.GenMove(state, game, brd, maxTime, score);
+}
+
+//----------------------------------------------------------------------------
+
+class WolveSide : public SelfPlaySide
+{
+public:
+    WolveSide(const std::string& name, const std::string& config,
+              int boardsize);
+
+    const HexBoard& PlayerBoard() const;
+
+    boost::shared_ptr<SelfPlayer> CreatePlayer(std::size_t numPlayers);
+
+    /** The player configured by the HTP file. */
+    const WolvePlayer& Prototype() const;
+
+    /** Cache book move for state; the book is shared by all games. */
+    HexPoint BookMove(const HexState& state);
+
+private:
+    WolvePlayer m_prototype;
+
+    WolveEngine m_engine;
+
+    boost::mutex m_bookMutex;
+};
+
+/** Wolve player with its own hashtable. */
+class WolveSelfPlayer : public SelfPlayer
+{
+public:
+    WolveSelfPlayer(WolveSide& side, std::size_t numPlayers);
+
+    HexPoint GenMove(const Game& game, HexColor color, HexBoard& brd);
+
+private:
+    WolveSide& m_side;
+
+    WolvePlayer m_player;
+};
+
+WolveSide::WolveSide(const std::string& name, const std::string& config,
+                     int boardsize)
+    : SelfPlaySide(name, Description("wolve", config)),
+      m_prototype(),
+      m_engine(boardsize, m_prototype)
+{
+    if (!config.empty())
+        m_engine.ExecuteFile(config);
+}
+
+const HexBoard& WolveSide::PlayerBoard() const
+{
+    return m_engine.PlayerBoard();
+}
+
+boost::shared_ptr<SelfPlayer> WolveSide::CreatePlayer(std::size_t numPlayers)
+{
+    return boost::shared_ptr<SelfPlayer>
+        (new WolveSelfPlayer(*this, numPlayers));
+}
+
+const WolvePlayer& WolveSide::Prototype() const
+{
+    return m_prototype;
+}
+
+HexPoint WolveSide::BookMove(const HexState& state)
+{
+    boost::mutex::scoped_lock lock(m_bookMutex);
+    return m_engine.BookMove(state);
+}
+
+WolveSelfPlayer::WolveSelfPlayer(WolveSide& side, std::size_t numPlayers)
+    : m_side(side),
+      m_player()
+{
+    m_player.CopySettingsFrom(side.Prototype(), numPlayers);
+}
+
+HexPoint WolveSelfPlayer::GenMove(const Game& game, HexColor color,
+                                  HexBoard& brd)
+{
+    HexState state(game.Board(), color);
+    HexPoint bookMove = m_side.BookMove(state);
+    if (bookMove != INVALID_POINT)
+        return bookMove;
+    double maxTime = m_player.MaxTime();
+    if (m_player.UseTimeManagement())
+        maxTime = WolveTimeControl::TimeForMove(game,
+                                                game.TimeRemaining(color));
+    double score;
+    brd.GetPosition().SetPosition(game.Board());
+    return m_player.GenMove(state, game, brd, maxTime, score);
+}
+
+//----------------------------------------------------------------------------
+
+} // namespace
+
+//----------------------------------------------------------------------------
+
+SelfPlayer::~SelfPlayer()
+{
+}
+
+//----------------------------------------------------------------------------
+
+SelfPlaySide::SelfPlaySide(const std::string& name,
+                           const std::string& description)
+    : m_name(name),
+      m_description(description)
+{
+}
+
+SelfPlaySide::~SelfPlaySide()
+{
+}
+
+SelfPlaySide* SelfPlaySide::Create(const std::string& type,
+                                   const std::string& name,
+                                   const std::string& config, int boardsize)
+{
+    if (type == "mohex")
+        return new MoHexSide(name, config, boardsize);
+    if (type == "wolve")
+        return new WolveSide(name, config, boardsize);
+    throw BenzeneException() << "Unknown player type '" << type << "'";
+}
+
+//----------------------------------------------------------------------------
@@ -0,0 +1,88 @@
+//----------------------------------------------------------------------------
+/** @file SelfPlaySide.hpp */
+//----------------------------------------------------------------------------
+
+#ifndef SELFPLAYSIDE_HPP
+#define SELFPLAYSIDE_HPP
+
+#include "Game.hpp"
+#include "HexBoard.hpp"
+
+#include <boost/shared_ptr.hpp>
+
+_BEGIN_BENZENE_NAMESPACE_
+
+//----------------------------------------------------------------------------
+
+/** A player in one of the games of a self-play run. */
+class SelfPlayer
+{
+public:
+    virtual ~SelfPlayer();
+
+    /** Generates a move for color in the current position of game.
+        brd is the work board of this player. Returns RESIGN if the
+        game is lost. */
+    virtual HexPoint GenMove(const Game& game, HexColor color,
+                             HexBoard& brd) = 0;
+};
+
+//----------------------------------------------------------------------------
+
+/** One of the two programs in a self-play run.
+
+    A side owns a prototype player and an engine that configures it
+    from an HTP file. Players created for the concurrent games copy
+    the prototype's settings and share its read-only data (MoHex
+    patterns, the ICEngine of the player board, the book). */
+class SelfPlaySide
+{
+public:
+    virtual ~SelfPlaySide();
+
+    /** Name used in the results file. */
+    const std::string& Name() const;
+
+    /** Description of the program for the sgf files. */
+    const std::string& Description() const;
+
+    /** Board configured by the HTP file; work boards for the
+        players are copies of it. */
+    virtual const HexBoard& PlayerBoard() const = 0;
+
+    /** Creates a player for a single game thread; numPlayers
+        players are created in total and share the prototype's
+        memory. */
+    virtual boost::shared_ptr<SelfPlayer>
+    CreatePlayer(std::size_t numPlayers) = 0;
+
+    /** Creates a side of the given type ("mohex" or "wolve") and
+        executes the HTP file config (if not empty). */
+    static SelfPlaySide* Create(const std::string& type,
+                                const std::string& name,
+                                const std::string& config, int boardsize);
+
+protected:
+    SelfPlaySide(const std::string& name, const std::string& description);
+
+private:
+    std::string m_name;
+
+    std::string m_description;
+};
+
+inline const std::string& SelfPlaySide::Name() const
+{
+    return m_name;
+}
+
+inline const std::string& SelfPlaySide::Description() const
+{
+    return m_description;
+}
+
+//----------------------------------------------------------------------------
+
+_END_BENZENE_NAMESPACE_
+
+#endif // SELFPLAYSIDE_HPP
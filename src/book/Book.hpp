@@ -34,7 +34,7 @@ public:
 
     byte* Pack() const;
 
-    void Unpack(const byte* t);
+    void Unpack(const byte* t, int size);
 
     void Rotate(const ConstBoard& brd);
 
@@ -68,8 +68,10 @@ inline byte* HexBookNode::Pack() const
     return (byte*)this;
 }
 
-inline void HexBookNode::Unpack(const byte* t)
+inline void HexBookNode::Unpack(const byte* t, int size)
 {
+    if (size < PackedSize())
+        throw BenzeneException("HexBookNode: truncated data!");
     *this = *(const HexBookNode*)t;
 }
 
@@ -14,7 +14,7 @@
 #include "EndgameUtil.hpp"
 #include "StateDB.hpp"
 #include "Resistance.hpp"
-#include "SgThreadedWorker.h"
+#include "TaskScheduler.hpp"
 #include "SgBookBuilder.h"
 #include "SgUctSearch.h"
 
@@ -181,7 +181,7 @@ private:
 
     std::vector<Worker> m_workers;
 
-    SgThreadedWorker<SgMove,float,Worker>* m_threadedWorker;
+    TaskWorker<SgMove,float,Worker>* m_taskWorker;
 
     void CreateWorkers();
 
@@ -243,7 +243,7 @@ void BookBuilder<PLAYER>::CreateWorkers()
     {
         PLAYER* newPlayer = new PLAYER();
         /** @todo Use concept checking to verify this method exists. */
-        newPlayer->CopySettingsFrom(m_orig_player);
+        newPlayer->CopySettingsFrom(m_orig_player, m_num_threads);
         newPlayer->SetSearchSingleton(true);
         // Set select to something not SG_UCTMOVESELECT_COUNT to
         // force it to perform the required number of playouts.
@@ -253,8 +253,8 @@ void BookBuilder<PLAYER>::CreateWorkers()
         m_boards.push_back(new HexBoard(*m_brd));
         m_workers.push_back(Worker(i, *m_players[i], *m_boards[i]));
     }
-    m_threadedWorker 
-        = new SgThreadedWorker<SgMove,float,Worker>(m_workers);
+    m_taskWorker 
+        = new TaskWorker<SgMove,float,Worker>(m_workers);
 }
 
 /** Destroys copied players, boards, and threads. */
@@ -267,7 +267,7 @@ void BookBuilder<PLAYER>::DestroyWorkers()
         delete m_boards[i];
         delete m_players[i];
     }
-    delete m_threadedWorker;
+    delete m_taskWorker;
     m_workers.clear();
     m_boards.clear();
     m_players.clear();
@@ -486,7 +486,7 @@ void BookBuilder<PLAYER>
 ::EvaluateChildren(const std::vector<SgMove>& childrenToDo,
                    std::vector<std::pair<SgMove, float> >& scores)
 {
-    m_threadedWorker->DoWork(childrenToDo, scores);
+    m_taskWorker->DoWork(childrenToDo, scores);
 }
 
 template<class PLAYER>
@@ -0,0 +1,338 @@
+//----------------------------------------------------------------------------
+/** @file BatchAnalysis.cpp */
+//----------------------------------------------------------------------------
+
+#include "SgSystem.h"
+#include "SgGameReader.h"
+
+#include "BatchAnalysis.hpp"
+#include "EndgameUtil.hpp"
+#include "HexSgUtil.hpp"
+#include "Resistance.hpp"
+#include "TaskScheduler.hpp"
+#include "VCPattern.hpp"
+
+#include <fstream>
+#include <iomanip>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+
+using namespace benzene;
+
+//----------------------------------------------------------------------------
+
+namespace {
+
+//----------------------------------------------------------------------------
+
+/** Plays move for color, checking that it is an empty cell. */
+void PlayBatchMove(StoneBoard& position, HexColor color, HexPoint move,
+                   const std::string& where)
+{
+    if (!position.Const().IsCell(move) || position.IsOccupied(move))
+        throw BenzeneException() << where << ": invalid move '"
+                                 << move << "'";
+    position.PlayMove(color, move);
+}
+
+/** A game without a size property is read at the size of brd. */
+void ReadSgf(std::istream& in, const StoneBoard& brd,
+             std::vector<HexState>& states)
+{
+    SgGameReader reader(in, brd.Width());
+    SgNode* root = reader.ReadGame();
+    if (root == 0)
+        throw BenzeneException() << "cannot read sgf";
+    reader.PrintWarnings(std::cerr);
+    int size = root->HasProp(SG_PROP_SIZE) 
+        ? root->GetIntProp(SG_PROP_SIZE) : brd.Width();
+    if (size != brd.Width() || size != brd.Height())
+    {
+        root->DeleteTree();
+        throw BenzeneException() << "sgf boardsize does not match board";
+    }
+    StoneBoard position(brd.Width(), brd.Height());
+    for (SgNode* cur = root; cur; cur = cur->NodeInDirection(SgNode::NEXT))
+    {
+        if (HexSgUtil::NodeHasSetupInfo(cur))
+        {
+            root->DeleteTree();
+            throw BenzeneException() << "sgf has setup info";
+        }
+        if (!cur->HasNodeMove())
+            continue;
+        HexColor color = HexSgUtil::SgColorToHexColor(cur->NodePlayer());
+        HexPoint move = HexSgUtil::SgPointToHexPoint(cur->NodeMove(),
+                                                     position.Height());
+        try {
+            PlayBatchMove(position, color, move, "sgf");
+        }
+        catch (...) {
+            root->DeleteTree();
+            throw;
+        }
+        states.push_back(HexState(position, !color));
+    }
+    root->DeleteTree();
+}
+
+void ReadLines(std::istream& in, const StoneBoard& brd,
+               std::vector<HexState>& states)
+{
+    std::string line;
+    for (std::size_t lineNumber = 1; std::getline(in, line); ++lineNumber)
+    {
+        std::istringstream is(line);
+        std::string token;
+        if (!(is >> token) || token[0] == '#')
+            continue;
+        std::ostringstream where;
+        where << "line " << lineNumber;
+        StoneBoard position(brd.Width(), brd.Height());
+        HexColor color = FIRST_TO_PLAY;
+        do {
+            PlayBatchMove(position, color, HexPointUtil::FromString(token),
+                          where.str());
+            color = !color;
+        } while (is >> token);
+        states.push_back(HexState(position, color));
+    }
+}
+
+//----------------------------------------------------------------------------
+
+/** A solved state and its data. */
+typedef std::pair<HexState, DfpnData> SolvedEntry;
+
+/** Solves states of a batch with a private solver, board and hash
+    table. Only the accesses to the shared database are serialized.
+    The solved entries along the principal variation of each state
+    are kept, so they can be added to the shared position set once
+    the batch is done. */
+class SolveWorker
+{
+public:
+    SolveWorker(const std::vector<HexState>& states, const DfpnSolver& solver,
+                const HexBoard& brd, DfpnStates& positions, int maxHash,
+                boost::mutex& databaseMutex);
+
+    std::string operator()(const std::size_t& index);
+
+    const std::vector<SolvedEntry>& Solved() const;
+
+private:
+    const std::vector<HexState>* m_states;
+
+    boost::shared_ptr<HexBoard> m_brd;
+
+    boost::shared_ptr<DfpnSolver> m_solver;
+
+    boost::shared_ptr<boost::scoped_ptr<DfpnHashTable> > m_hashTable;
+
+    boost::shared_ptr<DfpnStates> m_positions;
+
+    boost::shared_ptr<std::vector<SolvedEntry> > m_solved;
+};
+
+/** Uses no hash table if positions has none. */
+SolveWorker::SolveWorker(const std::vector<HexState>& states,
+                         const DfpnSolver& solver, const HexBoard& brd,
+                         DfpnStates& positions, int maxHash,
+                         boost::mutex& databaseMutex)
+    : m_states(&states),
+      m_brd(new HexBoard(brd)),
+      m_solver(new DfpnSolver()),
+      m_hashTable(new boost::scoped_ptr<DfpnHashTable>()),
+      m_positions(new DfpnStates(*m_hashTable, positions)),
+      m_solved(new std::vector<SolvedEntry>())
+{
+    if (positions.HashTable())
+    {
+        m_hashTable->reset(new DfpnHashTable(maxHash));
+        (*m_hashTable)->CopySettingsFrom(*positions.HashTable());
+    }
+    m_positions->SetDatabaseMutex(&databaseMutex);
+    m_solver->CopySettingsFrom(solver);
+    // Workers would interleave their gfx output
+    m_solver->SetUseGuiFx(false);
+}
+
+std::string SolveWorker::operator()(const std::size_t& index)
+{
+    const HexState& state = (*m_states)[index];
+    m_brd->GetPosition().SetPosition(state.Position());
+    PointSequence pv;
+    HexColor winner = m_solver->StartSearch(state, *m_brd, *m_positions, pv);
+    HexState cur(state);
+    for (std::size_t i = 0; i <= pv.size(); ++i)
+    {
+        if (i > 0)
+            cur.PlayMove(pv[i - 1]);
+        DfpnData data;
+        if (m_positions->Get(cur, data) && data.m_bounds.IsSolved())
+            m_solved->push_back(SolvedEntry(cur, data));
+    }
+    std::ostringstream os;
+    os << winner << ' ' << HexPointUtil::ToString(pv);
+    LogInfo() << "Batch " << index << ": " << os.str() << '\n';
+    return os.str();
+}
+
+const std::vector<SolvedEntry>& SolveWorker::Solved() const
+{
+    return *m_solved;
+}
+
+/** Size of the hash table of each of numWorkers workers, so that
+    together they are no larger than tt. */
+int WorkerHashSize(const DfpnHashTable* tt, std::size_t numWorkers)
+{
+    const int MIN_HASH = 1 << 10;
+    if (tt == 0)
+        return 0;
+    int maxHash = tt->MaxHash();
+    for (std::size_t n = 1; n < numWorkers && maxHash > MIN_HASH; n *= 2)
+        maxHash /= 2;
+    return maxHash;
+}
+
+/** Evaluates states of a batch on a private board. */
+class EvaluateWorker
+{
+public:
+    EvaluateWorker(const std::vector<HexState>& states, const HexBoard& brd);
+
+    std::string operator()(const std::size_t& index);
+
+private:
+    const std::vector<HexState>* m_states;
+
+    boost::shared_ptr<HexBoard> m_brd;
+};
+
+EvaluateWorker::EvaluateWorker(const std::vector<HexState>& states,
+                               const HexBoard& brd)
+    : m_states(&states),
+      m_brd(new HexBoard(brd))
+{
+}
+
+std::string EvaluateWorker::operator()(const std::size_t& index)
+{
+    const HexState& state = (*m_states)[index];
+    HexColor toPlay = state.ToPlay();
+    HexBoard& brd = *m_brd;
+    brd.GetPosition().SetPosition(state.Position());
+    brd.ComputeAll(toPlay);
+    HexColor winner = EMPTY;
+    std::size_t numConsider = 0;
+    if (EndgameUtil::IsWonGame(brd, toPlay))
+        winner = toPlay;
+    else if (EndgameUtil::IsLostGame(brd, toPlay))
+        winner = !toPlay;
+    else
+        numConsider = EndgameUtil::MovesToConsider(brd, toPlay).count();
+    Resistance resist;
+    resist.Evaluate(brd);
+    std::ostringstream os;
+    os << winner << ' ' << std::fixed << std::setprecision(3)
+       << resist.Score() << ' ' << numConsider;
+    LogInfo() << "Batch " << index << ": " << os.str() << '\n';
+    return os.str();
+}
+
+/** Runs the workers over all states and puts the results in input
+    order. */
+template<class WORKER>
+void RunWorkers(std::vector<WORKER>& workers, std::size_t numStates,
+                std::vector<std::string>& results)
+{
+    std::vector<std::size_t> work;
+    for (std::size_t i = 0; i < numStates; ++i)
+        work.push_back(i);
+    std::vector<std::pair<std::size_t, std::string> > output;
+    {
+        TaskWorker<std::size_t, std::string, WORKER>
+            taskWorker(workers);
+        taskWorker.DoWork(work, output);
+    }
+    results.assign(numStates, std::string());
+    for (std::size_t i = 0; i < output.size(); ++i)
+        results[output[i].first] = output[i].second;
+}
+
+/** Number of threads to use for numStates states. */
+std::size_t NumWorkers(std::size_t numThreads, std::size_t numStates)
+{
+    return std::max(static_cast<std::size_t>(1),
+                    std::min(numThreads, numStates));
+}
+
+//----------------------------------------------------------------------------
+
+} // namespace
+
+//----------------------------------------------------------------------------
+
+void BatchAnalysis::ReadPositions(const std::string& filename,
+                                  const StoneBoard& brd,
+                                  std::vector<HexState>& states)
+{
+    std::ifstream in(filename.c_str());
+    if (!in)
+        throw BenzeneException() << "cannot open '" << filename << "'";
+    const std::string sgf = ".sgf";
+    if (filename.size() >= sgf.size()
+        && filename.compare(filename.size() - sgf.size(),
+                            sgf.size(), sgf) == 0)
+        ReadSgf(in, brd, states);
+    else
+        ReadLines(in, brd, states);
+}
+
+void BatchAnalysis::Solve(const std::vector<HexState>& states,
+                          const DfpnSolver& solver, const HexBoard& brd,
+                          DfpnStates& positions, std::size_t numThreads,
+                          std::vector<std::string>& results)
+{
+    results.clear();
+    if (states.empty())
+        return;
+    // Build the pattern tables before the threads need them
+    VCPattern::GetPatterns(brd.Width(), brd.Height(), BLACK);
+    boost::mutex databaseMutex;
+    std::size_t numWorkers = NumWorkers(numThreads, states.size());
+    int maxHash = WorkerHashSize(positions.HashTable(), numWorkers);
+    std::vector<SolveWorker> workers;
+    for (std::size_t i = 0; i < numWorkers; ++i)
+        workers.push_back(SolveWorker(states, solver, brd, positions,
+                                      maxHash, databaseMutex));
+    LogInfo() << "BatchAnalysis: solving " << states.size() << " states on "
+              << workers.size() << " threads\n";
+    RunWorkers(workers, states.size(), results);
+    for (std::size_t i = 0; i < workers.size(); ++i)
+    {
+        const std::vector<SolvedEntry>& solved = workers[i].Solved();
+        for (std::size_t j = 0; j < solved.size(); ++j)
+            positions.Put(solved[j].first, solved[j].second);
+    }
+}
+
+void BatchAnalysis::Evaluate(const std::vector<HexState>& states,
+                             const HexBoard& brd, std::size_t numThreads,
+                             std::vector<std::string>& results)
+{
+    results.clear();
+    if (states.empty())
+        return;
+    // Build the pattern tables before the threads need them
+    VCPattern::GetPatterns(brd.Width(), brd.Height(), BLACK);
+    std::vector<EvaluateWorker> workers;
+    for (std::size_t i = 0; i < NumWorkers(numThreads, states.size()); ++i)
+        workers.push_back(EvaluateWorker(states, brd));
+    LogInfo() << "BatchAnalysis: evaluating " << states.size()
+              << " states on " << workers.size() << " threads\n";
+    RunWorkers(workers, states.size(), results);
+}
+
+//----------------------------------------------------------------------------
@@ -0,0 +1,58 @@
+//----------------------------------------------------------------------------
+/** @file BatchAnalysis.hpp */
+//----------------------------------------------------------------------------
+
+#ifndef BATCHANALYSIS_HPP
+#define BATCHANALYSIS_HPP
+
+#include "Hex.hpp"
+#include "HexBoard.hpp"
+#include "HexState.hpp"
+#include "DfpnSolver.hpp"
+
+_BEGIN_BENZENE_NAMESPACE_
+
+//----------------------------------------------------------------------------
+
+/** Analysis of a list of positions on a pool of threads.
+
+    Each thread works on its own copy of the board (and of the
+    solver), and positions are handed out to idle threads one at a
+    time. Every result is logged as soon as it is computed; the
+    results are returned in the order of the input.
+*/
+namespace BatchAnalysis
+{
+    /** Reads the positions of a batch from a file.
+        If the filename ends in ".sgf", all positions along the main
+        line of the game are used. Otherwise each line holds the
+        moves played from the empty board, alternating colors and
+        starting with FIRST_TO_PLAY; empty lines and lines beginning
+        with '#' are skipped. Throws a BenzeneException on errors. */
+    void ReadPositions(const std::string& filename, const StoneBoard& brd,
+                       std::vector<HexState>& states);
+
+    /** Solves each state with dfpn. Each thread runs a copy of solver
+        on a copy of brd, with its own hash table; the tables of all
+        threads together are no larger than the one of positions.
+        The threads share the database of positions. Once all states
+        are done, the solved states along each principal variation
+        are stored in positions. A result is the winner (EMPTY if the
+        search was aborted) followed by the principal variation. */
+    void Solve(const std::vector<HexState>& states, const DfpnSolver& solver,
+               const HexBoard& brd, DfpnStates& positions,
+               std::size_t numThreads, std::vector<std::string>& results);
+
+    /** Computes fillin and VCs for each state on a copy of brd. A
+        result is the color with a winning connection (EMPTY if the
+        state is not determined), the resistance score and the number
+        of moves to consider. */
+    void Evaluate(const std::vector<HexState>& states, const HexBoard& brd,
+                  std::size_t numThreads, std::vector<std::string>& results);
+}
+
+//----------------------------------------------------------------------------
+
+_END_BENZENE_NAMESPACE_
+
+#endif // BATCHANALYSIS_HPP
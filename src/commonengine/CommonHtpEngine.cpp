@@ -5,11 +5,14 @@
 #include "SgSystem.h"
 #include "SgGameReader.h"
 
+#include "BatchAnalysis.hpp"
 #include "BoardUtil.hpp"
 #include "BitsetIterator.hpp"
 #include "Decompositions.hpp"
 #include "CommonProgram.hpp"
 #include "HexSgUtil.hpp"
+#include "LogStore.hpp"
+#include "MemoryBudget.hpp"
 #include "CommonHtpEngine.hpp"
 #include "Resistance.hpp"
 #include "DfsSolver.hpp"
@@ -18,10 +21,37 @@
 #include "VCSet.hpp"
 #include "VCUtil.hpp"
 
+#include <boost/thread/thread.hpp>
+#include <sys/stat.h>
+
 using namespace benzene;
 
 //----------------------------------------------------------------------------
 
+namespace {
+
+/** Number of databases an engine may have open: the dfs and dfpn
+    databases and the opening book. */
+const std::size_t MAX_OPEN_DATABASES = 3;
+
+void ResizeDBCache(std::size_t bytes)
+{
+    HashDBCache::SetSize(bytes / MAX_OPEN_DATABASES);
+}
+
+/** Returns true if both names refer to the same existing file. */
+bool SameFile(const std::string& a, const std::string& b)
+{
+    struct stat stA;
+    struct stat stB;
+    return stat(a.c_str(), &stA) == 0 && stat(b.c_str(), &stB) == 0
+        && stA.st_dev == stB.st_dev && stA.st_ino == stB.st_ino;
+}
+
+} // namespace
+
+//----------------------------------------------------------------------------
+
 CommonHtpEngine::CommonHtpEngine(int boardsize)
     : HexHtpEngine(boardsize),
       m_pe(m_board.Width(), m_board.Height()),
@@ -68,10 +98,36 @@ CommonHtpEngine::CommonHtpEngine(int boardsize)
     RegisterCmd("eval-twod", &CommonHtpEngine::CmdEvalTwoDist);
     RegisterCmd("eval-resist", &CommonHtpEngine::CmdEvalResist);
     RegisterCmd("eval-resist-cells", &CommonHtpEngine::CmdEvalResistCells);
+    RegisterCmd("eval-batch", &CommonHtpEngine::CmdEvalBatch);
+    RegisterCmd("dfpn-solve-batch", &CommonHtpEngine::CmdDfpnSolveBatch);
+    RegisterCmd("db-compact", &CommonHtpEngine::CmdDBCompact);
+    RegisterCmd("param_memory", &CommonHtpEngine::CmdParamMemory);
+    RegisterCmd("memory-usage", &CommonHtpEngine::CmdMemoryUsage);
+
+    // Shares are relative to those of the player's components,
+    // registered by the subclasses.
+    MemoryBudget& budget = MemoryBudget::Get();
+    m_memoryComponents.push_back(budget.Register
+        ("dfpn_tt", 4.0,
+         boost::bind(&CommonHtpEngine::DfpnTTMemory, this),
+         boost::bind(&CommonHtpEngine::ResizeDfpnTT, this, _1)));
+    m_memoryComponents.push_back(budget.Register
+        ("dfs_tt", 1.0,
+         boost::bind(&CommonHtpEngine::DfsTTMemory, this),
+         boost::bind(&CommonHtpEngine::ResizeDfsTT, this, _1)));
+    m_memoryComponents.push_back(budget.Register
+        ("vc", 1.0, boost::bind(&CommonHtpEngine::VCMemory, this)));
+    // The database cache is shared by all engines of the process and
+    // binds no engine, so it stays registered.
+    if (!budget.Contains("db_cache"))
+        budget.Register("db_cache", 0.25, HashDBCache::Used, ResizeDBCache);
 }
 
 CommonHtpEngine::~CommonHtpEngine()
 {
+    MemoryBudget& budget = MemoryBudget::Get();
+    for (std::size_t i = 0; i < m_memoryComponents.size(); ++i)
+        budget.Unregister(m_memoryComponents[i]);
 }
 
 //----------------------------------------------------------------------------
@@ -108,7 +164,12 @@ void CommonHtpEngine::CmdAnalyzeCommands(HtpCommand& cmd)
         "group/Show Group/group-get %p\n"
         "pspairs/Show TwoDistance/eval-twod %c\n"
         "string/Show Resist/eval-resist %c\n"
-        "pspairs/Show Cell Energy/eval-resist-cells %c\n";
+        "pspairs/Show Cell Energy/eval-resist-cells %c\n"
+        "string/Eval Batch/eval-batch %r\n"
+        "string/DFPN Solve Batch/dfpn-solve-batch %r\n"
+        "none/Compact DB/db-compact %r\n"
+        "param/Memory Param/param_memory\n"
+        "string/Memory Usage/memory-usage\n";
     m_playerEnvCommands.AddAnalyzeCommands(cmd, "player");
     m_solverEnvCommands.AddAnalyzeCommands(cmd, "solver");
     m_vcCommands.AddAnalyzeCommands(cmd);
@@ -515,3 +576,200 @@ void CommonHtpEngine::CmdEvalResistCells(HtpCommand& cmd)
 }
 
 //----------------------------------------------------------------------------
+
+/** Reads the positions file and optional thread count of a batch
+    command. Uses one thread per core if no count is given. */
+void CommonHtpEngine::ReadBatch(HtpCommand& cmd, 
+                                std::vector<HexState>& states,
+                                std::size_t& numThreads) const
+{
+    cmd.CheckNuArgLessEqual(2);
+    std::string filename = cmd.Arg(0);
+    numThreads = boost::thread::hardware_concurrency();
+    if (cmd.NuArg() == 2)
+        numThreads = cmd.ArgMin<std::size_t>(1, 1);
+    try {
+        BatchAnalysis::ReadPositions(filename, m_game.Board(), states);
+    }
+    catch (BenzeneException& e) {
+        throw HtpFailure() << e.what();
+    }
+}
+
+/** Outputs one line per position: its index and its result. */
+void CommonHtpEngine::WriteBatch(HtpCommand& cmd, 
+                                 const std::vector<std::string>& results) const
+{
+    for (std::size_t i = 0; i < results.size(); ++i)
+        cmd << '\n' << i << ' ' << results[i];
+}
+
+/** Evaluates a list of positions on several threads. For each
+    position, fillin and VCs are computed on a copy of the player's
+    board; the result is the color with a winning connection (empty if
+    there is none), the resistance score and the size of the
+    mustplay. Results are logged as they complete. See
+    BatchAnalysis::ReadPositions() for the file format.
+    Usage: 
+      eval-batch [positions file] [threads]
+*/
+void CommonHtpEngine::CmdEvalBatch(HtpCommand& cmd)
+{
+    std::vector<HexState> states;
+    std::size_t numThreads;
+    ReadBatch(cmd, states, numThreads);
+    std::vector<std::string> results;
+    BatchAnalysis::Evaluate(states, *m_pe.brd, numThreads, results);
+    WriteBatch(cmd, results);
+}
+
+/** Solves a list of positions with dfpn on several threads. Each
+    thread uses a copy of the dfpn solver and the solver's board, and
+    its own part of the dfpn hashtable; all of them share the dfpn
+    database. The result for a
+    position is the winner and the principal variation. Results are
+    logged as they complete. See BatchAnalysis::ReadPositions() for
+    the file format.
+    Usage: 
+      dfpn-solve-batch [positions file] [threads]
+*/
+void CommonHtpEngine::CmdDfpnSolveBatch(HtpCommand& cmd)
+{
+    std::vector<HexState> states;
+    std::size_t numThreads;
+    ReadBatch(cmd, states, numThreads);
+    std::vector<std::string> results;
+    BatchAnalysis::Solve(states, m_dfpnSolver, *m_se.brd, m_dfpnPositions,
+                         numThreads, results);
+    WriteBatch(cmd, results);
+}
+
+/** Compacts a log store database (a file ending in ".lsdb"),
+    dropping records that have been replaced. Fails if the database
+    is open as the dfs or dfpn database; close it first with
+    dfpn-close-db or dfs-close-db.
+    Usage: 
+      db-compact [filename]
+*/
+void CommonHtpEngine::CmdDBCompact(HtpCommand& cmd)
+{
+    cmd.CheckNuArg(1);
+    std::string filename = cmd.Arg(0);
+    if (!LogStore::IsLogStoreName(filename))
+        throw HtpFailure() << "Not a log store: '" << filename << "'";
+    // Compact() replaces the files under an open store
+    if ((m_dfsDB && SameFile(filename, m_dfsDB->Filename()))
+        || (m_dfpnDB && SameFile(filename, m_dfpnDB->Filename())))
+        throw HtpFailure() << "Database is open: '" << filename << "'";
+    try
+    {
+        LogStore::Compact(filename);
+    }
+    catch (BenzeneException& e)
+    {
+        throw HtpFailure() << e.what();
+    }
+}
+
+//----------------------------------------------------------------------------
+
+/** Sets the memory budget of the process and the share of it each
+    component gets; see MemoryBudget. Setting the total resizes the
+    solver hashtables, the MoHex tree and fill-in map, and the cache
+    of databases opened afterwards. A total of zero turns the budget
+    off.
+    Usage: 
+      param_memory [total|share_<component>] [value]
+*/
+void CommonHtpEngine::CmdParamMemory(HtpCommand& cmd)
+{
+    MemoryBudget& budget = MemoryBudget::Get();
+    if (cmd.NuArg() == 0)
+    {
+        cmd << '\n'
+            << "[string] total " << budget.Total() << '\n';
+        std::vector<std::string> names = budget.Names();
+        for (std::size_t i = 0; i < names.size(); ++i)
+            cmd << "[string] share_" << names[i] << ' '
+                << budget.Share(names[i]) << '\n';
+    }
+    else if (cmd.NuArg() == 2)
+    {
+        std::string name = cmd.Arg(0);
+        const std::string sharePrefix = "share_";
+        if (name == "total")
+            budget.SetTotal(cmd.Arg<std::size_t>(1));
+        else if (name.compare(0, sharePrefix.size(), sharePrefix) == 0)
+        {
+            try
+            {
+                budget.SetShare(name.substr(sharePrefix.size()),
+                                cmd.ArgMin<float>(1, 0.0f));
+            }
+            catch (BenzeneException& e)
+            {
+                throw HtpFailure() << e.what();
+            }
+        }
+        else
+            throw HtpFailure() << "unknown parameter: " << name;
+    }
+    else 
+        throw HtpFailure("Expected 0 or 2 arguments");
+}
+
+/** Displays the memory allowance and use of each component.
+    VC memory is read from the boards without locking, so call this
+    between searches. */
+void CommonHtpEngine::CmdMemoryUsage(HtpCommand& cmd)
+{
+    cmd.CheckArgNone();
+    std::ostringstream os;
+    MemoryBudget::Get().Write(os);
+    cmd << '\n' << os.str();
+}
+
+//----------------------------------------------------------------------------
+
+std::size_t CommonHtpEngine::DfsTTMemory() const
+{
+    if (m_dfsHashTable.get() == 0)
+        return 0;
+    return m_dfsHashTable->MaxHash() * sizeof(SgHashEntry<DfsData>);
+}
+
+/** Keeps the table if its size does not change. */
+void CommonHtpEngine::ResizeDfsTT(std::size_t bytes)
+{
+    int bits = MemoryBudget::TableBits(bytes, sizeof(SgHashEntry<DfsData>));
+    if (m_dfsHashTable.get() != 0 && m_dfsHashTable->MaxHash() == 1 << bits)
+        return;
+    m_dfsHashTable.reset(new DfsHashTable(1 << bits));
+}
+
+std::size_t CommonHtpEngine::DfpnTTMemory() const
+{
+    if (m_dfpnHashTable.get() == 0)
+        return 0;
+    return m_dfpnHashTable->MemoryUsed();
+}
+
+/** Keeps the table if its size does not change, and the garbage
+    collection settings of the old table otherwise. */
+void CommonHtpEngine::ResizeDfpnTT(std::size_t bytes)
+{
+    int bits = MemoryBudget::TableBits(bytes, DfpnHashTable::SlotSize());
+    if (m_dfpnHashTable.get() != 0 && m_dfpnHashTable->MaxHash() == 1 << bits)
+        return;
+    DfpnHashTable* tt = new DfpnHashTable(1 << bits);
+    if (m_dfpnHashTable.get() != 0)
+        tt->CopySettingsFrom(*m_dfpnHashTable);
+    m_dfpnHashTable.reset(tt);
+}
+
+std::size_t CommonHtpEngine::VCMemory() const
+{
+    return m_pe.brd->VCMemoryUsed() + m_se.brd->VCMemoryUsed();
+}
+
+//----------------------------------------------------------------------------
@@ -27,6 +27,10 @@ public:
     
     ~CommonHtpEngine();
 
+    /** Returns the player's board; its parameters and ICEngine are
+        the ones set by the param commands. */
+    const HexBoard& PlayerBoard() const;
+
     /** @page benzenehtpenginecommands CommonHtpEngine Commands
         - @link CmdLicense() @c benzene-license @endlink
         - @link CmdGroupGet() @c group-get @endlink
@@ -43,6 +47,11 @@ public:
         - @link CmdEvalTwoDist() @c eval-twod @endlink
         - @link CmdEvalResist() @c eval-resist @endlink
         - @link CmdEvalResistCells() @c eval-resist-cells @endlink
+        - @link CmdEvalBatch() @c eval-batch @endlink
+        - @link CmdDfpnSolveBatch() @c dfpn-solve-batch @endlink
+        - @link CmdDBCompact() @c db-compact @endlink
+        - @link CmdParamMemory() @c param_memory @endlink
+        - @link CmdMemoryUsage() @c memory-usage @endlink
     */
 
     /** @name Command Callbacks */
@@ -65,6 +74,11 @@ public:
     void CmdEvalTwoDist(HtpCommand& cmd);
     void CmdEvalResist(HtpCommand& cmd);
     void CmdEvalResistCells(HtpCommand& cmd);
+    void CmdEvalBatch(HtpCommand& cmd);
+    void CmdDfpnSolveBatch(HtpCommand& cmd);
+    void CmdDBCompact(HtpCommand& cmd);
+    void CmdParamMemory(HtpCommand& cmd);
+    void CmdMemoryUsage(HtpCommand& cmd);
 
     // @} // @name
 
@@ -114,10 +128,35 @@ protected:
 
 private:
 
+    /** Names of the components of this engine in the MemoryBudget. */
+    std::vector<std::string> m_memoryComponents;
+
+    void ReadBatch(HtpCommand& cmd, std::vector<HexState>& states,
+                   std::size_t& numThreads) const;
+
+    void WriteBatch(HtpCommand& cmd, 
+                    const std::vector<std::string>& results) const;
+
+    std::size_t DfsTTMemory() const;
+
+    void ResizeDfsTT(std::size_t bytes);
+
+    std::size_t DfpnTTMemory() const;
+
+    void ResizeDfpnTT(std::size_t bytes);
+
+    std::size_t VCMemory() const;
+
+
     void RegisterCmd(const std::string& name,
                      GtpCallback<CommonHtpEngine>::Method method);
 };
 
+inline const HexBoard& CommonHtpEngine::PlayerBoard() const
+{
+    return *m_pe.brd;
+}
+
 //----------------------------------------------------------------------------
 
 _END_BENZENE_NAMESPACE_
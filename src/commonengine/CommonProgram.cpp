@@ -4,6 +4,7 @@
 
 #include "Decompositions.hpp"
 #include "HexProp.hpp"
+#include "Misc.hpp"
 #include "CommonProgram.hpp"
 
 #include <boost/program_options/cmdline.hpp>
@@ -31,13 +32,18 @@ void CommonProgram::RegisterCmdLineArguments()
     m_options_desc.add_options()
         ("boardsize", 
          po::value<int>(&m_boardsize)->default_value(11),
-         "Sets the size of the board.");
+         "Sets the size of the board.")
+        ("cache-dir", 
+         po::value<std::string>(&m_cache_dir)->default_value(""),
+         "Directory for caches of precomputed data "
+         "(empty for no caching).");
     BenzeneProgram::RegisterCmdLineArguments();
 }
 
 void CommonProgram::HandleCmdLineArguments()
 {
     BenzeneProgram::HandleCmdLineArguments();
+    MiscUtil::SetCacheDir(m_cache_dir);
 }
 
 void CommonProgram::InitializeSystem()
@@ -36,6 +36,8 @@ public:
 
 private:
     int m_boardsize;
+
+    std::string m_cache_dir;
 };
 
 inline int CommonProgram::BoardSize() const
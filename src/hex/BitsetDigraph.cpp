@@ -0,0 +1,102 @@
+//----------------------------------------------------------------------------
+/** @file BitsetDigraph.cpp */
+//----------------------------------------------------------------------------
+
+#include "BitsetDigraph.hpp"
+#include "BitsetIterator.hpp"
+
+using namespace benzene;
+
+//----------------------------------------------------------------------------
+
+bitset_t BitsetDigraph::OutSet(const bitset_t& sources) const
+{
+    bitset_t out;
+    for (BitsetIterator v(sources & m_vertices); v; ++v)
+        out |= Row(*v);
+    return out;
+}
+
+bitset_t BitsetDigraph::InSet(const bitset_t& targets) const
+{
+    bitset_t in;
+    for (std::size_t i = 0; i < m_rows.size(); ++i)
+        if ((m_rows[i] & targets).any())
+            in.set(m_rowVertex[i]);
+    return in;
+}
+
+/** Expands a frontier one row union at a time. */
+bitset_t BitsetDigraph::Reachable(const bitset_t& sources) const
+{
+    bitset_t reached = OutSet(sources);
+    bitset_t frontier = reached;
+    while (frontier.any())
+    {
+        frontier = OutSet(frontier) - reached;
+        reached |= frontier;
+    }
+    return reached;
+}
+
+/** The component of v is v plus the vertices reachable from v that
+    reach v. Uses the reachable sets of all vertices, which is cheap
+    since domination graphs are small. */
+void BitsetDigraph::FindStronglyConnectedComponents
+(std::vector<bitset_t>& out) const
+{
+    out.clear();
+    bitset_t reach[BITSETSIZE];
+    for (BitsetIterator v(m_vertices); v; ++v)
+    {
+        bitset_t source;
+        source.set(*v);
+        reach[*v] = Reachable(source);
+    }
+    bitset_t done;
+    for (BitsetIterator v(m_vertices); v; ++v)
+    {
+        if (done.test(*v))
+            continue;
+        bitset_t comp;
+        comp.set(*v);
+        for (BitsetIterator w(reach[*v]); w; ++w)
+            if (reach[*w].test(*v))
+                comp.set(*w);
+        done |= comp;
+        out.push_back(comp);
+    }
+}
+
+void BitsetDigraph::AddEdges(HexPoint source, const bitset_t& targets)
+{
+    AddVertex(source);
+    for (BitsetIterator t(targets); t; ++t)
+        AddVertex(*t);
+    Row(source) |= targets;
+}
+
+/** Rows of removed vertices are filled with the last row. */
+void BitsetDigraph::RemoveVertices(const bitset_t& vertices)
+{
+    if ((m_vertices & vertices).none())
+        return;
+    m_vertices = m_vertices - vertices;
+    std::size_t i = 0;
+    while (i < m_rows.size())
+    {
+        if (m_vertices.test(m_rowVertex[i]))
+        {
+            m_rows[i] = m_rows[i] - vertices;
+            ++i;
+            continue;
+        }
+        m_rows[i] = m_rows.back();
+        m_rowVertex[i] = m_rowVertex.back();
+        m_rowIndex[m_rowVertex[i]] = static_cast<unsigned short>(i);
+        m_rows.pop_back();
+        m_rowVertex.pop_back();
+    }
+}
+
+//----------------------------------------------------------------------------
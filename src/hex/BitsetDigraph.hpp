@@ -0,0 +1,208 @@
+//----------------------------------------------------------------------------
+/** @file BitsetDigraph.hpp */
+//----------------------------------------------------------------------------
+
+#ifndef BITSETDIGRAPH_HPP
+#define BITSETDIGRAPH_HPP
+
+#include <algorithm>
+#include <vector>
+#include "Hex.hpp"
+
+_BEGIN_BENZENE_NAMESPACE_
+
+//----------------------------------------------------------------------------
+
+/** Directed graph on HexPoints stored as bitset_t adjacency rows.
+
+    Same role as Digraph<HexPoint>, but sets of vertices are bitsets,
+    so unions over many vertices, reachability and strongly connected
+    components are computed a whole row at a time.
+
+    Rows are kept in a vector with one entry per vertex, so copying a
+    graph with few vertices, such as the domination graph in
+    InferiorCells, copies only a few rows. Incoming edges are not
+    stored; InSet() scans the rows of all vertices. */
+class BitsetDigraph
+{
+public:
+    BitsetDigraph();
+
+    //------------------------------------------------------------------------
+
+    /** Returns the vertex set. */
+    const bitset_t& Vertices() const;
+
+    std::size_t NumVertices() const;
+
+    bool VertexExists(HexPoint vertex) const;
+
+    /** Returns true if there is an edge (x->y). */
+    bool IsEdge(HexPoint x, HexPoint y) const;
+
+    /** Returns the number of edges leaving source. */
+    std::size_t OutDegree(HexPoint source) const;
+
+    /** Returns the number of edges entering target. */
+    std::size_t InDegree(HexPoint target) const;
+
+    /** Returns the vertices pointed to by source. */
+    const bitset_t& OutSet(HexPoint source) const;
+
+    /** Returns all targets of edges leaving vertices in sources. */
+    bitset_t OutSet(const bitset_t& sources) const;
+
+    /** Returns the vertices pointing to target. */
+    bitset_t InSet(HexPoint target) const;
+
+    /** Returns all sources of edges into vertices in targets. */
+    bitset_t InSet(const bitset_t& targets) const;
+
+    /** Returns the vertices reachable from sources by paths of one or
+        more edges. */
+    bitset_t Reachable(const bitset_t& sources) const;
+
+    /** Stores the strongly connected components in out. */
+    void FindStronglyConnectedComponents(std::vector<bitset_t>& out) const;
+
+    //------------------------------------------------------------------------
+
+    void Clear();
+
+    /** Adds edge from source to target. */
+    void AddEdge(HexPoint source, HexPoint target);
+
+    /** Adds edges from source to each of the targets. */
+    void AddEdges(HexPoint source, const bitset_t& targets);
+
+    /** Removes edge from source to target. */
+    void RemoveEdge(HexPoint source, HexPoint target);
+
+    /** Removes vertices and all their edges from the graph. */
+    void RemoveVertices(const bitset_t& vertices);
+
+    /** Removes vertex and all its edges from the graph. */
+    void RemoveVertex(HexPoint vertex);
+
+private:
+    bitset_t m_vertices;
+
+    /** Index in m_rows of the row of each vertex. */
+    unsigned short m_rowIndex[BITSETSIZE];
+
+    /** Outgoing edges of each vertex. */
+    std::vector<bitset_t> m_rows;
+
+    /** Vertex of each row. */
+    std::vector<HexPoint> m_rowVertex;
+
+    void AddVertex(HexPoint vertex);
+
+    bitset_t& Row(HexPoint vertex);
+
+    const bitset_t& Row(HexPoint vertex) const;
+};
+
+inline BitsetDigraph::BitsetDigraph()
+{
+    std::fill(m_rowIndex, m_rowIndex + BITSETSIZE, 0);
+}
+
+inline bitset_t& BitsetDigraph::Row(HexPoint vertex)
+{
+    BenzeneAssert(VertexExists(vertex));
+    return m_rows[m_rowIndex[vertex]];
+}
+
+inline const bitset_t& BitsetDigraph::Row(HexPoint vertex) const
+{
+    BenzeneAssert(VertexExists(vertex));
+    return m_rows[m_rowIndex[vertex]];
+}
+
+inline const bitset_t& BitsetDigraph::Vertices() const
+{
+    return m_vertices;
+}
+
+inline std::size_t BitsetDigraph::NumVertices() const
+{
+    return m_vertices.count();
+}
+
+inline bool BitsetDigraph::VertexExists(HexPoint vertex) const
+{
+    return m_vertices.test(vertex);
+}
+
+inline bool BitsetDigraph::IsEdge(HexPoint x, HexPoint y) const
+{
+    return VertexExists(x) && Row(x).test(y);
+}
+
+inline std::size_t BitsetDigraph::OutDegree(HexPoint source) const
+{
+    return Row(source).count();
+}
+
+inline std::size_t BitsetDigraph::InDegree(HexPoint target) const
+{
+    BenzeneAssert(VertexExists(target));
+    return InSet(target).count();
+}
+
+inline const bitset_t& BitsetDigraph::OutSet(HexPoint source) const
+{
+    return Row(source);
+}
+
+inline bitset_t BitsetDigraph::InSet(HexPoint target) const
+{
+    bitset_t targets;
+    targets.set(target);
+    return InSet(targets);
+}
+
+inline void BitsetDigraph::Clear()
+{
+    m_vertices.reset();
+    m_rows.clear();
+    m_rowVertex.clear();
+}
+
+inline void BitsetDigraph::AddVertex(HexPoint vertex)
+{
+    if (!m_vertices.test(vertex))
+    {
+        m_vertices.set(vertex);
+        m_rowIndex[vertex] = static_cast<unsigned short>(m_rows.size());
+        m_rows.push_back(bitset_t());
+        m_rowVertex.push_back(vertex);
+    }
+}
+
+inline void BitsetDigraph::AddEdge(HexPoint source, HexPoint target)
+{
+    AddVertex(source);
+    AddVertex(target);
+    Row(source).set(target);
+}
+
+inline void BitsetDigraph::RemoveEdge(HexPoint source, HexPoint target)
+{
+    if (VertexExists(source))
+        Row(source).reset(target);
+}
+
+inline void BitsetDigraph::RemoveVertex(HexPoint vertex)
+{
+    bitset_t vertices;
+    vertices.set(vertex);
+    RemoveVertices(vertices);
+}
+
+//----------------------------------------------------------------------------
+
+_END_BENZENE_NAMESPACE_
+
+#endif // BITSETDIGRAPH_HPP
@@ -10,12 +10,79 @@
 #include "Groups.hpp"
 #include "VCSet.hpp"
 #include "HexBoard.hpp"
+#include "VCPattern.hpp"
 #include "VCUtil.hpp"
+#include "TaskScheduler.hpp"
 
 using namespace benzene;
 
 //----------------------------------------------------------------------------
 
+namespace {
+
+/** Runs one of the VCBuilder::Build() methods as a task. Builds
+    from scratch if oldGroups is 0. */
+class BuildVCsTask
+{
+public:
+    BuildVCsTask(VCBuilder& builder, VCSet& con, const Groups* oldGroups,
+                 const Groups& groups, const PatternState& patterns,
+                 bitset_t* added, ChangeLog<VC>* log);
+
+    void operator()();
+
+private:
+    VCBuilder& m_builder;
+
+    VCSet& m_con;
+
+    const Groups* m_oldGroups;
+
+    const Groups& m_groups;
+
+    const PatternState& m_patterns;
+
+    bitset_t* m_added;
+
+    ChangeLog<VC>* m_log;
+};
+
+BuildVCsTask::BuildVCsTask(VCBuilder& builder, VCSet& con, 
+                           const Groups* oldGroups, const Groups& groups,
+                           const PatternState& patterns, 
+                           bitset_t* added, ChangeLog<VC>* log)
+    : m_builder(builder),
+      m_con(con),
+      m_oldGroups(oldGroups),
+      m_groups(groups),
+      m_patterns(patterns),
+      m_added(added),
+      m_log(log)
+{
+}
+
+void BuildVCsTask::operator()()
+{
+    if (m_oldGroups)
+        m_builder.Build(m_con, *m_oldGroups, m_groups, m_patterns, 
+                        m_added, m_log);
+    else
+        m_builder.Build(m_con, m_groups, m_patterns);
+}
+
+/** Computes the data the builders compute lazily from shared
+    objects, so that two builders can then read them at the same
+    time. */
+void PrepareConcurrentBuild(const StoneBoard& brd)
+{
+    brd.Stones(ALL_COLORS);
+    VCPattern::GetPatterns(brd.Width(), brd.Height(), BLACK);
+}
+
+} // namespace
+
+//----------------------------------------------------------------------------
+
 HexBoard::HexBoard(int width, int height, const ICEngine& ice,
                    VCBuilderParam& param)
     : m_brd(width, height), 
@@ -26,7 +93,8 @@ HexBoard::HexBoard(int width, int height, const ICEngine& ice,
       m_use_vcs(true),
       m_use_ice(true),
       m_use_decompositions(true),
-      m_backup_ice_info(true)
+      m_backup_ice_info(true),
+      m_concurrent_vcs(false)
 {
     Initialize();
 }
@@ -44,7 +112,8 @@ HexBoard::HexBoard(const HexBoard& other)
       m_use_vcs(other.m_use_vcs),
       m_use_ice(other.m_use_ice),
       m_use_decompositions(other.m_use_decompositions),
-      m_backup_ice_info(other.m_backup_ice_info)
+      m_backup_ice_info(other.m_backup_ice_info),
+      m_concurrent_vcs(other.m_concurrent_vcs)
 {
     m_patterns.CopyState(other.GetPatternState());
     for (BWIterator color; color; ++color)
@@ -78,22 +147,66 @@ void HexBoard::ComputeInferiorCells(HexColor color_to_move)
     }
 }
 
+VCBuilder& HexBoard::WhiteBuilder()
+{
+    if (!m_concurrent_vcs)
+        return m_builder;
+    if (!m_whiteBuilder)
+        m_whiteBuilder.reset(new VCBuilder(m_builder));
+    return *m_whiteBuilder;
+}
+
+/** Clears the statistics of all builders; white statistics are
+    copied to m_builder after each concurrent build. */
+void HexBoard::ClearBuilderStatistics()
+{
+    m_builder.ClearStatistics();
+    if (m_whiteBuilder)
+        m_whiteBuilder->ClearStatistics();
+}
+
 void HexBoard::BuildVCs()
 {
-    for (BWIterator c; c; ++c)
-        m_builder.Build(*m_cons[*c], m_groups, m_patterns);
+    if (!m_concurrent_vcs)
+    {
+        for (BWIterator c; c; ++c)
+            m_builder.Build(*m_cons[*c], m_groups, m_patterns);
+        return;
+    }
+    PrepareConcurrentBuild(m_brd);
+    VCBuilder& white = WhiteBuilder();
+    TaskGroup group;
+    group.Run(BuildVCsTask(white, *m_cons[WHITE], 0, m_groups,
+                           m_patterns, 0, 0));
+    m_builder.Build(*m_cons[BLACK], m_groups, m_patterns);
+    group.Wait();
+    m_builder.SetStatistics(WHITE, white.Statistics(WHITE));
 }
 
 void HexBoard::BuildVCs(const Groups& oldGroups, 
                         bitset_t added[BLACK_AND_WHITE], bool use_changelog)
 {
     BenzeneAssert((added[BLACK] & added[WHITE]).none());
-    for (BWIterator c; c; ++c)
+    if (!m_concurrent_vcs)
     {
-        ChangeLog<VC>* log = (use_changelog) ? &m_log[*c] : 0;
-        m_builder.Build(*m_cons[*c], oldGroups, m_groups, m_patterns, 
-                        added, log);
+        for (BWIterator c; c; ++c)
+        {
+            ChangeLog<VC>* log = (use_changelog) ? &m_log[*c] : 0;
+            m_builder.Build(*m_cons[*c], oldGroups, m_groups, m_patterns, 
+                            added, log);
+        }
+        return;
     }
+    PrepareConcurrentBuild(m_brd);
+    VCBuilder& white = WhiteBuilder();
+    TaskGroup group;
+    group.Run(BuildVCsTask(white, *m_cons[WHITE], &oldGroups,
+                           m_groups, m_patterns, added,
+                           use_changelog ? &m_log[WHITE] : 0));
+    m_builder.Build(*m_cons[BLACK], oldGroups, m_groups, m_patterns, added,
+                    use_changelog ? &m_log[BLACK] : 0);
+    group.Wait();
+    m_builder.SetStatistics(WHITE, white.Statistics(WHITE));
 }
 
 void HexBoard::MarkChangeLog()
@@ -162,7 +275,7 @@ void HexBoard::ComputeAll(HexColor color_to_move)
 
     if (m_use_vcs)
     {
-        m_builder.ClearStatistics();
+        ClearBuilderStatistics();
         BuildVCs();
         HandleVCDecomposition(color_to_move, false);
     }
@@ -191,7 +304,7 @@ void HexBoard::PlayMove(HexColor color, HexPoint cell)
 
     if (m_use_vcs)
     {
-        m_builder.ClearStatistics();
+        ClearBuilderStatistics();
         MarkChangeLog();
         BuildVCs(oldGroups, added, true);
         HandleVCDecomposition(!color, true);
@@ -224,7 +337,7 @@ void HexBoard::PlayStones(HexColor color, const bitset_t& played,
 
     if (m_use_vcs)
     {
-        m_builder.ClearStatistics();
+        ClearBuilderStatistics();
         MarkChangeLog();
         BuildVCs(oldGroups, added, true);
         HandleVCDecomposition(color_to_move, true);
@@ -266,6 +379,21 @@ void HexBoard::AddStones(HexColor color, const bitset_t& played,
     LogFine() << timer.GetTime() << "s to add stones.\n";
 }
 
+void HexBoard::AddDominated(const bitset_t& dominated, HexPoint cell)
+{
+    for (BitsetIterator p(dominated); p; ++p) 
+        m_inf.AddDominated(*p, cell);
+}
+
+std::size_t HexBoard::VCMemoryUsed() const
+{
+    std::size_t bytes = 0;
+    for (BWIterator c; c; ++c)
+        bytes += m_cons[*c]->MemoryUsed()
+            + m_log[*c].Size() * (sizeof(VC) + sizeof(ChangeLog<VC>::Action));
+    return bytes;
+}
+
 void HexBoard::UndoMove()
 {
     SgTimer timer;
@@ -66,6 +66,17 @@ public:
     /** See BackupIceInfo() */
     void SetBackupIceInfo(bool enable);
 
+    /** Whether the VCs of black and white are built at the same
+        time, each with its own VCBuilder. The white build runs as a
+        task of the TaskScheduler; if no worker is free, it runs on
+        the calling thread after the black build. Only useful for
+        callers that do not already use all cores. Statistics for
+        both colors are still available from Builder(). */
+    bool ConcurrentVCs() const;
+
+    /** See ConcurrentVCs() */
+    void SetConcurrentVCs(bool enable);
+
     // @}
 
     //-----------------------------------------------------------------------
@@ -106,6 +117,11 @@ public:
     /** Returns the set of inferior cell. */
     const InferiorCells& GetInferiorCells() const;
 
+    /** Marks each cell in dominated as dominated by cell in the
+        inferior cell info of the current state. Used to back-up ice
+        info computed on copies of this board. */
+    void AddDominated(const bitset_t& dominated, HexPoint cell);
+
     /** Returns the Inferior Cell Engine the board is using. */
     const ICEngine& ICE() const;
 
@@ -129,6 +145,10 @@ public:
     /** Returns the connection builder for this board. */
     const VCBuilder& Builder() const;
 
+    /** Approximate bytes used by the connection sets and their
+        changelogs. */
+    std::size_t VCMemoryUsed() const;
+
     //-----------------------------------------------------------------------
     
     int Width() const;
@@ -186,6 +206,10 @@ private:
     /** Builder used to compute virtual connections. */
     VCBuilder m_builder;
 
+    /** Builder used for white if ConcurrentVCs() is true. Created
+        the first time it is needed. */
+    boost::scoped_ptr<VCBuilder> m_whiteBuilder;
+
     /** Connection sets for black and white. */
     boost::scoped_ptr<VCSet> m_cons[BLACK_AND_WHITE];
 
@@ -210,6 +234,9 @@ private:
     /** See BackupIceInfo() */
     bool m_backup_ice_info;
 
+    /** See ConcurrentVCs() */
+    bool m_concurrent_vcs;
+
     // @}
     
     //-----------------------------------------------------------------------
@@ -228,6 +255,10 @@ private:
     void BuildVCs(const Groups& oldGroups, bitset_t added[BLACK_AND_WHITE],
                   bool use_changelog);
 
+    void ClearBuilderStatistics();
+
+    VCBuilder& WhiteBuilder();
+
     void MarkChangeLog();
 
     void RevertVCs();
@@ -354,6 +385,16 @@ inline void HexBoard::SetBackupIceInfo(bool enable)
     m_backup_ice_info = enable;
 }
 
+inline bool HexBoard::ConcurrentVCs() const
+{
+    return m_concurrent_vcs;
+}
+
+inline void HexBoard::SetConcurrentVCs(bool enable)
+{
+    m_concurrent_vcs = enable;
+}
+
 inline int HexBoard::Width() const
 {
     return m_brd.Width();
@@ -26,11 +26,13 @@ void HexEnvironment::NewGame(int width, int height)
         bool use_ice = brd->UseICE();
         bool use_dec = brd->UseDecompositions();
         bool backup  = brd->BackupIceInfo();
+        bool concurrent = brd->ConcurrentVCs();
         brd.reset(new HexBoard(width, height, ice, buildParam));
         brd->SetUseVCs(use_vcs);
         brd->SetUseICE(use_ice);
         brd->SetUseDecompositions(use_dec);
         brd->SetBackupIceInfo(backup);
+        brd->SetConcurrentVCs(concurrent);
     }
     brd->GetPosition().StartNewGame();
 }
@@ -195,6 +197,8 @@ void HexEnvironmentCommands::ParamBoard(HtpCommand& cmd)
         cmd << '\n'
             << "[bool] backup_ice_info "
             << brd.BackupIceInfo() << '\n'
+            << "[bool] concurrent_vcs "
+            << brd.ConcurrentVCs() << '\n'
             << "[bool] use_decompositions "
             << brd.UseDecompositions() << '\n'
             << "[bool] use_ice "
@@ -207,6 +211,8 @@ void HexEnvironmentCommands::ParamBoard(HtpCommand& cmd)
         std::string name = cmd.Arg(0);
         if (name == "backup_ice_info")
             brd.SetBackupIceInfo(cmd.Arg<bool>(1));
+        else if (name == "concurrent_vcs")
+            brd.SetConcurrentVCs(cmd.Arg<bool>(1));
         else if (name == "use_decompositions")
             brd.SetUseDecompositions(cmd.Arg<bool>(1));
         else if (name == "use_ice")
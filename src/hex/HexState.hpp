@@ -35,6 +35,14 @@ public:
     
     void UndoMove(HexPoint move);
 
+    /** Plays move without updating the hash.
+        See StoneBoard::PlayPlayoutMove(). */
+    void PlayPlayoutMove(HexPoint move);
+
+    /** Copies position and color to play of other, which must have
+        the same dimensions. See StoneBoard::CopyState(). */
+    void CopyState(const HexState& other);
+
     bool operator==(const HexState& other) const;
 
     bool operator!=(const HexState& other) const;
@@ -100,6 +108,18 @@ inline void HexState::UndoMove(HexPoint move)
     FlipColorToPlay();
 }
 
+inline void HexState::PlayPlayoutMove(HexPoint move)
+{
+    m_brd.PlayPlayoutMove(m_toPlay, move);
+    FlipColorToPlay();
+}
+
+inline void HexState::CopyState(const HexState& other)
+{
+    m_brd.CopyState(other.m_brd);
+    m_toPlay = other.m_toPlay;
+}
+
 inline void HexState::FlipColorToPlay()
 {
     m_toPlay = !m_toPlay;
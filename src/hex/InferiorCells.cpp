@@ -11,6 +11,7 @@
 */
 //----------------------------------------------------------------------------
 
+#include <algorithm>
 #include "BitsetIterator.hpp"
 #include "InferiorCells.hpp"
 
@@ -30,17 +31,11 @@ bitset_t InferiorCells::Dominated() const
     if (!m_dominated_computed) {
         
         // remove vulnerable and reversible cells from graph
-        Digraph<HexPoint> g(m_dom_graph);
-        for (BitsetIterator p(Vulnerable()); p; ++p) {
-            g.RemoveVertex(*p);
-        }
-        for (BitsetIterator p(Reversible()); p; ++p) {
-            g.RemoveVertex(*p);
-        }
+        BitsetDigraph g(m_dom_graph);
+        g.RemoveVertices(Vulnerable() | Reversible());
 
         bitset_t captains = InferiorCellsUtil::FindDominationCaptains(g);
-        bitset_t vertices = BitsetUtil::SetToBitset(g.Vertices());
-        m_dominated = vertices - captains;
+        m_dominated = g.Vertices() - captains;
         m_dominated_computed = true;
 
         /// TODO: ensure m_dominated is disjoint from all others.
@@ -67,6 +62,25 @@ bitset_t InferiorCells::Fillin(HexColor color) const
     return ret;
 }
 
+std::vector<VulnerableKiller> InferiorCells::Killers(HexPoint p) const
+{
+    std::vector<VulnerableKiller> killers;
+    for (std::size_t i = 0; i < m_killers.size(); ++i)
+        if (m_killers[i].first == p)
+            killers.push_back(m_killers[i].second);
+    std::stable_sort(killers.begin(), killers.end());
+    return killers;
+}
+
+bitset_t InferiorCells::Reversers(HexPoint p) const
+{
+    bitset_t reversers;
+    for (std::size_t i = 0; i < m_reversers.size(); ++i)
+        if (m_reversers[i].first == p)
+            reversers.set(m_reversers[i].second);
+    return reversers;
+}
+
 //----------------------------------------------------------------------------
 
 void InferiorCells::AddDead(HexPoint dead)
@@ -149,7 +163,7 @@ void InferiorCells::AddMutualFillin(HexColor color, HexPoint cell,
     AddMutualFillin(color, b, carrier);
 }
 
-void InferiorCells::AddDominated(HexPoint cell, const std::set<HexPoint>& dom)
+void InferiorCells::AddDominated(HexPoint cell, const bitset_t& dom)
 {
     m_dom_graph.AddEdges(cell, dom);
     m_dominated_computed = false;
@@ -165,15 +179,21 @@ void InferiorCells::AddDominated(HexPoint cell, HexPoint dominator)
     //AssertPairwiseDisjoint();
 }
 
-void InferiorCells::AddVulnerable(HexPoint cell, 
-                                  const std::set<HexPoint>& killers)
+void InferiorCells::AddKiller(HexPoint cell, const VulnerableKiller& killer)
+{
+    for (std::size_t i = 0; i < m_killers.size(); ++i)
+        if (m_killers[i].first == cell && m_killers[i].second == killer)
+            return;
+    m_killers.push_back(std::make_pair(cell, killer));
+}
+
+void InferiorCells::AddVulnerable(HexPoint cell, const bitset_t& killers)
 {
     m_vulnerable.set(cell);
 
     // add each killer with an empty carrier
-    std::set<HexPoint>::iterator it = killers.begin();
-    for (; it != killers.end(); ++it) {
-        m_killers[cell].insert(VulnerableKiller(*it));
+    for (BitsetIterator it(killers); it; ++it) {
+        AddKiller(cell, VulnerableKiller(*it));
     }
 
     // update reversible and dominated
@@ -184,10 +204,11 @@ void InferiorCells::AddVulnerable(HexPoint cell,
 }
 
 void InferiorCells::AddVulnerable(HexPoint cell, 
-                                  const std::set<VulnerableKiller>& killers)
+                                  const std::vector<VulnerableKiller>& killers)
 {
     m_vulnerable.set(cell);
-    m_killers[cell].insert(killers.begin(), killers.end());
+    for (std::size_t i = 0; i < killers.size(); ++i)
+        AddKiller(cell, killers[i]);
     RemoveReversible(cell);
     m_dominated_computed = false;
 
@@ -197,7 +218,7 @@ void InferiorCells::AddVulnerable(HexPoint cell,
 void InferiorCells::AddVulnerable(HexPoint cell, HexPoint killer)
 {
     m_vulnerable.set(cell);
-    m_killers[cell].insert(VulnerableKiller(killer));
+    AddKiller(cell, VulnerableKiller(killer));
     RemoveReversible(cell);
     m_dominated_computed = false;
 
@@ -207,7 +228,7 @@ void InferiorCells::AddVulnerable(HexPoint cell, HexPoint killer)
 void InferiorCells::AddVulnerable(HexPoint cell, const VulnerableKiller& killer)
 {
     m_vulnerable.set(cell);
-    m_killers[cell].insert(killer);
+    AddKiller(cell, killer);
     RemoveReversible(cell);
     m_dominated_computed = false;
 
@@ -232,8 +253,9 @@ void InferiorCells::AddReversible(HexPoint cell, bitset_t carrier,
     {
         if (m_vulnerable.test(*it)) continue;
         noAdditions = false;
+        if (!Reversers(*it).test(reverser))
+            m_reversers.push_back(std::make_pair(*it, reverser));
         m_reversible.set(*it);
-        m_reversers[*it].insert(reverser);
     }
     if (noAdditions) return;
     m_allReversibleCarriers |= reversibleCandidates;
@@ -244,18 +266,13 @@ void InferiorCells::AddReversible(HexPoint cell, bitset_t carrier,
 }
 
 void InferiorCells::AddReversible(HexPoint cell, bitset_t carrier,
-                                  const std::set<HexPoint>& reversers)
+                                  const bitset_t& reversers)
 {
     // Cell and carrier have equivalent roles, so just merge
     bitset_t reversibleCandidates = carrier;
     reversibleCandidates.set(cell);
     // Merge all reversers into one big pot (all or nothing :)
-    bitset_t reverserCandidates;
-    for (std::set<HexPoint>::iterator it = reversers.begin();
-         it != reversers.end(); ++it)
-    {
-        reverserCandidates.set(*it);
-    }
+    const bitset_t& reverserCandidates = reversers;
 
     // Cannot add any if not independent of previous reversible cells
     if ((m_allReversibleCarriers & reverserCandidates).any()) return;
@@ -268,8 +285,10 @@ void InferiorCells::AddReversible(HexPoint cell, bitset_t carrier,
     {
         if (m_vulnerable.test(*it)) continue;
         noAdditions = false;
+        bitset_t added = reversers - Reversers(*it);
+        for (BitsetIterator r(added); r; ++r)
+            m_reversers.push_back(std::make_pair(*it, *r));
         m_reversible.set(*it);
-        m_reversers[*it].insert(reversers.begin(), reversers.end());
     }
     if (noAdditions) return;
     m_allReversibleCarriers |= reversibleCandidates;
@@ -283,8 +302,7 @@ void InferiorCells::AddReversible(HexPoint cell, bitset_t carrier,
 
 void InferiorCells::AddDominatedFrom(const InferiorCells& other)
 {
-    bitset_t vertices=BitsetUtil::SetToBitset(other.m_dom_graph.Vertices());
-    for (BitsetIterator p(vertices); p; ++p) {
+    for (BitsetIterator p(other.m_dom_graph.Vertices()); p; ++p) {
         AddDominated(*p, other.m_dom_graph.OutSet(*p));
     }
     //AssertPairwiseDisjoint();
@@ -293,7 +311,7 @@ void InferiorCells::AddDominatedFrom(const InferiorCells& other)
 void InferiorCells::AddVulnerableFrom(const InferiorCells& other)
 {
     for (BitsetIterator p(other.Vulnerable()); p; ++p) {
-        AddVulnerable(*p, other.m_killers[*p]);
+        AddVulnerable(*p, other.Killers(*p));
     }
     AssertPairwiseDisjoint();
 }
@@ -301,7 +319,7 @@ void InferiorCells::AddVulnerableFrom(const InferiorCells& other)
 void InferiorCells::AddReversibleFrom(const InferiorCells& other)
 {
     for (BitsetIterator p(other.Reversible()); p; ++p) {
-        AddReversible(*p, EMPTY_BITSET, other.m_reversers[*p]);
+        AddReversible(*p, EMPTY_BITSET, other.Reversers(*p));
     }
     m_allReversibleCarriers |= other.AllReversibleCarriers();
     m_allReversers |= other.AllReversers();
@@ -384,17 +402,18 @@ void InferiorCells::ClearDominated()
 
 void InferiorCells::RemoveDominated(const bitset_t& dominated)
 {
-    bitset_t vertices = BitsetUtil::SetToBitset(m_dom_graph.Vertices());
-    for (BitsetIterator p(vertices & dominated); p; ++p) {
-        m_dom_graph.RemoveVertex(*p);
-    }
+    m_dom_graph.RemoveVertices(dominated);
     m_dominated_computed = false;
 }
 
 void InferiorCells::RemoveVulnerable(const bitset_t& vulnerable)
 {
-    for (BitsetIterator p(vulnerable & m_vulnerable); p; ++p) {
-        m_killers[*p].clear();
+    if ((vulnerable & m_vulnerable).any()) {
+        std::size_t j = 0;
+        for (std::size_t i = 0; i < m_killers.size(); ++i)
+            if (!vulnerable.test(m_killers[i].first))
+                m_killers[j++] = m_killers[i];
+        m_killers.erase(m_killers.begin() + j, m_killers.end());
     }
     m_vulnerable = m_vulnerable - vulnerable;
     m_dominated_computed = false;
@@ -402,8 +421,12 @@ void InferiorCells::RemoveVulnerable(const bitset_t& vulnerable)
 
 void InferiorCells::RemoveReversible(const bitset_t& reversible)
 {
-    for (BitsetIterator p(reversible & m_reversible); p; ++p) {
-        m_reversers[*p].clear();
+    if ((reversible & m_reversible).any()) {
+        std::size_t j = 0;
+        for (std::size_t i = 0; i < m_reversers.size(); ++i)
+            if (!reversible.test(m_reversers[i].first))
+                m_reversers[j++] = m_reversers[i];
+        m_reversers.erase(m_reversers.begin() + j, m_reversers.end());
     }
     m_reversible = m_reversible - reversible;
     m_dominated_computed = false;
@@ -412,9 +435,9 @@ void InferiorCells::RemoveReversible(const bitset_t& reversible)
 void InferiorCells::RemoveReversible(HexPoint reversible)
 {
     if (m_reversible.test(reversible)) {
-        m_reversers[reversible].clear();
-        m_reversible.reset(reversible);
-        m_dominated_computed = false;
+        bitset_t b;
+        b.set(reversible);
+        RemoveReversible(b);
     }
 }
 
@@ -466,7 +489,7 @@ void InferiorCells::AssertPairwiseDisjoint() const
 bitset_t InferiorCells::FindPresimplicialPairs() const
 {
     bitset_t fillin;
-    std::set<VulnerableKiller>::iterator k1, k2;
+    std::vector<VulnerableKiller>::const_iterator k1, k2;
 
     /** @todo Handle vulnerable cycles larger than length 2? If they
         occur, they are extrememly rare, so it is probably not worth
@@ -475,13 +498,15 @@ bitset_t InferiorCells::FindPresimplicialPairs() const
     for (BitsetIterator x(m_vulnerable); x; ++x) {
         if (fillin.test(*x)) continue;
 
-        for (k1 = m_killers[*x].begin(); k1 != m_killers[*x].end(); ++k1) {
+        const std::vector<VulnerableKiller> xKillers = Killers(*x);
+        for (k1 = xKillers.begin(); k1 != xKillers.end(); ++k1) {
             HexPoint y = k1->killer();
             if (fillin.test(y)) continue;
             if ((k1->carrier() & fillin).any()) continue;
 
             bool success = false;
-            for (k2 = m_killers[y].begin(); k2 != m_killers[y].end(); ++k2) {
+            const std::vector<VulnerableKiller> yKillers = Killers(y);
+            for (k2 = yKillers.begin(); k2 != yKillers.end(); ++k2) {
                 HexPoint z = k2->killer();
                 if (z != *x) continue;
                 if (fillin.test(z)) continue;
@@ -554,8 +579,9 @@ std::string InferiorCells::GuiOutput() const
         {
             os << "iv[";
             bool first=true;
-            std::set<VulnerableKiller>::const_iterator i;
-            for (i = m_killers[p].begin(); i != m_killers[p].end(); ++i) 
+            const std::vector<VulnerableKiller> killers = Killers(p);
+            std::vector<VulnerableKiller>::const_iterator i;
+            for (i = killers.begin(); i != killers.end(); ++i) 
             {
                 if (!first) os << "-";
                 os << i->killer();
@@ -567,8 +593,7 @@ std::string InferiorCells::GuiOutput() const
         {
             os << "ir[";
             bool first=true;
-            std::set<HexPoint>::const_iterator i;
-            for (i = m_reversers[p].begin(); i != m_reversers[p].end(); ++i) 
+            for (BitsetIterator i(Reversers(p)); i; ++i) 
             {
                 if (!first) os << "-";
                 os << *i;
@@ -580,8 +605,7 @@ std::string InferiorCells::GuiOutput() const
         {
             os << "id[";
             bool first=true;
-            std::set<HexPoint>::iterator i;
-            for (i=m_dom_graph.out_begin(p); i!=m_dom_graph.out_end(p); ++i) 
+            for (BitsetIterator i(m_dom_graph.OutSet(p)); i; ++i) 
             {
                 // PHIL IS CONFUSED: CAN THIS HAPPEN??
                 if (Vulnerable().test(*i))
@@ -613,29 +637,22 @@ std::string InferiorCells::GuiOutput() const
 //----------------------------------------------------------------------------
 
 bitset_t 
-InferiorCellsUtil::FindDominationCaptains(const Digraph<HexPoint>& graph)
+InferiorCellsUtil::FindDominationCaptains(const BitsetDigraph& graph)
 {
     bitset_t captains;
 
     // Find the strongly connected components of the domination graph.
-    std::vector<HexPointSet> comp;
+    std::vector<bitset_t> comp;
     graph.FindStronglyConnectedComponents(comp);
 
-    // Find the sinks in the component graph
+    // Find the sinks in the component graph; we are only concerned
+    // with edges leaving the component
     for (std::size_t i=0; i < comp.size(); ++i) {
-
-        std::set<HexPoint> out;
-        graph.OutSet(comp[i], out);
-
-        // remove members of the component from the outset since
-        // we are only concerned with edges leaving the component
-        std::set<HexPoint>::iterator it;
-        for (it = comp[i].begin(); it != comp[i].end(); ++it) 
-            out.erase(*it);
+        bitset_t out = graph.OutSet(comp[i]) - comp[i];
         
         // if a sink, pick a representative for the component
-        if (out.empty()) {
-            captains.set(*comp[i].begin());
+        if (out.none()) {
+            captains.set(BitsetUtil::FirstSetBit(comp[i]));
         }
     }
     
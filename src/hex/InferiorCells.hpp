@@ -7,7 +7,7 @@
 #define INFERIOR_CELLS_HPP
 
 #include "Hex.hpp"
-#include "Digraph.hpp"
+#include "BitsetDigraph.hpp"
 
 _BEGIN_BENZENE_NAMESPACE_
 
@@ -123,9 +123,10 @@ public:
 
     bitset_t Fillin(HexColor color) const;
 
-    const std::set<VulnerableKiller>& Killers(HexPoint p) const;
+    /** Returns the killers of p, ordered by killer. */
+    std::vector<VulnerableKiller> Killers(HexPoint p) const;
 
-    const std::set<HexPoint>& Reversers(HexPoint p) const;
+    bitset_t Reversers(HexPoint p) const;
     bitset_t AllReversers() const;
     bitset_t AllReversibleCarriers() const;
     
@@ -174,16 +175,17 @@ public:
                          const bitset_t& carrier);
 
     void AddDominated(HexPoint cell, HexPoint dominator);
-    void AddDominated(HexPoint cell, const std::set<HexPoint>& dom);
+    void AddDominated(HexPoint cell, const bitset_t& dom);
 
     void AddVulnerable(HexPoint cell, HexPoint killer);
-    void AddVulnerable(HexPoint cell, const std::set<HexPoint>& killers);
+    void AddVulnerable(HexPoint cell, const bitset_t& killers);
     void AddVulnerable(HexPoint cell, const VulnerableKiller& killer);
-    void AddVulnerable(HexPoint cell, const std::set<VulnerableKiller>& dom);
+    void AddVulnerable(HexPoint cell,
+                       const std::vector<VulnerableKiller>& killers);
 
     void AddReversible(HexPoint cell, bitset_t carrier, HexPoint reverser);
     void AddReversible(HexPoint cell, bitset_t carrier,
-                       const std::set<HexPoint>& reversers);
+                       const bitset_t& reversers);
 
     void AddDominatedFrom(const InferiorCells& other);
     void AddVulnerableFrom(const InferiorCells& other);
@@ -218,6 +220,9 @@ private:
 
     void AssertPairwiseDisjoint() const;
 
+    /** Adds killer to cell unless cell already has that killer. */
+    void AddKiller(HexPoint cell, const VulnerableKiller& killer);
+
     //------------------------------------------------------------------------
 
     bitset_t m_dead;
@@ -235,13 +240,18 @@ private:
     /** Vulnerable cells; not those involved in presimplicial
         pairs, though. */
     bitset_t m_vulnerable;
-    std::set<VulnerableKiller> m_killers[BITSETSIZE];
+
+    /** (cell, killer) pairs of the vulnerable cells. Kept flat,
+        rather than as one set per cell, so copies are cheap. */
+    std::vector<std::pair<HexPoint, VulnerableKiller> > m_killers;
     
     //------------------------------------------------------------------------
 
     /** Reversible cells and their reversers. */
     bitset_t m_reversible;
-    std::set<HexPoint> m_reversers[BITSETSIZE];
+
+    /** (cell, reverser) pairs of the reversible cells. */
+    std::vector<std::pair<HexPoint, HexPoint> > m_reversers;
     /** Data to test for independent captured-reversible sets. */
     bitset_t m_allReversibleCarriers;
     bitset_t m_allReversers;
@@ -250,7 +260,7 @@ private:
 
     /** Graph of domination; dominated cells point to their
         dominators. */
-    Digraph<HexPoint> m_dom_graph;
+    BitsetDigraph m_dom_graph;
 
     /** True if the dominated set has been computed from the
         domination graph.  Set to false whenever the domination graph
@@ -303,18 +313,6 @@ inline bitset_t InferiorCells::MutualFillinCarrier(HexColor color) const
     return m_mutual_fillin_carrier[color];
 }
 
-inline 
-const std::set<VulnerableKiller>& InferiorCells::Killers(HexPoint p) const
-{
-    return m_killers[p];
-}
-
-inline 
-const std::set<HexPoint>& InferiorCells::Reversers(HexPoint p) const
-{
-    return m_reversers[p];
-}
-
 inline bitset_t InferiorCells::AllReversers() const
 {
     return m_allReversers;
@@ -331,7 +329,7 @@ inline bitset_t InferiorCells::AllReversibleCarriers() const
 namespace InferiorCellsUtil
 {
 
-    bitset_t FindDominationCaptains(const Digraph<HexPoint>& graph);
+    bitset_t FindDominationCaptains(const BitsetDigraph& graph);
 
 }
 
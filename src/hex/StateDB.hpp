@@ -5,9 +5,18 @@
 #ifndef POSITIONDB_HPP
 #define POSITIONDB_HPP
 
+#include <iomanip>
+#include <map>
+#include <boost/bind.hpp>
 #include <boost/concept_check.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread/condition.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include "SgTime.h"
 #include "HashDB.hpp"
 #include "HexState.hpp"
+#include "Logger.hpp"
 
 _BEGIN_BENZENE_NAMESPACE_
 
@@ -59,7 +68,18 @@ struct StateDBStateConcept
 
 //----------------------------------------------------------------------------
 
-/** Database of hex positions handling rotations. */
+/** Database of hex positions handling rotations.
+
+    If created with a queue size, puts are written behind: Put()
+    stores the data in an in-memory table and returns, and a
+    background thread writes the table to the database in batches.
+    Repeated puts of a state before it is written are coalesced into
+    one write. Get() and Exists() look in the table before the
+    database, so a put is visible as soon as Put() returns. When the
+    table holds queue size states, Put() blocks until the writer has
+    taken them. Flush() and the destructor wait until everything has
+    been written. The first write that fails is recorded: later puts
+    return false, and Flush() throws. */
 template<class T>
 class StateDB
 {
@@ -77,15 +97,35 @@ public:
 
         std::size_t m_rotations;
 
+        /** Puts replacing a state not yet written. */
+        std::size_t m_coalesced;
+
+        /** Puts that waited for the writer because the table was
+            full. */
+        std::size_t m_stalls;
+
+        /** Batches written by the writer. */
+        std::size_t m_batches;
+
+        /** States written to the database. */
+        std::size_t m_writes;
+
+        /** Seconds spent writing to the database. */
+        double m_writeTime;
+
         std::string Write() const;
 
         Statistics();
     };
 
-    /** Opens database, creates it if it does not exist. */
-    StateDB(const std::string& filename, const std::string& type);
+    /** Opens database, creates it if it does not exist. If queueSize
+        is not zero, puts are written behind with a table of at most
+        queueSize states. */
+    StateDB(const std::string& filename, const std::string& type,
+            std::size_t queueSize = 0);
 
-    /** Closes database. */    
+    /** Writes all queued states and closes database. Logs a write
+        failure that Flush() has not reported. */    
     ~StateDB();
 
     /** Returns true if position exists in database. */
@@ -94,79 +134,270 @@ public:
     /** Returns true if get is successful. */
     bool Get(const HexState& pos, T& data) const;
 
-    /** Returns true if put is successful. */
+    /** Returns true if put is successful. A queued put returns false
+        once a write has failed. */
     bool Put(const HexState& brd, const T& data);
 
+    /** Waits until all queued states are written, then flushes the
+        database to disk. Throws a BenzeneException if a write failed
+        since the last call. */
     void Flush();
 
     Statistics GetStatistics() const;
 
     std::string BDBStatistics();
 
+    /** Name of the database file. */
+    const std::string& Filename() const;
+
 private:
+    typedef std::map<SgHashCode, T> Table;
+
     HashDB<T> m_db;
 
     mutable Statistics m_stats;
+
+    /** Maximum size of m_queued; 0 if puts are written through. */
+    std::size_t m_queueSize;
+
+    /** States put but not yet taken by the writer. */
+    Table m_queued;
+
+    /** Batch the writer is writing; only changed by the writer, with
+        m_queueMutex held. */
+    Table m_writing;
+
+    bool m_shutdown;
+
+    /** First write failure not yet reported by Flush(); empty if
+        none. */
+    std::string m_writeError;
+
+    /** Guards m_queued, m_writing, m_shutdown, m_writeError and
+        m_stats. */
+    mutable boost::mutex m_queueMutex;
+
+    /** Signalled when states are queued or on shutdown. */
+    boost::condition m_queuedCond;
+
+    /** Signalled when the writer has taken or written a batch. */
+    boost::condition m_writtenCond;
+
+    /** Serializes access to m_db between the writer and readers. */
+    mutable boost::mutex m_dbMutex;
+
+    boost::scoped_ptr<boost::thread> m_writer;
+
+    bool GetQueued(SgHashCode hash, T& data) const;
+
+    void WaitForWriter(boost::mutex::scoped_lock& lock);
+
+    void WriterLoop();
 };
 
 template<class T>
-StateDB<T>::StateDB(const std::string& filename, const std::string& type)
+StateDB<T>::StateDB(const std::string& filename, const std::string& type,
+                    std::size_t queueSize)
     : m_db(filename, type),
-      m_stats()
+      m_stats(),
+      m_queueSize(queueSize),
+      m_shutdown(false)
 {
+    if (m_queueSize > 0)
+        m_writer.reset(new boost::thread
+                       (boost::bind(&StateDB<T>::WriterLoop, this)));
 }
 
 template<class T>
 StateDB<T>::~StateDB()
 {
+    if (m_writer)
+    {
+        {
+            boost::mutex::scoped_lock lock(m_queueMutex);
+            m_shutdown = true;
+            m_queuedCond.notify_one();
+        }
+        m_writer->join();
+        if (!m_writeError.empty())
+            LogSevere() << "StateDB: states were not written: " 
+                        << m_writeError << '\n';
+    }
+}
+
+template<class T>
+bool StateDB<T>::GetQueued(SgHashCode hash, T& data) const
+{
+    boost::mutex::scoped_lock lock(m_queueMutex);
+    typename Table::const_iterator it = m_queued.find(hash);
+    if (it == m_queued.end())
+    {
+        it = m_writing.find(hash);
+        if (it == m_writing.end())
+            return false;
+    }
+    data = it->second;
+    return true;
 }
 
 template<class T>
 bool StateDB<T>::Exists(const HexState& state) const
 {
-    return m_db.Exists(GetHash(state));
+    SgHashCode hash = GetHash(state);
+    if (m_writer)
+    {
+        T data;
+        if (GetQueued(hash, data))
+            return true;
+    }
+    boost::mutex::scoped_lock lock(m_dbMutex);
+    return m_db.Exists(hash);
 }
 
 template<class T>
 bool StateDB<T>::Get(const HexState& state, T& data) const
 {
-    m_stats.m_gets++;
     SgHashCode hash = GetHash(state);
-    if (!m_db.Get(hash, data))
-        return false;
-    m_stats.m_hits++;
-    if (NeedToRotate(state, hash))
+    bool found = m_writer && GetQueued(hash, data);
+    if (!found)
     {
-        m_stats.m_rotations++;
-        data.Rotate(state.Position().Const());
+        boost::mutex::scoped_lock lock(m_dbMutex);
+        found = m_db.Get(hash, data);
     }
-    return true;
+    bool rotate = found && NeedToRotate(state, hash);
+    {
+        boost::mutex::scoped_lock lock(m_queueMutex);
+        m_stats.m_gets++;
+        if (found)
+            m_stats.m_hits++;
+        if (rotate)
+            m_stats.m_rotations++;
+    }
+    if (rotate)
+        data.Rotate(state.Position().Const());
+    return found;
 }
 
 template<class T>
 bool StateDB<T>::Put(const HexState& state, const T& data)
 {
-    m_stats.m_puts++;
     SgHashCode hash = GetHash(state);
     T myData(data);
-    if (NeedToRotate(state, hash))
-    {
-        m_stats.m_rotations++;
+    bool rotate = NeedToRotate(state, hash);
+    if (rotate)
         myData.Rotate(state.Position().Const());
+    boost::mutex::scoped_lock lock(m_queueMutex);
+    m_stats.m_puts++;
+    if (rotate)
+        m_stats.m_rotations++;
+    if (!m_writer)
+    {
+        lock.unlock();
+        boost::mutex::scoped_lock dbLock(m_dbMutex);
+        return m_db.Put(hash, myData);
+    }
+    if (!m_writeError.empty())
+        return false;
+    typename Table::iterator it = m_queued.find(hash);
+    if (it != m_queued.end())
+    {
+        m_stats.m_coalesced++;
+        it->second = myData;
+        return true;
+    }
+    if (m_queued.size() >= m_queueSize)
+    {
+        m_stats.m_stalls++;
+        while (m_queued.size() >= m_queueSize)
+            m_writtenCond.wait(lock);
+    }
+    bool wasEmpty = m_queued.empty();
+    m_queued[hash] = myData;
+    if (wasEmpty)
+        m_queuedCond.notify_one();
+    return true;
+}
+
+/** Blocks until the writer has written all queued states. Caller
+    holds lock on m_queueMutex. */
+template<class T>
+void StateDB<T>::WaitForWriter(boost::mutex::scoped_lock& lock)
+{
+    while (!m_queued.empty() || !m_writing.empty())
+        m_writtenCond.wait(lock);
+}
+
+template<class T>
+void StateDB<T>::WriterLoop()
+{
+    boost::mutex::scoped_lock lock(m_queueMutex);
+    while (true)
+    {
+        while (m_queued.empty() && !m_shutdown)
+            m_queuedCond.wait(lock);
+        if (m_queued.empty())
+            break;
+        m_writing.swap(m_queued);
+        m_writtenCond.notify_all();
+        lock.unlock();
+
+        // Readers only look at m_writing while we write it
+        double start = SgTime::Get();
+        std::string error;
+        try
+        {
+            for (typename Table::const_iterator it = m_writing.begin();
+                 it != m_writing.end(); ++it)
+            {
+                boost::mutex::scoped_lock dbLock(m_dbMutex);
+                if (!m_db.Put(it->first, it->second) && error.empty())
+                    error = "could not put " + it->first.ToString();
+            }
+        }
+        catch (const BenzeneException& e)
+        {
+            error = e.what();
+        }
+        double elapsed = SgTime::Get() - start;
+
+        lock.lock();
+        if (!error.empty())
+        {
+            LogSevere() << "StateDB: write failed: " << error << '\n';
+            if (m_writeError.empty())
+                m_writeError = error;
+        }
+        m_stats.m_batches++;
+        m_stats.m_writes += m_writing.size();
+        m_stats.m_writeTime += elapsed;
+        m_writing.clear();
+        m_writtenCond.notify_all();
     }
-    return m_db.Put(hash, myData);
 }
 
 template<class T>
 void StateDB<T>::Flush()
 {
-    m_db.Flush();
+    std::string error;
+    if (m_writer)
+    {
+        boost::mutex::scoped_lock lock(m_queueMutex);
+        WaitForWriter(lock);
+        error.swap(m_writeError);
+    }
+    {
+        boost::mutex::scoped_lock lock(m_dbMutex);
+        m_db.Flush();
+    }
+    if (!error.empty())
+        throw BenzeneException() << "StateDB: write failed: " << error;
 }
 
 template<class T>
 typename StateDB<T>::Statistics 
 StateDB<T>::GetStatistics() const
 {
+    boost::mutex::scoped_lock lock(m_queueMutex);
     return m_stats;
 }
 
@@ -175,7 +406,12 @@ StateDB<T>::Statistics::Statistics()
     : m_gets(0), 
       m_hits(0), 
       m_puts(0), 
-      m_rotations(0) 
+      m_rotations(0),
+      m_coalesced(0),
+      m_stalls(0),
+      m_batches(0),
+      m_writes(0),
+      m_writeTime(0.0)
 { 
 }
 
@@ -188,15 +424,34 @@ std::string StateDB<T>::Statistics::Write() const
        << "Hits       " << m_hits << '\n'
        << "Writes     " << m_puts << '\n'
        << "Rotations  " << m_rotations;
+    if (m_batches > 0)
+    {
+        os << '\n'
+           << "Coalesced  " << m_coalesced << '\n'
+           << "Stalls     " << m_stalls << '\n'
+           << "Batches    " << m_batches << '\n'
+           << "DBWrites   " << m_writes << '\n'
+           << "WriteTime  " << std::fixed << std::setprecision(3)
+           << m_writeTime << "s\n"
+           << "Writes/s   " << std::setprecision(0)
+           << (m_writeTime > 0.0 ? m_writes / m_writeTime : 0.0);
+    }
     return os.str();
 }
 
 template<class T>
 std::string StateDB<T>::BDBStatistics()
 {
+    boost::mutex::scoped_lock lock(m_dbMutex);
     return m_db.BDBStatistics();
 }
 
+template<class T>
+const std::string& StateDB<T>::Filename() const
+{
+    return m_db.Filename();
+}
+
 //----------------------------------------------------------------------------
 
 /** Set of positions; handles rotations. */
@@ -252,6 +252,19 @@ public:
         is updated. */
     void UndoMove(HexPoint cell);
 
+    /** Plays a stone like PlayMove(), but does not update the hash.
+        Meant for playouts, which only need the stones: Hash() is
+        wrong until the board is restored with CopyState() or
+        SetPosition().
+        @param color must be BLACK or WHITE.
+        @param cell must be an empty cell. */
+    void PlayPlayoutMove(HexColor color, HexPoint cell);
+
+    /** Copies the stones, played cells and hash of brd, which must
+        have the same dimensions. Cheaper than assignment, which also
+        copies the cached stone lists. */
+    void CopyState(const StoneBoard& brd);
+
     /** Rotates the board by 180' about the center. Hash is
         updated. */
     void RotateBoard();
@@ -426,6 +439,26 @@ inline bool StoneBoard::operator==(const StoneBoard& other) const
             && m_played == other.m_played);
 }
 
+inline void StoneBoard::PlayPlayoutMove(HexColor color, HexPoint cell)
+{
+    BenzeneAssert(HexColorUtil::isBlackWhite(color));
+    BenzeneAssert(Const().IsCell(cell));
+    BenzeneAssert(IsEmpty(cell));
+    m_played.set(cell);
+    m_stones[color].set(cell);
+    m_stones_calculated = false;
+}
+
+inline void StoneBoard::CopyState(const StoneBoard& brd)
+{
+    BenzeneAssert(Const() == brd.Const());
+    m_played = brd.m_played;
+    m_stones[BLACK] = brd.m_stones[BLACK];
+    m_stones[WHITE] = brd.m_stones[WHITE];
+    m_hash = brd.m_hash;
+    m_stones_calculated = false;
+}
+
 inline bool StoneBoard::operator!=(const StoneBoard& other) const
 {
     return !(operator==(other));
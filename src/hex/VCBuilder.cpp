@@ -2,6 +2,8 @@
 /** @file VCBuilder.cpp */
 //----------------------------------------------------------------------------
 
+#include <cstring>
+
 #include "SgSystem.h"
 #include "SgTimer.h"
 
@@ -36,6 +38,25 @@ VCBuilder::VCBuilder(VCBuilderParam& param)
     LoadCapturedSetPatterns();
 }
 
+VCBuilder::VCBuilder(const VCBuilder& other)
+    : m_orRule(*this), 
+      m_param(other.m_param),
+      m_queue(),
+      m_statistics(0),
+      m_groups(0),
+      m_brd(0),
+      m_con(0),
+      m_color(BLACK),
+      m_log(0)
+{
+    for (BWIterator c; c; ++c) 
+    {
+        m_statsForColor[*c] = other.m_statsForColor[*c];
+        m_capturedSetPatterns[*c] = other.m_capturedSetPatterns[*c];
+        m_hash_capturedSetPatterns[*c].Hash(m_capturedSetPatterns[*c]);
+    }
+}
+
 VCBuilder::~VCBuilder()
 {
 }
@@ -276,10 +297,10 @@ void VCBuilder::MergeAndShrink(const bitset_t& added,
     BenzeneAssert(xin != yin);
     BenzeneAssert(xout != yout);
 
-    VCList* fullsIn = &m_con->GetList(VC::FULL, xin, yin);
-    VCList* semisIn = &m_con->GetList(VC::SEMI, xin, yin);
-    VCList* fullsOut= &m_con->GetList(VC::FULL, xout, yout);
-    VCList* semisOut= &m_con->GetList(VC::SEMI, xout, yout);
+    VCList* fullsIn = m_con->Writable(VC::FULL, xin, yin);
+    VCList* semisIn = m_con->Writable(VC::SEMI, xin, yin);
+    VCList* fullsOut= m_con->Writable(VC::FULL, xout, yout);
+    VCList* semisOut= m_con->Writable(VC::SEMI, xout, yout);
     BenzeneAssert((fullsIn == fullsOut) == (semisIn == semisOut));
     bool doingMerge = (fullsIn != fullsOut);
 
@@ -360,11 +381,11 @@ void VCBuilder::RemoveAllContaining(const Groups& oldGroups,
             HexPoint yc = y->Captain();
 	    if (m_groups->GetGroup(yc).Color() == !m_color)
 	        continue;
-            std::size_t cur0 = m_con->GetList(VC::FULL, xc, yc)
-                .RemoveAllContaining(bs, m_log);
+            std::size_t cur0 = m_con->Writable(VC::FULL, xc, yc)
+                ->RemoveAllContaining(bs, m_log);
             m_statistics->killed0 += cur0; 
-            std::size_t cur1 = m_con->GetList(VC::SEMI, xc, yc)
-                .RemoveAllContaining(bs, m_log);
+            std::size_t cur1 = m_con->Writable(VC::SEMI, xc, yc)
+                ->RemoveAllContaining(bs, m_log);
             m_statistics->killed1 += cur1;
             if (cur0 || cur1)
                 m_queue.Push(std::make_pair(xc, yc));
@@ -378,14 +399,15 @@ void VCBuilder::RemoveAllContaining(const Groups& oldGroups,
 
 void VCBuilder::ProcessSemis(HexPoint xc, HexPoint yc)
 {
-    VCList& semis = m_con->GetList(VC::SEMI, xc, yc);
-    VCList& fulls = m_con->GetList(VC::FULL, xc, yc);
     bitset_t capturedSet = m_capturedSet[xc] | m_capturedSet[yc];
     bitset_t uncapturedSet = capturedSet;
     uncapturedSet.flip();
     // Nothing to do, so abort. 
-    if ((semis.HardIntersection() & uncapturedSet).any())
+    if ((m_con->GetList(VC::SEMI, xc, yc).HardIntersection() 
+         & uncapturedSet).any())
         return;
+    VCList& semis = *m_con->Writable(VC::SEMI, xc, yc);
+    VCList& fulls = *m_con->Writable(VC::FULL, xc, yc);
     std::list<VC> added;
     for (VCListIterator cur(semis, semis.Softlimit()); cur; ++cur) 
     {
@@ -416,7 +438,7 @@ void VCBuilder::ProcessSemis(HexPoint xc, HexPoint yc)
 
 void VCBuilder::ProcessFulls(HexPoint xc, HexPoint yc)
 {
-    VCList& fulls = m_con->GetList(VC::FULL, xc, yc);
+    VCList& fulls = *m_con->Writable(VC::FULL, xc, yc);
     for (VCListIterator cur(fulls, fulls.Softlimit()); cur; ++cur) 
     {
         if (!cur->Processed()) 
@@ -431,6 +453,11 @@ void VCBuilder::ProcessFulls(HexPoint xc, HexPoint yc)
 
 void VCBuilder::DoSearch()
 {
+    m_captains.reset();
+    HexColorSet not_other = HexColorSetUtil::NotColor(!m_color);
+    for (GroupIterator g(*m_groups, not_other); g; ++g) 
+        m_captains.set(g->Captain());
+
     bool winning_connection = false;
     while (!m_queue.Empty()) 
     {
@@ -467,7 +494,6 @@ void VCBuilder::DoSearch()
 void VCBuilder::AndClosure(const VC& vc)
 {
     HexColor other = !m_color;
-    HexColorSet not_other = HexColorSetUtil::NotColor(other);
     HexPoint endp[2];
     endp[0] = m_groups->CaptainOf(vc.X());
     endp[1] = m_groups->CaptainOf(vc.Y());
@@ -477,13 +503,19 @@ void VCBuilder::AndClosure(const VC& vc)
     BenzeneAssert(endc[0] != other);
     BenzeneAssert(endc[1] != other);
     bitset_t vcCapturedSet = m_capturedSet[endp[0]] | m_capturedSet[endp[1]];
-    for (GroupIterator g(*m_groups, not_other); g; ++g) 
+    // Only groups with a full connection to an endpoint can be used:
+    // DoAnd() does nothing for an empty list. Groups are ordered by
+    // captain, so this visits them in the same order as a
+    // GroupIterator would.
+    bitset_t candidates = (m_con->Adjacent(VC::FULL, endp[0]) 
+                           | m_con->Adjacent(VC::FULL, endp[1]))
+        & m_captains;
+    candidates.reset(endp[0]);
+    candidates.reset(endp[1]);
+    candidates = candidates - vc.Carrier();
+    for (BitsetIterator g(candidates); g; ++g) 
     {
-        HexPoint z = g->Captain();
-        if (z == endp[0] || z == endp[1])
-            continue;
-        if (vc.Carrier().test(z))
-            continue;
+        HexPoint z = *g;
         bitset_t capturedSet = vcCapturedSet | m_capturedSet[z];
         bitset_t uncapturedSet = capturedSet;
         uncapturedSet.flip();
@@ -492,13 +524,12 @@ void VCBuilder::AndClosure(const VC& vc)
             int j = (i + 1) & 1;
             if (m_param.and_over_edge || !HexPointUtil::isEdge(endp[i])) 
             {
-                VCList* fulls = &m_con->GetList(VC::FULL, z, endp[i]);
+                const VCList* fulls = &m_con->GetList(VC::FULL, z, endp[i]);
                 if ((fulls->SoftIntersection() & vc.Carrier()
                      & uncapturedSet).any())
                     continue;
                 AndRule rule = (endc[i] == EMPTY) ? CREATE_SEMI : CREATE_FULL;
-                DoAnd(z, endp[i], endp[j], rule, vc, capturedSet, 
-                      &m_con->GetList(VC::FULL, z, endp[i]));
+                DoAnd(z, endp[i], endp[j], rule, vc, capturedSet, fulls);
             }
         }
     }
@@ -689,8 +720,8 @@ bool VCBuilder::AddNewFull(const VC& vc)
     VCList::AddResult result = m_con->Add(vc, m_log);
     if (result != VCList::ADD_FAILED) 
     {
-        m_con->GetList(VC::SEMI, vc.X(), vc.Y())
-            .RemoveSuperSetsOf(vc.Carrier(), m_log);
+        m_con->Writable(VC::SEMI, vc.X(), vc.Y())
+            ->RemoveSuperSetsOf(vc.Carrier(), m_log);
         if (result == VCList::ADDED_INSIDE_SOFT_LIMIT)
             m_queue.Push(std::make_pair(vc.X(), vc.Y()));
         return true;
@@ -712,10 +743,10 @@ bool VCBuilder::AddNewFull(const VC& vc)
     intersection the semi-list is empty. */
 bool VCBuilder::AddNewSemi(const VC& vc)
 {
-    VCList* outFull = &m_con->GetList(VC::FULL, vc.X(), vc.Y());
-    VCList* outSemi = &m_con->GetList(VC::SEMI, vc.X(), vc.Y());
+    const VCList* outFull = &m_con->GetList(VC::FULL, vc.X(), vc.Y());
     if (!outFull->IsSupersetOfAny(vc.Carrier())) 
     {
+        VCList* outSemi = m_con->Writable(VC::SEMI, vc.X(), vc.Y());
         VCList::AddResult result = outSemi->Add(vc, m_log);
         if (result != VCList::ADD_FAILED) 
         {
@@ -730,7 +761,7 @@ bool VCBuilder::AddNewSemi(const VC& vc)
                         : outSemi->GetUnion();
                     VC v(outFull->GetX(), outFull->GetY(), 
                          carrier, VC_RULE_ALL);
-                    outFull->Add(v, m_log);
+                    m_con->Writable(VC::FULL, vc.X(), vc.Y())->Add(v, m_log);
                 }
             }
             return true;
@@ -788,8 +819,10 @@ std::string VCBuilderStatistics::ToString() const
 */
 VCBuilder::WorkQueue::WorkQueue()
     : m_head(0), 
-      m_array(128)
+      m_array(128),
+      m_epoch(1)
 {
+    memset(m_seen, 0, sizeof(m_seen));
 }
 
 bool VCBuilder::WorkQueue::Empty() const
@@ -809,14 +842,19 @@ std::size_t VCBuilder::WorkQueue::Capacity() const
 
 void VCBuilder::WorkQueue::Clear()
 {
-    memset(m_seen, 0, sizeof(m_seen));
+    ++m_epoch;
+    if (m_epoch == 0)
+    {
+        memset(m_seen, 0, sizeof(m_seen));
+        m_epoch = 1;
+    }
     m_array.clear();
     m_head = 0;
 }
 
 void VCBuilder::WorkQueue::Pop()
 {
-    m_seen[Front().first][Front().second] = false;
+    m_seen[Front().first][Front().second] = 0;
     m_head++;
 }
 
@@ -824,9 +862,9 @@ void VCBuilder::WorkQueue::Push(const HexPointPair& p)
 {
     HexPoint a = std::min(p.first, p.second);
     HexPoint b = std::max(p.first, p.second);
-    if (!m_seen[a][b]) 
+    if (m_seen[a][b] != m_epoch) 
     {
-        m_seen[a][a] = true;
+        m_seen[a][b] = m_epoch;
         m_array.push_back(std::make_pair(a, b));
     }
 }
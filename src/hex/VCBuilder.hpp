@@ -131,6 +131,11 @@ public:
 
     /** Constructor. */
     VCBuilder(VCBuilderParam& param);
+
+    /** Copy constructor. Shares the parameters of other, but none of
+        its working state, so both builders can run at the same
+        time. */
+    VCBuilder(const VCBuilder& other);
     
     /** Destrutor. */
     ~VCBuilder();
@@ -149,6 +154,11 @@ public:
     /** Clears the statistics for both colors. */
     void ClearStatistics();
 
+    /** Replaces the statistics for color. Used to collect the
+        statistics of a builder that ran concurrently with this
+        one. */
+    void SetStatistics(HexColor color, const VCBuilderStatistics& stats);
+
     //----------------------------------------------------------------------
 
     /** Computes connections from scratch. Old connections are removed
@@ -185,7 +195,11 @@ private:
     private:
         std::size_t m_head;
         std::vector<HexPointPair> m_array;
-        bool m_seen[BITSETSIZE][BITSETSIZE];
+
+        /** A pair is in the queue if its entry equals m_epoch, so
+            Clear() does not need to touch the matrix. */
+        unsigned m_seen[BITSETSIZE][BITSETSIZE];
+        unsigned m_epoch;
     };
     
     /** The types of VC to create when using the AND rule. */
@@ -229,6 +243,10 @@ private:
 
     ChangeLog<VC>* m_log;
 
+    /** Captains of the groups that are not of the opponent's color,
+        computed at the start of DoSearch(). */
+    bitset_t m_captains;
+
     bitset_t m_capturedSet[BITSETSIZE];
 
     PatternSet m_capturedSetPatterns[BLACK_AND_WHITE];
@@ -297,6 +315,12 @@ inline void VCBuilder::ClearStatistics()
     m_statsForColor[WHITE] = VCBuilderStatistics();
 }
 
+inline void VCBuilder::SetStatistics(HexColor color, 
+                                     const VCBuilderStatistics& stats)
+{
+    m_statsForColor[color] = stats;
+}
+
 //----------------------------------------------------------------------------
 
 _END_BENZENE_NAMESPACE_
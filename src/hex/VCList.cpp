@@ -14,12 +14,36 @@ VCList::VCList(HexPoint x, HexPoint y, std::size_t soft)
       m_softlimit(soft),
       m_vcs(),
       m_dirtyIntersection(false),
-      m_dirtyUnion(true)
+      m_dirtyUnion(true),
+      m_connected(0),
+      m_references(1)
 {
     m_softIntersection.set();
     m_hardIntersection.set();
 }
 
+VCList::VCList(const VCList& other)
+    : m_x(other.m_x), m_y(other.m_y),
+      m_softlimit(other.m_softlimit),
+      m_vcs(other.m_vcs),
+      m_dirtyIntersection(other.m_dirtyIntersection),
+      m_softIntersection(other.m_softIntersection),
+      m_hardIntersection(other.m_hardIntersection),
+      m_dirtyUnion(other.m_dirtyUnion),
+      m_union(other.m_union),
+      m_greedyUnion(other.m_greedyUnion),
+      m_connected(0),
+      m_references(1)
+{
+}
+
+void VCList::SetConnected(bitset_t* connected)
+{
+    m_connected = connected;
+    if (m_connected)
+        UpdateConnected();
+}
+
 //----------------------------------------------------------------------------
 
 std::string VCList::Dump() const
@@ -32,6 +32,15 @@ public:
     /** Creates a list with given limits. */
     VCList(HexPoint x, HexPoint y, std::size_t soft);
 
+    /** Copy constructor. The copy does not update the connected
+        bitsets of other and is not shared; see SetConnected(). */
+    VCList(const VCList& other);
+
+    /** Makes the list keep connected[x] and connected[y] up to date:
+        y is in connected[x] (and x in connected[y]) exactly when the
+        list is not empty. Used by VCSet; pass 0 to stop updating. */
+    void SetConnected(bitset_t* connected);
+
     HexPoint GetX() const;
     
     HexPoint GetY() const;
@@ -190,7 +199,18 @@ protected:
 
     mutable bitset_t m_greedyUnion;
 
-    /** Invalidates the precomputed list unions. */
+    /** See SetConnected() */
+    bitset_t* m_connected;
+
+    /** Number of VCSets holding this list; VCSet copies share lists
+        and copy them before changing them. */
+    volatile int m_references;
+
+    /** Updates the connected bitsets after the list changed. */
+    void UpdateConnected();
+
+    /** Invalidates the precomputed list unions. Called whenever the
+        list changes, so also updates the connected bitsets. */
     void DirtyListUnions();
 
     /** Invalidates the list intersection. */
@@ -205,6 +225,8 @@ protected:
     friend class VCListIterator;
 
     friend class VCListConstIterator;
+
+    friend class VCSet;
 };
 
 inline HexPoint VCList::GetX() const
@@ -243,9 +265,25 @@ inline bool VCList::Empty() const
     return m_vcs.empty();
 }
 
+inline void VCList::UpdateConnected()
+{
+    if (m_vcs.empty())
+    {
+        m_connected[m_x].reset(m_y);
+        m_connected[m_y].reset(m_x);
+    }
+    else
+    {
+        m_connected[m_x].set(m_y);
+        m_connected[m_y].set(m_x);
+    }
+}
+
 inline void VCList::DirtyListUnions()
 {
     m_dirtyUnion = true;
+    if (m_connected)
+        UpdateConnected();
 }
 
 inline void VCList::DirtyListIntersections()
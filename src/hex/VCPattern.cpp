@@ -8,6 +8,13 @@
 #include "StoneBoard.hpp"
 #include "VCPattern.hpp"
 
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
+#include <boost/cstdint.hpp>
+#include <boost/filesystem/operations.hpp>
+#include <boost/filesystem/path.hpp>
+
 using namespace benzene;
 
 //----------------------------------------------------------------------------
@@ -151,6 +158,202 @@ void ProcessPattern(const VCPattern& pat, StoneBoard& brd,
                    DIR_SOUTH, out[WHITE]);
 }
 
+//---------------------------------------------------------------------------
+
+/** Update this if the layout of the cache files changes. */
+const boost::uint32_t CACHE_VERSION = 1;
+
+/** Written at the start of every cache file. */
+const char CACHE_MAGIC[8] = { 'B', 'Z', 'V', 'C', 'P', 'A', 'T', '\0' };
+
+/** Written in native byte order; detects files from other
+    machines. */
+const boost::uint32_t CACHE_BYTE_ORDER = 0x01020304;
+
+/** FNV-1a hash of the pattern templates, so a cache is not used
+    after vc-patterns.txt changes. */
+boost::uint64_t HashTemplates(const std::string& text)
+{
+    const boost::uint64_t FNV_PRIME 
+        = (static_cast<boost::uint64_t>(1) << 40) | 0x1b3u;
+    boost::uint64_t hash 
+        = (static_cast<boost::uint64_t>(0xcbf29ce4u) << 32) | 0x84222325u;
+    for (std::size_t i = 0; i < text.size(); ++i)
+    {
+        hash ^= static_cast<unsigned char>(text[i]);
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+/** Returns the cache file for the boardsize, or an empty string if
+    caching is disabled. */
+std::string CacheFile(int width, int height)
+{
+    if (MiscUtil::CacheDir().empty())
+        return "";
+    std::ostringstream os;
+    os << "vc-patterns-" << width << 'x' << height << ".bin";
+    boost::filesystem::path p 
+        = boost::filesystem::path(MiscUtil::CacheDir()) / os.str();
+    return p.string();
+}
+
+template<typename T>
+void WriteValue(std::ostream& os, const T& value)
+{
+    os.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template<typename T>
+bool ReadValue(std::istream& is, T& value)
+{
+    is.read(reinterpret_cast<char*>(&value), sizeof(T));
+    return is.good();
+}
+
+/** Header of a cache file; every field must match for the cache to
+    be used. */
+void WriteHeader(std::ostream& os, int width, int height, 
+                 boost::uint64_t hash)
+{
+    os.write(CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    WriteValue(os, CACHE_VERSION);
+    WriteValue(os, CACHE_BYTE_ORDER);
+    WriteValue(os, static_cast<boost::uint32_t>(BITSETSIZE));
+    WriteValue(os, static_cast<boost::int32_t>(width));
+    WriteValue(os, static_cast<boost::int32_t>(height));
+    WriteValue(os, hash);
+}
+
+bool ReadHeader(std::istream& is, int width, int height, 
+                boost::uint64_t hash)
+{
+    std::ostringstream expected;
+    WriteHeader(expected, width, height, hash);
+    std::string header = expected.str();
+    std::vector<char> buf(header.size());
+    is.read(&buf[0], static_cast<std::streamsize>(buf.size()));
+    return is.good() && std::memcmp(&buf[0], header.data(), buf.size()) == 0;
+}
+
+void WritePatternSet(std::ostream& os, const std::vector<VCPattern>& pats)
+{
+    const int numBytes = MiscUtil::NumBytesToHoldBits(BITSETSIZE);
+    std::vector<byte> buf(numBytes);
+    WriteValue(os, static_cast<boost::uint64_t>(pats.size()));
+    for (std::size_t i = 0; i < pats.size(); ++i)
+    {
+        WriteValue(os, static_cast<boost::uint32_t>(pats[i].Endpoint(0)));
+        WriteValue(os, static_cast<boost::uint32_t>(pats[i].Endpoint(1)));
+        BitsetUtil::BitsetToBytes(pats[i].MustHave(), &buf[0], BITSETSIZE);
+        os.write(reinterpret_cast<const char*>(&buf[0]), numBytes);
+        BitsetUtil::BitsetToBytes(pats[i].NotOpponent(), &buf[0], BITSETSIZE);
+        os.write(reinterpret_cast<const char*>(&buf[0]), numBytes);
+    }
+}
+
+/** Returns the number of bytes from the current position to the
+    end of the stream. */
+boost::uint64_t BytesLeft(std::istream& is)
+{
+    std::streampos pos = is.tellg();
+    is.seekg(0, std::ios::end);
+    std::streampos end = is.tellg();
+    is.seekg(pos);
+    if (pos < 0 || end < pos)
+        return 0;
+    return static_cast<boost::uint64_t>(end - pos);
+}
+
+/** Fails if the pattern count does not fit in the rest of the file,
+    so a corrupt count never reaches reserve(). */
+bool ReadPatternSet(std::istream& is, std::vector<VCPattern>& pats)
+{
+    const int numBytes = MiscUtil::NumBytesToHoldBits(BITSETSIZE);
+    const boost::uint64_t patternBytes 
+        = 2 * sizeof(boost::uint32_t) + 2 * numBytes;
+    std::vector<byte> buf(numBytes);
+    boost::uint64_t size;
+    if (!ReadValue(is, size))
+        return false;
+    if (size > BytesLeft(is) / patternBytes)
+        return false;
+    pats.clear();
+    pats.reserve(static_cast<std::size_t>(size));
+    for (boost::uint64_t i = 0; i < size; ++i)
+    {
+        boost::uint32_t end1, end2;
+        if (!ReadValue(is, end1) || !ReadValue(is, end2))
+            return false;
+        if (end1 >= FIRST_INVALID || end2 >= FIRST_INVALID)
+            return false;
+        is.read(reinterpret_cast<char*>(&buf[0]), numBytes);
+        bitset_t must = BitsetUtil::BytesToBitset(&buf[0], BITSETSIZE);
+        is.read(reinterpret_cast<char*>(&buf[0]), numBytes);
+        bitset_t oppt = BitsetUtil::BytesToBitset(&buf[0], BITSETSIZE);
+        if (!is.good())
+            return false;
+        pats.push_back(VCPattern(static_cast<HexPoint>(end1), 
+                                 static_cast<HexPoint>(end2), must, oppt));
+    }
+    return true;
+}
+
+/** Loads the patterns for both colors from the cache. Returns false
+    if there is no valid cache file. */
+bool LoadCache(int width, int height, boost::uint64_t hash,
+               std::vector<VCPattern> out[BLACK_AND_WHITE])
+{
+    std::string file = CacheFile(width, height);
+    if (file.empty())
+        return false;
+    std::ifstream is(file.c_str(), std::ios::binary);
+    if (!is || !ReadHeader(is, width, height, hash))
+        return false;
+    for (BWIterator c; c; ++c)
+        if (!ReadPatternSet(is, out[*c]))
+            return false;
+    if (is.peek() != std::char_traits<char>::eof())
+        return false;
+    LogConfig() << "VCPattern: loaded " << out[BLACK].size() 
+                << " patterns from '" << file << "'.\n";
+    return true;
+}
+
+/** Writes the patterns to the cache. The file is written under a
+    temporary name and then renamed, so concurrent processes never
+    read a partial file. */
+void SaveCache(int width, int height, boost::uint64_t hash,
+               const std::vector<VCPattern> out[BLACK_AND_WHITE])
+{
+    std::string file = CacheFile(width, height);
+    if (file.empty())
+        return;
+    std::ostringstream tmpName;
+    tmpName << file << ".tmp" << getpid();
+    std::string tmp = tmpName.str();
+    {
+        std::ofstream os(tmp.c_str(), std::ios::binary);
+        WriteHeader(os, width, height, hash);
+        for (BWIterator c; c; ++c)
+            WritePatternSet(os, out[*c]);
+        if (!os)
+        {
+            LogWarning() << "VCPattern: could not write '" << tmp << "'.\n";
+            return;
+        }
+    }
+    try {
+        boost::filesystem::rename(tmp, file);
+    }
+    catch (std::exception& e) {
+        LogWarning() << "VCPattern: could not write cache: " 
+                     << e.what() << '\n';
+        std::remove(tmp.c_str());
+    }
+}
+
 } // annonymous namespace
 
 //----------------------------------------------------------------------------
@@ -191,16 +394,31 @@ void VCPattern::CreatePatterns(int width, int height)
 {
     LogFine() << "VCPattern::CreatePatterns(" 
               << width << ", " << height << ")\n";
-    std::ifstream fin;
+    std::ifstream templates;
     try {
-        std::string file = MiscUtil::OpenFile("vc-patterns.txt", fin);
+        std::string file = MiscUtil::OpenFile("vc-patterns.txt", templates);
         LogConfig() << "VCPattern: loading pattern templates from '" 
                     << file << "'.\n";
     }
     catch (BenzeneException& e) {
         throw BenzeneException() << "VCPattern: " << e.what();
     }
+    std::ostringstream text;
+    text << templates.rdbuf();
+    templates.close();
+    boost::uint64_t hash = HashTemplates(text.str());
+
     std::vector<VCPattern> out[BLACK_AND_WHITE];
+    if (LoadCache(width, height, hash, out))
+    {
+        GetConstructed(BLACK)[std::make_pair(width, height)] = out[BLACK];
+        GetConstructed(WHITE)[std::make_pair(width, height)] = out[WHITE];
+        return;
+    }
+    out[BLACK].clear();
+    out[WHITE].clear();
+
+    std::istringstream fin(text.str());
     std::vector<BuilderPattern> start, end;
     std::vector<VCPattern> complete;
     int numConstructed = 0;
@@ -312,7 +530,6 @@ void VCPattern::CreatePatterns(int width, int height)
                                          patternHeight));
         }
     }
-    fin.close();
 
     // Build ladder patterns by combining start and end patterns
     LogFine() << "Combining start(" << start.size()
@@ -374,6 +591,7 @@ void VCPattern::CreatePatterns(int width, int height)
     for (std::size_t i=0; i<complete.size(); ++i)
         ProcessPattern(complete[i], sb, out);
     LogFine() << out[BLACK].size() << " total patterns\n";
+    SaveCache(width, height, hash, out);
     GetConstructed(BLACK)[std::make_pair(width, height)] = out[BLACK];
     GetConstructed(WHITE)[std::make_pair(width, height)] = out[WHITE];
     LogFine() << "Done.\n";
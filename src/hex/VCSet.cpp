@@ -2,7 +2,9 @@
 /** @file VCSet.cpp */
 //----------------------------------------------------------------------------
 
+#include <algorithm>
 #include "Hex.hpp"
+#include "AtomicMemory.hpp"
 #include "ChangeLog.hpp"
 #include "VCSet.hpp"
 #include "VC.hpp"
@@ -29,6 +31,8 @@ VCSet::VCSet(const ConstBoard& brd, HexColor color)
                 new VCList(*y, *x, softlimit_full);
             m_vc[VC::SEMI][*x][*y] = m_vc[VC::SEMI][*y][*x] =
                 new VCList(*y, *x, softlimit_semi);
+            m_vc[VC::FULL][*x][*y]->SetConnected(m_adjacent[VC::FULL]);
+            m_vc[VC::SEMI][*x][*y]->SetConnected(m_adjacent[VC::SEMI]);
             if (*x == *y)
                 break;
         }
@@ -39,28 +43,39 @@ VCSet::VCSet(const VCSet& other)
     : m_brd(other.m_brd),
       m_color(other.m_color)
 {
-    AllocateAndCopyLists(other);
+    ShareLists(other);
 }
 
 void VCSet::operator=(const VCSet& other)
 {
+    if (this == &other)
+        return;
+    FreeLists();
     m_brd = other.m_brd;
     m_color = other.m_color;
-    FreeLists();
-    AllocateAndCopyLists(other);
+    ShareLists(other);
 }
 
-void VCSet::AllocateAndCopyLists(const VCSet& other)
+void VCSet::ShareLists(const VCSet& other)
 {
+    for (int i = 0; i < VC::NUM_TYPES; ++i)
+        for (int p = 0; p < BITSETSIZE; ++p)
+            m_adjacent[i][p] = other.m_adjacent[i][p];
     for (BoardIterator y = m_brd->EdgesAndInterior(); y; ++y) 
     {
         for (BoardIterator x = m_brd->EdgesAndInterior(); x; ++x) 
         {
-            m_vc[VC::FULL][*x][*y] = m_vc[VC::FULL][*y][*x] =
-                new VCList(*other.m_vc[VC::FULL][*y][*x]);
-
-            m_vc[VC::SEMI][*x][*y] = m_vc[VC::SEMI][*y][*x] =
-                new VCList(*other.m_vc[VC::SEMI][*y][*x]);
+            for (int i = 0; i < VC::NUM_TYPES; ++i)
+            {
+                VCList* list = other.m_vc[i][*y][*x];
+                // Shared lists must not change, not even their caches
+                if (list->m_dirtyUnion)
+                    list->ComputeUnions();
+                if (list->m_dirtyIntersection)
+                    list->ComputeIntersections();
+                FetchAndAdd(&list->m_references, 1);
+                m_vc[i][*x][*y] = m_vc[i][*y][*x] = list;
+            }
             if (*x == *y) 
                 break;
         }
@@ -72,6 +87,12 @@ VCSet::~VCSet()
     FreeLists();
 }
 
+void VCSet::Release(VCList* list)
+{
+    if (FetchAndAdd(&list->m_references, -1) == 1)
+        delete list;
+}
+
 void VCSet::FreeLists()
 {
     for (BoardIterator y = m_brd->EdgesAndInterior(); y; ++y) 
@@ -79,13 +100,23 @@ void VCSet::FreeLists()
         for (BoardIterator x = m_brd->EdgesAndInterior(); x; ++x) 
         {
             for (int i=0; i<VC::NUM_TYPES; ++i)
-                delete m_vc[i][*x][*y];
+                Release(m_vc[i][*x][*y]);
             if (*x == *y)
                 break;
         }
     }
 }
 
+VCList* VCSet::Unshare(VC::Type type, HexPoint x, HexPoint y)
+{
+    VCList* shared = m_vc[type][x][y];
+    VCList* list = new VCList(*shared);
+    list->SetConnected(m_adjacent[type]);
+    m_vc[type][x][y] = m_vc[type][y][x] = list;
+    Release(shared);
+    return list;
+}
+
 //----------------------------------------------------------------------------
 
 bool VCSet::Exists(HexPoint x, HexPoint y, VC::Type type) const
@@ -116,7 +147,8 @@ void VCSet::SetSoftLimit(VC::Type type, std::size_t limit)
 {
     for (BoardIterator y(m_brd->EdgesAndInterior()); y; ++y)
         for (BoardIterator x(m_brd->EdgesAndInterior()); *x != *y; ++x)
-            m_vc[type][*x][*y]->SetSoftlimit(limit);
+            if (m_vc[type][*x][*y]->Softlimit() != limit)
+                Writable(type, *x, *y)->SetSoftlimit(limit);
 }
 
 void VCSet::Clear()
@@ -124,7 +156,23 @@ void VCSet::Clear()
     for (BoardIterator y(m_brd->EdgesAndInterior()); y; ++y)
         for (BoardIterator x(m_brd->EdgesAndInterior()); *x != *y; ++x)
             for (int i = 0; i < VC::NUM_TYPES; ++i)
-                m_vc[i][*x][*y]->Clear();
+            {
+                VC::Type type = static_cast<VC::Type>(i);
+                VCList* list = m_vc[type][*x][*y];
+                if (list->Empty() && list->m_connected == m_adjacent[type])
+                    continue;
+                if (list->m_references != 1)
+                {
+                    // Start from an empty list instead of copying
+                    VCList* empty = new VCList(list->GetX(), list->GetY(),
+                                               list->Softlimit());
+                    empty->SetConnected(m_adjacent[type]);
+                    m_vc[type][*x][*y] = m_vc[type][*y][*x] = empty;
+                    Release(list);
+                }
+                else
+                    Writable(type, *x, *y)->Clear();
+            }
 }
 
 void VCSet::Revert(ChangeLog<VC>& log)
@@ -139,7 +187,7 @@ void VCSet::Revert(ChangeLog<VC>& log)
         }
         VC vc(log.TopData());
         log.Pop();
-        VCList* list = m_vc[vc.GetType()][vc.X()][vc.Y()];
+        VCList* list = Writable(vc.GetType(), vc.X(), vc.Y());
         if (action == ChangeLog<VC>::ADD) 
         {
 #ifdef NDEBUG
@@ -162,6 +210,30 @@ void VCSet::Revert(ChangeLog<VC>& log)
 
 //----------------------------------------------------------------------------
 
+std::size_t VCSet::MemoryUsed() const
+{
+    // A VC in a std::list node, with its two links
+    const double vcBytes = sizeof(VC) + 2 * sizeof(void*);
+    double bytes = sizeof(VCSet);
+    for (BoardIterator y(m_brd->EdgesAndInterior()); y; ++y) 
+    {
+        for (BoardIterator x(m_brd->EdgesAndInterior()); x; ++x) 
+        {
+            for (int i = 0; i < VC::NUM_TYPES; ++i)
+            {
+                const VCList* list = m_vc[i][*x][*y];
+                bytes += (sizeof(VCList) + vcBytes * list->Size())
+                    / std::max(1, static_cast<int>(list->m_references));
+            }
+            if (*x == *y)
+                break;
+        }
+    }
+    return static_cast<std::size_t>(bytes);
+}
+
+//----------------------------------------------------------------------------
+
 bool VCSet::operator==(const VCSet& other) const
 {
     for (BoardIterator x(m_brd->EdgesAndInterior()); x; ++x) 
@@ -19,14 +19,24 @@ _BEGIN_BENZENE_NAMESPACE_
 
 //----------------------------------------------------------------------------
 
-/** Stores the connections for a board and color. */
+/** Stores the connections for a board and color.
+
+    Copies share their VCLists: a list is copied only when one of the
+    sets holding it first changes it, that is, on a call to
+    Writable() or to a modifying method. Reading a list through
+    GetList() never copies it. Copying a set is
+    therefore cheap, and sets copied from the same position share the
+    connections they do not change. The reference counts are only
+    thread-safe if HAVE_GCC_ATOMIC_BUILTINS is defined. Copying a set
+    computes the cached unions and intersections of its lists, so a
+    set must not be copied while another thread reads it. */
 class VCSet
 {
 public:
     /** Creates a VCSet class on the given board size for color. */
     VCSet(const ConstBoard& brd, HexColor color);
 
-    /** Copy constructor. */
+    /** Copy constructor. Shares the lists of other. */
     VCSet(const VCSet& other);
 
     /** Destructor. */
@@ -47,14 +57,22 @@ public:
     /** Returns the VCList between (x, y). */
     const VCList& GetList(VC::Type type, HexPoint x, HexPoint y) const;
     
-    /** Returns the VCList between (x, y). */
-    VCList& GetList(VC::Type type, HexPoint x, HexPoint y);
+    /** Returns the VCList between (x, y) for changing. Copies the
+        list first if it is shared with another set, so only call
+        this to change the list. */
+    VCList* Writable(VC::Type type, HexPoint x, HexPoint y);
 
     /** Determines if there is at least one valid connection between
         the given pair of cells for the color and VC type, x and y
         must both be the color of this connection set. */
     bool Exists(HexPoint x, HexPoint y, VC::Type type) const;
 
+    /** Returns the set of points y for which the list of type between
+        x and y is not empty. Kept up to date as the lists change, so
+        this costs nothing. May contain points that are no longer
+        captains of a group. */
+    const bitset_t& Adjacent(VC::Type type, HexPoint x) const;
+
     /** Copies the smallest connection between x and y of type into
         out, returns true if successful. Returns false if no
         connection exists between x and y. */
@@ -64,6 +82,11 @@ public:
         (which is cleared beforehand). */
     void VCs(HexPoint x, HexPoint y, VC::Type type, std::vector<VC>& out) const;
 
+    /** Approximate bytes used by this set. A list shared with other
+        sets is split evenly among them, so the sum over all sets
+        counts each list once. */
+    std::size_t MemoryUsed() const;
+
     //------------------------------------------------------------------------
 
     /** @name Modifying methods */
@@ -77,7 +100,7 @@ public:
 
     /** Attempts to add the given vc to the list between (vc.x(),
         vc.y()). Returns result of the add operation. This method is
-        just a wrapper for GetList(vc.type(), vc.x(), vc.y())->add(vc).
+        just a wrapper for Writable(vc.type(), vc.x(), vc.y())->add(vc).
 
         @see VCList::add()
     */
@@ -95,7 +118,7 @@ public:
     /** @name Operators */
     // @{
 
-    /** Assignment operator. */
+    /** Assignment operator. Shares the lists of other. */
     void operator=(const VCSet& other);
 
     /** Returns true if other is isomorphic to us. */
@@ -107,13 +130,17 @@ public:
     // @}
 
 private:
-    /** Allocates space for, and copies lists from, the VCLists in
-        other. */
-    void AllocateAndCopyLists(const VCSet& other);
+    /** Shares the lists of other and copies its adjacency. */
+    void ShareLists(const VCSet& other);
 
-    /** Frees all allocated VCLists. */
+    /** Releases all VCLists, freeing those no other set holds. */
     void FreeLists();
 
+    /** Replaces a shared list by a copy owned by this set. */
+    VCList* Unshare(VC::Type type, HexPoint x, HexPoint y);
+
+    static void Release(VCList* list);
+
     /** @see Board() */
     const ConstBoard* m_brd;
 
@@ -123,6 +150,9 @@ private:
     /** The lists of vcs. 
         @todo use actual boardsize instead of BITSETSIZE? */
     VCList* m_vc[VC::NUM_TYPES][BITSETSIZE][BITSETSIZE];
+
+    /** See Adjacent() */
+    bitset_t m_adjacent[VC::NUM_TYPES][BITSETSIZE];
 };
 
 inline HexColor VCSet::Color() const
@@ -141,16 +171,26 @@ VCSet::GetList(VC::Type type, HexPoint x, HexPoint y) const
     return *m_vc[type][x][y];
 }
 
-inline VCList& 
-VCSet::GetList(VC::Type type, HexPoint x, HexPoint y)
+inline VCList* VCSet::Writable(VC::Type type, HexPoint x, HexPoint y)
 {
-    return *m_vc[type][x][y];
+    VCList* list = m_vc[type][x][y];
+    if (list->m_references != 1)
+        return Unshare(type, x, y);
+    // The list may have been shared with the set that created it
+    if (list->m_connected != m_adjacent[type])
+        list->SetConnected(m_adjacent[type]);
+    return list;
+}
+
+inline const bitset_t& VCSet::Adjacent(VC::Type type, HexPoint x) const
+{
+    return m_adjacent[type][x];
 }
 
 inline 
 VCList::AddResult VCSet::Add(const VC& vc, ChangeLog<VC>* log)
 {
-    return m_vc[vc.GetType()][vc.X()][vc.Y()]->Add(vc, log);
+    return Writable(vc.GetType(), vc.X(), vc.Y())->Add(vc, log);
 }
 
 inline std::size_t VCSet::SoftLimit(VC::Type type) const
@@ -0,0 +1,130 @@
+//----------------------------------------------------------------------------
+/** @file BitsetDigraphTest.cpp */
+//----------------------------------------------------------------------------
+
+#include <boost/test/auto_unit_test.hpp>
+
+#include "BitsetDigraph.hpp"
+
+using namespace benzene;
+
+//---------------------------------------------------------------------------
+
+namespace {
+
+BOOST_AUTO_TEST_CASE(BitsetDigraph_Edges)
+{
+    HexPoint a1 = HEX_CELL_A1;
+    HexPoint b1 = HEX_CELL_B1;
+    HexPoint c1 = HEX_CELL_C1;
+    HexPoint a2 = HEX_CELL_A2;
+    BitsetDigraph g;
+
+    g.AddEdge(a1, b1);
+    BOOST_CHECK_EQUAL(g.NumVertices(), 2u);
+    BOOST_CHECK_EQUAL(g.OutDegree(a1), 1u);
+    BOOST_CHECK_EQUAL(g.OutDegree(b1), 0u);
+    BOOST_CHECK_EQUAL(g.InDegree(a1), 0u);
+    BOOST_CHECK_EQUAL(g.InDegree(b1), 1u);
+    BOOST_CHECK(g.IsEdge(a1, b1));
+    BOOST_CHECK(!g.IsEdge(b1, a1));
+    BOOST_CHECK(!g.IsEdge(c1, a1));
+
+    bitset_t targets;
+    targets.set(b1);
+    targets.set(c1);
+    g.AddEdges(a2, targets);
+    g.AddEdge(c1, a1);
+    BOOST_CHECK_EQUAL(g.NumVertices(), 4u);
+    BOOST_CHECK(g.OutSet(a2) == targets);
+    BOOST_CHECK_EQUAL(g.InSet(b1).count(), 2u);
+    BOOST_CHECK(g.InSet(b1).test(a1));
+    BOOST_CHECK(g.InSet(b1).test(a2));
+    BOOST_CHECK_EQUAL(g.InSet(targets).count(), 2u);
+
+    // copies are independent
+    BitsetDigraph h(g);
+    h.RemoveVertex(b1);
+    BOOST_CHECK(!h.VertexExists(b1));
+    BOOST_CHECK_EQUAL(h.OutDegree(a1), 0u);
+    BOOST_CHECK(h.IsEdge(a2, c1));
+    BOOST_CHECK(h.IsEdge(c1, a1));
+    BOOST_CHECK(g.IsEdge(a1, b1));
+    BOOST_CHECK(g.IsEdge(a2, b1));
+
+    g.RemoveEdge(a2, b1);
+    BOOST_CHECK(!g.IsEdge(a2, b1));
+    BOOST_CHECK(g.VertexExists(b1));
+
+    g.Clear();
+    BOOST_CHECK_EQUAL(g.NumVertices(), 0u);
+    BOOST_CHECK(!g.IsEdge(a1, b1));
+}
+
+BOOST_AUTO_TEST_CASE(BitsetDigraph_Reachable)
+{
+    HexPoint a1 = HEX_CELL_A1;
+    HexPoint b1 = HEX_CELL_B1;
+    HexPoint c1 = HEX_CELL_C1;
+    HexPoint a2 = HEX_CELL_A2;
+    BitsetDigraph g;
+
+    //   a1 -> b1 -> c1 -> b1,  a2 -> a1
+    g.AddEdge(a1, b1);
+    g.AddEdge(b1, c1);
+    g.AddEdge(c1, b1);
+    g.AddEdge(a2, a1);
+
+    bitset_t source;
+    source.set(a2);
+    bitset_t reached = g.Reachable(source);
+    BOOST_CHECK_EQUAL(reached.count(), 3u);
+    BOOST_CHECK(!reached.test(a2));
+
+    source.reset();
+    source.set(b1);
+    reached = g.Reachable(source);
+    BOOST_CHECK_EQUAL(reached.count(), 2u);
+    BOOST_CHECK(reached.test(b1));
+    BOOST_CHECK(reached.test(c1));
+}
+
+BOOST_AUTO_TEST_CASE(BitsetDigraph_StronglyConnectedComponents)
+{
+    HexPoint a1 = HEX_CELL_A1;
+    HexPoint b1 = HEX_CELL_B1;
+    HexPoint c1 = HEX_CELL_C1;
+    HexPoint a2 = HEX_CELL_A2;
+    HexPoint b2 = HEX_CELL_B2;
+    BitsetDigraph g;
+
+    //   a1 -> b1 -> c1 -> a1,  a2 -> b1,  a2 <-> b2
+    g.AddEdge(a1, b1);
+    g.AddEdge(b1, c1);
+    g.AddEdge(c1, a1);
+    g.AddEdge(a2, b1);
+    g.AddEdge(a2, b2);
+    g.AddEdge(b2, a2);
+
+    std::vector<bitset_t> comp;
+    g.FindStronglyConnectedComponents(comp);
+    BOOST_CHECK_EQUAL(comp.size(), 2u);
+    bitset_t cycle;
+    cycle.set(a1);
+    cycle.set(b1);
+    cycle.set(c1);
+    bitset_t pair;
+    pair.set(a2);
+    pair.set(b2);
+    BOOST_CHECK((comp[0] == cycle && comp[1] == pair)
+                || (comp[0] == pair && comp[1] == cycle));
+
+    // single vertices are their own components
+    g.RemoveEdge(c1, a1);
+    g.FindStronglyConnectedComponents(comp);
+    BOOST_CHECK_EQUAL(comp.size(), 4u);
+}
+
+} // namespace
+
+//---------------------------------------------------------------------------
@@ -152,6 +152,46 @@ BOOST_AUTO_TEST_CASE(InferiorCells_Dominated)
     
 }
 
+BOOST_AUTO_TEST_CASE(InferiorCells_KillersAndReversers)
+{
+    HexPoint a1 = HEX_CELL_A1;
+    HexPoint b1 = HEX_CELL_B1;
+    HexPoint c1 = HEX_CELL_C1;
+    HexPoint a2 = HEX_CELL_A2;
+    HexPoint b2 = HEX_CELL_B2;
+    HexPoint c2 = HEX_CELL_C2;
+    InferiorCells inf;
+
+    // only the first carrier is kept for each killer
+    bitset_t carrier;
+    carrier.set(c2);
+    inf.AddVulnerable(a1, c1);
+    inf.AddVulnerable(a1, VulnerableKiller(b1, carrier));
+    inf.AddVulnerable(a1, VulnerableKiller(b1));
+    std::vector<VulnerableKiller> killers = inf.Killers(a1);
+    BOOST_REQUIRE_EQUAL(killers.size(), 2u);
+    BOOST_CHECK_EQUAL(killers[0].killer(), b1);
+    BOOST_CHECK(killers[0].carrier() == carrier);
+    BOOST_CHECK_EQUAL(killers[1].killer(), c1);
+
+    inf.AddReversible(a2, EMPTY_BITSET, b2);
+    BOOST_CHECK(inf.Reversible().test(a2));
+    BOOST_CHECK_EQUAL(inf.Reversers(a2).count(), 1u);
+    BOOST_CHECK(inf.Reversers(a2).test(b2));
+
+    // copies are independent
+    InferiorCells other(inf);
+    other.RemoveVulnerable(inf.Vulnerable());
+    other.RemoveReversible(a2);
+    BOOST_CHECK(other.Killers(a1).empty());
+    BOOST_CHECK(other.Reversers(a2).none());
+    BOOST_CHECK_EQUAL(inf.Killers(a1).size(), 2u);
+    BOOST_CHECK(inf.Reversers(a2).test(b2));
+
+    inf.ClearVulnerable();
+    BOOST_CHECK(inf.Killers(a1).empty());
+}
+
 }
 
 //---------------------------------------------------------------------------
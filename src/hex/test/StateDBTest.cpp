@@ -3,6 +3,8 @@
 //---------------------------------------------------------------------------
 #include <boost/test/auto_unit_test.hpp>
 
+#include <cstdio>
+#include <sstream>
 #include "SgSystem.h"
 #include "StateDB.hpp"
 
@@ -12,6 +14,117 @@ using namespace benzene;
 
 namespace {
 
+const char* TEST_FILE = "statedb-unittest.lsdb";
+
+const std::string TEST_TYPE = "BENZENE_STATEDB_UNITTEST";
+
+void RemoveFiles()
+{
+    std::remove(TEST_FILE);
+    std::remove((std::string(TEST_FILE) + ".idx").c_str());
+}
+
+/** While closed, the writer blocks in TestData::Pack(). */
+struct WriterGate
+{
+    boost::mutex m_mutex;
+
+    boost::condition m_cond;
+
+    bool m_closed;
+
+    bool m_writerWaiting;
+
+    WriterGate()
+        : m_closed(false),
+          m_writerWaiting(false)
+    { }
+};
+
+WriterGate g_gate;
+
+void CloseGate()
+{
+    boost::mutex::scoped_lock lock(g_gate.m_mutex);
+    g_gate.m_closed = true;
+}
+
+void OpenGate()
+{
+    boost::mutex::scoped_lock lock(g_gate.m_mutex);
+    g_gate.m_closed = false;
+    g_gate.m_cond.notify_all();
+}
+
+/** Waits until the writer is blocked at the closed gate. */
+void WaitForBlockedWriter()
+{
+    boost::mutex::scoped_lock lock(g_gate.m_mutex);
+    while (!g_gate.m_writerWaiting)
+        g_gate.m_cond.wait(lock);
+}
+
+/** Packs to an int; negative values cannot be written. */
+struct TestData
+{
+    int m_value;
+
+    TestData()
+        : m_value(0)
+    { }
+
+    explicit TestData(int value)
+        : m_value(value)
+    { }
+
+    int PackedSize() const
+    {
+        return sizeof(m_value);
+    }
+
+    byte* Pack() const
+    {
+        if (m_value < 0)
+            throw BenzeneException("TestData: cannot pack!");
+        boost::mutex::scoped_lock lock(g_gate.m_mutex);
+        while (g_gate.m_closed)
+        {
+            g_gate.m_writerWaiting = true;
+            g_gate.m_cond.notify_all();
+            g_gate.m_cond.wait(lock);
+        }
+        g_gate.m_writerWaiting = false;
+        static int data;
+        data = m_value;
+        return reinterpret_cast<byte*>(&data);
+    }
+
+    void Unpack(const byte* data, int size)
+    {
+        if (size != PackedSize())
+            throw BenzeneException("TestData: bad size!");
+        std::memcpy(&m_value, data, sizeof(m_value));
+    }
+
+    void Rotate(const ConstBoard& brd)
+    {
+        UNUSED(brd);
+    }
+};
+
+HexState MakeState(const char* stones)
+{
+    return HexState(StoneBoard(3, 3, stones), WHITE);
+}
+
+/** Value of state in the database written on disk; -1 if none. */
+int StoredValue(const HexState& state)
+{
+    StateDB<TestData> db(TEST_FILE, TEST_TYPE);
+    TestData data;
+    return db.Get(state, data) ? data.m_value : -1;
+}
+
 BOOST_AUTO_TEST_CASE(StateDB_StateSet)
 {
     StoneBoard b1(3, 3, "Bbw"
@@ -75,6 +188,94 @@ BOOST_AUTO_TEST_CASE(StateDB_StateMap)
     BOOST_CHECK_EQUAL(map[srb2], 1);
 }
 
+BOOST_AUTO_TEST_CASE(StateDB_WriteBehindCoalescesPuts)
+{
+    RemoveFiles();
+    const HexState s1 = MakeState("B........");
+    const HexState s2 = MakeState(".B.......");
+    {
+        StateDB<TestData> db(TEST_FILE, TEST_TYPE, 16);
+        CloseGate();
+        BOOST_CHECK(db.Put(s1, TestData(1)));
+        WaitForBlockedWriter();
+        // s1 is being written; these puts stay queued
+        BOOST_CHECK(db.Put(s2, TestData(2)));
+        BOOST_CHECK(db.Put(s2, TestData(3)));
+        BOOST_CHECK(db.Put(s2, TestData(4)));
+        TestData data;
+        BOOST_CHECK(db.Get(s1, data));
+        BOOST_CHECK_EQUAL(data.m_value, 1);
+        BOOST_CHECK(db.Get(s2, data));
+        BOOST_CHECK_EQUAL(data.m_value, 4);
+        BOOST_CHECK(db.Exists(s2));
+        OpenGate();
+        db.Flush();
+        StateDB<TestData>::Statistics stats = db.GetStatistics();
+        BOOST_CHECK_EQUAL(stats.m_puts, 4u);
+        BOOST_CHECK_EQUAL(stats.m_coalesced, 2u);
+        BOOST_CHECK_EQUAL(stats.m_writes, 2u);
+        BOOST_CHECK_EQUAL(stats.m_batches, 2u);
+    }
+    BOOST_CHECK_EQUAL(StoredValue(s1), 1);
+    BOOST_CHECK_EQUAL(StoredValue(s2), 4);
+    RemoveFiles();
+}
+
+BOOST_AUTO_TEST_CASE(StateDB_WriteBehindDrainsInDestructor)
+{
+    RemoveFiles();
+    const HexState s1 = MakeState("B........");
+    const HexState s2 = MakeState("..W......");
+    {
+        StateDB<TestData> db(TEST_FILE, TEST_TYPE, 1);
+        BOOST_CHECK(db.Put(s1, TestData(5)));
+        BOOST_CHECK(db.Put(s2, TestData(6)));
+    }
+    BOOST_CHECK_EQUAL(StoredValue(s1), 5);
+    BOOST_CHECK_EQUAL(StoredValue(s2), 6);
+    RemoveFiles();
 }
 
+BOOST_AUTO_TEST_CASE(StateDB_WriteBehindReportsError)
+{
+    RemoveFiles();
+    const HexState s1 = MakeState("B........");
+    const HexState s2 = MakeState(".B.......");
+    {
+        StateDB<TestData> db(TEST_FILE, TEST_TYPE, 16);
+        BOOST_CHECK(db.Put(s1, TestData(-1)));
+        BOOST_CHECK_THROW(db.Flush(), BenzeneException);
+        // Flush() reported the error; writing goes on
+        BOOST_CHECK(db.Put(s2, TestData(7)));
+        db.Flush();
+        BOOST_CHECK(db.Put(s1, TestData(-1)));
+        while (db.GetStatistics().m_batches < 3)
+            boost::thread::yield();
+        // Puts fail until Flush() reports the error
+        BOOST_CHECK(!db.Put(s2, TestData(8)));
+        BOOST_CHECK_THROW(db.Flush(), BenzeneException);
+    }
+    BOOST_CHECK_EQUAL(StoredValue(s1), -1);
+    BOOST_CHECK_EQUAL(StoredValue(s2), 7);
+    RemoveFiles();
+}
+
+BOOST_AUTO_TEST_CASE(StateDB_WriteBehindLogsUnreportedError)
+{
+    // Not deleted: the global logger writes to it until exit
+    std::ostringstream* os = new std::ostringstream;
+    Logger::Global().AddStream(*os, LOG_LEVEL_SEVERE);
+    RemoveFiles();
+    {
+        StateDB<TestData> db(TEST_FILE, TEST_TYPE, 16);
+        BOOST_CHECK(db.Put(MakeState("B........"), TestData(-1)));
+    }
+    Logger::Global().Flush();
+    BOOST_CHECK(os->str().find("states were not written")
+                != std::string::npos);
+    RemoveFiles();
+}
+
+} // namespace
+
 //---------------------------------------------------------------------------
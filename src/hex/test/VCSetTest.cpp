@@ -33,6 +33,66 @@ BOOST_AUTO_TEST_CASE(VCSet_CheckCopy)
     BOOST_CHECK(con1 != con2);
 }
 
+BOOST_AUTO_TEST_CASE(VCSet_Adjacent)
+{
+    StoneBoard bd(11, 11);
+    VCSet con1(bd.Const(), BLACK);
+    BOOST_CHECK(con1.Adjacent(VC::FULL, NORTH).none());
+    con1.Add(VC(NORTH, HEX_CELL_A1), 0);
+    BOOST_CHECK(con1.Adjacent(VC::FULL, NORTH).test(HEX_CELL_A1));
+    BOOST_CHECK(con1.Adjacent(VC::FULL, HEX_CELL_A1).test(NORTH));
+    BOOST_CHECK(con1.Adjacent(VC::SEMI, NORTH).none());
+    
+    VCSet con2(con1);
+    BOOST_CHECK(con2.Adjacent(VC::FULL, NORTH).test(HEX_CELL_A1));
+
+    ChangeLog<VC> cl;
+    cl.Push(ChangeLog<VC>::MARKER, VC());
+    con1.Add(VC(SOUTH, HEX_CELL_C1), &cl);
+    BOOST_CHECK(con1.Adjacent(VC::FULL, SOUTH).test(HEX_CELL_C1));
+    BOOST_CHECK(!con2.Adjacent(VC::FULL, SOUTH).test(HEX_CELL_C1));
+    con1.Revert(cl);
+    BOOST_CHECK(con1.Adjacent(VC::FULL, SOUTH).none());
+
+    con1.Clear();
+    BOOST_CHECK(con1.Adjacent(VC::FULL, NORTH).none());
+    BOOST_CHECK(con2.Adjacent(VC::FULL, NORTH).test(HEX_CELL_A1));
+}
+
+BOOST_AUTO_TEST_CASE(VCSet_SharedLists)
+{
+    StoneBoard bd(11, 11);
+    VCSet con1(bd.Const(), BLACK);
+    con1.Add(VC(NORTH, HEX_CELL_A1), 0);
+    VCSet con2(con1);
+    const VCSet& c1 = con1;
+    const VCSet& c2 = con2;
+    // Copies share lists until one of them changes
+    BOOST_CHECK(&c1.GetList(VC::FULL, NORTH, HEX_CELL_B1)
+                == &c2.GetList(VC::FULL, NORTH, HEX_CELL_B1));
+    con2.Add(VC(NORTH, HEX_CELL_B1), 0);
+    BOOST_CHECK(&c1.GetList(VC::FULL, NORTH, HEX_CELL_B1)
+                != &c2.GetList(VC::FULL, NORTH, HEX_CELL_B1));
+    BOOST_CHECK(con2.Exists(NORTH, HEX_CELL_B1, VC::FULL));
+    BOOST_CHECK(!con1.Exists(NORTH, HEX_CELL_B1, VC::FULL));
+    BOOST_CHECK(!con1.Adjacent(VC::FULL, NORTH).test(HEX_CELL_B1));
+    BOOST_CHECK(con2.Adjacent(VC::FULL, NORTH).test(HEX_CELL_B1));
+
+    // A list left to one set updates the adjacency of that set
+    {
+        VCSet con3(con1);
+        con1.Add(VC(NORTH, HEX_CELL_C1), 0);
+        con3.Writable(VC::FULL, NORTH, HEX_CELL_A1)->Clear();
+        BOOST_CHECK(!con3.Adjacent(VC::FULL, NORTH).test(HEX_CELL_A1));
+        BOOST_CHECK(con1.Adjacent(VC::FULL, NORTH).test(HEX_CELL_A1));
+        BOOST_CHECK(con2.Adjacent(VC::FULL, NORTH).test(HEX_CELL_A1));
+    }
+    con2.Clear();
+    BOOST_CHECK(con2.Adjacent(VC::FULL, NORTH).none());
+    BOOST_CHECK(con1.Exists(NORTH, HEX_CELL_A1, VC::FULL));
+    BOOST_CHECK(con1.Exists(NORTH, HEX_CELL_C1, VC::FULL));
+}
+
 BOOST_AUTO_TEST_CASE(VCSet_CheckRevert)
 {
     //   a  b  c  d  e  f  g  h  i  
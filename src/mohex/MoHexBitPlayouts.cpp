@@ -0,0 +1,190 @@
+//----------------------------------------------------------------------------
+/** @file MoHexBitPlayouts.cpp */
+//----------------------------------------------------------------------------
+
+#include "SgSystem.h"
+
+#include "BitsetIterator.hpp"
+#include "MoHexBitPlayouts.hpp"
+
+using namespace benzene;
+
+//----------------------------------------------------------------------------
+
+namespace {
+
+/** Number of random cells tried when looking for a cell to give
+    away in exchange for a repaired bridge. */
+const int REPAIR_TRIES = 4;
+
+int CountLanes(boost::uint64_t lanes)
+{
+    int count = 0;
+    for (; lanes; ++count)
+        lanes &= lanes - 1;
+    return count;
+}
+
+} // namespace
+
+//----------------------------------------------------------------------------
+
+MoHexBitPlayouts::MoHexBitPlayouts()
+{
+}
+
+int MoHexBitPlayouts::Run(const StoneBoard& brd, HexColor toPlay,
+                          int numLanes, bool bridgeRepair)
+{
+    BenzeneAssert(HexColorUtil::isBlackWhite(toPlay));
+    BenzeneAssert(1 <= numLanes && numLanes <= MAX_LANES);
+    const Lanes all = (numLanes == MAX_LANES)
+        ? ~Lanes(0) : (Lanes(1) << numLanes) - 1;
+    m_empty.clear();
+    for (BitsetIterator it(brd.GetEmpty()); it; ++it)
+        m_empty.push_back(*it);
+    Fill(brd, toPlay, all, numLanes);
+    if (bridgeRepair)
+    {
+        FindBridges(brd);
+        RepairBridges(all);
+    }
+    Lanes black = BlackWins(brd, all);
+    return CountLanes(toPlay == BLACK ? black : all & ~black);
+}
+
+/** Sets the stones of all lanes. Each lane gives the player to move
+    the first half of a partial shuffle of the empty cells. */
+void MoHexBitPlayouts::Fill(const StoneBoard& brd, HexColor toPlay,
+                            Lanes all, int numLanes)
+{
+    for (BoardIterator it(brd.Const().EdgesAndInterior()); it; ++it)
+    {
+        const HexColor color = brd.GetColor(*it);
+        m_stones[BLACK][*it] = (color == BLACK) ? all : 0;
+        m_stones[WHITE][*it] = (color == WHITE) ? all : 0;
+    }
+    const int n = static_cast<int>(m_empty.size());
+    const int mine = (n + 1) / 2;
+    Lanes* own = m_stones[toPlay];
+    for (int lane = 0; lane < numLanes; ++lane)
+    {
+        const Lanes bit = Lanes(1) << lane;
+        for (int i = 0; i < mine; ++i)
+        {
+            int j = i + m_random.Int(n - i);
+            std::swap(m_empty[i], m_empty[j]);
+            own[m_empty[i]] |= bit;
+        }
+    }
+    Lanes* other = m_stones[!toPlay];
+    for (int i = 0; i < n; ++i)
+        other[m_empty[i]] = all & ~own[m_empty[i]];
+}
+
+void MoHexBitPlayouts::FindBridges(const StoneBoard& brd)
+{
+    const ConstBoard& cbrd = brd.Const();
+    m_bridges.clear();
+    for (std::size_t i = 0; i < m_empty.size(); ++i)
+    {
+        const HexPoint a = m_empty[i];
+        for (BoardIterator b(cbrd.Nbs(a)); b; ++b)
+        {
+            if (*b <= a || !brd.IsEmpty(*b))
+                continue;
+            HexColor common[2];
+            int numCommon = 0;
+            for (BoardIterator c(cbrd.Nbs(a)); c; ++c)
+            {
+                if (*c == *b || !cbrd.Adjacent(*c, *b))
+                    continue;
+                if (numCommon < 2)
+                    common[numCommon] = brd.GetColor(*c);
+                ++numCommon;
+            }
+            if (numCommon == 2 && common[0] != EMPTY
+                && common[0] == common[1])
+            {
+                Bridge bridge;
+                bridge.m_a = a;
+                bridge.m_b = *b;
+                bridge.m_color = common[0];
+                m_bridges.push_back(bridge);
+            }
+        }
+    }
+}
+
+/** Gives one carrier cell back to the owner of each intruded bridge.
+    The owner gives up a random cell it holds in that lane; lanes
+    where no such cell is found in a few tries are left alone. */
+void MoHexBitPlayouts::RepairBridges(Lanes all)
+{
+    if (m_empty.size() < 3)
+        return;
+    const int n = static_cast<int>(m_empty.size());
+    for (std::size_t i = 0; i < m_bridges.size(); ++i)
+    {
+        const Bridge& bridge = m_bridges[i];
+        Lanes* own = m_stones[bridge.m_color];
+        Lanes* other = m_stones[!bridge.m_color];
+        Lanes broken = other[bridge.m_a] & other[bridge.m_b] & all;
+        for (int t = 0; broken && t < REPAIR_TRIES; ++t)
+        {
+            const HexPoint p = m_empty[m_random.Int(n)];
+            if (p == bridge.m_a || p == bridge.m_b)
+                continue;
+            const Lanes swap = broken & own[p];
+            own[p] &= ~swap;
+            other[p] |= swap;
+            own[bridge.m_b] |= swap;
+            other[bridge.m_b] &= ~swap;
+            broken &= ~swap;
+        }
+    }
+}
+
+/** Returns the lanes in which black connects north to south. The
+    board is full in every lane, so white wins the others. Reach
+    is spread from north with alternating forward and backward sweeps
+    until it stops changing. */
+MoHexBitPlayouts::Lanes MoHexBitPlayouts::BlackWins(const StoneBoard& brd,
+                                                    Lanes all)
+{
+    const ConstBoard& cbrd = brd.Const();
+    const Lanes* black = m_stones[BLACK];
+    for (BoardIterator it(cbrd.EdgesAndInterior()); it; ++it)
+        m_reach[*it] = 0;
+    m_reach[NORTH] = all;
+    m_cells.clear();
+    for (BoardIterator it(cbrd.Interior()); it; ++it)
+        m_cells.push_back(*it);
+    bool changed = true;
+    for (bool forward = true; changed; forward = !forward)
+    {
+        changed = false;
+        for (std::size_t i = 0; i < m_cells.size(); ++i)
+        {
+            const HexPoint p = forward ? m_cells[i]
+                                       : m_cells[m_cells.size() - 1 - i];
+            if (!black[p] || m_reach[p] == black[p])
+                continue;
+            Lanes r = 0;
+            for (BoardIterator nb(cbrd.Nbs(p)); nb; ++nb)
+                r |= m_reach[*nb];
+            r &= black[p];
+            if (r != m_reach[p])
+            {
+                m_reach[p] = r;
+                changed = true;
+            }
+        }
+    }
+    Lanes south = 0;
+    for (BoardIterator nb(cbrd.Nbs(SOUTH)); nb; ++nb)
+        south |= m_reach[*nb];
+    return south;
+}
+
+//----------------------------------------------------------------------------
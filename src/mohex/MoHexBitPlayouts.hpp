@@ -0,0 +1,98 @@
+//----------------------------------------------------------------------------
+/** @file MoHexBitPlayouts.hpp */
+//----------------------------------------------------------------------------
+
+#ifndef MOHEXBITPLAYOUTS_HPP
+#define MOHEXBITPLAYOUTS_HPP
+
+#include "SgSystem.h"
+#include "SgRandom.h"
+
+#include <vector>
+#include <boost/cstdint.hpp>
+
+#include "StoneBoard.hpp"
+
+_BEGIN_BENZENE_NAMESPACE_
+
+//----------------------------------------------------------------------------
+
+/** Runs up to 64 random playouts from one position at the same time.
+
+    The playouts are bit-sliced: each cell has one 64-bit word per
+    color and bit i of the word is set if the cell has that color in
+    playout i (a lane). A uniformly random playout to the end of the
+    game gives the player to move a uniformly random subset of half
+    the empty cells (rounded up), so each lane is filled in at once
+    instead of move by move. The winner of all lanes is then found
+    with a single bit-parallel flood fill from one of black's edges.
+
+    The pattern heuristic of MoHexPlayoutPolicy cannot be run per
+    lane. The only part that is approximated is its most important
+    rule, answering an intrusion into a bridge: for each bridge on the
+    starting position, lanes where the opponent got both carrier cells
+    give one of them back to the owner of the bridge, in exchange for
+    another cell of the owner, so the number of stones is unchanged.
+
+    Playout moves are not recorded, so RAVE gets no updates from the
+    playout phase when this is used. */
+class MoHexBitPlayouts
+{
+public:
+    /** Maximum number of lanes. */
+    static const int MAX_LANES = 64;
+
+    MoHexBitPlayouts();
+
+    /** Plays numLanes playouts from brd with toPlay to move and
+        returns the number won by toPlay.
+        @param brd Starting position; need not have empty cells.
+        @param toPlay Color to move.
+        @param numLanes Number of playouts, in [1, MAX_LANES].
+        @param bridgeRepair Whether to apply the bridge rule. */
+    int Run(const StoneBoard& brd, HexColor toPlay, int numLanes,
+            bool bridgeRepair);
+
+private:
+    typedef boost::uint64_t Lanes;
+
+    /** Two adjacent empty cells whose common neighbours both have
+        color m_color. */
+    struct Bridge
+    {
+        HexPoint m_a;
+
+        HexPoint m_b;
+
+        HexColor m_color;
+    };
+
+    SgRandom m_random;
+
+    /** Empty cells of the starting position. */
+    std::vector<HexPoint> m_empty;
+
+    std::vector<Bridge> m_bridges;
+
+    /** Interior cells, in board order. */
+    std::vector<HexPoint> m_cells;
+
+    Lanes m_stones[BLACK_AND_WHITE][BITSETSIZE];
+
+    Lanes m_reach[BITSETSIZE];
+
+    void Fill(const StoneBoard& brd, HexColor toPlay, Lanes all,
+              int numLanes);
+
+    void FindBridges(const StoneBoard& brd);
+
+    void RepairBridges(Lanes all);
+
+    Lanes BlackWins(const StoneBoard& brd, Lanes all);
+};
+
+//----------------------------------------------------------------------------
+
+_END_BENZENE_NAMESPACE_
+
+#endif // MOHEXBITPLAYOUTS_HPP
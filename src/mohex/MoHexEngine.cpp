@@ -5,6 +5,8 @@
 #include "SgSystem.h"
 
 #include "BitsetIterator.hpp"
+#include "MemoryBudget.hpp"
+#include "MoHexBitPlayouts.hpp"
 #include "MoHexEngine.hpp"
 #include "MoHexPlayer.hpp"
 #include "PlayAndSolve.hpp"
@@ -100,10 +102,28 @@ MoHexEngine::MoHexEngine(int boardsize, MoHexPlayer& player)
     RegisterCmd("mohex-rave-values", &MoHexEngine::RaveValues);
     RegisterCmd("mohex-bounds", &MoHexEngine::Bounds);
     RegisterCmd("mohex-find-top-moves", &MoHexEngine::FindTopMoves);
+    RegisterCmd("mohex-perf-stats", &MoHexEngine::PerfStats);
+    RegisterCmd("mohex-open-tree-db", &MoHexEngine::OpenTreeDB);
+    RegisterCmd("mohex-close-tree-db", &MoHexEngine::CloseTreeDB);
+    RegisterCmd("mohex-store-tree", &MoHexEngine::StoreTree);
+
+    MemoryBudget& budget = MemoryBudget::Get();
+    m_memoryComponents.push_back(budget.Register
+        ("uct_tree", 8.0,
+         boost::bind(&MoHexEngine::TreeMemory, this),
+         boost::bind(&MoHexEngine::ResizeTree, this, _1)));
+    m_memoryComponents.push_back(budget.Register
+        ("fillin_map", 1.0,
+         boost::bind(&MoHexEngine::FillinMapMemory, this),
+         boost::bind(&MoHexEngine::ResizeFillinMap, this, _1)));
 }
 
 MoHexEngine::~MoHexEngine()
 {
+    m_player.SetTreeDB(0);
+    MemoryBudget& budget = MemoryBudget::Get();
+    for (std::size_t i = 0; i < m_memoryComponents.size(); ++i)
+        budget.Unregister(m_memoryComponents[i]);
 }
 
 //----------------------------------------------------------------------------
@@ -114,6 +134,35 @@ void MoHexEngine::RegisterCmd(const std::string& name,
     Register(name, new GtpCallback<MoHexEngine>(this, method));
 }
 
+/** Nodes are allocated as the trees grow, so this counts the nodes
+    in the tree rather than MaxNodes(). */
+std::size_t MoHexEngine::TreeMemory() const
+{
+    return m_player.Search().Tree().NuNodes() * sizeof(SgUctNode);
+}
+
+/** SgUctSearch keeps two trees of MaxNodes() nodes each. Setting
+    MaxNodes() discards the trees, so it is only set if it changes. */
+void MoHexEngine::ResizeTree(std::size_t bytes)
+{
+    std::size_t maxNodes = std::max(bytes / sizeof(SgUctNode) / 2,
+                                    static_cast<std::size_t>(1));
+    if (maxNodes != m_player.Search().MaxNodes())
+        m_player.Search().SetMaxNodes(maxNodes);
+}
+
+std::size_t MoHexEngine::FillinMapMemory() const
+{
+    return m_player.Search().SharedData().stones.MemoryUsed();
+}
+
+/** Applies to the map created by the next search. */
+void MoHexEngine::ResizeFillinMap(std::size_t bytes)
+{
+    m_player.Search().SetFillinMapBits
+        (MemoryBudget::TableBits(bytes, HashMap<StoneBoard>::SlotSize()));
+}
+
 double MoHexEngine::TimeForMove(HexColor color)
 {
     if (m_player.UseTimeManagement())
@@ -126,13 +175,18 @@ HexPoint MoHexEngine::GenMove(HexColor color, bool useGameClock)
     SG_UNUSED(useGameClock);
     if (SwapCheck::PlaySwap(m_game, color))
         return SWAP_PIECES;
-    HexPoint bookMove = m_bookCheck.BestMove(HexState(m_game.Board(), color));
+    HexPoint bookMove = BookMove(HexState(m_game.Board(), color));
     if (bookMove != INVALID_POINT)
         return bookMove;
     double maxTime = TimeForMove(color);
     return DoSearch(color, maxTime);
 }
 
+HexPoint MoHexEngine::BookMove(const HexState& state)
+{
+    return m_bookCheck.BestMove(state);
+}
+
 HexPoint MoHexEngine::DoSearch(HexColor color, double maxTime)
 {
     HexState state(m_game.Board(), color);
@@ -165,7 +219,11 @@ void MoHexEngine::CmdAnalyzeCommands(HtpCommand& cmd)
         "pspairs/MoHex Values/mohex-values\n"
         "pspairs/MoHex Rave Values/mohex-rave-values\n"
         "pspairs/MoHex Bounds/mohex-bounds\n"
-        "pspairs/MoHex Top Moves/mohex-find-top-moves %c\n";
+        "pspairs/MoHex Top Moves/mohex-find-top-moves %c\n"
+        "string/MoHex Perf Stats/mohex-perf-stats\n"
+        "none/MoHex Open Tree DB/mohex-open-tree-db %r\n"
+        "none/MoHex Close Tree DB/mohex-close-tree-db\n"
+        "none/MoHex Store Tree/mohex-store-tree\n";
 }
 
 void MoHexEngine::MoHexPolicyParam(HtpCommand& cmd)
@@ -209,12 +267,18 @@ void MoHexEngine::MoHexParam(HtpCommand& cmd)
         cmd << '\n'
             << "[bool] backup_ice_info "
             << m_player.BackupIceInfo() << '\n'
+            << "[bool] bit_playout_bridges "
+            << search.BitPlayoutBridges() << '\n'
 #if HAVE_GCC_ATOMIC_BUILTINS
             << "[bool] lock_free " 
             << search.LockFree() << '\n'
 #endif
             << "[bool] keep_games "
             << search.KeepGames() << '\n'
+            << "[bool] log_perf_stats "
+            << m_player.LogPerfStats() << '\n'
+            << "[bool] perf_stats "
+            << search.CollectPerfStats() << '\n'
             << "[bool] perform_pre_search " 
             << m_player.PerformPreSearch() << '\n'
             << "[bool] ponder "
@@ -237,6 +301,8 @@ void MoHexEngine::MoHexParam(HtpCommand& cmd)
             << search.VirtualLoss() << '\n'
             << "[string] bias_term "
             << search.BiasTermConstant() << '\n'
+            << "[string] bit_playouts "
+            << search.BitPlayouts() << '\n'
             << "[string] expand_threshold "
             << search.ExpandThreshold() << '\n'
             << "[string] fillin_map_bits "
@@ -261,6 +327,8 @@ void MoHexEngine::MoHexParam(HtpCommand& cmd)
 #endif
             << "[string] playout_update_radius "
             << search.PlayoutUpdateRadius() << '\n'
+            << "[string] pre_search_threads "
+            << m_player.PreSearchThreads() << '\n'
             << "[string] randomize_rave_frequency "
             << search.RandomizeRaveFrequency() << '\n'
             << "[string] rave_weight_final "
@@ -275,12 +343,18 @@ void MoHexEngine::MoHexParam(HtpCommand& cmd)
         std::string name = cmd.Arg(0);
         if (name == "backup_ice_info")
             m_player.SetBackupIceInfo(cmd.Arg<bool>(1));
+        else if (name == "bit_playout_bridges")
+            search.SetBitPlayoutBridges(cmd.Arg<bool>(1));
 #if HAVE_GCC_ATOMIC_BUILTINS
         else if (name == "lock_free")
             search.SetLockFree(cmd.Arg<bool>(1));
 #endif
         else if (name == "keep_games")
             search.SetKeepGames(cmd.Arg<bool>(1));
+        else if (name == "log_perf_stats")
+            m_player.SetLogPerfStats(cmd.Arg<bool>(1));
+        else if (name == "perf_stats")
+            search.SetCollectPerfStats(cmd.Arg<bool>(1));
         else if (name == "perform_pre_search")
             m_player.SetPerformPreSearch(cmd.Arg<bool>(1));
         else if (name == "ponder")
@@ -295,6 +369,9 @@ void MoHexEngine::MoHexParam(HtpCommand& cmd)
            m_player.SetReuseSubtree(cmd.Arg<bool>(1));
         else if (name == "bias_term")
             search.SetBiasTermConstant(cmd.Arg<float>(1));
+        else if (name == "bit_playouts")
+            search.SetBitPlayouts
+                (cmd.ArgMinMax<int>(1, 0, MoHexBitPlayouts::MAX_LANES));
         else if (name == "expand_threshold")
             search.SetExpandThreshold(cmd.ArgMin<int>(1, 0));
         else if (name == "knowledge_threshold")
@@ -319,6 +396,8 @@ void MoHexEngine::MoHexParam(HtpCommand& cmd)
 #endif
         else if (name == "number_playouts_per_visit")
             search.SetNumberPlayouts(cmd.ArgMin<int>(1, 1));
+        else if (name == "pre_search_threads")
+            m_player.SetPreSearchThreads(cmd.ArgMin<std::size_t>(1, 1));
         else if (name == "playout_update_radius")
             search.SetPlayoutUpdateRadius(cmd.ArgMin<int>(1, 0));
         else if (name == "rave_weight_final")
@@ -451,6 +530,76 @@ void MoHexEngine::FindTopMoves(HtpCommand& cmd)
             << '@' << std::fixed << std::setprecision(3) << scores[i];
 }
 
+/** Displays cycles spent in each phase of the simulations of the
+    last search, summed over all threads. The cycles are only counted
+    while perf_stats is on. With the argument "json" the
+    statistics are written as a single line of JSON. */
+void MoHexEngine::PerfStats(HtpCommand& cmd)
+{
+    cmd.CheckNuArgLessEqual(1);
+    MoHexPerfStats stats = m_player.Search().PerfStats();
+    if (cmd.NuArg() == 1)
+    {
+        if (cmd.ArgToLower(0) != "json")
+            throw HtpFailure() << "Unknown format: " << cmd.Arg(0);
+        cmd << stats.WriteJson();
+    }
+    else
+        cmd << '\n' << stats.Write();
+}
+
+/** Opens a database of search trees. While it is open, a search
+    that cannot reuse the last tree starts from the tree stored for
+    its position. A filename ending in ".lsdb" gives a log store.
+    Usage: 
+      mohex-open-tree-db [filename]
+*/
+void MoHexEngine::OpenTreeDB(HtpCommand& cmd)
+{
+    cmd.CheckNuArg(1);
+    std::string filename = cmd.Arg(0);
+    m_player.SetTreeDB(0);
+    try {
+        m_treeDB.reset(new MoHexTreeDB(filename));
+    }
+    catch (BenzeneException& e) {
+        m_treeDB.reset(0);
+        throw HtpFailure() << "Error opening db: '" << e.what() << "'\n";
+    }
+    m_player.SetTreeDB(m_treeDB.get());
+}
+
+/** Closes the database of search trees. */
+void MoHexEngine::CloseTreeDB(HtpCommand& cmd)
+{
+    cmd.CheckNuArg(0);
+    if (m_treeDB.get() == 0)
+        throw HtpFailure("No open database!\n");
+    m_player.SetTreeDB(0);
+    m_treeDB.reset(0);
+}
+
+/** Stores the tree of the previous search in the database of search
+    trees, replacing the tree stored for its position. The optional
+    parameter is the max number of nodes to store; the nodes closest
+    to the root are kept. If not given, the entire tree is stored.
+    Usage: 
+      mohex-store-tree [max nodes]
+*/
+void MoHexEngine::StoreTree(HtpCommand& cmd)
+{
+    cmd.CheckNuArgLessEqual(1);
+    std::size_t maxNodes = m_player.Search().Tree().NuNodes();
+    if (cmd.NuArg() == 1)
+        maxNodes = cmd.ArgMin<std::size_t>(0, 1);
+    try {
+        m_player.StoreTree(maxNodes);
+    }
+    catch (BenzeneException& e) {
+        throw HtpFailure() << e.what();
+    }
+}
+
 //----------------------------------------------------------------------------
 // Pondering
 
@@ -461,16 +610,16 @@ void MoHexEngine::InitPonder()
     SgSetUserAbort(false);
 }
 
+/** Searches the current position while waiting for the next
+    command. The search is stopped by StopPonder() when a command
+    arrives; if that command is a move by the opponent, the next
+    search grafts the matching subtree of the pondering tree as its
+    root. The parallel solver is not used while pondering. */
 void MoHexEngine::Ponder()
 {
     if (!m_player.Ponder())
         return;
-    if (!m_player.ReuseSubtree())
-    {
-        LogWarning() << "Pondering requires reuse_subtree.\n";
-        return;
-    }
-    // Call genmove() after 0.2 seconds delay to avoid calls 
+    // Start searching after 0.2 seconds delay to avoid calls 
     // in very short intervals between received commands
     boost::xtime time;
     boost::xtime_get(&time, boost::TIME_UTC_);
@@ -482,12 +631,9 @@ void MoHexEngine::Ponder()
         boost::thread::sleep(time);
     }
     LogInfo() << "MoHexEngine::Ponder: start\n";
-    // Search for at most 10 minutes
-    // Force it to search even if root has a singleton consider set
-    bool oldSingleton = m_player.SearchSingleton();
-    m_player.SetSearchSingleton(true);
-    DoSearch(m_game.Board().WhoseTurn(), 600);
-    m_player.SetSearchSingleton(oldSingleton);
+    HexState state(m_game.Board(), m_game.Board().WhoseTurn());
+    m_player.PonderSearch(state, m_game, m_pe.SyncBoard(m_game.Board()));
+    LogInfo() << "MoHexEngine::Ponder: stopped\n";
 }
 
 void MoHexEngine::StopPonder()
@@ -36,6 +36,10 @@ public:
     void RaveValues(HtpCommand& cmd);
     void Bounds(HtpCommand& cmd);
     void FindTopMoves(HtpCommand& cmd);
+    void PerfStats(HtpCommand& cmd);
+    void OpenTreeDB(HtpCommand& cmd);
+    void CloseTreeDB(HtpCommand& cmd);
+    void StoreTree(HtpCommand& cmd);
 
     // @} // @name
 
@@ -49,6 +53,10 @@ public:
 
     double TimeForMove(HexColor color);
 
+    /** Returns the move from the opening book for state, or
+        INVALID_POINT if no book is open or state is not in it. */
+    HexPoint BookMove(const HexState& state);
+
 private:
 
     MoHexPlayer& m_player;
@@ -59,10 +67,25 @@ private:
 
     BookBuilderCommands<MoHexPlayer> m_bookCommands;
 
+    /** Stored search trees used by m_player; see
+        MoHexPlayer::TreeDB(). */
+    boost::scoped_ptr<MoHexTreeDB> m_treeDB;
+
+    /** Names of the components of this engine in the MemoryBudget. */
+    std::vector<std::string> m_memoryComponents;
+
     HexPoint GenMove(HexColor color, bool useGameClock);
 
     HexPoint DoSearch(HexColor color, double maxTime);
 
+    std::size_t TreeMemory() const;
+
+    void ResizeTree(std::size_t bytes);
+
+    std::size_t FillinMapMemory() const;
+
+    void ResizeFillinMap(std::size_t bytes);
+
     void RegisterCmd(const std::string& name,
                      GtpCallback<MoHexEngine>::Method method);
 };
@@ -0,0 +1,144 @@
+//----------------------------------------------------------------------------
+/** @file MoHexPerfStats.cpp */
+//----------------------------------------------------------------------------
+
+#include <iomanip>
+#include <sstream>
+
+#include "AtomicMemory.hpp"
+#include "MoHexPerfStats.hpp"
+
+using namespace benzene;
+
+//----------------------------------------------------------------------------
+
+namespace {
+
+/** Returns a / b, or 0 if b is 0. */
+double Ratio(boost::uint64_t a, boost::uint64_t b)
+{
+    if (b == 0)
+        return 0.0;
+    return static_cast<double>(a) / static_cast<double>(b);
+}
+
+} // namespace
+
+//----------------------------------------------------------------------------
+
+MoHexPerfStats::MoHexPerfStats()
+{
+    Clear();
+}
+
+void MoHexPerfStats::Clear()
+{
+    for (int i = 0; i < NUM_PHASES; ++i)
+    {
+        m_cycles[i] = 0;
+        m_count[i] = 0;
+    }
+    m_playouts = 0;
+}
+
+void MoHexPerfStats::Merge(const MoHexPerfStats& other)
+{
+    for (int i = 0; i < NUM_PHASES; ++i)
+    {
+        m_cycles[i] += other.m_cycles[i];
+        m_count[i] += other.m_count[i];
+    }
+    m_playouts += other.m_playouts;
+}
+
+const char* MoHexPerfStats::PhaseName(Phase phase)
+{
+    switch (phase)
+    {
+    case IN_TREE:        return "in_tree";
+    case EXECUTE_MOVE:   return "execute_move";
+    case PATTERN_UPDATE: return "pattern_update";
+    case PLAYOUT_MOVE:   return "playout_move";
+    case WINNER_CHECK:   return "winner_check";
+    case KNOWLEDGE:      return "knowledge";
+    default:             return "?";
+    }
+}
+
+std::string MoHexPerfStats::Write() const
+{
+    std::ostringstream os;
+    os << "Playouts " << m_playouts << '\n'
+       << std::left << std::setw(16) << "Phase"
+       << std::right << std::setw(16) << "Cycles"
+       << std::setw(12) << "Calls"
+       << std::setw(12) << "Cyc/Call"
+       << std::setw(14) << "Cyc/Playout" << '\n';
+    os << std::fixed << std::setprecision(1);
+    for (int i = 0; i < NUM_PHASES; ++i)
+    {
+        Phase phase = static_cast<Phase>(i);
+        os << std::left << std::setw(16) << PhaseName(phase)
+           << std::right << std::setw(16) << m_cycles[i]
+           << std::setw(12) << m_count[i]
+           << std::setw(12) << Ratio(m_cycles[i], m_count[i])
+           << std::setw(14) << Ratio(m_cycles[i], m_playouts) << '\n';
+    }
+    return os.str();
+}
+
+std::string MoHexPerfStats::WriteJson() const
+{
+    std::ostringstream os;
+    os << std::fixed << std::setprecision(1);
+    os << "{\"playouts\":" << m_playouts << ",\"phases\":{";
+    for (int i = 0; i < NUM_PHASES; ++i)
+    {
+        Phase phase = static_cast<Phase>(i);
+        if (i > 0)
+            os << ',';
+        os << '"' << PhaseName(phase) << "\":{"
+           << "\"cycles\":" << m_cycles[i]
+           << ",\"calls\":" << m_count[i]
+           << ",\"cycles_per_playout\":" << Ratio(m_cycles[i], m_playouts)
+           << '}';
+    }
+    os << "}}";
+    return os.str();
+}
+
+//----------------------------------------------------------------------------
+
+MoHexPublishedPerfStats::MoHexPublishedPerfStats()
+    : m_sequence(0),
+      m_stats()
+{
+}
+
+void MoHexPublishedPerfStats::Publish(const MoHexPerfStats& stats)
+{
+    ++m_sequence;
+    WriteBarrier();
+    m_stats = stats;
+    WriteBarrier();
+    ++m_sequence;
+}
+
+MoHexPerfStats MoHexPublishedPerfStats::Read() const
+{
+    MoHexPerfStats stats;
+    while (true)
+    {
+        const boost::uint32_t sequence = m_sequence;
+        ReadBarrier();
+        if ((sequence & 1) == 0)
+        {
+            stats = m_stats;
+            ReadBarrier();
+            if (m_sequence == sequence)
+                return stats;
+        }
+    }
+}
+
+//----------------------------------------------------------------------------
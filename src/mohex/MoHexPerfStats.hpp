@@ -0,0 +1,204 @@
+//----------------------------------------------------------------------------
+/** @file MoHexPerfStats.hpp */
+//----------------------------------------------------------------------------
+
+#ifndef MOHEXPERFSTATS_HPP
+#define MOHEXPERFSTATS_HPP
+
+#include <string>
+#include <boost/cstdint.hpp>
+
+#include "Benzene.hpp"
+#include "Misc.hpp"
+
+_BEGIN_BENZENE_NAMESPACE_
+
+//----------------------------------------------------------------------------
+
+/** Cycle counts spent in each phase of a MoHex simulation.
+
+    Each MoHexThreadState owns one instance and is the only writer,
+    so no synchronization is needed when counting. After each game
+    the thread publishes it to a MoHexPublishedPerfStats, which other
+    threads read; MoHexSearch sums these copies when the statistics
+    are requested. Counting is off unless
+    MoHexSearch::CollectPerfStats() is set. */
+class MoHexPerfStats
+{
+public:
+    /** Phases that are timed. */
+    enum Phase
+    {
+        /** From the start of a game until the playout phase.
+            Includes the moves, pattern updates and knowledge
+            computations done in the tree. */
+        IN_TREE,
+
+        /** Playing a stone to the state, excluding patterns. */
+        EXECUTE_MOVE,
+
+        /** Updating the pattern state after a move. */
+        PATTERN_UPDATE,
+
+        /** Generating a move in the playout phase. */
+        PLAYOUT_MOVE,
+
+        /** Detecting the winner of a game. */
+        WINNER_CHECK,
+
+        /** Computing fillin and VCs for a tree node. */
+        KNOWLEDGE,
+
+        NUM_PHASES
+    };
+
+    MoHexPerfStats();
+
+    /** Resets all counters. */
+    void Clear();
+
+    /** Adds cycles spent in phase. */
+    void Add(Phase phase, boost::uint64_t cycles);
+
+    /** Counts a completed playout. */
+    void AddPlayout();
+
+    /** Counts count completed playouts. */
+    void AddPlayouts(boost::uint64_t count);
+
+    /** Adds all counters of other to this. */
+    void Merge(const MoHexPerfStats& other);
+
+    boost::uint64_t Cycles(Phase phase) const;
+
+    boost::uint64_t Count(Phase phase) const;
+
+    boost::uint64_t Playouts() const;
+
+    /** Returns a table with total cycles, calls, cycles per call and
+        cycles per playout for each phase. */
+    std::string Write() const;
+
+    /** Returns the same data as Write() as a single line of JSON. */
+    std::string WriteJson() const;
+
+    /** Returns the name of phase, as used in Write() and
+        WriteJson(). */
+    static const char* PhaseName(Phase phase);
+
+private:
+    boost::uint64_t m_cycles[NUM_PHASES];
+
+    boost::uint64_t m_count[NUM_PHASES];
+
+    boost::uint64_t m_playouts;
+};
+
+inline void MoHexPerfStats::Add(Phase phase, boost::uint64_t cycles)
+{
+    m_cycles[phase] += cycles;
+    ++m_count[phase];
+}
+
+inline void MoHexPerfStats::AddPlayout()
+{
+    ++m_playouts;
+}
+
+inline void MoHexPerfStats::AddPlayouts(boost::uint64_t count)
+{
+    m_playouts += count;
+}
+
+inline boost::uint64_t MoHexPerfStats::Cycles(Phase phase) const
+{
+    return m_cycles[phase];
+}
+
+inline boost::uint64_t MoHexPerfStats::Count(Phase phase) const
+{
+    return m_count[phase];
+}
+
+inline boost::uint64_t MoHexPerfStats::Playouts() const
+{
+    return m_playouts;
+}
+
+//----------------------------------------------------------------------------
+
+/** Copy of a MoHexPerfStats written by one thread and read by others
+    without locks.
+
+    A sequence number is odd while a copy is being written; a reader
+    retries until it copied the stats between two equal, even
+    readings of the sequence number. */
+class MoHexPublishedPerfStats
+{
+public:
+    MoHexPublishedPerfStats();
+
+    /** Replaces the copy with stats. Must only be called by the
+        owning thread. */
+    void Publish(const MoHexPerfStats& stats);
+
+    /** Returns the last published stats. Can be called from any
+        thread. */
+    MoHexPerfStats Read() const;
+
+private:
+    volatile boost::uint32_t m_sequence;
+
+    MoHexPerfStats m_stats;
+
+    /** Not implemented */
+    MoHexPublishedPerfStats(const MoHexPublishedPerfStats& other);
+
+    /** Not implemented */
+    void operator=(const MoHexPublishedPerfStats& other);
+};
+
+//----------------------------------------------------------------------------
+
+/** Adds the cycles between construction and destruction to a phase
+    of a MoHexPerfStats. Does not read the cycle counter if enabled
+    is false. */
+class MoHexPerfTimer
+{
+public:
+    MoHexPerfTimer(MoHexPerfStats& stats, MoHexPerfStats::Phase phase,
+                   bool enabled);
+
+    ~MoHexPerfTimer();
+
+private:
+    MoHexPerfStats& m_stats;
+
+    MoHexPerfStats::Phase m_phase;
+
+    bool m_enabled;
+
+    boost::uint64_t m_start;
+};
+
+inline MoHexPerfTimer::MoHexPerfTimer(MoHexPerfStats& stats,
+                                      MoHexPerfStats::Phase phase,
+                                      bool enabled)
+    : m_stats(stats),
+      m_phase(phase),
+      m_enabled(enabled),
+      m_start(enabled ? MiscUtil::ReadCycleCounter() : 0)
+{
+}
+
+inline MoHexPerfTimer::~MoHexPerfTimer()
+{
+    if (m_enabled)
+        m_stats.Add(m_phase, MiscUtil::ReadCycleCounter() - m_start);
+}
+
+//----------------------------------------------------------------------------
+
+_END_BENZENE_NAMESPACE_
+
+#endif // MOHEXPERFSTATS_HPP
@@ -3,9 +3,11 @@
 //----------------------------------------------------------------------------
 
 #include "SgSystem.h"
+#include "SgTime.h"
 #include "SgTimer.h"
 #include "SgUctTreeUtil.h"
 
+#include "BenzeneException.hpp"
 #include "BitsetIterator.hpp"
 #include "BoardUtil.hpp"
 #include "VCSet.hpp"
@@ -15,8 +17,10 @@
 #include "MoHexPlayoutPolicy.hpp"
 #include "MoHexPlayer.hpp"
 #include "EndgameUtil.hpp"
+#include "MemoryBudget.hpp"
 #include "Resistance.hpp"
 #include "SequenceHash.hpp"
+#include "TaskScheduler.hpp"
 
 using namespace benzene;
 
@@ -24,6 +28,10 @@ using namespace benzene;
 
 namespace {
 
+/** Time limit passed to the search while pondering. The search is
+    expected to be stopped with SgUserAbort() well before this. */
+const double PONDER_MAX_TIME = 24 * 60 * 60;
+
 /** Returns true if one is a prefix of the other. */
 bool IsPrefixOf(const MoveSequence& a, const MoveSequence& b)
 {
@@ -48,14 +56,127 @@ void SortConsiderSet(const bitset_t& consider, const Resistance& resist,
         moves.push_back(mvsc[i].second);
 }                             
 
+//----------------------------------------------------------------------------
+
+/** Outcome of playing a single root move in the pre-search. */
+struct PreSearchResult
+{
+    /** False if the move was skipped due to time or an earlier win. */
+    bool evaluated;
+
+    bool win;
+
+    bool loss;
+
+    /** Dead and captured cells (for the player to move at the root)
+        in the state after the move. Used to back-up ice info into
+        the root. */
+    bitset_t inferior;
+
+    /** Time spent evaluating this move. */
+    double time;
+
+    PreSearchResult()
+        : evaluated(false), win(false), loss(false), time(0.0)
+    { }
+};
+
+/** Copyable worker that evaluates root moves on its own board.
+    Moves are passed as indices into the sorted move list so the
+    results can be put back into resistance order. */
+class PreSearchWorker
+{
+public:
+    PreSearchWorker(HexBoard& brd, HexColor color, 
+                    const std::vector<HexPoint>& moves, double startTime,
+                    double maxTime, volatile bool& foundWin);
+
+    PreSearchResult operator()(const std::size_t& index);
+
+private:
+    HexBoard* m_brd;
+
+    HexColor m_color;
+
+    const std::vector<HexPoint>* m_moves;
+
+    double m_startTime;
+
+    double m_maxTime;
+
+    volatile bool* m_foundWin;
+};
+
+PreSearchWorker::PreSearchWorker(HexBoard& brd, HexColor color,
+                                 const std::vector<HexPoint>& moves,
+                                 double startTime, double maxTime,
+                                 volatile bool& foundWin)
+    : m_brd(&brd),
+      m_color(color),
+      m_moves(&moves),
+      m_startTime(startTime),
+      m_maxTime(maxTime),
+      m_foundWin(&foundWin)
+{
+}
+
+PreSearchResult PreSearchWorker::operator()(const std::size_t& index)
+{
+    PreSearchResult result;
+    if (*m_foundWin || SgUserAbort() 
+        || SgTime::Get() - m_startTime > m_maxTime)
+        return result;
+    SgTimer timer;
+    HexPoint move = (*m_moves)[index];
+    HexColor other = !m_color;
+    m_brd->PlayMove(m_color, move);
+    result.evaluated = true;
+    if (EndgameUtil::IsLostGame(*m_brd, other))
+    {
+        result.win = true;
+        *m_foundWin = true;
+    }
+    else if (EndgameUtil::IsWonGame(*m_brd, other))
+        result.loss = true;
+    const InferiorCells& inf = m_brd->GetInferiorCells();
+    result.inferior = inf.Dead() | inf.Captured(m_color);
+    m_brd->UndoMove();
+    result.time = timer.GetTime();
+    return result;
+}
+
+//----------------------------------------------------------------------------
+
 }
 
 //----------------------------------------------------------------------------
 
 MoHexPlayer::MoHexPlayer()
     : BenzenePlayer(),
-      m_shared_policy(),
-      m_search(new HexThreadStateFactory(&m_shared_policy), 
+      m_own_policy(new MoHexSharedPolicy()),
+      m_shared_policy(m_own_policy.get()),
+      m_search(new HexThreadStateFactory(m_shared_policy), 
+               MoHexUtil::ComputeMaxNumMoves()),
+      m_backup_ice_info(true),
+      m_max_games(99999999),
+      m_max_time(10),
+      m_useTimeManagement(false),
+      m_reuse_subtree(false),
+      m_ponder(false),
+      m_performPreSearch(true),
+      m_preSearchThreads(1),
+      m_logPerfStats(false),
+      m_treeDB(0),
+      m_pondering(false),
+      m_reusePonderTree(false)
+{
+}
+
+MoHexPlayer::MoHexPlayer(MoHexSharedPolicy& sharedPolicy)
+    : BenzenePlayer(),
+      m_own_policy(0),
+      m_shared_policy(&sharedPolicy),
+      m_search(new HexThreadStateFactory(m_shared_policy), 
                MoHexUtil::ComputeMaxNumMoves()),
       m_backup_ice_info(true),
       m_max_games(99999999),
@@ -63,7 +184,12 @@ MoHexPlayer::MoHexPlayer()
       m_useTimeManagement(false),
       m_reuse_subtree(false),
       m_ponder(false),
-      m_performPreSearch(true)
+      m_performPreSearch(true),
+      m_preSearchThreads(1),
+      m_logPerfStats(false),
+      m_treeDB(0),
+      m_pondering(false),
+      m_reusePonderTree(false)
 {
 }
 
@@ -71,7 +197,8 @@ MoHexPlayer::~MoHexPlayer()
 {
 }
 
-void MoHexPlayer::CopySettingsFrom(const MoHexPlayer& other)
+void MoHexPlayer::CopySettingsFrom(const MoHexPlayer& other,
+                                   std::size_t numCopies)
 {
     SetBackupIceInfo(other.BackupIceInfo());
     Search().SetLockFree(other.Search().LockFree());
@@ -83,10 +210,19 @@ void MoHexPlayer::CopySettingsFrom(const MoHexPlayer& other)
     SetMaxGames(other.MaxGames());
     SetMaxTime(other.MaxTime());
     SetPerformPreSearch(other.PerformPreSearch());
+    SetPreSearchThreads(other.PreSearchThreads());
+    SetLogPerfStats(other.LogPerfStats());
+    Search().SetCollectPerfStats(other.Search().CollectPerfStats());
     SetUseTimeManagement(other.UseTimeManagement());
-    Search().SetMaxNodes(other.Search().MaxNodes());
+    std::size_t maxNodes = other.Search().MaxNodes();
+    if (MemoryBudget::Get().Total() > 0 && numCopies > 1)
+        maxNodes = std::max(maxNodes / numCopies,
+                            static_cast<std::size_t>(1));
+    Search().SetMaxNodes(maxNodes);
     Search().SetNumberThreads(other.Search().NumberThreads());
     Search().SetPlayoutUpdateRadius(other.Search().PlayoutUpdateRadius());
+    Search().SetBitPlayouts(other.Search().BitPlayouts());
+    Search().SetBitPlayoutBridges(other.Search().BitPlayoutBridges());
     Search().SetRandomizeRaveFrequency
         (other.Search().RandomizeRaveFrequency());
     Search().SetRaveWeightFinal(other.Search().RaveWeightFinal());
@@ -109,12 +245,14 @@ HexPoint MoHexPlayer::Search(const HexState& state, const Game& game,
     PrintParameters(color, maxTime);
 
     // Do presearch and abort if win found. Allow it to take 20% of
-    // total time.
+    // total time. Skip it while pondering: its results are only
+    // useful for the player to move.
     SgTimer timer;
     bitset_t consider = given_to_consider;
     PointSequence winningSequence;
-    if (m_performPreSearch && PerformPreSearch(brd, color, consider, 
-                                               maxTime * 0.2, winningSequence))
+    if (m_performPreSearch && !m_pondering
+        && PerformPreSearch(brd, color, consider, maxTime * 0.2, 
+                            winningSequence))
     {
 	LogInfo() << "Winning sequence found before UCT search!\n"
 		  << "Sequence: " << winningSequence[0] << '\n';
@@ -133,15 +271,19 @@ HexPoint MoHexPlayer::Search(const HexState& state, const Game& game,
     data.rootState = HexState(brd.GetPosition(), color);
     data.rootConsider = consider;
     
-    // Reuse the old subtree
+    // Reuse the old subtree. A tree left behind by pondering is
+    // always reused since that is the point of pondering.
     SgUctTree* initTree = 0;
-    if (m_reuse_subtree)
+    if (m_reuse_subtree || m_reusePonderTree)
     {
         MoHexSharedData oldData(m_search.SharedData());
         initTree = TryReuseSubtree(oldData, data);
         if (!initTree)
             LogInfo() << "No subtree to reuse.\n";
     }
+    if (!initTree && m_treeDB)
+        initTree = TryLoadTree(data);
+    m_reusePonderTree = false;
     m_search.SetSharedData(data);
 
     brd.GetPatternState().ClearPatternCheckStats();
@@ -156,6 +298,8 @@ HexPoint MoHexPlayer::Search(const HexState& state, const Game& game,
                             rootFilter, initTree, 0);
 
     brd.GetPatternState().SetUpdateRadius(old_radius);
+    if (m_pondering)
+        m_reusePonderTree = true;
 
     // Output stats
     std::ostringstream os;
@@ -177,6 +321,8 @@ HexPoint MoHexPlayer::Search(const HexState& state, const Game& game,
         os << " " << MoHexUtil::MoveString(sequence[i]);
     os << '\n';
     LogInfo() << os.str() << '\n';
+    if (m_logPerfStats && m_search.CollectPerfStats())
+        LogInfo() << "PerfStats " << m_search.PerfStats().WriteJson() << '\n';
 
 #if 0
     if (m_save_games) 
@@ -207,6 +353,12 @@ HexPoint MoHexPlayer::Search(const HexState& state, const Game& game,
     consider set if there are non-losing moves in the consider set.
     If all moves are losing, perform no pruning, search will resist.
 
+    If PreSearchThreads() is larger than one, the moves are evaluated
+    in parallel on copies of the board; workers stop taking new moves
+    once a win is found or time runs out. Ice info backed-up from the
+    children is then merged into brd in the same order the sequential
+    search would have produced it.
+
     Returns true if there is a win, false otherwise. 
 
     @todo Is it true that MoHex will resist in the strongest way
@@ -216,37 +368,90 @@ bool MoHexPlayer::PerformPreSearch(HexBoard& brd, HexColor color,
                                    bitset_t& consider, double maxTime, 
                                    PointSequence& winningSequence)
 {
-   
     bitset_t losing;
-    HexColor other = !color;
-    PointSequence seq;
     bool foundWin = false;
+    volatile bool foundWinFlag = false;
 
     SgTimer elapsed;
     Resistance resist;
     resist.Evaluate(brd);
     std::vector<HexPoint> moves;
     SortConsiderSet(consider, resist, moves);
-    for (std::size_t i = 0; i < moves.size() && !foundWin; ++i) 
+    std::vector<PreSearchResult> results(moves.size());
+    std::size_t numThreads 
+        = std::max(static_cast<std::size_t>(1), 
+                   std::min(m_preSearchThreads, moves.size()));
+    double startTime = SgTime::Get();
+    if (numThreads == 1)
     {
-        if (elapsed.GetTime() > maxTime)
+        PreSearchWorker worker(brd, color, moves, startTime, maxTime, 
+                               foundWinFlag);
+        for (std::size_t i = 0; i < moves.size() && !foundWinFlag; ++i) 
+            results[i] = worker(i);
+    }
+    else
+    {
+        std::vector<HexBoard*> boards;
+        std::vector<PreSearchWorker> workers;
+        for (std::size_t i = 0; i < numThreads; ++i)
+        {
+            boards.push_back(new HexBoard(brd));
+            // Ice info is merged into brd below
+            boards.back()->SetBackupIceInfo(false);
+            workers.push_back(PreSearchWorker(*boards.back(), color, moves,
+                                              startTime, maxTime, 
+                                              foundWinFlag));
+        }
+        std::vector<std::size_t> work;
+        for (std::size_t i = 0; i < moves.size(); ++i)
+            work.push_back(i);
+        std::vector<std::pair<std::size_t, PreSearchResult> > output;
         {
-            LogInfo() << "PreSearch: max time reached "
-                      << '(' << i << '/' << moves.size() << ").\n";
-            break;
+            TaskWorker<std::size_t, PreSearchResult, PreSearchWorker>
+                taskWorker(workers);
+            taskWorker.DoWork(work, output);
         }
-        brd.PlayMove(color, moves[i]);
-        seq.push_back(moves[i]);
-        if (EndgameUtil::IsLostGame(brd, other)) // Check for winning move
+        for (std::size_t i = 0; i < output.size(); ++i)
+            results[output[i].first] = output[i].second;
+        for (std::size_t i = 0; i < boards.size(); ++i)
+            delete boards[i];
+    }
+
+    double sequentialTime = 0.0;
+    std::size_t evaluated = 0;
+    for (std::size_t i = 0; i < moves.size(); ++i)
+    {
+        const PreSearchResult& result = results[i];
+        if (!result.evaluated)
+            continue;
+        ++evaluated;
+        sequentialTime += result.time;
+        if (result.win)
         {
-            winningSequence = seq;
-            foundWin = true;
-        }	
-        else if (EndgameUtil::IsWonGame(brd, other))
+            if (!foundWin)
+            {
+                winningSequence.clear();
+                winningSequence.push_back(moves[i]);
+                foundWin = true;
+            }
+        }
+        else if (result.loss)
             losing.set(moves[i]);
-        seq.pop_back();
-        brd.UndoMove();
+        if (numThreads > 1 && brd.BackupIceInfo())
+        {
+            bitset_t a = brd.GetPosition().GetEmpty() 
+                - brd.GetInferiorCells().All();
+            a &= result.inferior;
+            brd.AddDominated(a, moves[i]);
+        }
     }
+    if (!foundWin && evaluated < moves.size())
+        LogInfo() << "PreSearch: max time reached "
+                  << '(' << evaluated << '/' << moves.size() << ").\n";
+    LogInfo() << "PreSearch: " << evaluated << " moves, " 
+              << numThreads << " threads, " 
+              << elapsed.GetTime() << "s wall, "
+              << sequentialTime << "s single-threaded\n";
 
     // Abort if we found a one-move win
     if (foundWin)
@@ -415,6 +620,68 @@ SgUctTree* MoHexPlayer::TryReuseSubtree(const MoHexSharedData& oldData,
     return 0;
 }
 
+/** Restores the tree stored for the new root in TreeDB(). Returns
+    valid pointer to new tree on success, 0 on failure. The fill-in
+    of the restored nodes is added to data. */
+SgUctTree* MoHexPlayer::TryLoadTree(MoHexSharedData& data)
+{
+    // As when reusing subtrees, the stored tree was built with
+    // knowledge, so knowledge must be on.
+    if (m_search.KnowledgeThreshold().empty())
+    {
+        LogInfo() << "LoadTree: knowledge is off.\n";
+        return 0;
+    }
+    MoHexTreeData treeData;
+    try
+    {
+        if (!m_treeDB->Get(data.rootState, treeData))
+        {
+            LogInfo() << "LoadTree: no stored tree.\n";
+            return 0;
+        }
+    }
+    catch (BenzeneException& e)
+    {
+        LogWarning() << "LoadTree: " << e.what() << '\n';
+        return 0;
+    }
+    if (!treeData.SameBoardSize(data.rootState.Position().Const()))
+    {
+        LogInfo() << "LoadTree: stored tree is for another board size.\n";
+        return 0;
+    }
+    SgUctTree& tree = m_search.GetTempTree();
+    std::size_t numNodes = treeData.Restore(tree, data.rootState,
+                                            data.gameSequence, data.stones);
+    if (numNodes <= 1)
+        return 0;
+
+    // Fix root's children to be those in the consider set
+    std::vector<SgMove> moves;
+    for (BitsetIterator it(data.rootConsider); it; ++it)
+        moves.push_back(static_cast<SgMove>(*it));
+    tree.SetChildren(0, tree.Root(), moves);
+
+    LogInfo() << "MoHexPlayer: Loaded " << numNodes << " of "
+              << treeData.NumNodes() << " stored nodes\n";
+    return &tree;
+}
+
+void MoHexPlayer::StoreTree(std::size_t maxNodes)
+{
+    if (m_treeDB == 0)
+        throw BenzeneException("MoHexPlayer: no tree database");
+    // Only a search gives the root children and sets the root state.
+    if (!m_search.Tree().Root().HasChildren())
+        throw BenzeneException("MoHexPlayer: no search tree");
+    const MoHexSharedData& shared = m_search.SharedData();
+    MoHexTreeData data(m_search.Tree(), shared.rootState, 
+                       shared.gameSequence, shared.stones, maxNodes);
+    m_treeDB->Put(shared.rootState, data);
+    LogInfo() << "MoHexPlayer: Stored " << data.NumNodes() << " nodes\n";
+}
+
 void MoHexPlayer::CopyKnowledgeData(const SgUctTree& tree,
                                     const SgUctNode& node,
                                     HexColor color, MoveSequence& sequence,
@@ -443,6 +710,19 @@ void MoHexPlayer::CopyKnowledgeData(const SgUctTree& tree,
 
 //----------------------------------------------------------------------------
 
+void MoHexPlayer::PonderSearch(const HexState& state, const Game& game,
+                               HexBoard& brd)
+{
+    // Force it to search even if root has a singleton consider set
+    bool oldSingleton = SearchSingleton();
+    SetSearchSingleton(true);
+    m_pondering = true;
+    double score;
+    GenMove(state, game, brd, PONDER_MAX_TIME, score);
+    m_pondering = false;
+    SetSearchSingleton(oldSingleton);
+}
+
 void MoHexPlayer::FindTopMoves(int num, const HexState& state, 
                                const Game& game, HexBoard& brd, 
                                const bitset_t& given_to_consider,
@@ -8,6 +8,9 @@
 #include "BenzenePlayer.hpp"
 #include "MoHexSearch.hpp"
 #include "MoHexPlayoutPolicy.hpp"
+#include "MoHexTreeDB.hpp"
+
+#include <boost/scoped_ptr.hpp>
 
 _BEGIN_BENZENE_NAMESPACE_
 
@@ -19,6 +22,11 @@ class MoHexPlayer : public BenzenePlayer
 public:
     MoHexPlayer();
 
+    /** Creates a player that uses sharedPolicy instead of loading
+        its own patterns. The policy must outlive the player, and its
+        configuration is shared with all other players using it. */
+    explicit MoHexPlayer(MoHexSharedPolicy& sharedPolicy);
+
     virtual ~MoHexPlayer();
 
     /** Returns "mohex". */
@@ -36,8 +44,19 @@ public:
     /** Returns the shared policy. */
     const MoHexSharedPolicy& SharedPolicy() const;
 
-    /** Copy settings from other player. */
-    void CopySettingsFrom(const MoHexPlayer& other);
+    /** Copy settings from other player. If the MemoryBudget has a
+        total, other's tree size is split among the numCopies players
+        copying it. */
+    void CopySettingsFrom(const MoHexPlayer& other,
+                          std::size_t numCopies = 1);
+
+    /** Searches state until SgUserAbort() is set, as if generating
+        a move with no time limit. The pre-search is skipped. The next
+        call to Search() will try to reuse the resulting tree (and its
+        knowledge) even if ReuseSubtree() is false, so that the time
+        spent while the opponent was thinking is not lost. */
+    void PonderSearch(const HexState& state, const Game& game,
+                      HexBoard& brd);
 
     /** Find the top moves in a position.
         Performs multiple calls to Search(), removing the previous
@@ -48,6 +67,11 @@ public:
                       double maxTime, std::vector<HexPoint>& moves,
                       std::vector<double>& scores);
 
+    /** Stores the tree of the last search in TreeDB(), keeping at
+        most maxNodes nodes. Throws if no database is set or there
+        was no search. */
+    void StoreTree(std::size_t maxNodes);
+
     //-----------------------------------------------------------------------
 
     /** @name Parameters */
@@ -94,10 +118,36 @@ public:
     /** See PerformPreSearch() */
     void SetPerformPreSearch(bool flag);
 
+    /** Number of threads used to evaluate root moves in the
+        pre-search. Each thread works on its own copy of the board. */
+    std::size_t PreSearchThreads() const;
+
+    /** See PreSearchThreads() */
+    void SetPreSearchThreads(std::size_t threads);
+
+    /** Logs the per-phase cycle counts of each search as a line of
+        JSON. The counts are only collected if
+        MoHexSearch::CollectPerfStats() is set. See MoHexPerfStats. */
+    bool LogPerfStats() const;
+
+    /** See LogPerfStats() */
+    void SetLogPerfStats(bool flag);
+
+    /** Database of stored search trees. If a search cannot reuse the
+        last tree, it starts from the tree stored for its position, if
+        there is one. 0 if not used. Not owned by the player. */
+    MoHexTreeDB* TreeDB() const;
+
+    /** See TreeDB() */
+    void SetTreeDB(MoHexTreeDB* db);
+
     // @}
 
 protected:
-    MoHexSharedPolicy m_shared_policy;
+    /** Policy owned by this player; 0 if it uses an external one. */
+    boost::scoped_ptr<MoHexSharedPolicy> m_own_policy;
+
+    MoHexSharedPolicy* m_shared_policy;
     
     MoHexSearch m_search;
    
@@ -119,6 +169,22 @@ protected:
     bool m_ponder;
 
     bool m_performPreSearch;
+
+    /** See PreSearchThreads() */
+    std::size_t m_preSearchThreads;
+
+    /** See LogPerfStats() */
+    bool m_logPerfStats;
+
+    /** See TreeDB() */
+    MoHexTreeDB* m_treeDB;
+
+    /** True while inside PonderSearch(). */
+    bool m_pondering;
+
+    /** True if the last search was a ponder search whose tree should
+        be reused by the next search. */
+    bool m_reusePonderTree;
     
     /** Generates a move in the given gamestate using uct. */
     HexPoint Search(const HexState& state, const Game& game,
@@ -133,6 +199,8 @@ protected:
     SgUctTree* TryReuseSubtree(const MoHexSharedData& oldData,
                                MoHexSharedData& newData);
 
+    SgUctTree* TryLoadTree(MoHexSharedData& data);
+
     void CopyKnowledgeData(const SgUctTree& tree, const SgUctNode& node,
                            HexColor color, MoveSequence& sequence,
                            const MoHexSharedData& oldData,
@@ -156,12 +224,12 @@ inline const MoHexSearch& MoHexPlayer::Search() const
 
 inline MoHexSharedPolicy& MoHexPlayer::SharedPolicy()
 {
-    return m_shared_policy;
+    return *m_shared_policy;
 }
 
 inline const MoHexSharedPolicy& MoHexPlayer::SharedPolicy() const
 {
-    return m_shared_policy;
+    return *m_shared_policy;
 }
 
 inline bool MoHexPlayer::BackupIceInfo() const
@@ -234,6 +302,36 @@ inline void MoHexPlayer::SetPerformPreSearch(bool flag)
     m_performPreSearch = flag;
 }
 
+inline std::size_t MoHexPlayer::PreSearchThreads() const
+{
+    return m_preSearchThreads;
+}
+
+inline void MoHexPlayer::SetPreSearchThreads(std::size_t threads)
+{
+    m_preSearchThreads = threads;
+}
+
+inline bool MoHexPlayer::LogPerfStats() const
+{
+    return m_logPerfStats;
+}
+
+inline void MoHexPlayer::SetLogPerfStats(bool flag)
+{
+    m_logPerfStats = flag;
+}
+
+inline MoHexTreeDB* MoHexPlayer::TreeDB() const
+{
+    return m_treeDB;
+}
+
+inline void MoHexPlayer::SetTreeDB(MoHexTreeDB* db)
+{
+    m_treeDB = db;
+}
+
 //----------------------------------------------------------------------------
 
 _END_BENZENE_NAMESPACE_
@@ -54,8 +54,12 @@ MoHexSearch::MoHexSearch(SgUctThreadStateFactory* factory, int maxMoves)
       m_playoutUpdateRadius(1),
       m_brd(0),
       m_fillinMapBits(16),
+      m_bitPlayouts(0),
+      m_bitPlayoutBridges(true),
+      m_collectPerfStats(false),
       m_sharedData(new MoHexSharedData(m_fillinMapBits)),
-      m_root(0)
+      m_root(0),
+      m_searchStarted(false)
 {
     SetBiasTermConstant(0.0);
     SetExpandThreshold(1);
@@ -153,6 +157,7 @@ void MoHexSearch::OnStartSearch()
     SetMaxGameLength(maxGameLength);
     m_lastPositionSearched = m_brd->GetPosition();
     m_nextLiveGfx = 1000;
+    m_searchStarted = true;
 }
 
 void MoHexSearch::SaveGames(const std::string& filename) const
@@ -168,6 +173,20 @@ void MoHexSearch::SaveTree(std::ostream& out, int maxDepth) const
                         m_sharedData->rootState.ToPlay(), out, maxDepth);
 }
 
+MoHexPerfStats MoHexSearch::PerfStats() const
+{
+    MoHexPerfStats stats;
+    if (!m_searchStarted)
+        return stats;
+    for (unsigned int i = 0; i < NumberThreads(); ++i)
+    {
+        const MoHexThreadState& state 
+            = dynamic_cast<const MoHexThreadState&>(ThreadState(i));
+        stats.Merge(state.PerfStats());
+    }
+    return stats;
+}
+
 void MoHexSearch::OnSearchIteration(SgUctValue gameNumber, 
                                     const unsigned int threadId,
                                     const SgUctGameInfo& info)
@@ -100,6 +100,11 @@ public:
     /** @see MoHexUtil::SaveTree() */
     void SaveTree(std::ostream& out, int maxDepth) const;
 
+    /** Returns the sum of the per-phase cycle counts of all threads
+        since the start of the last search. All counts are zero if no
+        search has been started yet or CollectPerfStats() was off. */
+    MoHexPerfStats PerfStats() const;
+
     // @}
 
     //-----------------------------------------------------------------------
@@ -140,6 +145,31 @@ public:
     /** See FillinMapBits(). */
     void SetFillinMapBits(int bits);
 
+    /** Number of bit-sliced playouts run at each leaf.
+        If non-zero, leaves are evaluated by MoHexBitPlayouts with
+        this many lanes instead of by a playout of the policy.
+        Default is 0. */
+    int BitPlayouts() const;
+
+    /** See BitPlayouts(). Must be in [0, MoHexBitPlayouts::MAX_LANES]. */
+    void SetBitPlayouts(int lanes);
+
+    /** Apply the bridge rule in bit-sliced playouts.
+        See MoHexBitPlayouts. */
+    bool BitPlayoutBridges() const;
+
+    /** See BitPlayoutBridges(). */
+    void SetBitPlayoutBridges(bool enable);
+
+    /** Time the phases of each simulation for PerfStats(). Reads the
+        cycle counter several times per playout, so it is off by
+        default. Takes effect at the start of the next search.
+        Default is false. */
+    bool CollectPerfStats() const;
+
+    /** See CollectPerfStats(). */
+    void SetCollectPerfStats(bool enable);
+
     // @} 
 
 private:
@@ -162,6 +192,15 @@ private:
     HexBoard* m_brd;
 
     int m_fillinMapBits;
+
+    /** See BitPlayouts() */
+    int m_bitPlayouts;
+
+    /** See BitPlayoutBridges() */
+    bool m_bitPlayoutBridges;
+
+    /** See CollectPerfStats() */
+    bool m_collectPerfStats;
    
     /** Data among threads. */
     boost::scoped_ptr<MoHexSharedData> m_sharedData;
@@ -174,6 +213,10 @@ private:
 
     SgUctValue m_nextLiveGfx;
 
+    /** True once a search has started; thread states exist from
+        then on. */
+    bool m_searchStarted;
+
     /** Not implemented */
     MoHexSearch(const MoHexSearch& search);
 
@@ -261,6 +304,36 @@ inline void MoHexSearch::SetFillinMapBits(int bits)
     m_fillinMapBits = bits;
 }
 
+inline int MoHexSearch::BitPlayouts() const
+{
+    return m_bitPlayouts;
+}
+
+inline void MoHexSearch::SetBitPlayouts(int lanes)
+{
+    m_bitPlayouts = lanes;
+}
+
+inline bool MoHexSearch::BitPlayoutBridges() const
+{
+    return m_bitPlayoutBridges;
+}
+
+inline void MoHexSearch::SetBitPlayoutBridges(bool enable)
+{
+    m_bitPlayoutBridges = enable;
+}
+
+inline bool MoHexSearch::CollectPerfStats() const
+{
+    return m_collectPerfStats;
+}
+
+inline void MoHexSearch::SetCollectPerfStats(bool enable)
+{
+    m_collectPerfStats = enable;
+}
+
 //----------------------------------------------------------------------------
 
 _END_BENZENE_NAMESPACE_
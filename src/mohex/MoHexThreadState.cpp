@@ -131,7 +131,9 @@ MoHexThreadState::MoHexThreadState(const unsigned int threadId,
       m_search(sch),
       m_treeUpdateRadius(treeUpdateRadius),
       m_playoutUpdateRadius(playoutUpdateRadius),
-      m_isInPlayout(false)
+      m_isInPlayout(false),
+      m_collectPerfStats(false),
+      m_gameStartCycles(0)
 {
 }
 
@@ -154,8 +156,24 @@ std::string MoHexThreadState::Dump() const
     return os.str();
 }
 
+bool MoHexThreadState::UseBitPlayouts() const
+{
+    return m_search.BitPlayouts() > 0 && !GameOver(m_state->Position());
+}
+
 SgUctValue MoHexThreadState::Evaluate()
 {
+    if (UseBitPlayouts())
+    {
+        MoHexPerfTimer timer(m_perfStats, MoHexPerfStats::PLAYOUT_MOVE,
+                             m_collectPerfStats);
+        const int lanes = m_search.BitPlayouts();
+        int wins = m_bitPlayouts.Run(m_state->Position(), m_state->ToPlay(),
+                                     lanes, m_search.BitPlayoutBridges());
+        return SgUctValue(wins) / SgUctValue(lanes);
+    }
+    MoHexPerfTimer timer(m_perfStats, MoHexPerfStats::WINNER_CHECK,
+                         m_collectPerfStats);
     const StoneBoard& pos = m_state->Position();
     SG_ASSERT(GameOver(pos));
     SgUctValue score = (GetWinner(pos) == m_state->ToPlay()) ? 1.0 : 0.0;
@@ -197,11 +215,25 @@ void MoHexThreadState::ExecuteMove(HexPoint cell, int updateRadius)
     // TODO: Handle case when assertions are on.
     SG_ASSERT(m_state->Position().IsEmpty(cell));
     SG_ASSERT(m_pastate->UpdateRadius() == updateRadius);
-    m_state->PlayMove(cell);
-    if (updateRadius == 1)
-	m_pastate->UpdateRingGodel(cell);
-    else
-	m_pastate->Update(cell);
+    {
+        MoHexPerfTimer timer(m_perfStats, MoHexPerfStats::EXECUTE_MOVE,
+                             m_collectPerfStats);
+        // Nothing looks at the hash during a playout, and the state
+        // is overwritten when the playout is taken back or the next
+        // game starts.
+        if (m_isInPlayout)
+            m_state->PlayPlayoutMove(cell);
+        else
+            m_state->PlayMove(cell);
+    }
+    {
+        MoHexPerfTimer timer(m_perfStats, MoHexPerfStats::PATTERN_UPDATE,
+                             m_collectPerfStats);
+        if (updateRadius == 1)
+            m_pastate->UpdateRingGodel(cell);
+        else
+            m_pastate->Update(cell);
+    }
     m_lastMovePlayed = cell;
     m_atRoot = false;
 }
@@ -226,8 +258,12 @@ bool MoHexThreadState::GenerateAllMoves(SgUctValue count,
         // First time we have been to this node. If solid winning
         // chain exists then mark as proven and abort. Otherwise, mark
         // every empty cell is a valid move.
-        if (IsProvenState(*m_state, provenType))
-            return false;
+        {
+            MoHexPerfTimer timer(m_perfStats, MoHexPerfStats::WINNER_CHECK,
+                                 m_collectPerfStats);
+            if (IsProvenState(*m_state, provenType))
+                return false;
+        }
         for (BitsetIterator it(m_state->Position().GetEmpty()); it; ++it)
             moves.push_back(SgUctMoveInfo(*it));
         m_priorKnowledge.ProcessPosition(moves);
@@ -258,8 +294,11 @@ bool MoHexThreadState::GenerateAllMoves(SgUctValue count,
 SgMove MoHexThreadState::GeneratePlayoutMove(bool& skipRaveUpdate)
 {
     skipRaveUpdate = false;
-    if (GameOver(m_state->Position()))
+    // Bit-sliced playouts are run from the leaf in Evaluate().
+    if (GameOver(m_state->Position()) || m_search.BitPlayouts() > 0)
         return SG_NULLMOVE;
+    MoHexPerfTimer timer(m_perfStats, MoHexPerfStats::PLAYOUT_MOVE,
+                         m_collectPerfStats);
     SgPoint move = m_policy->GenerateMove(*m_pastate, m_state->ToPlay(),
                                           m_lastMovePlayed);
     SG_ASSERT(move != SG_NULLMOVE);
@@ -288,6 +327,9 @@ void MoHexThreadState::StartSearch()
                                    brd.ICE(), brd.Builder().Parameters()));
     }
     m_policy->InitializeForSearch();
+    m_collectPerfStats = m_search.CollectPerfStats();
+    m_perfStats.Clear();
+    m_publishedPerfStats.Publish(m_perfStats);
 }
 
 void MoHexThreadState::TakeBackInTree(std::size_t nuMoves)
@@ -301,7 +343,7 @@ void MoHexThreadState::TakeBackPlayout(std::size_t nuMoves)
     if (m_search.NumberPlayouts() > 1)
     {
         m_lastMovePlayed = m_playoutStartLastMove;
-        *m_state = *m_playoutStartState;
+        m_state->CopyState(*m_playoutStartState);
         m_pastate->CopyState(*m_playoutStartPatterns);
     }
 }
@@ -313,17 +355,22 @@ SgBlackWhite MoHexThreadState::ToPlay() const
 
 void MoHexThreadState::GameStart()
 {
+    if (m_collectPerfStats)
+        m_gameStartCycles = MiscUtil::ReadCycleCounter();
     m_atRoot = true;
     m_isInPlayout = false;
     m_gameSequence = m_sharedData->gameSequence;
     m_lastMovePlayed = LastMoveFromHistory(m_gameSequence);
-    *m_state = m_sharedData->rootState;
+    m_state->CopyState(m_sharedData->rootState);
     m_pastate->SetUpdateRadius(m_treeUpdateRadius);
     m_pastate->Update();
 }
 
 void MoHexThreadState::StartPlayouts()
 {
+    if (m_collectPerfStats)
+        m_perfStats.Add(MoHexPerfStats::IN_TREE, 
+                        MiscUtil::ReadCycleCounter() - m_gameStartCycles);
     m_isInPlayout = true;
     m_pastate->SetUpdateRadius(m_playoutUpdateRadius);
     // Playout radius should normally be no bigger than tree radius,
@@ -335,7 +382,7 @@ void MoHexThreadState::StartPlayouts()
     if (m_search.NumberPlayouts() > 1)
     {
         m_playoutStartLastMove = m_lastMovePlayed;
-        *m_playoutStartState = *m_state;
+        m_playoutStartState->CopyState(*m_state);
         m_playoutStartPatterns->CopyState(*m_pastate);
     }
 }
@@ -345,14 +392,29 @@ void MoHexThreadState::StartPlayout()
     m_policy->InitializeForPlayout(m_state->Position());
 }
 
+/** Publishes the counters of the game for PerfStats(). */
 void MoHexThreadState::EndPlayout()
 {
+    if (!m_collectPerfStats)
+        return;
+    if (UseBitPlayouts())
+        m_perfStats.AddPlayouts(m_search.BitPlayouts());
+    else
+        m_perfStats.AddPlayout();
+    m_publishedPerfStats.Publish(m_perfStats);
+}
+
+MoHexPerfStats MoHexThreadState::PerfStats() const
+{
+    return m_publishedPerfStats.Read();
 }
 
 /** Computes moves to consider and stores fillin in the shared
     data. Sets provenType if state is determined by VCs. */
 bitset_t MoHexThreadState::ComputeKnowledge(SgUctProvenType& provenType)
 {
+    MoHexPerfTimer timer(m_perfStats, MoHexPerfStats::KNOWLEDGE,
+                         m_collectPerfStats);
     m_vcBrd->GetPosition().SetPosition(m_state->Position());
     m_vcBrd->ComputeAll(m_state->ToPlay());
     // Consider set will be all empty cells if state is a determined
@@ -12,6 +12,8 @@
 #include "HashMap.hpp"
 #include "HexBoard.hpp"
 #include "HexState.hpp"
+#include "MoHexBitPlayouts.hpp"
+#include "MoHexPerfStats.hpp"
 #include "MoHexPriorKnowledge.hpp"
 #include "Move.hpp"
 #include "VC.hpp"
@@ -145,6 +147,11 @@ public:
 
     HexColor GetColorToPlay() const;
 
+    /** Cycles spent by this thread in each phase since the start of
+        the last search, up to the end of its last game. Safe to call
+        from other threads while searching. */
+    MoHexPerfStats PerfStats() const;
+
 private:
     /** Assertion handler to dump the state of a MoHexThreadState. */
     class AssertionHandler
@@ -208,9 +215,29 @@ private:
 
     bool m_usingKnowledge;
 
+    /** Copy of MoHexSearch::CollectPerfStats() made at the start of
+        the search. */
+    bool m_collectPerfStats;
+
+    /** Counters of the current search; written only by this
+        thread. */
+    MoHexPerfStats m_perfStats;
+
+    /** See PerfStats() */
+    MoHexPublishedPerfStats m_publishedPerfStats;
+
+    /** Leaf evaluation used if MoHexSearch::BitPlayouts() is
+        non-zero. */
+    MoHexBitPlayouts m_bitPlayouts;
+
+    /** Cycle counter at the start of the current game. */
+    boost::uint64_t m_gameStartCycles;
+
     bitset_t ComputeKnowledge(SgUctProvenType& provenType);
 
     void ExecuteMove(HexPoint cell, int updateRadius);
+
+    bool UseBitPlayouts() const;
 };
 
 inline const StoneBoard& MoHexThreadState::Board() const
@@ -0,0 +1,368 @@
+//----------------------------------------------------------------------------
+/** @file MoHexTreeDB.cpp */
+//----------------------------------------------------------------------------
+
+#include "SgSystem.h"
+
+#include <cstring>
+#include <deque>
+#include <boost/cstdint.hpp>
+#include "BenzeneException.hpp"
+#include "BoardUtil.hpp"
+#include "MoHexTreeDB.hpp"
+#include "SequenceHash.hpp"
+
+using namespace benzene;
+
+//----------------------------------------------------------------------------
+
+const std::string MoHexTreeDB::MOHEX_TREE_DB_VERSION
+    ("BENZENE_MOHEX_TREE_DB_VER_0002");
+
+//----------------------------------------------------------------------------
+
+namespace {
+
+/** Number of bytes before the first node: format, width, height and
+    the number of nodes. */
+const std::size_t HEADER_SIZE = 3 + sizeof(boost::uint32_t);
+
+/** Move and number of children, proven type, five floats, knowledge
+    count and whether fill-in follows. */
+const std::size_t NODE_SIZE = 2 * sizeof(unsigned short) + 1
+    + 6 * sizeof(float) + 1;
+
+const byte TREE_DATA_FORMAT = 2;
+
+/** Bytes of the fill-in of a node: 2 bits per interior cell. */
+std::size_t FillinSize(int width, int height)
+{
+    return (width * height + 3) / 4;
+}
+
+template<typename T>
+byte* Write(byte* data, const T& value)
+{
+    std::memcpy(data, &value, sizeof(value));
+    return data + sizeof(value);
+}
+
+template<typename T>
+const byte* Read(const byte* data, T& value)
+{
+    std::memcpy(&value, data, sizeof(value));
+    return data + sizeof(value);
+}
+
+/** Packs the color of each interior cell into 2 bits, in the order
+    of ConstBoard::Interior(), as StoneBoard::GetBoardID() does. */
+byte* WriteFillin(byte* data, const ConstBoard& brd, 
+                  const bitset_t fillin[BLACK_AND_WHITE])
+{
+    std::size_t i = 0;
+    byte packed = 0;
+    for (BoardIterator p(brd.Interior()); p; ++p, ++i)
+    {
+        HexColor color = fillin[BLACK].test(*p) ? BLACK
+            : (fillin[WHITE].test(*p) ? WHITE : EMPTY);
+        packed = static_cast<byte>(packed | (color << (2 * (i % 4))));
+        if (i % 4 == 3)
+        {
+            *data++ = packed;
+            packed = 0;
+        }
+    }
+    if (i % 4 != 0)
+        *data++ = packed;
+    return data;
+}
+
+const byte* ReadFillin(const byte* data, const ConstBoard& brd,
+                       bitset_t fillin[BLACK_AND_WHITE])
+{
+    fillin[BLACK].reset();
+    fillin[WHITE].reset();
+    std::size_t i = 0;
+    for (BoardIterator p(brd.Interior()); p; ++p, ++i)
+    {
+        int color = (data[i / 4] >> (2 * (i % 4))) & 0x3;
+        if (color == BLACK || color == WHITE)
+            fillin[color].set(*p);
+    }
+    return data + FillinSize(brd.Width(), brd.Height());
+}
+
+/** Throws if fewer than size bytes are left before end. */
+void CheckSize(const byte* data, const byte* end, std::size_t size)
+{
+    if (static_cast<std::size_t>(end - data) < size)
+        throw BenzeneException("MoHexTreeData: truncated data!");
+}
+
+/** Node of a tree being copied, with the moves leading to it. */
+typedef std::pair<const SgUctNode*, MoveSequence> QueueEntry;
+
+/** Color of the player to move in a node reached by sequence. */
+HexColor ToPlay(const HexState& rootState, const MoveSequence& rootSequence,
+                const MoveSequence& sequence)
+{
+    return (sequence.size() - rootSequence.size()) % 2 == 0
+        ? rootState.ToPlay() : !rootState.ToPlay();
+}
+
+} // namespace
+
+//----------------------------------------------------------------------------
+
+MoHexTreeData::Node::Node()
+    : m_move(INVALID_POINT),
+      m_numChildren(0),
+      m_provenType(SG_NOT_PROVEN),
+      m_count(0),
+      m_mean(0),
+      m_posCount(0),
+      m_raveCount(0),
+      m_raveValue(0),
+      m_knowledgeCount(0),
+      m_hasFillin(false)
+{
+}
+
+MoHexTreeData::Node::Node(const SgUctNode& node)
+    : m_move(static_cast<HexPoint>(node.Move())),
+      m_numChildren(0),
+      m_provenType(node.ProvenType()),
+      m_count(static_cast<float>(node.MoveCount())),
+      m_mean(node.HasMean() ? static_cast<float>(node.Mean()) : 0),
+      m_posCount(static_cast<float>(node.PosCount())),
+      m_raveCount(static_cast<float>(node.RaveCount())),
+      m_raveValue(node.HasRaveValue()
+                  ? static_cast<float>(node.RaveValue()) : 0),
+      m_knowledgeCount(static_cast<float>(node.KnowledgeCount())),
+      m_hasFillin(false)
+{
+}
+
+//----------------------------------------------------------------------------
+
+MoHexTreeData::MoHexTreeData()
+    : m_width(0),
+      m_height(0)
+{
+}
+
+MoHexTreeData::MoHexTreeData(const SgUctTree& tree, 
+                             const HexState& rootState,
+                             const MoveSequence& sequence,
+                             const HashMap<StoneBoard>& fillin,
+                             std::size_t maxNodes)
+    : m_width(rootState.Position().Width()),
+      m_height(rootState.Position().Height())
+{
+    std::deque<QueueEntry> queue;
+    queue.push_back(QueueEntry(&tree.Root(), sequence));
+    m_nodes.push_back(Node(tree.Root()));
+    m_nodes.back().m_move = INVALID_POINT;
+    for (std::size_t i = 0; i < m_nodes.size(); ++i)
+    {
+        const SgUctNode& node = *queue.front().first;
+        const MoveSequence nodeSequence = queue.front().second;
+        queue.pop_front();
+        // Fill-in of the root is given by MoHexPlayer, not the tree
+        StoneBoard position;
+        if (i > 0 && fillin.Get(SequenceHash::Hash(nodeSequence), position))
+        {
+            m_nodes[i].m_hasFillin = true;
+            m_nodes[i].m_fillin[BLACK] = position.GetBlack();
+            m_nodes[i].m_fillin[WHITE] = position.GetWhite();
+        }
+        if (!node.HasChildren()
+            || m_nodes.size() + node.NuChildren() > maxNodes)
+            continue;
+        m_nodes[i].m_numChildren
+            = static_cast<unsigned short>(node.NuChildren());
+        const HexColor color = ToPlay(rootState, sequence, nodeSequence);
+        for (SgUctChildIterator it(tree, node); it; ++it)
+        {
+            MoveSequence childSequence(nodeSequence);
+            childSequence.push_back
+                (Move(color, static_cast<HexPoint>((*it).Move())));
+            queue.push_back(QueueEntry(&(*it), childSequence));
+            m_nodes.push_back(Node(*it));
+        }
+    }
+}
+
+/** Creates the children of the nodes in the order they were stored,
+    so the children of the next node to expand are always the next
+    nodes of the snapshot. The position with fill-in of a node is
+    rebuilt from the root position and the moves to the node. */
+std::size_t MoHexTreeData::Restore(SgUctTree& tree, 
+                                   const HexState& rootState,
+                                   const MoveSequence& sequence,
+                                   HashMap<StoneBoard>& fillin) const
+{
+    tree.Clear();
+    if (m_nodes.empty())
+        return 0;
+    const SgUctNode& root = tree.Root();
+    const Node& rootData = m_nodes[0];
+    if (rootData.m_count > 0)
+        tree.InitializeValue(root, rootData.m_mean, rootData.m_count);
+    tree.SetPosCount(root, rootData.m_posCount);
+    tree.SetProvenType(root, rootData.m_provenType);
+    const_cast<SgUctNode&>(root).SetKnowledgeCount
+        (rootData.m_knowledgeCount);
+    std::deque<QueueEntry> queue;
+    queue.push_back(QueueEntry(&root, sequence));
+    std::size_t next = 1;
+    std::vector<SgUctMoveInfo> moves;
+    for (std::size_t i = 0; i < m_nodes.size() && !queue.empty(); ++i)
+    {
+        const SgUctNode& node = *queue.front().first;
+        const MoveSequence nodeSequence = queue.front().second;
+        queue.pop_front();
+        const std::size_t numChildren = m_nodes[i].m_numChildren;
+        if (numChildren == 0)
+            continue;
+        if (next + numChildren > m_nodes.size()
+            || !tree.HasCapacity(0, numChildren))
+            break;
+        moves.clear();
+        for (std::size_t j = next; j < next + numChildren; ++j)
+        {
+            const Node& child = m_nodes[j];
+            moves.push_back(SgUctMoveInfo(child.m_move, child.m_mean,
+                                          child.m_count, child.m_raveValue,
+                                          child.m_raveCount));
+        }
+        tree.CreateChildren(0, node, moves);
+        const HexColor color = ToPlay(rootState, sequence, nodeSequence);
+        for (SgUctChildIterator it(tree, node); it; ++it, ++next)
+        {
+            const Node& child = m_nodes[next];
+            tree.SetPosCount(*it, child.m_posCount);
+            tree.SetProvenType(*it, child.m_provenType);
+            // Knowledge is only computed again at the next threshold,
+            // so the children restored below are kept.
+            const_cast<SgUctNode&>(*it).SetKnowledgeCount
+                (child.m_knowledgeCount);
+            MoveSequence childSequence(nodeSequence);
+            childSequence.push_back(Move(color, child.m_move));
+            if (child.m_hasFillin)
+            {
+                StoneBoard position(rootState.Position());
+                for (std::size_t k = sequence.size(); 
+                     k < childSequence.size(); ++k)
+                    position.PlayMove(childSequence[k].Color(),
+                                      childSequence[k].Point());
+                const bitset_t empty = position.GetEmpty();
+                position.AddColor(BLACK, child.m_fillin[BLACK] & empty);
+                position.AddColor(WHITE, child.m_fillin[WHITE] & empty);
+                fillin.Add(SequenceHash::Hash(childSequence), position);
+            }
+            queue.push_back(QueueEntry(&(*it), childSequence));
+        }
+    }
+    return tree.NuNodes();
+}
+
+//----------------------------------------------------------------------------
+
+int MoHexTreeData::PackedSize() const
+{
+    std::size_t size = HEADER_SIZE + m_nodes.size() * NODE_SIZE;
+    for (std::size_t i = 0; i < m_nodes.size(); ++i)
+        if (m_nodes[i].m_hasFillin)
+            size += FillinSize(m_width, m_height);
+    return static_cast<int>(size);
+}
+
+byte* MoHexTreeData::Pack() const
+{
+    m_packed.resize(PackedSize());
+    byte* data = &m_packed[0];
+    *data++ = TREE_DATA_FORMAT;
+    *data++ = static_cast<byte>(m_width);
+    *data++ = static_cast<byte>(m_height);
+    data = Write(data, static_cast<boost::uint32_t>(m_nodes.size()));
+    for (std::size_t i = 0; i < m_nodes.size(); ++i)
+    {
+        const Node& node = m_nodes[i];
+        data = Write(data, static_cast<unsigned short>(node.m_move));
+        data = Write(data, node.m_numChildren);
+        *data++ = static_cast<byte>(node.m_provenType);
+        data = Write(data, node.m_count);
+        data = Write(data, node.m_mean);
+        data = Write(data, node.m_posCount);
+        data = Write(data, node.m_raveCount);
+        data = Write(data, node.m_raveValue);
+        data = Write(data, node.m_knowledgeCount);
+        *data++ = node.m_hasFillin ? 1 : 0;
+        if (node.m_hasFillin)
+            data = WriteFillin(data, ConstBoard::Get(m_width, m_height),
+                               node.m_fillin);
+    }
+    return &m_packed[0];
+}
+
+void MoHexTreeData::Unpack(const byte* data, int size)
+{
+    const byte* end = data + size;
+    CheckSize(data, end, HEADER_SIZE);
+    if (*data++ != TREE_DATA_FORMAT)
+        throw BenzeneException("MoHexTreeData: unknown format!");
+    m_width = *data++;
+    m_height = *data++;
+    boost::uint32_t numNodes;
+    data = Read(data, numNodes);
+    // Before allocating the nodes
+    CheckSize(data, end, numNodes * NODE_SIZE);
+    m_nodes.resize(numNodes);
+    for (std::size_t i = 0; i < m_nodes.size(); ++i)
+    {
+        CheckSize(data, end, NODE_SIZE);
+        Node& node = m_nodes[i];
+        unsigned short move;
+        data = Read(data, move);
+        node.m_move = static_cast<HexPoint>(move);
+        data = Read(data, node.m_numChildren);
+        node.m_provenType = static_cast<SgUctProvenType>(*data++);
+        data = Read(data, node.m_count);
+        data = Read(data, node.m_mean);
+        data = Read(data, node.m_posCount);
+        data = Read(data, node.m_raveCount);
+        data = Read(data, node.m_raveValue);
+        data = Read(data, node.m_knowledgeCount);
+        node.m_hasFillin = (*data++ != 0);
+        if (node.m_hasFillin)
+        {
+            CheckSize(data, end, FillinSize(m_width, m_height));
+            data = ReadFillin(data, ConstBoard::Get(m_width, m_height),
+                              node.m_fillin);
+        }
+    }
+    // The children of all nodes must be exactly the nodes after the
+    // root, so that Restore() never reads past the last node.
+    std::size_t numChildren = 0;
+    for (std::size_t i = 0; i < m_nodes.size(); ++i)
+        numChildren += m_nodes[i].m_numChildren;
+    if (!m_nodes.empty() && numChildren != m_nodes.size() - 1)
+        throw BenzeneException("MoHexTreeData: bad number of children!");
+}
+
+/** The root has no move and is skipped. */
+void MoHexTreeData::Rotate(const ConstBoard& brd)
+{
+    for (std::size_t i = 1; i < m_nodes.size(); ++i)
+    {
+        Node& node = m_nodes[i];
+        node.m_move = BoardUtil::Rotate(brd, node.m_move);
+        if (!node.m_hasFillin)
+            continue;
+        node.m_fillin[BLACK] = BoardUtil::Rotate(brd, node.m_fillin[BLACK]);
+        node.m_fillin[WHITE] = BoardUtil::Rotate(brd, node.m_fillin[WHITE]);
+    }
+}
+
+//----------------------------------------------------------------------------
@@ -0,0 +1,151 @@
+//----------------------------------------------------------------------------
+/** @file MoHexTreeDB.hpp */
+//----------------------------------------------------------------------------
+
+#ifndef MOHEXTREEDB_HPP
+#define MOHEXTREEDB_HPP
+
+#include "SgUctTree.h"
+
+#include "HashMap.hpp"
+#include "HexState.hpp"
+#include "Move.hpp"
+#include "StateDB.hpp"
+
+_BEGIN_BENZENE_NAMESPACE_
+
+//----------------------------------------------------------------------------
+
+/** Snapshot of a MoHex search tree stored in a MoHexTreeDB.
+
+    Holds the move, counts, values and proven type of each node, in
+    breadth-first order, with the number of children of each node.
+    Only the children kept by the knowledge are in the search tree,
+    so a restored tree keeps its pruning. The knowledge count of each
+    node and the position with fill-in of each node whose knowledge
+    was computed are stored as well, so the search does not compute
+    the knowledge of a restored node again and truncate its
+    children.
+
+    Packed, a node takes 30 bytes, plus 2 bits per cell if it has
+    fill-in.
+
+    Do not forget to update MoHexTreeDB::MOHEX_TREE_DB_VERSION if the
+    packed format changes. */
+class MoHexTreeData
+{
+public:
+    MoHexTreeData();
+
+    /** Copies tree, keeping at most maxNodes nodes. Nodes closer to
+        the root are kept first; a node is either stored with all its
+        children or as a leaf. The fill-in of a node is looked up in
+        fillin by the hash of sequence followed by the moves to the
+        node, as MoHexThreadState stores it; the first move is by the
+        player to move in rootState. */
+    MoHexTreeData(const SgUctTree& tree, const HexState& rootState,
+                  const MoveSequence& sequence,
+                  const HashMap<StoneBoard>& fillin, std::size_t maxNodes);
+
+    std::size_t NumNodes() const;
+
+    /** Returns true if the board size of the snapshot is that of brd. */
+    bool SameBoardSize(const ConstBoard& brd) const;
+
+    /** Clears tree and rebuilds the snapshot in it, using the node
+        allocator of thread 0. Nodes that do not fit are left out, as
+        SgUctTreeUtil::ExtractSubtree() does. The fill-in of the
+        restored nodes is added to fillin, keyed as in the
+        constructor. Returns the number of nodes in tree. */
+    std::size_t Restore(SgUctTree& tree, const HexState& rootState,
+                        const MoveSequence& sequence,
+                        HashMap<StoneBoard>& fillin) const;
+
+    /** @name StateDBStateConcept */
+    // @{
+
+    int PackedSize() const;
+
+    byte* Pack() const;
+
+    void Unpack(const byte* data, int size);
+
+    void Rotate(const ConstBoard& brd);
+
+    // @}
+
+private:
+    struct Node
+    {
+        HexPoint m_move;
+
+        unsigned short m_numChildren;
+
+        SgUctProvenType m_provenType;
+
+        float m_count;
+
+        float m_mean;
+
+        float m_posCount;
+
+        float m_raveCount;
+
+        float m_raveValue;
+
+        float m_knowledgeCount;
+
+        /** True if the node has a position with fill-in. */
+        bool m_hasFillin;
+
+        /** Stones of each color in the position with fill-in. */
+        bitset_t m_fillin[BLACK_AND_WHITE];
+
+        Node();
+
+        explicit Node(const SgUctNode& node);
+    };
+
+    int m_width;
+
+    int m_height;
+
+    /** Nodes in breadth-first order; the children of a node follow
+        the children of the nodes before it. */
+    std::vector<Node> m_nodes;
+
+    /** Buffer returned by Pack(). Not shared between snapshots, since
+        each database only locks the snapshots it packs. */
+    mutable std::vector<byte> m_packed;
+};
+
+inline std::size_t MoHexTreeData::NumNodes() const
+{
+    return m_nodes.size();
+}
+
+inline bool MoHexTreeData::SameBoardSize(const ConstBoard& brd) const
+{
+    return m_width == brd.Width() && m_height == brd.Height();
+}
+
+//----------------------------------------------------------------------------
+
+/** Database of MoHex search trees keyed by the root position.
+    A filename ending in ".lsdb" gives a LogStore, whose index is
+    mapped into memory; see HashDB. */
+class MoHexTreeDB : public StateDB<MoHexTreeData>
+{
+public:
+    static const std::string MOHEX_TREE_DB_VERSION;
+
+    MoHexTreeDB(const std::string& filename)
+        : StateDB<MoHexTreeData>(filename, MOHEX_TREE_DB_VERSION)
+    { }
+};
+
+//----------------------------------------------------------------------------
+
+_END_BENZENE_NAMESPACE_
+
+#endif // MOHEXTREEDB_HPP
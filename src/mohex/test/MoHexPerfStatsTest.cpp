@@ -0,0 +1,90 @@
+//---------------------------------------------------------------------------
+/** @file MoHexPerfStatsTest.cpp */
+//---------------------------------------------------------------------------
+#include <boost/test/auto_unit_test.hpp>
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+
+#include "MoHexPerfStats.hpp"
+
+using namespace benzene;
+
+//---------------------------------------------------------------------------
+
+namespace {
+
+const int NUM_PUBLISHES = 100000;
+
+/** Publishes stats in which every counter equals the number of
+    publishes so far. */
+void PublishAll(MoHexPublishedPerfStats& published)
+{
+    MoHexPerfStats stats;
+    for (int i = 0; i < NUM_PUBLISHES; ++i)
+    {
+        for (int p = 0; p < MoHexPerfStats::NUM_PHASES; ++p)
+            stats.Add(static_cast<MoHexPerfStats::Phase>(p), 1);
+        stats.AddPlayout();
+        published.Publish(stats);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(MoHexPerfStats_AddAndMerge)
+{
+    MoHexPerfStats a;
+    a.Add(MoHexPerfStats::EXECUTE_MOVE, 10);
+    a.Add(MoHexPerfStats::EXECUTE_MOVE, 5);
+    a.AddPlayouts(4);
+    MoHexPerfStats b;
+    b.Add(MoHexPerfStats::EXECUTE_MOVE, 1);
+    b.AddPlayout();
+    b.Merge(a);
+    BOOST_CHECK_EQUAL(b.Cycles(MoHexPerfStats::EXECUTE_MOVE), 16u);
+    BOOST_CHECK_EQUAL(b.Count(MoHexPerfStats::EXECUTE_MOVE), 3u);
+    BOOST_CHECK_EQUAL(b.Count(MoHexPerfStats::KNOWLEDGE), 0u);
+    BOOST_CHECK_EQUAL(b.Playouts(), 5u);
+    b.Clear();
+    BOOST_CHECK_EQUAL(b.Playouts(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(MoHexPerfStats_TimerDisabled)
+{
+    MoHexPerfStats stats;
+    {
+        MoHexPerfTimer timer(stats, MoHexPerfStats::KNOWLEDGE, false);
+    }
+    BOOST_CHECK_EQUAL(stats.Count(MoHexPerfStats::KNOWLEDGE), 0u);
+    {
+        MoHexPerfTimer timer(stats, MoHexPerfStats::KNOWLEDGE, true);
+    }
+    BOOST_CHECK_EQUAL(stats.Count(MoHexPerfStats::KNOWLEDGE), 1u);
+}
+
+/** Every copy read while another thread publishes must come from a
+    single Publish(). */
+BOOST_AUTO_TEST_CASE(MoHexPerfStats_PublishedReadIsConsistent)
+{
+    MoHexPublishedPerfStats published;
+    BOOST_CHECK_EQUAL(published.Read().Playouts(), 0u);
+    boost::thread writer(boost::bind(PublishAll, boost::ref(published)));
+    bool consistent = true;
+    boost::uint64_t last = 0;
+    while (last < static_cast<boost::uint64_t>(NUM_PUBLISHES))
+    {
+        MoHexPerfStats stats = published.Read();
+        last = stats.Playouts();
+        for (int p = 0; p < MoHexPerfStats::NUM_PHASES; ++p)
+        {
+            MoHexPerfStats::Phase phase
+                = static_cast<MoHexPerfStats::Phase>(p);
+            if (stats.Cycles(phase) != last || stats.Count(phase) != last)
+                consistent = false;
+        }
+    }
+    writer.join();
+    BOOST_CHECK(consistent);
+}
+
+}
+
+//---------------------------------------------------------------------------
@@ -0,0 +1,135 @@
+//---------------------------------------------------------------------------
+/** @file MoHexTreeDBTest.cpp */
+//---------------------------------------------------------------------------
+#include <boost/test/auto_unit_test.hpp>
+
+#include "SgSystem.h"
+#include "MoHexTreeDB.hpp"
+#include "SequenceHash.hpp"
+
+using namespace benzene;
+
+//---------------------------------------------------------------------------
+
+namespace {
+
+/** Root with children a1 and b2; a1 has the proven child c3. */
+void MakeTree(SgUctTree& tree)
+{
+    tree.CreateAllocators(1);
+    tree.SetMaxNodes(100);
+    std::vector<SgUctMoveInfo> moves;
+    moves.push_back(SgUctMoveInfo(HEX_CELL_A1, 0.25, 4, 0.5, 8));
+    moves.push_back(SgUctMoveInfo(HEX_CELL_B2, 0.75, 2, 0.25, 3));
+    tree.CreateChildren(0, tree.Root(), moves);
+    const SgUctNode& a1 = *SgUctChildIterator(tree, tree.Root());
+    tree.SetPosCount(a1, 5);
+    moves.clear();
+    moves.push_back(SgUctMoveInfo(HEX_CELL_C3, 1.0, 3, 0.5, 1));
+    tree.CreateChildren(0, a1, moves);
+    tree.SetProvenType(*SgUctChildIterator(tree, a1), SG_PROVEN_WIN);
+}
+
+BOOST_AUTO_TEST_CASE(MoHexTreeData_PackUnpackRotate)
+{
+    const ConstBoard& brd = ConstBoard::Get(3, 3);
+    const HexState state(StoneBoard(3, 3), BLACK);
+    HashMap<StoneBoard> fillin(8);
+    SgUctTree tree;
+    MakeTree(tree);
+    MoHexTreeData data(tree, state, MoveSequence(), fillin, 100);
+    BOOST_CHECK_EQUAL(data.NumNodes(), 4u);
+
+    MoHexTreeData copy;
+    copy.Unpack(data.Pack(), data.PackedSize());
+    BOOST_CHECK_EQUAL(copy.PackedSize(), data.PackedSize());
+    BOOST_CHECK(copy.SameBoardSize(brd));
+    BOOST_CHECK(!copy.SameBoardSize(ConstBoard::Get(4, 4)));
+    copy.Rotate(brd);
+
+    SgUctTree restored;
+    restored.CreateAllocators(1);
+    restored.SetMaxNodes(100);
+    BOOST_CHECK_EQUAL(copy.Restore(restored, state, MoveSequence(), fillin),
+                      4u);
+    SgUctChildIterator it(restored, restored.Root());
+    const SgUctNode& c3 = *it;
+    BOOST_CHECK_EQUAL(c3.Move(), HEX_CELL_C3);
+    BOOST_CHECK_EQUAL(c3.MoveCount(), 4);
+    BOOST_CHECK_CLOSE(c3.Mean(), 0.25, 1e-4);
+    BOOST_CHECK_EQUAL(c3.PosCount(), 5);
+    BOOST_CHECK_EQUAL(c3.RaveCount(), 8);
+    BOOST_CHECK_EQUAL(c3.NuChildren(), 1);
+    const SgUctNode& a1 = *SgUctChildIterator(restored, c3);
+    BOOST_CHECK_EQUAL(a1.Move(), HEX_CELL_A1);
+    BOOST_CHECK_EQUAL(a1.ProvenType(), SG_PROVEN_WIN);
+    ++it;
+    BOOST_CHECK_EQUAL((*it).Move(), HEX_CELL_B2);
+    BOOST_CHECK_CLOSE((*it).RaveValue(), 0.25, 1e-4);
+    BOOST_CHECK(!(*it).HasChildren());
+}
+
+BOOST_AUTO_TEST_CASE(MoHexTreeData_MaxNodes)
+{
+    const HexState state(StoneBoard(3, 3), BLACK);
+    HashMap<StoneBoard> fillin(8);
+    SgUctTree tree;
+    MakeTree(tree);
+    MoHexTreeData data(tree, state, MoveSequence(), fillin, 3);
+    BOOST_CHECK_EQUAL(data.NumNodes(), 3u);
+    MoHexTreeData copy;
+    copy.Unpack(data.Pack(), data.PackedSize());
+    SgUctTree restored;
+    restored.CreateAllocators(1);
+    restored.SetMaxNodes(100);
+    BOOST_CHECK_EQUAL(copy.Restore(restored, state, MoveSequence(), fillin),
+                      3u);
+    BOOST_CHECK(!(*SgUctChildIterator(restored, restored.Root()))
+                .HasChildren());
+}
+
+/** The knowledge count and fill-in of a1 survive a round trip, so
+    its child c3 is not truncated by computing the knowledge again. */
+BOOST_AUTO_TEST_CASE(MoHexTreeData_KnowledgeAndFillin)
+{
+    const HexState state(StoneBoard(3, 3), BLACK);
+    MoveSequence sequence;
+    sequence.push_back(Move(WHITE, HEX_CELL_B1));
+    SgUctTree tree;
+    MakeTree(tree);
+    const SgUctNode& a1 = *SgUctChildIterator(tree, tree.Root());
+    const_cast<SgUctNode&>(a1).SetKnowledgeCount(3);
+    MoveSequence a1Sequence(sequence);
+    a1Sequence.push_back(Move(BLACK, HEX_CELL_A1));
+    StoneBoard position(3, 3);
+    position.PlayMove(BLACK, HEX_CELL_A1);
+    position.AddColor(WHITE, bitset_t().set(HEX_CELL_B2));
+    HashMap<StoneBoard> fillin(8);
+    fillin.Add(SequenceHash::Hash(a1Sequence), position);
+    MoHexTreeData data(tree, state, sequence, fillin, 100);
+
+    MoHexTreeData copy;
+    copy.Unpack(data.Pack(), data.PackedSize());
+    BOOST_CHECK_EQUAL(copy.PackedSize(), data.PackedSize());
+    SgUctTree restored;
+    restored.CreateAllocators(1);
+    restored.SetMaxNodes(100);
+    HashMap<StoneBoard> restoredFillin(8);
+    BOOST_CHECK_EQUAL(copy.Restore(restored, state, sequence, 
+                                   restoredFillin), 4u);
+    const SgUctNode& restoredA1 
+        = *SgUctChildIterator(restored, restored.Root());
+    BOOST_CHECK_EQUAL(restoredA1.KnowledgeCount(), 3);
+    BOOST_CHECK_EQUAL(restoredA1.NuChildren(), 1);
+    StoneBoard restoredPosition;
+    BOOST_CHECK(restoredFillin.Get(SequenceHash::Hash(a1Sequence),
+                                   restoredPosition));
+    BOOST_CHECK(restoredPosition.GetBlack() == position.GetBlack());
+    BOOST_CHECK(restoredPosition.GetWhite() == position.GetWhite());
+    BOOST_CHECK(restoredPosition.GetPlayed() == position.GetPlayed());
+    BOOST_CHECK(restoredPosition.Hash() == position.Hash());
+}
+
+} // namespace
+
+//---------------------------------------------------------------------------
@@ -64,13 +64,13 @@ HexPoint VulPreCheck::KillLastMove(HexBoard& brd, const Game& game_state,
         {
 	    LogWarning() << "Opponent's last move was vulnerable - killing it!"
                          << '\n';
-	    std::set<VulnerableKiller> killers = inf.Killers(lastCell);
+	    std::vector<VulnerableKiller> killers = inf.Killers(lastCell);
 	    BenzeneAssert(!killers.empty());
 	    
 	    /** If opponent's last move can be made unconditionally dead,
 		this is preferable since we can treat it as such in the
 		future, thereby finding more opponent vulnerable cells. */
-	    std::set<VulnerableKiller>::iterator i;
+	    std::vector<VulnerableKiller>::iterator i;
 	    for (i = killers.begin(); i != killers.end(); ++i) 
             {
 		if (i->carrier().none()) 
@@ -38,6 +38,7 @@ void DfpnCommands::Register(GtpEngine& e)
     Register(e, "dfpn-open-db", &DfpnCommands::CmdOpenDB);
     Register(e, "dfpn-close-db", &DfpnCommands::CmdCloseDB);
     Register(e, "dfpn-db-stat", &DfpnCommands::CmdDBStat);
+    Register(e, "dfpn-convert-db", &DfpnCommands::CmdConvertDB);
     Register(e, "dfpn-evaluation-info", &DfpnCommands::CmdEvaluationInfo);
 }
 
@@ -64,6 +65,7 @@ void DfpnCommands::AddAnalyzeCommands(HtpCommand& cmd)
         "none/DFPN Open DB/dfpn-open-db %r\n"
         "none/DFPN Close DB/dfpn-close-db\n"
         "string/DFPN DB Stats/dfpn-db-stat\n"
+        "none/DFPN Convert DB/dfpn-convert-db %r %w\n"
         "string/DFPN Eval Info/dfpn-evaluation-info\n";
 }
 
@@ -104,11 +106,16 @@ void DfpnCommands::CmdParam(HtpCommand& cmd)
         cmd << '\n'
             << "[bool] use_guifx "
             << m_solver.UseGuiFx() << '\n'
+            << "[string] threshold_epsilon "
+            << m_solver.ThresholdEpsilon() << '\n'
             << "[string] timelimit "
             << m_solver.Timelimit() << '\n'
             << "[string] tt_bits "  
-            << ((m_tt.get() == 0) ? 0 : log2(m_tt->MaxHash())) << '\n'
-            << "[string] widening_base "
+            << ((m_tt.get() == 0) ? 0 : log2(m_tt->MaxHash())) << '\n';
+        if (m_tt.get() != 0)
+            cmd << "[string] tt_gc_keep " << m_tt->GCKeep() << '\n'
+                << "[string] tt_gc_threshold " << m_tt->GCThreshold() << '\n';
+        cmd << "[string] widening_base "
             << m_solver.WideningBase() << '\n'
             << "[string] widening_factor "
             << m_solver.WideningFactor() << '\n';
@@ -118,16 +125,46 @@ void DfpnCommands::CmdParam(HtpCommand& cmd)
         std::string name = cmd.Arg(0);
         if (name == "use_guifx")
             m_solver.SetUseGuiFx(cmd.Arg<bool>(1));
+        else if (name == "threshold_epsilon")
+            m_solver.SetThresholdEpsilon(cmd.ArgMin<float>(1, 0.0f));
         else if (name == "timelimit")
             m_solver.SetTimelimit(cmd.ArgMin<float>(1, 0.0));
-	else if (name == "tt_bits")
-	{
-	    int bits = cmd.ArgMin<int>(1, 0);
-	    if (bits == 0)
-		m_tt.reset(0);
-	    else
-		m_tt.reset(new DfpnHashTable(1 << bits));
-	}
+        else if (name == "tt_bits")
+        {
+            int bits = cmd.ArgMin<int>(1, 0);
+            if (bits == 0)
+                m_tt.reset(0);
+            else
+            {
+                DfpnHashTable* tt = new DfpnHashTable(1 << bits);
+                if (m_tt.get() != 0)
+                    tt->CopySettingsFrom(*m_tt);
+                m_tt.reset(tt);
+            }
+        }
+        else if (name == "tt_gc_keep" || name == "tt_gc_threshold")
+        {
+            if (m_tt.get() == 0)
+                throw GtpFailure() << "No hashtable";
+            float value = cmd.Arg<float>(1);
+            if (value < 0.0f || value > 1.0f)
+                throw GtpFailure() << name << " must be in [0, 1]";
+            if (name == "tt_gc_keep")
+            {
+                if (m_tt->GCThreshold() > 0.0f
+                    && value >= m_tt->GCThreshold())
+                    throw GtpFailure() << "tt_gc_keep must be less than "
+                                       << "tt_gc_threshold";
+                m_tt->SetGCKeep(value);
+            }
+            else
+            {
+                if (value > 0.0f && value <= m_tt->GCKeep())
+                    throw GtpFailure() << "tt_gc_threshold must be 0 or "
+                                       << "greater than tt_gc_keep";
+                m_tt->SetGCThreshold(value);
+            }
+        }
         else if (name == "widening_base")
             m_solver.SetWideningBase(cmd.ArgMin<int>(1, 1));
         else if (name == "widening_factor")
@@ -294,7 +331,7 @@ void DfpnCommands::CmdOpenDB(HtpCommand& cmd)
     }
 }
 
-/** Closes an open database. */
+/** Closes an open database, after writing all queued puts. */
 void DfpnCommands::CmdCloseDB(HtpCommand& cmd)
 {
     cmd.CheckNuArg(0);
@@ -303,13 +340,35 @@ void DfpnCommands::CmdCloseDB(HtpCommand& cmd)
     m_db.reset(0);
 }
 
-/** Prints database statistics. */
+/** Prints hashtable and database statistics. */
 void DfpnCommands::CmdDBStat(HtpCommand& cmd)
 {
     cmd.CheckNuArg(0);
-    if (m_db.get() == 0)
-        throw HtpFailure("No open database!\n");
-    cmd << m_db->BDBStatistics();
+    if (m_db.get() == 0 && m_tt.get() == 0)
+        throw HtpFailure("No open database or hashtable!\n");
+    if (m_tt.get() != 0)
+        cmd << '\n' << m_tt->Statistics();
+    if (m_db.get() != 0)
+        cmd << '\n' << m_db->GetStatistics().Write()
+            << '\n' << m_db->BDBStatistics();
+}
+
+/** Copies a database written by an older version of the solver into
+    a database of the current version.
+    Usage: 
+      dfpn-convert-db [old database] [new database]
+*/
+void DfpnCommands::CmdConvertDB(HtpCommand& cmd)
+{
+    cmd.CheckNuArg(2);
+    std::size_t count;
+    try {
+        count = DfpnDB::ConvertVersion2(cmd.Arg(0), cmd.Arg(1));
+    }
+    catch (BenzeneException& e) {
+        throw HtpFailure() << "Error converting db: '" << e.what() << "'\n";
+    }
+    cmd << count;
 }
 
 void DfpnCommands::CmdEvaluationInfo(HtpCommand& cmd)
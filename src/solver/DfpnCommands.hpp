@@ -57,6 +57,7 @@ private:
     void CmdOpenDB(HtpCommand& cmd);
     void CmdCloseDB(HtpCommand& cmd);
     void CmdDBStat(HtpCommand& cmd);
+    void CmdConvertDB(HtpCommand& cmd);
     void CmdEvaluationInfo(HtpCommand& cmd);
 };
 
@@ -12,6 +12,8 @@
 #include "ProofUtil.hpp"
 #include "Resistance.hpp"
 
+#include <cmath>
+#include <cstring>
 #include <boost/filesystem/path.hpp>
 
 using namespace benzene;
@@ -23,7 +25,61 @@ using std::ceil;
 /** Current version of the dfpn database.
     Update this if DfpnData changes to prevent old out-of-date
     databases from being loaded. */
-const std::string DfpnDB::DFPN_DB_VERSION("BENZENE_DFPN_DB_VER_0002");
+const std::string DfpnDB::DFPN_DB_VERSION("BENZENE_DFPN_DB_VER_0003");
+
+/** Version of databases with the fixed size encoding of DfpnData,
+    which DfpnDB::ConvertVersion2() can read. */
+const std::string DfpnDB::DFPN_DB_VERSION_2("BENZENE_DFPN_DB_VER_0002");
+
+namespace {
+
+/** Rewrites version 2 entries into a database of the current
+    version. */
+class DfpnDBConverter : public LogStore::Visitor
+{
+public:
+    DfpnDBConverter(HashDB<DfpnData>& target)
+        : m_target(target),
+          m_count(0)
+    { }
+
+    void Visit(const void* key, std::size_t keySize,
+               const void* data, std::size_t dataSize)
+    {
+        // Skip the database type
+        if (keySize != sizeof(SgHashCode))
+            return;
+        SgHashCode hash;
+        std::memcpy(&hash, key, sizeof(hash));
+        DfpnData entry;
+        entry.UnpackVersion2(static_cast<const byte*>(data), dataSize);
+        m_target.Put(hash, entry);
+        ++m_count;
+    }
+
+    std::size_t Count() const
+    {
+        return m_count;
+    }
+
+private:
+    HashDB<DfpnData>& m_target;
+
+    std::size_t m_count;
+};
+
+} // namespace
+
+std::size_t DfpnDB::ConvertVersion2(const std::string& from,
+                                    const std::string& to)
+{
+    HashDB<DfpnData> source(from, DFPN_DB_VERSION_2);
+    HashDB<DfpnData> target(to, DFPN_DB_VERSION);
+    DfpnDBConverter converter(target);
+    source.ForEach(converter);
+    target.Flush();
+    return converter.Count();
+}
 
 //----------------------------------------------------------------------------
 
@@ -170,45 +226,262 @@ void DfpnSolver::GuiFx::DoWrite()
 
 //----------------------------------------------------------------------------
 
+namespace {
+
+/** First byte of a packed DfpnData. */
+const byte DFPN_DATA_FORMAT = 1;
+
+/** Writes bytes to a buffer, or only counts them if the buffer is
+    0. */
+class DfpnDataEncoder
+{
+public:
+    explicit DfpnDataEncoder(byte* data)
+        : m_data(data),
+          m_size(0)
+    { }
+
+    void Byte(byte b)
+    {
+        if (m_data)
+            m_data[m_size] = b;
+        ++m_size;
+    }
+
+    /** Seven bits per byte, low bits first; the high bit is set on
+        all but the last byte. */
+    void Varint(boost::uint64_t value)
+    {
+        while (value >= 0x80)
+        {
+            Byte(static_cast<byte>(value | 0x80));
+            value >>= 7;
+        }
+        Byte(static_cast<byte>(value));
+    }
+
+    void Raw(const void* data, std::size_t size)
+    {
+        if (m_data)
+            std::memcpy(m_data + m_size, data, size);
+        m_size += size;
+    }
+
+    std::size_t Size() const
+    {
+        return m_size;
+    }
+
+private:
+    byte* m_data;
+
+    std::size_t m_size;
+};
+
+/** Reads the bytes written by DfpnDataEncoder. Throws a
+    BenzeneException instead of reading past the end of the data. */
+class DfpnDataDecoder
+{
+public:
+    DfpnDataDecoder(const byte* data, std::size_t size)
+        : m_data(data),
+          m_end(data + size)
+    { }
+
+    std::size_t Remaining() const
+    {
+        return static_cast<std::size_t>(m_end - m_data);
+    }
+
+    void Need(std::size_t size) const
+    {
+        if (Remaining() < size)
+            throw BenzeneException("DfpnData: truncated data!");
+    }
+
+    byte Byte()
+    {
+        Need(1);
+        return *m_data++;
+    }
+
+    boost::uint64_t Varint()
+    {
+        boost::uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7)
+        {
+            byte b = Byte();
+            value |= static_cast<boost::uint64_t>(b & 0x7f) << shift;
+            if ((b & 0x80) == 0)
+                return value;
+        }
+        throw BenzeneException("DfpnData: bad varint!");
+    }
+
+    /** Varint that must be less than max. */
+    std::size_t Varint(std::size_t max)
+    {
+        boost::uint64_t value = Varint();
+        if (value >= max)
+            throw BenzeneException("DfpnData: value out of range!");
+        return static_cast<std::size_t>(value);
+    }
+
+    void Raw(void* data, std::size_t size)
+    {
+        Need(size);
+        std::memcpy(data, m_data, size);
+        m_data += size;
+    }
+
+private:
+    const byte* m_data;
+
+    const byte* m_end;
+};
+
+std::size_t VarintSize(boost::uint64_t value)
+{
+    std::size_t size = 1;
+    for (; value >= 0x80; value >>= 7)
+        ++size;
+    return size;
+}
+
+/** The proof set is written either as a list of cells, each as the
+    distance from the previous one, or as a bitmap up to its last
+    cell, whichever is shorter. The first varint is the number of
+    cells or bytes times two, plus one for a bitmap. */
+void EncodeProofSet(DfpnDataEncoder& out, const bitset_t& proofSet)
+{
+    std::size_t listSize = 0;
+    std::size_t count = 0;
+    int last = 0;
+    for (BitsetIterator p(proofSet); p; ++p)
+    {
+        listSize += VarintSize(*p - last);
+        last = *p;
+        ++count;
+    }
+    std::size_t mapBytes = (count == 0) ? 0 : last / 8 + 1;
+    if (VarintSize(count * 2) + listSize 
+        <= VarintSize(mapBytes * 2 + 1) + mapBytes)
+    {
+        out.Varint(count * 2);
+        last = 0;
+        for (BitsetIterator p(proofSet); p; ++p)
+        {
+            out.Varint(*p - last);
+            last = *p;
+        }
+    }
+    else
+    {
+        out.Varint(mapBytes * 2 + 1);
+        for (std::size_t i = 0; i < mapBytes; ++i)
+        {
+            byte b = 0;
+            for (int j = 0; j < 8; ++j)
+                if (proofSet.test(i * 8 + j))
+                    b |= static_cast<byte>(1 << j);
+            out.Byte(b);
+        }
+    }
+}
+
+bitset_t DecodeProofSet(DfpnDataDecoder& in)
+{
+    bitset_t proofSet;
+    boost::uint64_t value = in.Varint();
+    std::size_t size = static_cast<std::size_t>(value / 2);
+    if (value % 2 == 0)
+    {
+        std::size_t cell = 0;
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            cell += in.Varint(BITSETSIZE - cell);
+            proofSet.set(cell);
+        }
+    }
+    else
+    {
+        if (size * 8 > BITSETSIZE)
+            throw BenzeneException("DfpnData: proof set too large!");
+        in.Need(size);
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            byte b = in.Byte();
+            for (int j = 0; j < 8; ++j)
+                if (b & (1 << j))
+                    proofSet.set(i * 8 + j);
+        }
+    }
+    return proofSet;
+}
+
+} // namespace
+
+/** Packed data is DFPN_DATA_FORMAT, varints for the bounds, best
+    move and work, the raw evaluation score, the proof set (see
+    EncodeProofSet()) and a varint count followed by a varint for each
+    child. Cells fit in one byte on boards up to 11x11. */
+std::size_t DfpnData::Encode(byte* data) const
+{
+    DfpnDataEncoder out(data);
+    out.Byte(DFPN_DATA_FORMAT);
+    out.Varint(m_bounds.phi);
+    out.Varint(m_bounds.delta);
+    out.Varint(m_bestMove);
+    out.Varint(m_work);
+    out.Raw(&m_evaluationScore, sizeof(m_evaluationScore));
+    EncodeProofSet(out, m_maxProofSet);
+    const std::vector<HexPoint>& moves = m_children.m_children;
+    out.Varint(moves.size());
+    for (std::size_t i = 0; i < moves.size(); ++i)
+        out.Varint(moves[i]);
+    return out.Size();
+}
+
 int DfpnData::PackedSize() const
 {
-    return sizeof(m_bounds)
-        + sizeof(m_bestMove)
-        + sizeof(m_work)
-        + sizeof(m_maxProofSet)
-        + sizeof(m_evaluationScore)
-        + sizeof(short) * (m_children.Size() + 1);
+    return static_cast<int>(Encode(0));
 }
 
 byte* DfpnData::Pack() const
 {
     static byte data[4096];
-    byte* off = data;
-    *reinterpret_cast<DfpnBounds*>(off) = m_bounds;
-    off += sizeof(m_bounds);
-    *reinterpret_cast<HexPoint*>(off) = m_bestMove;
-    off += sizeof(m_bestMove);
-    *reinterpret_cast<size_t*>(off) = m_work;
-    off += sizeof(m_work);
-    *reinterpret_cast<bitset_t*>(off) = m_maxProofSet;
-    off += sizeof(m_maxProofSet);
-    *reinterpret_cast<float*>(off) = m_evaluationScore;
-    off += sizeof(m_evaluationScore);
-    const std::vector<HexPoint>& moves = m_children.m_children;
-    for (std::size_t i = 0; i < moves.size(); ++i)
-    {
-        *reinterpret_cast<short*>(off) = static_cast<short>(moves[i]);
-        off += sizeof(short);
-    }
-    *reinterpret_cast<short*>(off) = static_cast<short>(INVALID_POINT);
-    off += sizeof(short);
-    if (off - data != PackedSize())
+    if (PackedSize() > static_cast<int>(sizeof(data)))
         throw BenzeneException("Bad size!");
+    Encode(data);
     return data;
 }
 
-void DfpnData::Unpack(const byte* data)
+void DfpnData::Unpack(const byte* data, int size)
+{
+    DfpnDataDecoder in(data, size);
+    if (in.Byte() != DFPN_DATA_FORMAT)
+        throw BenzeneException("DfpnData: unknown format!");
+    m_bounds.phi = static_cast<DfpnBoundType>(in.Varint());
+    m_bounds.delta = static_cast<DfpnBoundType>(in.Varint());
+    m_bestMove = static_cast<HexPoint>(in.Varint(FIRST_INVALID));
+    m_work = static_cast<size_t>(in.Varint());
+    in.Raw(&m_evaluationScore, sizeof(m_evaluationScore));
+    m_maxProofSet = DecodeProofSet(in);
+    // Each child takes at least one byte
+    std::vector<HexPoint> moves(in.Varint(in.Remaining() + 1));
+    for (std::size_t i = 0; i < moves.size(); ++i)
+        moves[i] = static_cast<HexPoint>(in.Varint(FIRST_INVALID));
+    m_children.SetChildren(moves);
+}
+
+void DfpnData::UnpackVersion2(const byte* data, std::size_t size)
 {
+    const std::size_t fixedSize = sizeof(m_bounds) + sizeof(m_bestMove)
+        + sizeof(m_work) + sizeof(m_maxProofSet) 
+        + sizeof(m_evaluationScore);
+    if (size < fixedSize)
+        throw BenzeneException("DfpnData: truncated data!");
+    const byte* end = data + size;
     m_bounds = *reinterpret_cast<const DfpnBounds*>(data);
     data += sizeof(m_bounds);
     m_bestMove = *reinterpret_cast<const HexPoint*>(data);
@@ -222,6 +495,8 @@ void DfpnData::Unpack(const byte* data)
     std::vector<HexPoint> moves;
     while (true)
     {
+        if (end - data < static_cast<std::ptrdiff_t>(sizeof(short)))
+            throw BenzeneException("DfpnData: truncated data!");
         short s = *reinterpret_cast<const short*>(data);
         data += sizeof(short);
         HexPoint p = static_cast<HexPoint>(s);
@@ -244,12 +519,199 @@ void DfpnData::Rotate(const ConstBoard& brd)
 
 //----------------------------------------------------------------------------
 
+DfpnHashTable::DfpnHashTable(int maxHash)
+    : m_maxHash(maxHash),
+      m_entry(new Entry[maxHash]),
+      m_numEntries(0),
+      m_gcThreshold(0.9f),
+      m_gcKeep(0.5f),
+      m_numLookups(0),
+      m_numFound(0),
+      m_numStores(0),
+      m_numReplaced(0),
+      m_numGC(0),
+      m_gcBackoff(0),
+      m_numFreed(0),
+      m_gcTime(0.0)
+{
+}
+
+DfpnHashTable::~DfpnHashTable()
+{
+}
+
+void DfpnHashTable::Clear()
+{
+    for (int i = 0; i < m_maxHash; ++i)
+        m_entry[i].m_data.Invalidate();
+    m_numEntries = 0;
+    m_gcBackoff = 0;
+}
+
+void DfpnHashTable::CopySettingsFrom(const DfpnHashTable& other)
+{
+    SetGCThreshold(other.GCThreshold());
+    SetGCKeep(other.GCKeep());
+}
+
+bool DfpnHashTable::Lookup(const SgHashCode& hash, DfpnData* data) const
+{
+    ++m_numLookups;
+    int index = static_cast<int>(hash.Hash(m_maxHash));
+    for (int i = 0; i < WINDOW; ++i)
+    {
+        const Entry& entry = m_entry[(index + i) % m_maxHash];
+        if (entry.m_data.IsValid() && entry.m_hash == hash)
+        {
+            *data = entry.m_data;
+            ++m_numFound;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool DfpnHashTable::IsWorseEntry(const DfpnData& a, const DfpnData& b)
+{
+    bool aSolved = a.m_bounds.IsSolved();
+    if (aSolved != b.m_bounds.IsSolved())
+        return !aSolved;
+    return a.m_work < b.m_work;
+}
+
+bool DfpnHashTable::Store(const SgHashCode& hash, const DfpnData& data)
+{
+    ++m_numStores;
+    if (m_gcThreshold > 0.0f && m_numEntries >= GCLimit())
+    {
+        if (m_gcBackoff > 0)
+            --m_gcBackoff;
+        else
+            CollectGarbage();
+    }
+    int index = static_cast<int>(hash.Hash(m_maxHash));
+    Entry* victim = 0;
+    for (int i = 0; i < WINDOW; ++i)
+    {
+        Entry& entry = m_entry[(index + i) % m_maxHash];
+        if (!entry.m_data.IsValid())
+        {
+            if (victim == 0 || victim->m_data.IsValid())
+                victim = &entry;
+        }
+        else if (entry.m_hash == hash)
+        {
+            entry.m_data = data;
+            return true;
+        }
+        else if (victim == 0 
+                 || (victim->m_data.IsValid()
+                     && IsWorseEntry(entry.m_data, victim->m_data)))
+            victim = &entry;
+    }
+    // Always store: the search reads back what it just wrote.
+    if (victim->m_data.IsValid())
+        ++m_numReplaced;
+    else
+        ++m_numEntries;
+    victim->m_hash = hash;
+    victim->m_data = data;
+    return true;
+}
+
+std::size_t DfpnHashTable::GCLimit() const
+{
+    return std::max(static_cast<std::size_t>(1),
+                    static_cast<std::size_t>(m_gcThreshold 
+                                             * float(m_maxHash)));
+}
+
+void DfpnHashTable::CollectGarbage()
+{
+    SgTimer timer;
+    std::size_t keep = static_cast<std::size_t>(m_gcKeep * float(m_maxHash));
+    if (m_numEntries <= keep)
+        return;
+    std::size_t toFree = m_numEntries - keep;
+    std::vector<std::size_t> work;
+    work.reserve(m_numEntries);
+    for (int i = 0; i < m_maxHash; ++i)
+    {
+        const DfpnData& data = m_entry[i].m_data;
+        if (data.IsValid() && !data.m_bounds.IsSolved())
+            work.push_back(data.m_work);
+    }
+    std::size_t freed = 0;
+    if (!work.empty())
+    {
+        toFree = std::min(toFree, work.size());
+        // Entries with less work than the cutoff are freed; entries
+        // with exactly the cutoff are freed until toFree is reached.
+        std::nth_element(work.begin(), work.begin() + (toFree - 1), 
+                         work.end());
+        std::size_t cutoff = work[toFree - 1];
+        std::size_t numBelow = 0;
+        for (std::size_t i = 0; i < work.size(); ++i)
+            if (work[i] < cutoff)
+                ++numBelow;
+        std::size_t freeAtCutoff = toFree - numBelow;
+        for (int i = 0; i < m_maxHash; ++i)
+        {
+            DfpnData& data = m_entry[i].m_data;
+            if (!data.IsValid() || data.m_bounds.IsSolved()
+                || data.m_work > cutoff)
+                continue;
+            if (data.m_work == cutoff)
+            {
+                if (freeAtCutoff == 0)
+                    continue;
+                --freeAtCutoff;
+            }
+            data.Invalidate();
+            ++freed;
+        }
+    }
+    m_numEntries -= freed;
+    m_numFreed += freed;
+    ++m_numGC;
+    if (m_numEntries > keep)
+    {
+        std::size_t limit = GCLimit();
+        m_gcBackoff = (limit > keep) ? limit - keep : 1;
+        LogFine() << "DfpnHashTable GC: mostly solved entries, skipping "
+                  << m_gcBackoff << " stores\n";
+    }
+    m_gcTime += timer.GetTime();
+    LogFine() << "DfpnHashTable GC: freed " << freed << " entries, "
+              << m_numEntries << " left (" << timer.GetTime() << "s)\n";
+}
+
+std::string DfpnHashTable::Statistics() const
+{
+    std::ostringstream os;
+    os << "DfpnHashTable statistics\n"
+       << SgWriteLabel("Slots") << m_maxHash << '\n'
+       << SgWriteLabel("Entries") << m_numEntries << " ("
+       << (double(m_numEntries) * 100.0 / double(m_maxHash)) << "%)\n"
+       << SgWriteLabel("Lookups") << m_numLookups << '\n'
+       << SgWriteLabel("Found") << m_numFound << '\n'
+       << SgWriteLabel("Stores") << m_numStores << '\n'
+       << SgWriteLabel("Replaced") << m_numReplaced << '\n'
+       << SgWriteLabel("GC passes") << m_numGC << '\n'
+       << SgWriteLabel("GC freed") << m_numFreed << '\n'
+       << SgWriteLabel("GC time") << m_gcTime << '\n';
+    return os.str();
+}
+
+//----------------------------------------------------------------------------
+
 DfpnSolver::DfpnSolver()
     : m_positions(0),
       m_useGuiFx(false),
       m_timelimit(0.0),
       m_wideningBase(1),
       m_wideningFactor(0.25f),
+      m_thresholdEpsilon(0.0f),
       m_guiFx(),
       m_allEvaluation(-2.5, 2.0, 45),
       m_allSolvedEvaluation(-2.5, 2.0, 45),
@@ -270,6 +732,9 @@ void DfpnSolver::PrintStatistics(HexColor winner,
        << SgWriteLabel("MID calls") << m_numMIDcalls << '\n'
        << SgWriteLabel("VC builds") << m_numVCbuilds << '\n'
        << SgWriteLabel("Terminal") << m_numTerminal << '\n'
+       << SgWriteLabel("Re-expansions") << m_numReexpansions
+       << " (" << (double(m_numReexpansions) * 100.0
+                   / double(m_numMIDcalls)) << "%)\n"
        << SgWriteLabel("Work") << m_numMIDcalls + m_numTerminal << '\n'
        << SgWriteLabel("Wasted Work") << m_totalWastedWork
        << " (" << (double(m_totalWastedWork) * 100.0 
@@ -293,13 +758,29 @@ void DfpnSolver::PrintStatistics(HexColor winner,
     os << '\n'
        << SgWriteLabel("Winner") << winner << '\n'
        << SgWriteLabel("PV") << HexPointUtil::ToString(pv) << '\n';
-    if (m_positions->Database())
-        os << '\n' << m_positions->Database()->GetStatistics().Write() << '\n';
-    if (m_positions->HashTable())
-        os << '\n' << *m_positions->HashTable() << '\n';
+    {
+        boost::scoped_ptr<boost::mutex::scoped_lock> lock;
+        if (m_positions->DatabaseMutex())
+            lock.reset(new boost::mutex::scoped_lock
+                       (*m_positions->DatabaseMutex()));
+        if (m_positions->Database())
+            os << '\n' << m_positions->Database()->GetStatistics().Write() 
+               << '\n';
+        if (m_positions->HashTable())
+            os << '\n' << *m_positions->HashTable() << '\n';
+    }
     LogInfo() << os.str();
 }
 
+void DfpnSolver::CopySettingsFrom(const DfpnSolver& other)
+{
+    m_useGuiFx = other.m_useGuiFx;
+    m_timelimit = other.m_timelimit;
+    m_wideningBase = other.m_wideningBase;
+    m_wideningFactor = other.m_wideningFactor;
+    m_thresholdEpsilon = other.m_thresholdEpsilon;
+}
+
 std::string DfpnSolver::EvaluationInfo() const
 {
     std::ostringstream os;
@@ -330,6 +811,7 @@ HexColor DfpnSolver::StartSearch(const HexState& state, HexBoard& board,
     m_numTerminal = 0;
     m_numMIDcalls = 0;
     m_numVCbuilds = 0;
+    m_numReexpansions = 0;
     m_totalWastedWork = 0;
     m_prunedSiblingStats.Clear();
     m_moveOrderingPercent.Clear();
@@ -352,7 +834,7 @@ HexColor DfpnSolver::StartSearch(const HexState& state, HexBoard& board,
         LogInfo() << "Already solved!\n";
         HexColor w = data.m_bounds.IsWinning() 
             ? m_state->ToPlay() : !m_state->ToPlay();
-        SolverDBUtil::GetVariation(*m_state, *m_positions, pv);
+        GetVariation(*m_state, pv);
         LogInfo() << w << " wins!\n";
         LogInfo() << "PV: " << HexPointUtil::ToString(pv) << '\n';
         return w;
@@ -363,7 +845,7 @@ HexColor DfpnSolver::StartSearch(const HexState& state, HexBoard& board,
     MID(maxBounds, history);
     m_timer.Stop();
 
-    SolverDBUtil::GetVariation(*m_state, *m_positions, pv);
+    GetVariation(*m_state, pv);
     HexColor winner = EMPTY;
     if (TTRead(*m_state, data) && data.m_bounds.IsSolved())
         winner = data.m_bounds.IsWinning() 
@@ -441,6 +923,7 @@ size_t DfpnSolver::MID(const DfpnBounds& maxBounds, DfpnHistory& history)
                 // return here without doing anything: the caller will
                 // now update to this new info and carry on.
                 return 0;
+            ++m_numReexpansions;
         }
         else
         {
@@ -533,7 +1016,8 @@ size_t DfpnSolver::MID(const DfpnBounds& maxBounds, DfpnHistory& history)
         DfpnBounds childMaxBounds;
         childMaxBounds.phi = maxBounds.delta 
             - (currentBounds.delta - childBounds.phi);
-        childMaxBounds.delta = std::min(maxBounds.phi, delta2 + 1);
+        childMaxBounds.delta = std::min(maxBounds.phi, 
+                                        ChildDeltaThreshold(delta2));
         BenzeneAssert(childMaxBounds.GreaterThan(childBounds));
         if (delta2 != DfpnBounds::INFTY)
             m_deltaIncrease.Add(float(childMaxBounds.delta-childBounds.delta));
@@ -743,6 +1227,21 @@ void DfpnSolver::SelectChild(std::size_t& bestIndex, DfpnBoundType& delta2,
     BenzeneAssert(delta1 < DfpnBounds::INFTY);
 }
 
+DfpnBoundType DfpnSolver::ChildDeltaThreshold(DfpnBoundType delta2) const
+{
+    if (delta2 == DfpnBounds::INFTY)
+        return DfpnBounds::INFTY;
+    DfpnBoundType threshold = delta2 + 1;
+    if (m_thresholdEpsilon > 0.0f)
+    {
+        double scaled = std::ceil(double(delta2) 
+                                  * (1.0 + double(m_thresholdEpsilon)));
+        scaled = std::min(scaled, double(DfpnBounds::INFTY));
+        threshold = std::max(threshold, DfpnBoundType(scaled));
+    }
+    return threshold;
+}
+
 void DfpnSolver::UpdateBounds(DfpnBounds& bounds, 
                               const std::vector<DfpnData>& childData,
                               size_t maxChildIndex) const
@@ -789,6 +1288,11 @@ void DfpnSolver::TTWrite(const HexState& state, const DfpnData& data)
     m_positions->Put(state, data);
 }
 
+void DfpnSolver::GetVariation(const HexState& state, PointSequence& pv)
+{
+    SolverDBUtil::GetVariation(state, *m_positions, pv);
+}
+
 //----------------------------------------------------------------------------
 
 void DfpnSolver::PropagateBackwards(const Game& game, DfpnStates& pos)
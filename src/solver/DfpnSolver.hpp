@@ -6,7 +6,6 @@
 #define SOLVERDFPN_HPP
 
 #include "SgSystem.h"
-#include "SgHashTable.h"
 #include "SgStatistics.h"
 #include "SgTimer.h"
 
@@ -18,6 +17,7 @@
 #include "SolverDB.hpp"
 
 #include <limits>
+#include <boost/scoped_array.hpp>
 #include <boost/scoped_ptr.hpp>
 
 _BEGIN_BENZENE_NAMESPACE_
@@ -238,14 +238,22 @@ public:
 
     byte* Pack() const;
 
-    void Unpack(const byte* data);
+    void Unpack(const byte* data, int size);
 
     void Rotate(const ConstBoard& brd);
 
     // @}
 
+    /** Unpacks data in the fixed size encoding of version 2
+        databases. */
+    void UnpackVersion2(const byte* data, std::size_t size);
+
 private:
     bool m_isValid;
+
+    /** Writes the packed data to data and returns its size; only
+        returns the size if data is 0. */
+    std::size_t Encode(byte* data) const;
 };
 
 
@@ -394,9 +402,180 @@ public:
 //----------------------------------------------------------------------------
 
 /** Hashtable used in dfpn search.  
+
+    Each state maps to a small window of consecutive slots. A store
+    uses a free slot in the window or otherwise replaces the entry
+    with the least work, preferring unsolved entries.
+
+    Once the number of occupied slots reaches GCThreshold() of the
+    table, a garbage collection pass frees the unsolved entries with
+    the least work until only GCKeep() of the table is occupied
+    (SmallTreeGC). Solved states and large subtrees survive, so a
+    long search keeps its most expensive results when the table
+    fills up. If a pass cannot get down to GCKeep(), because most
+    entries are solved, garbage collection is skipped for as many
+    stores as it takes to fill the table from GCKeep() to
+    GCThreshold(), so that passes that free little stay rare.
     @ingroup dfpn
 */
-typedef SgHashTable<DfpnData> DfpnHashTable;
+class DfpnHashTable
+{
+public:
+    /** Creates a table with maxHash slots. */
+    explicit DfpnHashTable(int maxHash);
+
+    ~DfpnHashTable();
+
+    /** Removes all entries. GC statistics are kept. */
+    void Clear();
+
+    /** Returns true if state was found and copies its data. */
+    bool Lookup(const SgHashCode& hash, DfpnData* data) const;
+
+    /** Stores data for state; may trigger garbage collection.
+        Always succeeds. */
+    bool Store(const SgHashCode& hash, const DfpnData& data);
+
+    /** Number of slots. */
+    int MaxHash() const;
+
+    /** Number of occupied slots. */
+    std::size_t NumEntries() const;
+
+    /** Bytes used by the slots. */
+    std::size_t MemoryUsed() const;
+
+    /** Bytes used by one slot. */
+    static std::size_t SlotSize();
+
+    /** Frees unsolved entries with the least work until at most
+        GCKeep() of the table is occupied. */
+    void CollectGarbage();
+
+    /** Returns table and garbage collection statistics. */
+    std::string Statistics() const;
+
+    /** Copies the GC parameters of other. */
+    void CopySettingsFrom(const DfpnHashTable& other);
+
+    /** @name Parameters */
+    // @{
+
+    /** Fraction of occupied slots that triggers garbage collection.
+        Set to 0 to disable garbage collection. */
+    float GCThreshold() const;
+
+    /** See GCThreshold() */
+    void SetGCThreshold(float threshold);
+
+    /** Fraction of slots left occupied after garbage collection.
+        Must be less than GCThreshold(). */
+    float GCKeep() const;
+
+    /** See GCKeep() */
+    void SetGCKeep(float keep);
+
+    // @}
+
+private:
+    struct Entry
+    {
+        SgHashCode m_hash;
+
+        DfpnData m_data;
+    };
+
+    /** Number of consecutive slots a state may occupy. */
+    static const int WINDOW = 4;
+
+    int m_maxHash;
+
+    boost::scoped_array<Entry> m_entry;
+
+    std::size_t m_numEntries;
+
+    float m_gcThreshold;
+
+    float m_gcKeep;
+
+    mutable std::size_t m_numLookups;
+
+    mutable std::size_t m_numFound;
+
+    std::size_t m_numStores;
+
+    std::size_t m_numReplaced;
+
+    std::size_t m_numGC;
+
+    /** Stores left before garbage collection may run again, after a
+        pass that could not free enough entries. */
+    std::size_t m_gcBackoff;
+
+    std::size_t m_numFreed;
+
+    double m_gcTime;
+
+    /** Number of slots that triggers garbage collection. */
+    std::size_t GCLimit() const;
+
+    /** Returns true if a is a better eviction victim than b. */
+    static bool IsWorseEntry(const DfpnData& a, const DfpnData& b);
+
+    /** Not implemented. */
+    DfpnHashTable(const DfpnHashTable&);
+
+    /** Not implemented. */
+    DfpnHashTable& operator=(const DfpnHashTable&);
+};
+
+inline int DfpnHashTable::MaxHash() const
+{
+    return m_maxHash;
+}
+
+inline std::size_t DfpnHashTable::NumEntries() const
+{
+    return m_numEntries;
+}
+
+inline std::size_t DfpnHashTable::MemoryUsed() const
+{
+    return m_maxHash * SlotSize();
+}
+
+inline std::size_t DfpnHashTable::SlotSize()
+{
+    return sizeof(Entry);
+}
+
+inline float DfpnHashTable::GCThreshold() const
+{
+    return m_gcThreshold;
+}
+
+inline void DfpnHashTable::SetGCThreshold(float threshold)
+{
+    m_gcThreshold = threshold;
+    m_gcBackoff = 0;
+}
+
+inline float DfpnHashTable::GCKeep() const
+{
+    return m_gcKeep;
+}
+
+inline void DfpnHashTable::SetGCKeep(float keep)
+{
+    m_gcKeep = keep;
+    m_gcBackoff = 0;
+}
+
+inline std::ostream& operator<<(std::ostream& os, const DfpnHashTable& tt)
+{
+    os << tt.Statistics();
+    return os;
+}
 
 /** Database of solved positions. 
     @ingroup dfpn
@@ -406,9 +585,19 @@ class DfpnDB : public StateDB<DfpnData>
 public:
     static const std::string DFPN_DB_VERSION;
 
+    static const std::string DFPN_DB_VERSION_2;
+
+    /** States written behind at most; see StateDB. */
+    static const std::size_t WRITE_QUEUE_SIZE = 1 << 16;
+
     DfpnDB(const std::string& filename)
-        : StateDB<DfpnData>(filename, DFPN_DB_VERSION)
+        : StateDB<DfpnData>(filename, DFPN_DB_VERSION, WRITE_QUEUE_SIZE)
     { }
+
+    /** Copies a version 2 database into a new database of the current
+        version. Returns the number of states copied. */
+    static std::size_t ConvertVersion2(const std::string& from,
+                                       const std::string& to);
 };
 
 /** Combines a hashtable with a position db.
@@ -449,6 +638,12 @@ public:
         is not in position set. */
     void PropagateBackwards(const Game& game, DfpnStates& pos);
 
+    /** Number of calls to MID() in the last search. */
+    std::size_t NumMIDcalls() const;
+
+    /** Copies the parameters of other. */
+    void CopySettingsFrom(const DfpnSolver& other);
+
     //------------------------------------------------------------------------
 
     /** @name Parameters */
@@ -485,6 +680,17 @@ public:
     /** See WideningFactor() */
     void SetWideningFactor(float wideningFactor);
 
+    /** Epsilon of the 1+epsilon threshold scheme (Pawlewicz and
+        Lew). The best child is searched until its delta exceeds
+        (1+epsilon) times the second smallest delta instead of the
+        second smallest delta plus one, so the search stays in a
+        subtree longer and re-expands siblings less often.
+        0 gives the classic dfpn threshold. */
+    float ThresholdEpsilon() const;
+
+    /** See ThresholdEpsilon() */
+    void SetThresholdEpsilon(float epsilon);
+
     // @}
 
 private:
@@ -550,6 +756,9 @@ private:
     /** See WideningFactor() */
     float m_wideningFactor;
 
+    /** See ThresholdEpsilon() */
+    float m_thresholdEpsilon;
+
     /** Number of calls to CheckAbort() before we check the timer.
         This is to avoid expensive calls to SgTime::Get(). Try to scale
         this so that it is checked twice a second. */
@@ -565,6 +774,9 @@ private:
 
     size_t m_numVCbuilds;
 
+    /** Number of MID() calls on states that were already expanded. */
+    size_t m_numReexpansions;
+
     SgStatisticsExt<float, std::size_t> m_prunedSiblingStats;
 
     SgStatisticsExt<float, std::size_t> m_moveOrderingPercent;
@@ -591,6 +803,10 @@ private:
                      const std::vector<DfpnData>& childrenDfpnBounds,
                      size_t maxChildIndex) const;
 
+    /** Delta threshold for the best child given the second
+        smallest delta of its siblings. See ThresholdEpsilon(). */
+    DfpnBoundType ChildDeltaThreshold(DfpnBoundType delta2) const;
+
     void UpdateBounds(DfpnBounds& bounds, 
                       const std::vector<DfpnData>& childBounds,
                       size_t maxChildIndex) const;
@@ -604,6 +820,8 @@ private:
 
     void TTWrite(const HexState& state, const DfpnData& data);
 
+    void GetVariation(const HexState& state, PointSequence& pv);
+
     void DumpGuiFx(const std::vector<HexPoint>& children,
                    const std::vector<DfpnBounds>& childBounds) const;
 
@@ -626,6 +844,11 @@ inline void DfpnSolver::AddListener(DfpnListener& listener)
         m_listener.push_back(&listener);
 }
 
+inline std::size_t DfpnSolver::NumMIDcalls() const
+{
+    return m_numMIDcalls;
+}
+
 inline bool DfpnSolver::UseGuiFx() const
 {
     return m_useGuiFx;
@@ -666,6 +889,16 @@ inline void DfpnSolver::SetWideningFactor(float wideningFactor)
     m_wideningFactor = wideningFactor;
 }
 
+inline float DfpnSolver::ThresholdEpsilon() const
+{
+    return m_thresholdEpsilon;
+}
+
+inline void DfpnSolver::SetThresholdEpsilon(float epsilon)
+{
+    m_thresholdEpsilon = epsilon;
+}
+
 //----------------------------------------------------------------------------
 
 _END_BENZENE_NAMESPACE_
@@ -111,6 +111,10 @@ void DfsCommands::CmdParamSolver(HtpCommand& cmd)
             << m_solver.UseGuiFx() << '\n'
             << "[string] move_ordering "
             << m_solver.MoveOrdering() << '\n' // FIXME: PRINT NICELY!!
+            << "[string] split_depth "
+            << m_solver.SplitDepth() << '\n'
+            << "[string] threads "
+            << m_solver.NumThreads() << '\n'
             << "[string] tt_bits "  
             << ((m_tt.get() == 0) ? 0 : log2(m_tt->MaxHash())) << '\n'
             << "[string] update_depth "  
@@ -129,6 +133,10 @@ void DfsCommands::CmdParamSolver(HtpCommand& cmd)
             m_solver.SetUseGuiFx(cmd.Arg<bool>(1));
         else if (name == "move_ordering")
             m_solver.SetMoveOrdering(cmd.ArgMinMax<int>(1, 0, 7));
+        else if (name == "split_depth")
+            m_solver.SetSplitDepth(cmd.ArgMin<int>(1, 1));
+        else if (name == "threads")
+            m_solver.SetNumThreads(cmd.ArgMin<int>(1, 1));
 	else if (name == "tt_bits")
 	{
 	    int bits = cmd.ArgMin<int>(1, 0);
@@ -300,13 +308,14 @@ void DfsCommands::CmdGetState(HtpCommand& cmd)
     }
 }
 
-/** Prints database statistics. */
+/** Prints database statistics, including the write-behind queue. */
 void DfsCommands::CmdDBStat(HtpCommand& cmd)
 {
     cmd.CheckNuArg(0);
     if (m_db.get() == 0)
         throw HtpFailure("No open database!\n");
-    cmd << m_db->BDBStatistics();
+    cmd << m_db->GetStatistics().Write() << '\n'
+        << m_db->BDBStatistics();
 }
 
 /** Prints histogram of last search. */
@@ -2,6 +2,7 @@
 /** @file DfsData.cpp */
 //----------------------------------------------------------------------------
 
+#include "BenzeneException.hpp"
 #include "Misc.hpp"
 #include "DfsData.hpp"
 #include "BoardUtil.hpp"
@@ -44,8 +45,10 @@ byte* DfsData::Pack() const
     return data;
 }
 
-void DfsData::Unpack(const byte* data)
+void DfsData::Unpack(const byte* data, int size)
 {
+    if (size < PackedSize())
+        throw BenzeneException("DfsData: truncated data!");
     m_isValid = true;
 
     int index = 0;
@@ -68,7 +68,7 @@ struct DfsData
 
     byte* Pack() const;
 
-    void Unpack(const byte* t);
+    void Unpack(const byte* t, int size);
 
     void Rotate(const ConstBoard& brd);
 
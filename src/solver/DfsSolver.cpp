@@ -17,10 +17,14 @@
 #include "HexBoard.hpp"
 #include "ProofUtil.hpp"
 #include "Resistance.hpp"
+#include "TaskScheduler.hpp"
 #include "VCSet.hpp"
 #include "VCUtil.hpp"
 
+#include <algorithm>
+#include <vector>
 #include <boost/scoped_ptr.hpp>
+#include <boost/shared_ptr.hpp>
 
 using namespace benzene;
 
@@ -33,6 +37,224 @@ const std::string DfsDB::DFS_DB_VERSION("BENZENE_DFS_DB_VER_0001");
 
 //----------------------------------------------------------------------------
 
+struct DfsSolver::SplitTask
+{
+    /** Move to play; INVALID_POINT for a side of a decomposition. */
+    HexPoint move;
+
+    /** Opponent stones filled in to isolate a side of a
+        decomposition. */
+    bitset_t fill;
+
+    SplitTask(HexPoint m, const bitset_t& f);
+};
+
+DfsSolver::SplitTask::SplitTask(HexPoint m, const bitset_t& f)
+    : move(m),
+      fill(f)
+{
+}
+
+struct DfsSolver::SplitResult
+{
+    /** False if the task was cancelled or aborted. */
+    bool solved;
+
+    /** True if the player to move in the split state wins. */
+    bool win;
+
+    DfsSolutionSet solution;
+
+    SplitResult();
+};
+
+DfsSolver::SplitResult::SplitResult()
+    : solved(false),
+      win(false),
+      solution()
+{
+}
+
+class DfsSolver::SplitWorker
+{
+public:
+    SplitWorker(DfsSolver& solver, const std::vector<SplitTask>& tasks,
+                const PointSequence& variation);
+
+    SplitResult operator()(const std::size_t& index);
+
+private:
+    DfsSolver* m_solver;
+
+    const std::vector<SplitTask>* m_tasks;
+
+    PointSequence m_variation;
+};
+
+DfsSolver::SplitWorker::SplitWorker(DfsSolver& solver, 
+                                    const std::vector<SplitTask>& tasks,
+                                    const PointSequence& variation)
+    : m_solver(&solver),
+      m_tasks(&tasks),
+      m_variation(variation)
+{
+}
+
+DfsSolver::SplitResult 
+DfsSolver::SplitWorker::operator()(const std::size_t& index)
+{
+    SplitResult result;
+    if (!m_solver->Cancelled())
+        m_solver->SolveSplitTask((*m_tasks)[index], m_variation, result);
+    return result;
+}
+
+struct DfsSolver::ChildEval
+{
+    /** False if evaluation was cancelled because a sibling is a
+        win. */
+    bool evaluated;
+
+    /** True if the child is determined by its VCs. */
+    bool terminal;
+
+    /** Result of a terminal child. */
+    DfsData data;
+
+    /** Proof of a terminal child. */
+    bitset_t proof;
+
+    /** True if the player that moved into the child has a winning
+        semi. */
+    bool winning_semi_exists;
+
+    /** Size of the opponent's mustplay in the child. */
+    double mustplay_size;
+
+    /** Cells dead or captured for the player to move in the parent
+        state, as found in the child. Backed up as dominated by the
+        child's move when the child is evaluated on a worker
+        board. */
+    bitset_t dominated;
+
+    ChildEval();
+};
+
+DfsSolver::ChildEval::ChildEval()
+    : evaluated(false),
+      terminal(false),
+      data(),
+      proof(),
+      winning_semi_exists(false),
+      mustplay_size(0.0),
+      dominated()
+{
+}
+
+class DfsSolver::ChildEvalWorker
+{
+public:
+    ChildEvalWorker(DfsSolver& solver, const std::vector<HexPoint>& cells);
+
+    ChildEval operator()(const std::size_t& index);
+
+private:
+    DfsSolver* m_solver;
+
+    const std::vector<HexPoint>* m_cells;
+};
+
+DfsSolver::ChildEvalWorker::ChildEvalWorker(DfsSolver& solver, 
+                                            const std::vector<HexPoint>& cells)
+    : m_solver(&solver),
+      m_cells(&cells)
+{
+}
+
+DfsSolver::ChildEval 
+DfsSolver::ChildEvalWorker::operator()(const std::size_t& index)
+{
+    ChildEval eval;
+    if (!m_solver->Cancelled())
+    {
+        m_solver->EvaluateChild((*m_cells)[index], eval);
+        if (eval.terminal && !eval.data.m_win)
+            m_solver->m_cancel.back().Cancel();
+    }
+    return eval;
+}
+
+//----------------------------------------------------------------------------
+
+/** Direct-mapped table of the resistance scores of all cells,
+    keyed by the hash of the state. */
+class DfsSolver::ResistCache
+{
+public:
+    ResistCache();
+
+    void Clear();
+
+    /** Copies the scores of the state into scores, which must hold
+        BITSETSIZE values. Returns false if the state is not
+        cached. */
+    bool Get(const SgHashCode& hash, HexEval* scores) const;
+
+    void Put(const SgHashCode& hash, const HexEval* scores);
+
+private:
+    static const int SIZE = 1024;
+
+    struct Entry
+    {
+        bool valid;
+
+        SgHashCode hash;
+
+        HexEval scores[BITSETSIZE];
+    };
+
+    mutable boost::mutex m_mutex;
+
+    std::vector<Entry> m_entries;
+};
+
+DfsSolver::ResistCache::ResistCache()
+    : m_entries(SIZE)
+{
+    Clear();
+}
+
+void DfsSolver::ResistCache::Clear()
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    for (std::size_t i = 0; i < m_entries.size(); ++i)
+        m_entries[i].valid = false;
+}
+
+bool DfsSolver::ResistCache::Get(const SgHashCode& hash, 
+                                 HexEval* scores) const
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    const Entry& entry = m_entries[hash.Hash(SIZE)];
+    if (!entry.valid || entry.hash != hash)
+        return false;
+    std::copy(entry.scores, entry.scores + BITSETSIZE, scores);
+    return true;
+}
+
+void DfsSolver::ResistCache::Put(const SgHashCode& hash, 
+                                 const HexEval* scores)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    Entry& entry = m_entries[hash.Hash(SIZE)];
+    entry.valid = true;
+    entry.hash = hash;
+    std::copy(scores, scores + BITSETSIZE, entry.scores);
+}
+
+//----------------------------------------------------------------------------
+
 DfsSolver::DfsSolver()
     : m_positions(0),
       m_use_decompositions(true),
@@ -42,7 +264,12 @@ DfsSolver::DfsSolver()
       m_use_guifx(false),
       m_move_ordering(DfsMoveOrderFlags::WITH_MUSTPLAY 
                       | DfsMoveOrderFlags::WITH_RESIST 
-                      | DfsMoveOrderFlags::FROM_CENTER)
+                      | DfsMoveOrderFlags::FROM_CENTER),
+      m_numThreads(1),
+      m_splitDepth(2),
+      m_splitLevel(0),
+      m_positionsMutex(0),
+      m_cancel()
 {
 }
 
@@ -67,6 +294,10 @@ HexColor DfsSolver::Solve(const HexState& state, HexBoard& brd,
     m_statistics = GlobalStatistics();
     m_state.reset(new HexState(state));
     m_workBrd = &brd;
+    if (!m_resistCache)
+        m_resistCache.reset(new ResistCache());
+    else
+        m_resistCache->Clear();
 
     // DfsSolver currently cannot handle permanently inferior cells.
     if (m_workBrd->ICE().FindPermanentlyInferior())
@@ -104,11 +335,19 @@ HexColor DfsSolver::Solve(const HexState& state, HexBoard& brd,
 
 bool DfsSolver::CheckTransposition(DfsData& data) const
 {
+    if (m_positionsMutex)
+    {
+        boost::mutex::scoped_lock lock(*m_positionsMutex);
+        return m_positions->Get(*m_state, data);
+    }
     return m_positions->Get(*m_state, data);
 }
 
 void DfsSolver::StoreState(const DfsData& data, const bitset_t& proof)
 {
+    boost::scoped_ptr<boost::mutex::scoped_lock> lock;
+    if (m_positionsMutex)
+        lock.reset(new boost::mutex::scoped_lock(*m_positionsMutex));
     m_positions->Put(*m_state, data);
     const SolverDBParameters& param = m_positions->Parameters();
     if (m_state->Position().NumStones() <= param.m_transStones)
@@ -127,14 +366,17 @@ void DfsSolver::StoreState(const DfsData& data, const bitset_t& proof)
 
 //----------------------------------------------------------------------------
 
-/** Checks timelimit and SgUserAbort(). Sets m_aborted if necessary,
+/** Checks timelimit and SgUserAbort(), and for workers whether a
+    sibling subtree was proven a win. Sets m_aborted if necessary,
     aborting the search. Returns true if search should be aborted,
     false otherwise. */
 bool DfsSolver::CheckAbort()
 {
     if (!m_aborted)
     {
-        if (SgUserAbort()) 
+        if (Cancelled())
+            m_aborted = true;
+        else if (SgUserAbort()) 
         {
             m_aborted = true;
             LogInfo() << "DfsSolver::CheckAbort(): Abort flag!\n";
@@ -148,6 +390,15 @@ bool DfsSolver::CheckAbort()
     return m_aborted;
 }
 
+/** Returns true if a split above this solver was cancelled. */
+bool DfsSolver::Cancelled() const
+{
+    for (std::size_t i = 0; i < m_cancel.size(); ++i)
+        if (m_cancel[i].IsCancelled())
+            return true;
+    return false;
+}
+
 /** Returns true if node is terminal. Fills in data if terminal.
     Data's bestmove field is not specified here.*/
 bool DfsSolver::HandleTerminalNode(DfsData& data, bitset_t& proof) const
@@ -233,7 +484,8 @@ bool DfsSolver::SolveState(PointSequence& variation, DfsSolutionSet& solution)
     HandleProof(variation, winning_state, solution);
 
     // Dump histogram every 1M moves
-    if ((m_statistics.played / 1000000) > (m_last_histogram_dump)) 
+    if (m_splitLevel == 0
+        && (m_statistics.played / 1000000) > (m_last_histogram_dump)) 
     {
         LogInfo() << m_histogram.Write() << '\n';
         m_last_histogram_dump = m_statistics.played / 1000000;
@@ -266,42 +518,44 @@ bool DfsSolver::SolveDecomposition(PointSequence& variation,
             << "Side0:" << m_workBrd->Write(carrier[0]) << '\n'
             << "Side1:" << m_workBrd->Write(carrier[1]) << '\n';
         
-    DfsData data;
-    DfsSolutionSet dsolution[2];
+    bitset_t fill[2];
     for (int s = 0; s < 2; ++s) 
-    {
-        bool win = false;
-        m_workBrd->PlayStones(!color, 
-                              carrier[s^1] & m_workBrd->Const().GetCells(), 
-                              color);
+        fill[s] = carrier[s^1] & m_workBrd->Const().GetCells();
 
-        bitset_t proof;
-        if (HandleTerminalNode(data, proof)) 
-        {
-            win = data.m_win;
-            dsolution[s].proof = proof;
-            dsolution[s].m_numMoves = data.m_numMoves;
-            dsolution[s].pv.clear();
-            dsolution[s].stats.expanded_states = 0;
-            dsolution[s].stats.explored_states = 1;
-            dsolution[s].stats.minimal_explored = 1;
-            dsolution[s].stats.total_states = 1;
-        } 
-        else 
-            win = SolveInteriorState(variation, dsolution[s]);
-
-        m_workBrd->UndoMove();
-
-        if (win) 
+    int winner = -1;
+    DfsSolutionSet dsolution[2];
+    if (CanSplit(2))
+    {
+        std::vector<SplitTask> tasks;
+        for (int s = 0; s < 2; ++s)
+            tasks.push_back(SplitTask(INVALID_POINT, fill[s]));
+        std::vector<SplitResult> results;
+        RunSplit(variation, tasks, results);
+        if (m_aborted)
+            return false;
+        for (int s = 0; s < 2; ++s)
         {
-            solution.pv = dsolution[s].pv;
-            solution.proof = dsolution[s].proof;
-            solution.m_numMoves = dsolution[s].m_numMoves;
-            solution.stats += dsolution[s].stats;
-            solution.stats.decompositions_won++;
-            return true;
-        } 
+            dsolution[s] = results[s].solution;
+            if (winner == -1 && results[s].solved && results[s].win)
+                winner = s;
+        }
     }
+    else
+    {
+        for (int s = 0; winner == -1 && s < 2; ++s) 
+            if (SolveDecompositionSide(variation, fill[s], dsolution[s]))
+                winner = s;
+    }
+
+    if (winner != -1) 
+    {
+        solution.pv = dsolution[winner].pv;
+        solution.proof = dsolution[winner].proof;
+        solution.m_numMoves = dsolution[winner].m_numMoves;
+        solution.stats += dsolution[winner].stats;
+        solution.stats.decompositions_won++;
+        return true;
+    } 
         
     // Combine the two losing proofs
     solution.pv = dsolution[0].pv;
@@ -316,6 +570,36 @@ bool DfsSolver::SolveDecomposition(PointSequence& variation,
     return false;
 }
 
+/** Solves one side of a decomposition by filling the other side with
+    opponent stones. */
+bool DfsSolver::SolveDecompositionSide(PointSequence& variation,
+                                       const bitset_t& fill,
+                                       DfsSolutionSet& solution)
+{
+    HexColor color = m_state->ToPlay();
+    bool win = false;
+    m_workBrd->PlayStones(!color, fill, color);
+
+    DfsData data;
+    bitset_t proof;
+    if (HandleTerminalNode(data, proof)) 
+    {
+        win = data.m_win;
+        solution.proof = proof;
+        solution.m_numMoves = data.m_numMoves;
+        solution.pv.clear();
+        solution.stats.expanded_states = 0;
+        solution.stats.explored_states = 1;
+        solution.stats.minimal_explored = 1;
+        solution.stats.total_states = 1;
+    } 
+    else 
+        win = SolveInteriorState(variation, solution);
+
+    m_workBrd->UndoMove();
+    return win;
+}
+
 /** Does the recursive mustplay search. */
 bool DfsSolver::SolveInteriorState(PointSequence& variation,
                                    DfsSolutionSet& solution)
@@ -389,8 +673,17 @@ bool DfsSolver::SolveInteriorState(PointSequence& variation,
     //----------------------------------------------------------------------
     std::size_t states_under_losing = 0;
 
+    std::size_t numToSolve = 0;
+    for (std::size_t i = 0; i < moves.size(); ++i)
+        if (mustplay.test(moves[i].point()))
+            ++numToSolve;
+    bool split = !winning_state && CanSplit(numToSolve);
+    if (split)
+        winning_state = SolveSplit(variation, solution, mustplay, moves,
+                                   original_mustplay.count());
+
     for (unsigned index = 0; 
-         !winning_state && index < moves.size(); 
+         !split && !winning_state && index < moves.size(); 
          ++index) 
     {
         HexPoint cell = moves[index].point();
@@ -407,51 +700,276 @@ bool DfsSolver::SolveInteriorState(PointSequence& variation,
         bool win = !SolveState(variation, child);
         variation.pop_back();
         UndoMove(cell);
-        solution.stats += child.stats;
+        winning_state = AddChildResult(cell, index, win, child, solution,
+                                       mustplay, original_mustplay.count(),
+                                       states_under_losing);
+    }
+    BenzeneAssert(solution.m_numMoves != -1);
+    return winning_state;
+}
+
+/** Adds the result of the child after cell, the index'th move
+    considered, to solution. Returns true if the child is a loss for
+    the opponent. */
+bool DfsSolver::AddChildResult(HexPoint cell, std::size_t index, bool win,
+                               const DfsSolutionSet& child, 
+                               DfsSolutionSet& solution, bitset_t& mustplay,
+                               std::size_t original_mustplay_size,
+                               std::size_t& states_under_losing)
+{
+    std::size_t numStones = m_state->Position().NumStones();
+    solution.stats += child.stats;
+    if (win) 
+    {
+        // Win: copy proof over, copy pv, abort!
+        solution.proof = child.proof;
+        solution.SetPV(cell, child.pv);
+        solution.m_numMoves = child.m_numMoves + 1;
+        solution.stats.winning_expanded++;
+        solution.stats.minimal_explored = child.stats.minimal_explored + 1;
+        solution.stats.branches_to_win += index + 1;
+
+        m_histogram.winning[numStones]++;
+        m_histogram.size_of_winning_states[numStones] 
+            += child.stats.explored_states;
+        m_histogram.branches[numStones] += index + 1;
+        m_histogram.states_under_losing[numStones] += states_under_losing;
+        m_histogram.mustplay[numStones] += original_mustplay_size;
+
+        BenzeneAssert(solution.m_numMoves != -1);
+        return true;
+    } 
+    // Loss: add returned proof to current proof. Prune
+    // mustplay by proof.  Maintain PV to longest loss.
+    mustplay &= child.proof;
+    solution.proof |= child.proof;
+    states_under_losing += child.stats.explored_states;
+
+    m_histogram.size_of_losing_states[numStones] 
+        += child.stats.explored_states;
+
+    if (child.m_numMoves + 1 > solution.m_numMoves) 
+    {
+        solution.m_numMoves = child.m_numMoves + 1;
+        solution.SetPV(cell, child.pv);
+    }
+    BenzeneAssert(solution.m_numMoves != -1);
+    return false;
+}
+
+//----------------------------------------------------------------------------
 
-        if (win) 
+/** Workers split again until SplitDepth() splits are nested. */
+bool DfsSolver::CanSplit(std::size_t numTasks) const
+{
+    return m_numThreads > 1 && m_splitLevel < m_splitDepth 
+        && numTasks >= 2;
+}
+
+/** Solves all moves in mustplay in parallel, then combines the
+    results in move order as the sequential loop would: the first
+    winning move is used if there is one, otherwise the losing proofs
+    are merged and moves outside the pruned mustplay are skipped.
+    Work spent on subtrees that were not needed is still counted in
+    the statistics. */
+bool DfsSolver::SolveSplit(PointSequence& variation, 
+                           DfsSolutionSet& solution, bitset_t& mustplay, 
+                           const std::vector<HexMoveValue>& moves,
+                           std::size_t original_mustplay_size)
+{
+    const std::size_t NO_TASK = moves.size();
+    std::vector<SplitTask> tasks;
+    std::vector<std::size_t> taskOf(moves.size(), NO_TASK);
+    for (std::size_t i = 0; i < moves.size(); ++i)
+    {
+        if (mustplay.test(moves[i].point()))
         {
-            // Win: copy proof over, copy pv, abort!
-            winning_state = true;
-            solution.proof = child.proof;
-            solution.SetPV(cell, child.pv);
-            solution.m_numMoves = child.m_numMoves + 1;
-            solution.stats.winning_expanded++;
-            solution.stats.minimal_explored = child.stats.minimal_explored + 1;
-            solution.stats.branches_to_win += index + 1;
-
-            m_histogram.winning[numStones]++;
-            m_histogram.size_of_winning_states[numStones] 
-                += child.stats.explored_states;
-            m_histogram.branches[numStones] += index + 1;
-            m_histogram.states_under_losing[numStones] += states_under_losing;
-            m_histogram.mustplay[numStones] += original_mustplay.count();
-
-	    BenzeneAssert(solution.m_numMoves != -1);	    
-        } 
-        else 
+            taskOf[i] = tasks.size();
+            tasks.push_back(SplitTask(moves[i].point(), EMPTY_BITSET));
+        }
+    }
+    std::vector<SplitResult> results;
+    RunSplit(variation, tasks, results);
+    if (m_aborted)
+        return false;
+
+    std::vector<bool> used(tasks.size(), false);
+    std::size_t states_under_losing = 0;
+    bool winning_state = false;
+    for (std::size_t i = 0; !winning_state && i < moves.size(); ++i)
+    {
+        std::size_t t = taskOf[i];
+        if (t != NO_TASK && results[t].solved && results[t].win)
         {
-            // Loss: add returned proof to current proof. Prune
-            // mustplay by proof.  Maintain PV to longest loss.
-            mustplay &= child.proof;
-            solution.proof |= child.proof;
-            states_under_losing += child.stats.explored_states;
-
-            m_histogram.size_of_losing_states[numStones] 
-                += child.stats.explored_states;
-
-            if (child.m_numMoves + 1 > solution.m_numMoves) 
-            {
-                solution.m_numMoves = child.m_numMoves + 1;
-                solution.SetPV(cell, child.pv);
-            }
-	    BenzeneAssert(solution.m_numMoves != -1);
+            used[t] = true;
+            winning_state 
+                = AddChildResult(moves[i].point(), i, true, 
+                                 results[t].solution, solution, mustplay,
+                                 original_mustplay_size, 
+                                 states_under_losing);
         }
     }
-    BenzeneAssert(solution.m_numMoves != -1);
+    for (std::size_t i = 0; !winning_state && i < moves.size(); ++i)
+    {
+        HexPoint cell = moves[i].point();
+        if (!mustplay.test(cell)) 
+        {
+            solution.stats.pruned++;
+            continue;
+        }
+        // mustplay only shrinks, so every move in it has a task
+        std::size_t t = taskOf[i];
+        BenzeneAssert(t != NO_TASK && results[t].solved);
+        used[t] = true;
+        AddChildResult(cell, i, false, results[t].solution, solution,
+                       mustplay, original_mustplay_size, 
+                       states_under_losing);
+    }
+    for (std::size_t t = 0; t < tasks.size(); ++t)
+        if (!used[t])
+            solution.stats += results[t].solution.stats;
     return winning_state;
 }
 
+/** Solves the tasks with a pool of worker solvers. Sets m_aborted if
+    a task could not be solved for any reason other than a sibling
+    proving a win. Nested splits share the mutex of the outermost
+    one. */
+void DfsSolver::RunSplit(const PointSequence& variation,
+                         const std::vector<SplitTask>& tasks,
+                         std::vector<SplitResult>& results)
+{
+    boost::mutex ownMutex;
+    boost::mutex& positionsMutex 
+        = m_positionsMutex ? *m_positionsMutex : ownMutex;
+    CancelToken cancel;
+    std::size_t numThreads = std::min(static_cast<std::size_t>(m_numThreads),
+                                      tasks.size());
+    LogInfo() << "DfsSolver: splitting " << tasks.size() << " subtrees "
+              << "over " << numThreads << " threads at "
+              << HexPointUtil::ToString(variation) << '\n';
+
+    std::vector<boost::shared_ptr<HexBoard> > boards;
+    std::vector<boost::shared_ptr<DfsSolver> > solvers;
+    CreateWorkers(numThreads, positionsMutex, cancel, boards, solvers);
+    std::vector<SplitWorker> workers;
+    for (std::size_t i = 0; i < solvers.size(); ++i)
+        workers.push_back(SplitWorker(*solvers[i], tasks, variation));
+    std::vector<std::size_t> work;
+    for (std::size_t i = 0; i < tasks.size(); ++i)
+        work.push_back(i);
+    std::vector<std::pair<std::size_t, SplitResult> > output;
+    {
+        TaskWorker<std::size_t, SplitResult, SplitWorker> 
+            taskWorker(workers);
+        taskWorker.DoWork(work, output, cancel);
+    }
+
+    results.assign(tasks.size(), SplitResult());
+    for (std::size_t i = 0; i < output.size(); ++i)
+        results[output[i].first] = output[i].second;
+    MergeWorkers(solvers);
+    if (!cancel.IsCancelled())
+        for (std::size_t i = 0; i < results.size(); ++i)
+            if (!results[i].solved)
+                m_aborted = true;
+    CheckAbort();
+}
+
+/** Creates worker solvers, each with its own copy of the board,
+    positioned at the current state. */
+void DfsSolver::CreateWorkers(std::size_t numWorkers, 
+                              boost::mutex& positionsMutex, 
+                              const CancelToken& cancel,
+                              std::vector<boost::shared_ptr<HexBoard> >& boards,
+                              std::vector<boost::shared_ptr<DfsSolver> >& 
+                              solvers)
+{
+    for (std::size_t i = 0; i < numWorkers; ++i)
+    {
+        boards.push_back(boost::shared_ptr<HexBoard>
+                         (new HexBoard(*m_workBrd)));
+        solvers.push_back(boost::shared_ptr<DfsSolver>(new DfsSolver()));
+        solvers.back()->InitWorker(*this, *m_state, *boards.back(),
+                                   positionsMutex, cancel);
+    }
+}
+
+/** Adds the histograms and statistics of the workers to this
+    solver. */
+void DfsSolver::MergeWorkers(const std::vector<boost::shared_ptr<DfsSolver> >&
+                             solvers)
+{
+    for (std::size_t i = 0; i < solvers.size(); ++i)
+    {
+        m_histogram += solvers[i]->m_histogram;
+        m_statistics.played += solvers[i]->m_statistics.played;
+    }
+}
+
+void DfsSolver::CopySettingsFrom(const DfsSolver& other)
+{
+    m_use_decompositions = other.m_use_decompositions;
+    m_update_depth = other.m_update_depth;
+    m_shrink_proofs = other.m_shrink_proofs;
+    m_backup_ice_info = other.m_backup_ice_info;
+    m_use_guifx = other.m_use_guifx;
+    m_move_ordering = other.m_move_ordering;
+    m_numThreads = other.m_numThreads;
+    m_splitDepth = other.m_splitDepth;
+}
+
+/** Prepares this solver to solve subtrees of the state of master. */
+void DfsSolver::InitWorker(const DfsSolver& master, const HexState& state,
+                           HexBoard& brd, boost::mutex& positionsMutex,
+                           const CancelToken& cancel)
+{
+    CopySettingsFrom(master);
+    // Workers would interleave their gfx output
+    m_use_guifx = false;
+    m_positions = master.m_positions;
+    m_depthLimit = master.m_depthLimit;
+    m_timeLimit = master.m_timeLimit;
+    if (m_timeLimit > 0)
+        m_timeLimit = std::max(m_timeLimit - master.m_timer.GetTime(), 
+                               0.001);
+    m_aborted = false;
+    m_timer.Start();
+    m_histogram = DfsHistogram();
+    m_last_histogram_dump = 0;
+    m_statistics = GlobalStatistics();
+    m_state.reset(new HexState(state));
+    m_workBrd = &brd;
+    m_completed.resize(BITSETSIZE);
+    m_positionsMutex = &positionsMutex;
+    m_splitLevel = master.m_splitLevel + 1;
+    m_cancel = master.m_cancel;
+    m_cancel.push_back(cancel);
+    m_resistCache = master.m_resistCache;
+}
+
+/** Solves a single task in this worker. The variation is the one of
+    the split state. Cancels the other tasks on a win. */
+void DfsSolver::SolveSplitTask(const SplitTask& task, 
+                               PointSequence variation, SplitResult& result)
+{
+    m_aborted = false;
+    if (task.move != INVALID_POINT)
+    {
+        PlayMove(task.move);
+        variation.push_back(task.move);
+        result.win = !SolveState(variation, result.solution);
+        variation.pop_back();
+        UndoMove(task.move);
+    }
+    else
+        result.win = SolveDecompositionSide(variation, task.fill, 
+                                            result.solution);
+    result.solved = !m_aborted;
+    if (result.solved && result.win)
+        m_cancel.back().Cancel();
+}
+
 /** Shrinks/verifies proof then stores it. */
 void DfsSolver::HandleProof(const PointSequence& variation,
                             bool winning_state, DfsSolutionSet& solution)
@@ -566,7 +1084,6 @@ bool DfsSolver::OrderMoves(bitset_t& mustplay, DfsSolutionSet& solution,
 {        
     LogFine() << "OrderMoves\n";
     HexColor color = m_state->ToPlay();
-    HexColor other = !color;
 
     // union and intersection of proofs for all losing moves
     bitset_t proof_union;
@@ -630,7 +1147,7 @@ bool DfsSolver::OrderMoves(bitset_t& mustplay, DfsSolutionSet& solution,
     }
 
     // We need to actually order moves now :)
-    boost::scoped_ptr<Resistance> resist;
+    std::vector<HexEval> rscores;
     bool with_ordering = m_move_ordering;
     bool with_resist = m_move_ordering & DfsMoveOrderFlags::WITH_RESIST;
     bool with_center = m_move_ordering & DfsMoveOrderFlags::FROM_CENTER;
@@ -638,10 +1155,32 @@ bool DfsSolver::OrderMoves(bitset_t& mustplay, DfsSolutionSet& solution,
     
     if (with_resist && with_ordering)
     {
-        resist.reset(new Resistance());
-        resist->Evaluate(*m_workBrd);
+        rscores.resize(BITSETSIZE);
+        if (!m_resistCache->Get(m_state->Hash(), &rscores[0]))
+        {
+            boost::scoped_ptr<Resistance> resist(new Resistance());
+            resist->Evaluate(*m_workBrd);
+            for (int i = 0; i < BITSETSIZE; ++i)
+                rscores[i] = resist->Score(static_cast<HexPoint>(i));
+            m_resistCache->Put(m_state->Hash(), &rscores[0]);
+        }
     }
     
+    // Evaluate the children on worker boards of the TaskScheduler.
+    // The loop below consumes the results in the same order as it
+    // would compute them.
+    std::vector<HexPoint> cells;
+    std::vector<ChildEval> evals;
+    if (with_ordering && with_mustplay)
+    {
+        for (BitsetIterator it(mustplay); it; ++it)
+            if (!losingMoves.test(*it))
+                cells.push_back(*it);
+        if (TaskScheduler::Get().NumThreads() > 1 && cells.size() >= 2)
+            EvaluateChildren(cells, evals);
+    }
+    std::size_t nextEval = 0;
+
     moves.clear();
     for (BitsetIterator it(mustplay); !found_win && it; ++it)
     {
@@ -668,12 +1207,20 @@ bool DfsSolver::OrderMoves(bitset_t& mustplay, DfsSolutionSet& solution,
 	    // 8x8 is no longer solvable. However, it is very expensive!
             if (with_mustplay)
 	    {
-                PlayMove(*it);
-                
-                DfsData data;
-                bitset_t proof;
-		// No need to check DB/TT since did this above
-		if (HandleTerminalNode(data, proof))
+                ChildEval eval;
+                if (evals.empty())
+                    EvaluateChild(*it, eval);
+                else
+                {
+                    BenzeneAssert(cells[nextEval] == *it);
+                    eval = evals[nextEval++];
+                }
+                // Cancelled: a later child is a win
+                if (!eval.evaluated)
+                    continue;
+                const DfsData& data = eval.data;
+                const bitset_t& proof = eval.proof;
+		if (eval.terminal)
 		{
                     exact_score = true;
                     solution.stats.minimal_explored++;
@@ -706,17 +1253,9 @@ bool DfsSolver::OrderMoves(bitset_t& mustplay, DfsSolutionSet& solution,
                 }
 		else
 		{
-                    // Not a leaf node. 
-                    // Do we force a mustplay on our opponent?
-                    HexPoint edge1 = HexPointUtil::colorEdge1(color);
-                    HexPoint edge2 = HexPointUtil::colorEdge2(color);
-                    if (m_workBrd->Cons(color).Exists(edge1, edge2, VC::SEMI))
-                        winning_semi_exists = true;
-                    bitset_t mp = VCUtil::GetMustplay(*m_workBrd, other);
-                    mustplay_size = static_cast<double>(mp.count());
+                    winning_semi_exists = eval.winning_semi_exists;
+                    mustplay_size = eval.mustplay_size;
                 } 
-                
-                UndoMove(*it);
             } // end of mustplay move ordering
 
             // Perform move ordering 
@@ -729,7 +1268,7 @@ bool DfsSolver::OrderMoves(bitset_t& mustplay, DfsSolutionSet& solution,
                 }
                 if (with_resist)
 		{
-                    rscore = resist->Score(*it);
+                    rscore = rscores[*it];
                     BenzeneAssert(rscore < 100.0);
                 }
                 tiebreaker = (with_resist) ? 100.0 - rscore : fromcenter;
@@ -781,8 +1320,110 @@ bool DfsSolver::OrderMoves(bitset_t& mustplay, DfsSolutionSet& solution,
     return found_win;
 }
 
+/** Plays cell and computes the move ordering information of the
+    child. */
+void DfsSolver::EvaluateChild(HexPoint cell, ChildEval& eval)
+{
+    HexColor color = m_state->ToPlay();
+    PlayMove(cell);
+    eval.evaluated = true;
+    // No need to check DB/TT since OrderMoves() did this already
+    eval.terminal = HandleTerminalNode(eval.data, eval.proof);
+    if (!eval.terminal)
+    {
+        // Not a leaf node. 
+        // Do we force a mustplay on our opponent?
+        HexPoint edge1 = HexPointUtil::colorEdge1(color);
+        HexPoint edge2 = HexPointUtil::colorEdge2(color);
+        eval.winning_semi_exists 
+            = m_workBrd->Cons(color).Exists(edge1, edge2, VC::SEMI);
+        bitset_t mp = VCUtil::GetMustplay(*m_workBrd, !color);
+        eval.mustplay_size = static_cast<double>(mp.count());
+    }
+    const InferiorCells& inf = m_workBrd->GetInferiorCells();
+    eval.dominated = inf.Dead() | inf.Captured(color);
+    UndoMove(cell);
+}
+
+/** Evaluates the children after each of cells in parallel. Stops
+    early once a child is found that is lost for the opponent. The
+    terminal children are stored in the DfsStates, so transpositions
+    into them are found by the TT/DB sweep of OrderMoves(). The ice
+    info the workers back up is added to m_workBrd, as PopHistory()
+    would have done had the children been played on it. */
+void DfsSolver::EvaluateChildren(const std::vector<HexPoint>& cells,
+                                 std::vector<ChildEval>& evals)
+{
+    boost::mutex ownMutex;
+    boost::mutex& positionsMutex 
+        = m_positionsMutex ? *m_positionsMutex : ownMutex;
+    CancelToken cancel;
+    std::size_t numThreads = std::min(TaskScheduler::Get().NumThreads(),
+                                      cells.size());
+    std::vector<boost::shared_ptr<HexBoard> > boards;
+    std::vector<boost::shared_ptr<DfsSolver> > solvers;
+    CreateWorkers(numThreads, positionsMutex, cancel, boards, solvers);
+    std::vector<ChildEvalWorker> workers;
+    for (std::size_t i = 0; i < solvers.size(); ++i)
+        workers.push_back(ChildEvalWorker(*solvers[i], cells));
+    std::vector<std::size_t> work;
+    for (std::size_t i = 0; i < cells.size(); ++i)
+        work.push_back(i);
+    std::vector<std::pair<std::size_t, ChildEval> > output;
+    {
+        TaskWorker<std::size_t, ChildEval, ChildEvalWorker> 
+            taskWorker(workers);
+        taskWorker.DoWork(work, output, cancel);
+    }
+
+    evals.assign(cells.size(), ChildEval());
+    for (std::size_t i = 0; i < output.size(); ++i)
+        evals[output[i].first] = output[i].second;
+    MergeWorkers(solvers);
+
+    for (std::size_t i = 0; i < evals.size(); ++i)
+    {
+        if (evals[i].evaluated && m_workBrd->BackupIceInfo())
+        {
+            bitset_t a = m_workBrd->GetPosition().GetEmpty() 
+                - m_workBrd->GetInferiorCells().All();
+            a &= evals[i].dominated;
+            m_workBrd->AddDominated(a, cells[i]);
+        }
+        if (!evals[i].terminal)
+            continue;
+        m_state->PlayMove(cells[i]);
+        StoreState(evals[i].data, evals[i].proof);
+        m_state->UndoMove(cells[i]);
+    }
+}
+
 //----------------------------------------------------------------------------
 
+namespace {
+
+void AddStatsMap(DfsHistogram::StatsMap& a, const DfsHistogram::StatsMap& b)
+{
+    for (DfsHistogram::StatsMap::const_iterator it = b.begin(); 
+         it != b.end(); ++it)
+        a[it->first] += it->second;
+}
+
+} // namespace
+
+void DfsHistogram::operator+=(const DfsHistogram& o)
+{
+    AddStatsMap(terminal, o.terminal);
+    AddStatsMap(states, o.states);
+    AddStatsMap(winning, o.winning);
+    AddStatsMap(size_of_winning_states, o.size_of_winning_states);
+    AddStatsMap(size_of_losing_states, o.size_of_losing_states);
+    AddStatsMap(branches, o.branches);
+    AddStatsMap(mustplay, o.mustplay);
+    AddStatsMap(states_under_losing, o.states_under_losing);
+    AddStatsMap(tthits, o.tthits);
+}
+
 std::string DfsHistogram::Write()
 {
     std::ostringstream os;
@@ -880,6 +1521,8 @@ void DfsSolver::DumpStats(const DfsSolutionSet& solution) const
        << (double(solution.stats.explored_states) / total_time) << '\n'
        << SgWriteLabel("Played/sec") << 
         (double(m_statistics.played) / total_time) << '\n'
+       << SgWriteLabel("Threads") << m_numThreads << '\n'
+       << SgWriteLabel("Split Depth") << m_splitDepth << '\n'
        << SgWriteLabel("Total Time") << total_time << "s\n"
        << SgWriteLabel("Moves to W/L") << solution.m_numMoves << " moves\n"
        << SgWriteLabel("PV") << HexPointUtil::ToString(solution.pv) << '\n';
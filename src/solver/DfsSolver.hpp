@@ -15,8 +15,11 @@
 #include "SolverDB.hpp"
 #include "StateDB.hpp"
 #include "HexEval.hpp"
+#include "TaskScheduler.hpp"
 
 #include <boost/scoped_ptr.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
 
 _BEGIN_BENZENE_NAMESPACE_
 
@@ -31,8 +34,11 @@ class DfsDB : public StateDB<DfsData>
 public:
     static const std::string DFS_DB_VERSION;
 
+    /** States written behind at most; see StateDB. */
+    static const std::size_t WRITE_QUEUE_SIZE = 1 << 16;
+
     DfsDB(const std::string& filename)
-        : StateDB<DfsData>(filename, DFS_DB_VERSION)
+        : StateDB<DfsData>(filename, DFS_DB_VERSION, WRITE_QUEUE_SIZE)
     { }
 };
 
@@ -157,6 +163,9 @@ struct DfsHistogram
     
     /** Writes histogram in human-readable format to a string. */
     std::string Write();
+
+    /** Adds all counters of o to this histogram. */
+    void operator+=(const DfsHistogram& o);
 };
 
 //----------------------------------------------------------------------------
@@ -223,6 +232,26 @@ namespace DfsMoveOrderFlags
 /** Determines the winner of a gamestate.
     DfsSolver uses a mustplay driven depth-first search to determine the
     winner in the given state.
+
+    With more than one thread, the first state in the search that has
+    at least two moves to consider (or a decomposition) is split: its
+    subtrees are handed to a pool of workers, each with its own
+    DfsSolver and copy of the board. Idle workers take the next
+    unsolved subtree. A worker splits its own subtree again in the
+    same way, up to SplitDepth() nested splits; the tasks of all
+    splits run on the TaskScheduler, whose idle threads steal them.
+    Once a winning move of a split state is proven, the split is
+    cancelled: its workers take no new subtree and the running ones
+    abort. The workers share the DfsStates through a mutex, and their
+    statistics are added to the histogram and DumpStats() of this
+    solver.
+
+    The children in the move ordering of a state are evaluated in
+    parallel on the TaskScheduler whenever it has more than one
+    thread, whatever NumThreads() and SplitDepth() are. Terminal
+    children found this way are stored in the DfsStates. The
+    resistance scores used to break ties are cached by the hash of
+    the state for the duration of Solve().
 */
 class DfsSolver 
 {
@@ -291,6 +320,20 @@ public:
     /** See MoveOrdering() */
     void SetMoveOrdering(int flags);
 
+    /** Number of threads used to solve split subtrees.
+        1 gives the sequential search. */
+    int NumThreads() const;
+
+    /** See NumThreads() */
+    void SetNumThreads(int threads);
+
+    /** Maximum number of nested split states on a path from the
+        root. 1 splits only the first state. Default is 2. */
+    int SplitDepth() const;
+
+    /** See SplitDepth() */
+    void SetSplitDepth(int depth);
+
     // @}
 
     //------------------------------------------------------------------------
@@ -304,6 +347,29 @@ public:
 
 private:
 
+    /** Subtree of a split state. */
+    struct SplitTask;
+
+    /** Result of solving a SplitTask. */
+    struct SplitResult;
+
+    /** Solves SplitTasks with a worker DfsSolver. */
+    class SplitWorker;
+
+    friend class SplitWorker;
+
+    /** Move ordering information about a child state. */
+    struct ChildEval;
+
+    /** Computes ChildEvals with a worker DfsSolver. */
+    class ChildEvalWorker;
+
+    friend class ChildEvalWorker;
+
+    /** Resistance scores of the states seen in the current search,
+        shared with the workers. */
+    class ResistCache;
+
     //------------------------------------------------------------------------
     
     /** Globabl statistics for the current solver run. */
@@ -359,6 +425,27 @@ private:
     
     double m_timeLimit;
 
+    /** See NumThreads() */
+    int m_numThreads;
+
+    /** See SplitDepth() */
+    int m_splitDepth;
+
+    /** Number of splits above the states of this solver; 0 if this
+        solver is not a worker. */
+    int m_splitLevel;
+
+    /** Guards m_positions while a split is running; 0 if this solver
+        is not a worker. */
+    boost::mutex* m_positionsMutex;
+
+    /** One token for each split above this solver, cancelled when a
+        subtree of that split proved a win. */
+    std::vector<CancelToken> m_cancel;
+
+    /** Created by Solve(); workers use the cache of their master. */
+    boost::shared_ptr<ResistCache> m_resistCache;
+
     //------------------------------------------------------------------------
 
     void PlayMove(HexPoint cell);
@@ -370,6 +457,8 @@ private:
     void StoreState(const DfsData& state, const bitset_t& proof);
 
     bool CheckAbort();
+
+    bool Cancelled() const;
     
     bool HandleLeafNode(DfsData& state, bitset_t& proof) const;
 
@@ -388,6 +477,50 @@ private:
 
     void HandleProof(const PointSequence& variation,
                      bool winning_state, DfsSolutionSet& solution);
+
+    bool SolveDecompositionSide(PointSequence& variation,
+                                const bitset_t& fill,
+                                DfsSolutionSet& solution);
+
+    bool AddChildResult(HexPoint cell, std::size_t index, bool win,
+                        const DfsSolutionSet& child, 
+                        DfsSolutionSet& solution, bitset_t& mustplay,
+                        std::size_t original_mustplay_size,
+                        std::size_t& states_under_losing);
+
+    bool CanSplit(std::size_t numTasks) const;
+
+    bool SolveSplit(PointSequence& variation, DfsSolutionSet& solution,
+                    bitset_t& mustplay, 
+                    const std::vector<HexMoveValue>& moves,
+                    std::size_t original_mustplay_size);
+
+    void RunSplit(const PointSequence& variation,
+                  const std::vector<SplitTask>& tasks,
+                  std::vector<SplitResult>& results);
+
+    void CopySettingsFrom(const DfsSolver& other);
+
+    void InitWorker(const DfsSolver& master, const HexState& state, 
+                    HexBoard& brd, boost::mutex& positionsMutex,
+                    const CancelToken& cancel);
+
+    void SolveSplitTask(const SplitTask& task, PointSequence variation,
+                        SplitResult& result);
+
+    void CreateWorkers(std::size_t numWorkers, 
+                       boost::mutex& positionsMutex,
+                       const CancelToken& cancel,
+                       std::vector<boost::shared_ptr<HexBoard> >& boards,
+                       std::vector<boost::shared_ptr<DfsSolver> >& solvers);
+
+    void MergeWorkers(const std::vector<boost::shared_ptr<DfsSolver> >& 
+                      solvers);
+
+    void EvaluateChild(HexPoint cell, ChildEval& eval);
+
+    void EvaluateChildren(const std::vector<HexPoint>& cells,
+                          std::vector<ChildEval>& evals);
 };
 
 //----------------------------------------------------------------------------
@@ -452,6 +585,26 @@ inline void DfsSolver::SetMoveOrdering(int flags)
     m_move_ordering = flags;
 }
 
+inline int DfsSolver::NumThreads() const
+{
+    return m_numThreads;
+}
+
+inline void DfsSolver::SetNumThreads(int threads)
+{
+    m_numThreads = threads;
+}
+
+inline int DfsSolver::SplitDepth() const
+{
+    return m_splitDepth;
+}
+
+inline void DfsSolver::SetSplitDepth(int depth)
+{
+    m_splitDepth = depth;
+}
+
 inline DfsHistogram DfsSolver::Histogram() const
 {
     return m_histogram;
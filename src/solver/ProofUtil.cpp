@@ -44,8 +44,7 @@ bitset_t ProofUtil::InitialProofForOpponent(const HexBoard& brd,
     // need to add one.
     for (BitsetIterator p(inf.Reversible()); p; ++p) 
     {
-        const std::set<HexPoint>& reversers = inf.Reversers(*p);
-        proof.set(*reversers.begin());
+        proof.set(BitsetUtil::FirstSetBit(inf.Reversers(*p)));
     }
     // Add vulnerable killers and their carriers.
     // TODO: Currently, we just add the first killer: we should see if
@@ -53,9 +52,9 @@ bitset_t ProofUtil::InitialProofForOpponent(const HexBoard& brd,
     // to add one.
     for (BitsetIterator p(inf.Vulnerable()); p; ++p) 
     {
-        const std::set<VulnerableKiller>& killers = inf.Killers(*p);
-        proof.set((*killers.begin()).killer());
-        proof |= ((*killers.begin()).carrier());
+        const std::vector<VulnerableKiller> killers = inf.Killers(*p);
+        proof.set(killers.front().killer());
+        proof |= killers.front().carrier();
     }
     return proof;
 }
@@ -10,6 +10,7 @@
 #include "BenzeneSolver.hpp"
 #include "HexState.hpp"
 #include <boost/concept_check.hpp>
+#include <boost/thread/mutex.hpp>
 
 _BEGIN_BENZENE_NAMESPACE_
 
@@ -50,6 +51,11 @@ public:
              boost::scoped_ptr<DB>& database, 
              const SolverDBParameters& param);
 
+    /** Uses hashTable, and the database and parameters of other. Lets
+        several threads each use their own hash table on top of one
+        database; see SetDatabaseMutex(). */
+    SolverDB(boost::scoped_ptr<HASH>& hashTable, SolverDB& other);
+
     ~SolverDB();
 
     bool Get(const HexState& state, DATA& data);
@@ -65,6 +71,15 @@ public:
     SolverDBParameters& Parameters();
 
     void SetParameters(const SolverDBParameters& param);
+
+    /** Serializes all accesses to the database with mutex. Must be
+        set when several SolverDBs share one database; 0 (the
+        default) means exclusive access. The hash table is never
+        locked. */
+    void SetDatabaseMutex(boost::mutex* mutex);
+
+    /** See SetDatabaseMutex() */
+    boost::mutex* DatabaseMutex();
     
 private:
     boost::scoped_ptr<HASH>& m_hashTable;
@@ -73,6 +88,9 @@ private:
 
     SolverDBParameters m_param;
 
+    /** See SetDatabaseMutex() */
+    boost::mutex* m_databaseMutex;
+
     bool UseDatabase() const;
 
     bool UseHashTable() const;
@@ -87,7 +105,18 @@ SolverDB<HASH, DB, DATA>::SolverDB(boost::scoped_ptr<HASH>& hashTable,
                                    const SolverDBParameters& param)
     : m_hashTable(hashTable),
       m_database(database),
-      m_param(param)
+      m_param(param),
+      m_databaseMutex(0)
+{
+}
+
+template<class HASH, class DB, class DATA>
+SolverDB<HASH, DB, DATA>::SolverDB(boost::scoped_ptr<HASH>& hashTable, 
+                                   SolverDB& other)
+    : m_hashTable(hashTable),
+      m_database(other.m_database),
+      m_param(other.m_param),
+      m_databaseMutex(0)
 {
 }
 
@@ -127,6 +156,18 @@ void SolverDB<HASH, DB, DATA>::SetParameters(const SolverDBParameters& p)
     return m_param = p;
 }
 
+template<class HASH, class DB, class DATA>
+void SolverDB<HASH, DB, DATA>::SetDatabaseMutex(boost::mutex* mutex)
+{
+    m_databaseMutex = mutex;
+}
+
+template<class HASH, class DB, class DATA>
+boost::mutex* SolverDB<HASH, DB, DATA>::DatabaseMutex()
+{
+    return m_databaseMutex;
+}
+
 template<class HASH, class DB, class DATA>
 bool SolverDB<HASH, DB, DATA>::UseDatabase() const
 {
@@ -143,7 +184,14 @@ template<class HASH, class DB, class DATA>
 bool SolverDB<HASH, DB, DATA>::Get(const HexState& state, DATA& data)
 {
     if (UseDatabase() && state.Position().NumStones() <= m_param.m_maxStones)
+    {
+        if (m_databaseMutex)
+        {
+            boost::mutex::scoped_lock lock(*m_databaseMutex);
+            return m_database->Get(state, data);
+        }
         return m_database->Get(state, data);
+    }
     if (UseHashTable())
         return m_hashTable->Lookup(state.Hash(), &data);
     return false;
@@ -153,7 +201,15 @@ template<class HASH, class DB, class DATA>
 void SolverDB<HASH, DB, DATA>::Put(const HexState& state, const DATA& data)
 {
     if (UseDatabase() && state.Position().NumStones() <= m_param.m_maxStones)
-        m_database->Put(state, data);
+    {
+        if (m_databaseMutex)
+        {
+            boost::mutex::scoped_lock lock(*m_databaseMutex);
+            m_database->Put(state, data);
+        }
+        else
+            m_database->Put(state, data);
+    }
     else if (UseHashTable())
         m_hashTable->Store(state.Hash(), data);
 }
@@ -0,0 +1,153 @@
+//---------------------------------------------------------------------------
+/** @file DfpnDataTest.cpp */
+//---------------------------------------------------------------------------
+#include <boost/test/auto_unit_test.hpp>
+
+#include <cstdio>
+#include "SgSystem.h"
+#include "BenzeneException.hpp"
+#include "DfpnSolver.hpp"
+
+using namespace benzene;
+
+//---------------------------------------------------------------------------
+
+namespace {
+
+const char* V2_FILE = "dfpndata-unittest-v2.lsdb";
+
+const char* V3_FILE = "dfpndata-unittest-v3.lsdb";
+
+void RemoveFiles()
+{
+    std::remove(V2_FILE);
+    std::remove((std::string(V2_FILE) + ".idx").c_str());
+    std::remove(V3_FILE);
+    std::remove((std::string(V3_FILE) + ".idx").c_str());
+}
+
+DfpnData MakeData(const bitset_t& proofSet)
+{
+    std::vector<HexPoint> moves;
+    moves.push_back(HEX_CELL_A1);
+    moves.push_back(HEX_CELL_K11);
+    moves.push_back(HEX_CELL_C3);
+    DfpnChildren children;
+    children.SetChildren(moves);
+    return DfpnData(DfpnBounds(0, DfpnBounds::INFTY), children,
+                    HEX_CELL_K11, 123456789, proofSet, 0.75f);
+}
+
+void CheckEqual(const DfpnData& a, const DfpnData& b)
+{
+    BOOST_CHECK_EQUAL(a.m_bounds.phi, b.m_bounds.phi);
+    BOOST_CHECK_EQUAL(a.m_bounds.delta, b.m_bounds.delta);
+    BOOST_CHECK_EQUAL(a.m_bestMove, b.m_bestMove);
+    BOOST_CHECK_EQUAL(a.m_work, b.m_work);
+    BOOST_CHECK(a.m_maxProofSet == b.m_maxProofSet);
+    BOOST_CHECK_EQUAL(a.m_evaluationScore, b.m_evaluationScore);
+    BOOST_REQUIRE_EQUAL(a.m_children.Size(), b.m_children.Size());
+    for (std::size_t i = 0; i < a.m_children.Size(); ++i)
+        BOOST_CHECK_EQUAL(a.m_children.FirstMove(i),
+                          b.m_children.FirstMove(i));
+}
+
+template<typename T>
+void Append(std::vector<byte>& record, const T& value)
+{
+    const byte* p = reinterpret_cast<const byte*>(&value);
+    record.insert(record.end(), p, p + sizeof(value));
+}
+
+DfpnData RoundTrip(const DfpnData& data)
+{
+    std::vector<byte> packed(data.Pack(), data.Pack() + data.PackedSize());
+    DfpnData copy;
+    copy.Unpack(&packed[0], static_cast<int>(packed.size()));
+    return copy;
+}
+
+BOOST_AUTO_TEST_CASE(DfpnData_PackUnpackList)
+{
+    // A few cells are shorter as a list than as a bitmap
+    bitset_t proofSet;
+    proofSet.set(HEX_CELL_B2);
+    proofSet.set(HEX_CELL_K11);
+    DfpnData data(MakeData(proofSet));
+    CheckEqual(data, RoundTrip(data));
+
+    DfpnData empty(MakeData(bitset_t()));
+    CheckEqual(empty, RoundTrip(empty));
+}
+
+BOOST_AUTO_TEST_CASE(DfpnData_PackUnpackBitmap)
+{
+    // Every cell up to K11 is shorter as a bitmap
+    bitset_t proofSet;
+    for (int p = FIRST_CELL; p <= HEX_CELL_K11; ++p)
+        proofSet.set(p);
+    DfpnData data(MakeData(proofSet));
+    CheckEqual(data, RoundTrip(data));
+    bitset_t sparse;
+    sparse.set(HEX_CELL_K11);
+    BOOST_CHECK(data.PackedSize() > MakeData(sparse).PackedSize());
+}
+
+BOOST_AUTO_TEST_CASE(DfpnData_UnpackTruncated)
+{
+    bitset_t proofSet;
+    proofSet.set(HEX_CELL_B2);
+    DfpnData data(MakeData(proofSet));
+    std::vector<byte> packed(data.Pack(), data.Pack() + data.PackedSize());
+    for (std::size_t size = 0; size < packed.size(); ++size)
+    {
+        DfpnData copy;
+        BOOST_CHECK_THROW(copy.Unpack(&packed[0], static_cast<int>(size)),
+                          BenzeneException);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(DfpnData_ConvertVersion2)
+{
+    RemoveFiles();
+    bitset_t proofSet;
+    proofSet.set(HEX_CELL_B2);
+    proofSet.set(HEX_CELL_C3);
+    DfpnData data(MakeData(proofSet));
+    // Version 2 stored the fields raw, then the children as shorts
+    std::vector<byte> record;
+    Append(record, data.m_bounds);
+    Append(record, data.m_bestMove);
+    Append(record, data.m_work);
+    Append(record, data.m_maxProofSet);
+    Append(record, data.m_evaluationScore);
+    for (std::size_t i = 0; i < data.m_children.Size(); ++i)
+        Append(record, static_cast<short>(data.m_children.FirstMove(i)));
+    Append(record, static_cast<short>(INVALID_POINT));
+
+    DfpnData v2;
+    v2.UnpackVersion2(&record[0], record.size());
+    CheckEqual(data, v2);
+    BOOST_CHECK_THROW(v2.UnpackVersion2(&record[0], record.size() - 1),
+                      BenzeneException);
+
+    const HexState state(StoneBoard(11, 11), BLACK);
+    SgHashCode hash = state.Hash();
+    {
+        HashDB<DfpnData> db(V2_FILE, DfpnDB::DFPN_DB_VERSION_2);
+        BOOST_CHECK(db.Put(&hash, sizeof(hash), &record[0],
+                           static_cast<int>(record.size())));
+    }
+    BOOST_CHECK_EQUAL(DfpnDB::ConvertVersion2(V2_FILE, V3_FILE), 1u);
+    {
+        HashDB<DfpnData> db(V3_FILE, DfpnDB::DFPN_DB_VERSION);
+        DfpnData converted;
+        BOOST_REQUIRE(db.Get(hash, converted));
+        CheckEqual(data, converted);
+    }
+    RemoveFiles();
+}
+
+} // namespace
+
+//---------------------------------------------------------------------------
@@ -47,6 +47,29 @@ inline bool CompareAndSwap(volatile T* ptr, T oldValue, T newValue)
 #endif
 }
 
+/** Stores before the barrier become visible to other threads before
+    stores after it. x86 keeps stores in order, so there this only
+    stops the compiler from reordering them. */
+inline void WriteBarrier()
+{
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+    __asm__ __volatile__ ("" : : : "memory");
+#elif HAVE_GCC_ATOMIC_BUILTINS
+    __sync_synchronize();
+#endif
+}
+
+/** Loads before the barrier are performed before loads after it.
+    See WriteBarrier(). */
+inline void ReadBarrier()
+{
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+    __asm__ __volatile__ ("" : : : "memory");
+#elif HAVE_GCC_ATOMIC_BUILTINS
+    __sync_synchronize();
+#endif
+}
+
 //----------------------------------------------------------------------------
 
 _END_BENZENE_NAMESPACE_
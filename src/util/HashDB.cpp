@@ -0,0 +1,47 @@
+//----------------------------------------------------------------------------
+/** @file HashDB.cpp */
+//----------------------------------------------------------------------------
+
+#include "HashDB.hpp"
+
+using namespace benzene;
+
+//----------------------------------------------------------------------------
+
+boost::mutex HashDBCache::s_mutex;
+
+std::size_t HashDBCache::s_size = 0;
+
+std::size_t HashDBCache::s_used = 0;
+
+std::size_t HashDBCache::Size()
+{
+    boost::mutex::scoped_lock lock(s_mutex);
+    return s_size;
+}
+
+void HashDBCache::SetSize(std::size_t bytes)
+{
+    boost::mutex::scoped_lock lock(s_mutex);
+    s_size = bytes;
+}
+
+std::size_t HashDBCache::Used()
+{
+    boost::mutex::scoped_lock lock(s_mutex);
+    return s_used;
+}
+
+void HashDBCache::Add(std::size_t bytes)
+{
+    boost::mutex::scoped_lock lock(s_mutex);
+    s_used += bytes;
+}
+
+void HashDBCache::Remove(std::size_t bytes)
+{
+    boost::mutex::scoped_lock lock(s_mutex);
+    s_used -= bytes;
+}
+
+//----------------------------------------------------------------------------
@@ -6,10 +6,15 @@
 #define HASHDB_H
 
 #include <boost/concept_check.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread/mutex.hpp>
 
+#include <algorithm>
 #include <cstdio>
 #include <cstring>
+#include <sstream>
 #include <string>
+#include <vector>
 
 #include <db.h>
 
@@ -17,12 +22,15 @@
 #include "Benzene.hpp"
 #include "Types.hpp"
 #include "BenzeneException.hpp"
+#include "LogStore.hpp"
 
 _BEGIN_BENZENE_NAMESPACE_
 
 //----------------------------------------------------------------------------
 
-/** Class supports Pack(), Unpack(), and PackedSize(). */
+/** Class supports Pack(), Unpack(), and PackedSize(). Unpack() is
+    given the number of bytes read from the database and throws a
+    BenzeneException if they do not hold a valid state. */
 template<class T>
 struct PackableConcept
 {
@@ -30,11 +38,10 @@ struct PackableConcept
     {
         const T t;
         int size = t.PackedSize();
-        size = 42;  // to avoid non-used warning
         byte* d = t.Pack();
 
         T a = t;
-        a.Unpack(d);
+        a.Unpack(d, size);
     }
 };
 
@@ -52,7 +59,43 @@ struct HashDBStateConcept
 
 //----------------------------------------------------------------------------
 
-/** Front end for a Berkely DB hash table. */
+/** Berkeley DB cache of the databases opened by HashDB.
+    Databases are opened without a shared environment, so each has its
+    own cache of Size() bytes. */
+class HashDBCache
+{
+public:
+    /** Cache size of databases opened from now on; zero keeps the
+        Berkeley DB default. */
+    static std::size_t Size();
+
+    /** See Size() */
+    static void SetSize(std::size_t bytes);
+
+    /** Bytes of cache held by the open databases. */
+    static std::size_t Used();
+
+    /** Called by HashDB when a database is opened. */
+    static void Add(std::size_t bytes);
+
+    /** Called by HashDB when a database is closed. */
+    static void Remove(std::size_t bytes);
+
+private:
+    static boost::mutex s_mutex;
+
+    static std::size_t s_size;
+
+    static std::size_t s_used;
+};
+
+//----------------------------------------------------------------------------
+
+/** Front end for a Berkely DB hash table.
+
+    If the filename ends in ".lsdb" the data is kept in a LogStore
+    instead. A LogStore can be read by several threads while another
+    thread writes to it, and a Put() is only durable after Flush(). */
 template<class T>
 class HashDB
 {
@@ -83,9 +126,16 @@ public:
     /** Flush the db to disk. */
     void Flush();
 
-    /** Returns statistics of the berkeley db. */
+    /** Calls visitor on every key and its packed data, including the
+        key of the database type. */
+    void ForEach(LogStore::Visitor& visitor) const;
+
+    /** Returns statistics of the berkeley db or log store. */
     std::string BDBStatistics();
 
+    /** Name of the database file. */
+    const std::string& Filename() const;
+
 private:
 
     static const int PERMISSION_FLAGS = 0664;
@@ -122,9 +172,21 @@ private:
 
     DB* m_db;
 
+    /** Log store used instead of m_db for ".lsdb" files. */
+    boost::scoped_ptr<LogStore> m_log;
+
+    /** T::Pack() may return a shared buffer; held from packing until
+        the data is written. */
+    boost::mutex m_packMutex;
+
     /** Name of database file. */
     std::string m_filename;
 
+    /** Size of the Berkeley DB cache; see HashDBCache. */
+    std::size_t m_cacheSize;
+
+    void OpenBDB();
+
     bool GetHeader(Header& header) const;
     
     void PutHeader(Header& header);
@@ -133,20 +195,13 @@ private:
 template<class T>
 HashDB<T>::HashDB(const std::string& filename, const std::string& type)
     : m_db(0),
-      m_filename(filename)
+      m_filename(filename),
+      m_cacheSize(0)
 {
-    int ret;
-    if ((ret = db_create(&m_db, NULL, 0)) != 0) 
-    {
-        fprintf(stderr, "db_create: %s\n", db_strerror(ret));
-        throw BenzeneException("HashDB: opening/creating db!");
-    }
-    if ((ret = m_db->open(m_db, NULL, filename.c_str(), NULL, 
-                          DB_HASH, DB_CREATE, PERMISSION_FLAGS)) != 0) 
-    {
-        m_db->err(m_db, ret, "%s", m_filename.c_str());
-        throw BenzeneException("HashDB: error opening db!");
-    }
+    if (LogStore::IsLogStoreName(filename))
+        m_log.reset(new LogStore(filename));
+    else
+        OpenBDB();
     Header newHeader(type);
     Header oldHeader;
     if (GetHeader(oldHeader))
@@ -161,9 +216,44 @@ HashDB<T>::HashDB(const std::string& filename, const std::string& type)
         PutHeader(newHeader);
 }
 
+template<class T>
+void HashDB<T>::OpenBDB()
+{
+    int ret;
+    if ((ret = db_create(&m_db, NULL, 0)) != 0) 
+    {
+        fprintf(stderr, "db_create: %s\n", db_strerror(ret));
+        throw BenzeneException("HashDB: opening/creating db!");
+    }
+    const std::size_t cacheSize = HashDBCache::Size();
+    if (cacheSize != 0
+        && (ret = m_db->set_cachesize
+            (m_db, static_cast<u_int32_t>(cacheSize >> 30),
+             static_cast<u_int32_t>(cacheSize & ((1 << 30) - 1)), 1)) != 0)
+    {
+        m_db->err(m_db, ret, "%s", m_filename.c_str());
+        throw BenzeneException("HashDB: error setting cache size!");
+    }
+    if ((ret = m_db->open(m_db, NULL, m_filename.c_str(), NULL, 
+                          DB_HASH, DB_CREATE, PERMISSION_FLAGS)) != 0) 
+    {
+        m_db->err(m_db, ret, "%s", m_filename.c_str());
+        throw BenzeneException("HashDB: error opening db!");
+    }
+    u_int32_t gbytes;
+    u_int32_t bytes;
+    int ncache;
+    if (m_db->get_cachesize(m_db, &gbytes, &bytes, &ncache) == 0)
+        m_cacheSize = (static_cast<std::size_t>(gbytes) << 30) + bytes;
+    HashDBCache::Add(m_cacheSize);
+}
+
 template<class T>
 HashDB<T>::~HashDB()
 {
+    if (m_log)
+        return;
+    HashDBCache::Remove(m_cacheSize);
     int ret;
     if ((ret = m_db->close(m_db, CLOSE_FLAGS)) != 0) 
     {
@@ -190,6 +280,8 @@ void HashDB<T>::PutHeader(Header& header)
 template<class T>
 bool HashDB<T>::Exists(SgHashCode hash) const
 {
+    if (m_log)
+        return m_log->Exists(&hash, sizeof(hash));
     DBT key, data;
     memset(&key, 0, sizeof(key)); 
     memset(&data, 0, sizeof(data)); 
@@ -215,6 +307,14 @@ bool HashDB<T>::Exists(SgHashCode hash) const
 template<class T>
 bool HashDB<T>::Get(SgHashCode hash, T& d) const
 {
+    if (m_log)
+    {
+        std::vector<byte> data;
+        if (!m_log->Get(&hash, sizeof(hash), data))
+            return false;
+        d.Unpack(&data[0], static_cast<int>(data.size()));
+        return true;
+    }
     DBT key, data;
     memset(&key, 0, sizeof(key)); 
     memset(&data, 0, sizeof(data)); 
@@ -225,7 +325,8 @@ bool HashDB<T>::Get(SgHashCode hash, T& d) const
     int ret = m_db->get(m_db, NULL, &key, &data, 0);
     switch(ret) {
     case 0:
-        d.Unpack(static_cast<byte*>(data.data));
+        d.Unpack(static_cast<byte*>(data.data), 
+                 static_cast<int>(data.size));
         return true;
 
     case DB_NOTFOUND:
@@ -242,6 +343,14 @@ bool HashDB<T>::Get(SgHashCode hash, T& d) const
 template<class T>
 bool HashDB<T>::Get(void* k, int ksize, void* d, int dsize) const
 {
+    if (m_log)
+    {
+        std::vector<byte> data;
+        if (!m_log->Get(k, ksize, data))
+            return false;
+        memcpy(d, &data[0], std::min(data.size(), std::size_t(dsize)));
+        return true;
+    }
     DBT key, data;
     memset(&key, 0, sizeof(key)); 
     memset(&data, 0, sizeof(data)); 
@@ -269,6 +378,12 @@ bool HashDB<T>::Get(void* k, int ksize, void* d, int dsize) const
 template<class T>
 bool HashDB<T>::Put(SgHashCode hash, const T& d)
 {
+    boost::mutex::scoped_lock lock(m_packMutex);
+    if (m_log)
+    {
+        m_log->Put(&hash, sizeof(hash), d.Pack(), d.PackedSize());
+        return true;
+    }
     DBT key, data; 
     memset(&key, 0, sizeof(key)); 
     memset(&data, 0, sizeof(data)); 
@@ -291,6 +406,11 @@ bool HashDB<T>::Put(SgHashCode hash, const T& d)
 template<class T>
 bool HashDB<T>::Put(void* k, int ksize, void* d, int dsize)
 {
+    if (m_log)
+    {
+        m_log->Put(k, ksize, d, dsize);
+        return true;
+    }
     DBT key, data; 
     memset(&key, 0, sizeof(key)); 
     memset(&data, 0, sizeof(data)); 
@@ -313,12 +433,53 @@ bool HashDB<T>::Put(void* k, int ksize, void* d, int dsize)
 template<class T>
 void HashDB<T>::Flush()
 {
+    if (m_log)
+    {
+        m_log->Flush();
+        return;
+    }
     m_db->sync(m_db, 0);
 }
 
+template<class T>
+void HashDB<T>::ForEach(LogStore::Visitor& visitor) const
+{
+    if (m_log)
+    {
+        m_log->ForEach(visitor);
+        return;
+    }
+    DBC* cursor;
+    int ret;
+    if ((ret = m_db->cursor(m_db, NULL, &cursor, 0)) != 0)
+    {
+        m_db->err(m_db, ret, "%s", m_filename.c_str());
+        throw BenzeneException("HashDB: error in ForEach()!");
+    }
+    DBT key, data;
+    memset(&key, 0, sizeof(key)); 
+    memset(&data, 0, sizeof(data)); 
+    while ((ret = cursor->c_get(cursor, &key, &data, DB_NEXT)) == 0)
+        visitor.Visit(key.data, key.size, data.data, data.size);
+    cursor->c_close(cursor);
+    if (ret != DB_NOTFOUND)
+    {
+        m_db->err(m_db, ret, "%s", m_filename.c_str());
+        throw BenzeneException("HashDB: error in ForEach()!");
+    }
+}
+
+template<class T>
+const std::string& HashDB<T>::Filename() const
+{
+    return m_filename;
+}
+
 template<class T>
 std::string HashDB<T>::BDBStatistics()
 {
+    if (m_log)
+        return m_log->Statistics();
     DB_HASH_STAT* stats_ptr;
     int ret;
     if ((ret = m_db->stat(m_db, NULL, &stats_ptr, 0)) != 0) {
@@ -74,6 +74,12 @@ public:
     /** Returns number of objects stored. */
     unsigned Count() const;
 
+    /** Returns the bytes used by the slots. */
+    std::size_t MemoryUsed() const;
+
+    /** Returns the bytes used by one slot. */
+    static std::size_t SlotSize();
+
     /** Retrieves object with key. 
         Returns true on success and object is copied into
         out. Otherwise, returns false.*/
@@ -195,6 +201,18 @@ inline unsigned HashMap<T>::Count() const
     return m_count;
 }
 
+template<typename T>
+inline std::size_t HashMap<T>::MemoryUsed() const
+{
+    return m_size * SlotSize();
+}
+
+template<typename T>
+inline std::size_t HashMap<T>::SlotSize()
+{
+    return sizeof(int) + sizeof(Data);
+}
+
 /** Performs linear probing to find key. */
 template<typename T>
 bool HashMap<T>::FindKey(const SgHashCode& key, unsigned& slot) const
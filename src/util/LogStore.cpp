@@ -0,0 +1,712 @@
+//----------------------------------------------------------------------------
+/** @file LogStore.cpp */
+//----------------------------------------------------------------------------
+
+#include "LogStore.hpp"
+#include "AtomicMemory.hpp"
+#include "BenzeneException.hpp"
+#include "Logger.hpp"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <boost/crc.hpp>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace benzene;
+
+//----------------------------------------------------------------------------
+
+struct LogStore::IndexHeader
+{
+    char m_magic[8];
+
+    boost::uint32_t m_version;
+
+    /** The index has 2^m_bits slots. */
+    boost::uint32_t m_bits;
+
+    /** Number of keys. */
+    boost::uint64_t m_count;
+
+    /** Number of records in the log, including replaced ones. */
+    boost::uint64_t m_records;
+
+    /** Size of the log at the last Flush(). */
+    boost::uint64_t m_indexedSize;
+
+    /** Size of the log after the last Put(). */
+    boost::uint64_t m_logSize;
+
+    /** 0 while the store is open; set on close after a final sync. */
+    boost::uint32_t m_clean;
+};
+
+/** Slot of the index; free if the fingerprint is 0. */
+struct LogStore::Slot
+{
+    volatile boost::uint64_t m_fingerprint;
+
+    volatile boost::uint64_t m_offset;
+};
+
+//----------------------------------------------------------------------------
+
+namespace {
+
+const char LOG_MAGIC[8] = { 'B', 'Z', 'L', 'O', 'G', 'D', 'B', '1' };
+
+const char INDEX_MAGIC[8] = { 'B', 'Z', 'L', 'O', 'G', 'I', 'X', '1' };
+
+const boost::uint32_t INDEX_VERSION = 2;
+
+const boost::uint32_t RECORD_MAGIC = 0x4c524543; // "LREC"
+
+/** The log starts with LOG_MAGIC, padded to this size. */
+const boost::uint64_t LOG_HEADER_SIZE = 16;
+
+/** Slots start at this offset in the index file. */
+const std::size_t INDEX_HEADER_SIZE = 64;
+
+const int INITIAL_BITS = 16;
+
+const int MAX_BITS = 40;
+
+/** Sanity limits for records read from disk. */
+const boost::uint32_t MAX_KEY_SIZE = 1 << 16;
+
+const boost::uint32_t MAX_DATA_SIZE = 1 << 26;
+
+struct RecordHeader
+{
+    boost::uint32_t m_magic;
+
+    boost::uint32_t m_keySize;
+
+    boost::uint32_t m_dataSize;
+
+    /** CRC-32 of the sizes, the key and the data. */
+    boost::uint32_t m_crc;
+};
+
+boost::uint32_t RecordCrc(boost::uint32_t keySize, boost::uint32_t dataSize,
+                          const void* key, const void* data)
+{
+    boost::crc_32_type crc;
+    crc.process_bytes(&keySize, sizeof(keySize));
+    crc.process_bytes(&dataSize, sizeof(dataSize));
+    crc.process_bytes(key, keySize);
+    crc.process_bytes(data, dataSize);
+    return crc.checksum();
+}
+
+/** 64-bit FNV-1a hash of the key; never 0, which marks free slots. */
+boost::uint64_t Fingerprint(const void* key, std::size_t keySize)
+{
+    const boost::uint64_t prime
+        = (static_cast<boost::uint64_t>(1) << 40) | 0x1b3u;
+    boost::uint64_t hash
+        = (static_cast<boost::uint64_t>(0xcbf29ce4u) << 32) | 0x84222325u;
+    const byte* p = static_cast<const byte*>(key);
+    for (std::size_t i = 0; i < keySize; ++i)
+    {
+        hash ^= p[i];
+        hash *= prime;
+    }
+    return hash == 0 ? 1 : hash;
+}
+
+/** Reads a value written by another thread, with a memory barrier. */
+inline boost::uint64_t AtomicRead(volatile boost::uint64_t* ptr)
+{
+    return FetchAndAdd(ptr, static_cast<boost::uint64_t>(0));
+}
+
+std::string ErrorString()
+{
+    return std::strerror(errno);
+}
+
+bool ReadAt(int fd, boost::uint64_t offset, void* buffer, std::size_t size)
+{
+    byte* p = static_cast<byte*>(buffer);
+    while (size > 0)
+    {
+        ssize_t n = pread(fd, p, size, static_cast<off_t>(offset));
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        p += n;
+        offset += n;
+        size -= n;
+    }
+    return true;
+}
+
+void WriteAt(int fd, boost::uint64_t offset, const void* buffer,
+             std::size_t size)
+{
+    const byte* p = static_cast<const byte*>(buffer);
+    while (size > 0)
+    {
+        ssize_t n = pwrite(fd, p, size, static_cast<off_t>(offset));
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            throw BenzeneException() << "LogStore: write failed: "
+                                     << ErrorString();
+        p += n;
+        offset += n;
+        size -= n;
+    }
+}
+
+bool FileExists(const std::string& name)
+{
+    struct stat st;
+    return stat(name.c_str(), &st) == 0;
+}
+
+} // namespace
+
+//----------------------------------------------------------------------------
+
+LogStore::LogStore(const std::string& filename)
+    : m_filename(filename),
+      m_logFd(-1),
+      m_logSize(0),
+      m_index(0)
+{
+    try {
+        OpenLog();
+        OpenIndex();
+        Recover();
+    }
+    catch (...) {
+        Close();
+        throw;
+    }
+}
+
+LogStore::~LogStore()
+{
+    try {
+        Flush();
+        MarkClean();
+    }
+    catch (const BenzeneException& e) {
+        LogSevere() << e.what() << '\n';
+    }
+    Close();
+}
+
+void LogStore::Close()
+{
+    if (m_index != 0)
+        UnmapIndex(m_index);
+    m_index = 0;
+    for (std::size_t i = 0; i < m_oldIndexes.size(); ++i)
+        UnmapIndex(m_oldIndexes[i]);
+    m_oldIndexes.clear();
+    if (m_logFd >= 0)
+        close(m_logFd);
+    m_logFd = -1;
+}
+
+//----------------------------------------------------------------------------
+
+void LogStore::OpenLog()
+{
+    m_logFd = open(m_filename.c_str(), O_RDWR | O_CREAT, 0664);
+    if (m_logFd < 0)
+        throw BenzeneException() << "LogStore: cannot open '" << m_filename
+                                 << "': " << ErrorString();
+    struct stat st;
+    if (fstat(m_logFd, &st) != 0)
+        throw BenzeneException() << "LogStore: cannot stat '" << m_filename
+                                 << "': " << ErrorString();
+    if (st.st_size == 0)
+    {
+        byte header[LOG_HEADER_SIZE];
+        std::memset(header, 0, sizeof(header));
+        std::memcpy(header, LOG_MAGIC, sizeof(LOG_MAGIC));
+        WriteAt(m_logFd, 0, header, sizeof(header));
+        m_logSize = LOG_HEADER_SIZE;
+        return;
+    }
+    char magic[sizeof(LOG_MAGIC)];
+    if (!ReadAt(m_logFd, 0, magic, sizeof(magic))
+        || std::memcmp(magic, LOG_MAGIC, sizeof(LOG_MAGIC)) != 0)
+        throw BenzeneException() << "LogStore: '" << m_filename
+                                 << "' is not a log store";
+    m_logSize = static_cast<boost::uint64_t>(st.st_size);
+}
+
+void LogStore::OpenIndex()
+{
+    std::string name = m_filename + ".idx";
+    if (FileExists(name))
+    {
+        int fd = open(name.c_str(), O_RDONLY);
+        IndexHeader header;
+        bool ok = fd >= 0 && ReadAt(fd, 0, &header, sizeof(header));
+        if (fd >= 0)
+            close(fd);
+        if (ok && std::memcmp(header.m_magic, INDEX_MAGIC,
+                              sizeof(INDEX_MAGIC)) == 0
+            && header.m_version == INDEX_VERSION
+            && header.m_bits >= static_cast<boost::uint32_t>(INITIAL_BITS)
+            && header.m_bits <= static_cast<boost::uint32_t>(MAX_BITS)
+            && header.m_indexedSize >= LOG_HEADER_SIZE
+            && header.m_indexedSize <= m_logSize)
+        {
+            m_index = MapIndex(name, header.m_bits, false);
+            return;
+        }
+        LogWarning() << "LogStore: rebuilding bad index '" << name << "'\n";
+    }
+    m_index = MapIndex(name, INITIAL_BITS, true);
+}
+
+LogStore::Index* LogStore::MapIndex(const std::string& name, int bits,
+                                    bool create)
+{
+    const std::size_t size = INDEX_HEADER_SIZE
+        + (static_cast<std::size_t>(1) << bits) * sizeof(Slot);
+    int flags = O_RDWR | (create ? O_CREAT | O_TRUNC : 0);
+    int fd = open(name.c_str(), flags, 0664);
+    if (fd < 0)
+        throw BenzeneException() << "LogStore: cannot open '" << name
+                                 << "': " << ErrorString();
+    if (create && ftruncate(fd, static_cast<off_t>(size)) != 0)
+    {
+        close(fd);
+        throw BenzeneException() << "LogStore: cannot size '" << name
+                                 << "': " << ErrorString();
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) != size)
+    {
+        close(fd);
+        throw BenzeneException() << "LogStore: bad index size '" << name
+                                 << "'";
+    }
+    void* map = mmap(0, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+        throw BenzeneException() << "LogStore: cannot map '" << name
+                                 << "': " << ErrorString();
+    Index* index = new Index();
+    index->m_map = map;
+    index->m_mapSize = size;
+    index->m_header = static_cast<IndexHeader*>(map);
+    index->m_slots = reinterpret_cast<Slot*>(static_cast<byte*>(map)
+                                             + INDEX_HEADER_SIZE);
+    index->m_mask = (static_cast<boost::uint64_t>(1) << bits) - 1;
+    if (create)
+    {
+        IndexHeader& header = *index->m_header;
+        std::memcpy(header.m_magic, INDEX_MAGIC, sizeof(INDEX_MAGIC));
+        header.m_version = INDEX_VERSION;
+        header.m_bits = bits;
+        header.m_count = 0;
+        header.m_records = 0;
+        header.m_indexedSize = LOG_HEADER_SIZE;
+        header.m_logSize = LOG_HEADER_SIZE;
+        // Empty, so replaying the whole log builds it
+        header.m_clean = 1;
+    }
+    return index;
+}
+
+void LogStore::UnmapIndex(Index* index)
+{
+    msync(index->m_map, index->m_mapSize, MS_SYNC);
+    munmap(index->m_map, index->m_mapSize);
+    delete index;
+}
+
+//----------------------------------------------------------------------------
+
+bool LogStore::ReadRecord(boost::uint64_t offset, std::vector<byte>& record,
+                          boost::uint64_t& next) const
+{
+    RecordHeader header;
+    if (!ReadAt(m_logFd, offset, &header, sizeof(header))
+        || header.m_magic != RECORD_MAGIC
+        || header.m_keySize > MAX_KEY_SIZE
+        || header.m_dataSize > MAX_DATA_SIZE)
+        return false;
+    // Key size goes in front of the key and data
+    record.resize(sizeof(boost::uint32_t) + header.m_keySize
+                  + header.m_dataSize);
+    std::memcpy(&record[0], &header.m_keySize, sizeof(boost::uint32_t));
+    byte* body = &record[0] + sizeof(boost::uint32_t);
+    if (!ReadAt(m_logFd, offset + sizeof(header), body,
+                header.m_keySize + header.m_dataSize))
+        return false;
+    if (RecordCrc(header.m_keySize, header.m_dataSize, body,
+                  body + header.m_keySize) != header.m_crc)
+        return false;
+    next = offset + sizeof(header) + header.m_keySize + header.m_dataSize;
+    return true;
+}
+
+namespace {
+
+/** Key size of a record read by ReadRecord(). */
+std::size_t RecordKeySize(const std::vector<byte>& record)
+{
+    boost::uint32_t keySize;
+    std::memcpy(&keySize, &record[0], sizeof(keySize));
+    return keySize;
+}
+
+const byte* RecordKey(const std::vector<byte>& record)
+{
+    return &record[0] + sizeof(boost::uint32_t);
+}
+
+bool RecordHasKey(const std::vector<byte>& record, const void* key,
+                  std::size_t keySize)
+{
+    return RecordKeySize(record) == keySize
+        && std::memcmp(RecordKey(record), key, keySize) == 0;
+}
+
+} // namespace
+
+const LogStore::Slot* LogStore::Find(const Index& index,
+                                     boost::uint64_t fingerprint,
+                                     const void* key, std::size_t keySize,
+                                     std::vector<byte>& record) const
+{
+    for (boost::uint64_t i = fingerprint & index.m_mask; ;
+         i = (i + 1) & index.m_mask)
+    {
+        Slot& slot = index.m_slots[i];
+        boost::uint64_t f = slot.m_fingerprint;
+        if (f == 0)
+            return 0;
+        if (f != fingerprint)
+            continue;
+        boost::uint64_t next;
+        if (ReadRecord(AtomicRead(&slot.m_offset), record, next)
+            && RecordHasKey(record, key, keySize))
+            return &slot;
+    }
+}
+
+void LogStore::Insert(Index& index, boost::uint64_t fingerprint,
+                      const void* key, std::size_t keySize,
+                      boost::uint64_t offset)
+{
+    std::vector<byte> record;
+    for (boost::uint64_t i = fingerprint & index.m_mask; ;
+         i = (i + 1) & index.m_mask)
+    {
+        Slot& slot = index.m_slots[i];
+        boost::uint64_t f = slot.m_fingerprint;
+        if (f == 0)
+        {
+            // Publish the offset before the fingerprint, so readers
+            // that see the fingerprint see a valid offset
+            slot.m_offset = offset;
+            CompareAndSwap(&slot.m_fingerprint,
+                           static_cast<boost::uint64_t>(0), fingerprint);
+            ++index.m_header->m_count;
+            return;
+        }
+        if (f != fingerprint)
+            continue;
+        boost::uint64_t old = slot.m_offset;
+        boost::uint64_t next;
+        if (ReadRecord(old, record, next)
+            && RecordHasKey(record, key, keySize))
+        {
+            CompareAndSwap(&slot.m_offset, old, offset);
+            return;
+        }
+    }
+}
+
+void LogStore::Grow()
+{
+    Index* oldIndex = m_index;
+    const int bits = static_cast<int>(oldIndex->m_header->m_bits) + 1;
+    if (bits > MAX_BITS)
+        throw BenzeneException() << "LogStore: index of '" << m_filename
+                                 << "' is full";
+    const std::string name = m_filename + ".idx";
+    const std::string tmpName = name + ".tmp";
+    Index* index = MapIndex(tmpName, bits, true);
+    *index->m_header = *oldIndex->m_header;
+    index->m_header->m_bits = bits;
+    // Keys in the old index are distinct, so no records need to be
+    // read: every entry goes into the first free slot
+    for (boost::uint64_t i = 0; i <= oldIndex->m_mask; ++i)
+    {
+        const Slot& slot = oldIndex->m_slots[i];
+        if (slot.m_fingerprint == 0)
+            continue;
+        boost::uint64_t j = slot.m_fingerprint & index->m_mask;
+        while (index->m_slots[j].m_fingerprint != 0)
+            j = (j + 1) & index->m_mask;
+        index->m_slots[j].m_offset = slot.m_offset;
+        index->m_slots[j].m_fingerprint = slot.m_fingerprint;
+    }
+    msync(index->m_map, index->m_mapSize, MS_SYNC);
+    if (std::rename(tmpName.c_str(), name.c_str()) != 0)
+    {
+        UnmapIndex(index);
+        throw BenzeneException() << "LogStore: cannot replace '" << name
+                                 << "': " << ErrorString();
+    }
+    CompareAndSwap(&m_index, oldIndex, index);
+    m_oldIndexes.push_back(oldIndex);
+}
+
+//----------------------------------------------------------------------------
+
+boost::uint64_t LogStore::Replay(boost::uint64_t from)
+{
+    std::vector<byte> record;
+    boost::uint64_t offset = from;
+    boost::uint64_t next;
+    while (offset < m_logSize && ReadRecord(offset, record, next))
+    {
+        std::size_t keySize = RecordKeySize(record);
+        const byte* key = RecordKey(record);
+        if ((m_index->m_header->m_count + 1) * 2 > m_index->m_mask + 1)
+            Grow();
+        Insert(*m_index, Fingerprint(key, keySize), key, keySize, offset);
+        ++m_index->m_header->m_records;
+        offset = next;
+    }
+    return offset;
+}
+
+/** Rebuilds the index from the records before logEnd. Returns the
+    end of the last valid record. */
+boost::uint64_t LogStore::RebuildIndex(boost::uint64_t logEnd)
+{
+    const std::string name = m_filename + ".idx";
+    UnmapIndex(m_index);
+    m_index = MapIndex(name, INITIAL_BITS, true);
+    m_logSize = logEnd;
+    return Replay(LOG_HEADER_SIZE);
+}
+
+/** After a clean close, the index covers the whole log. Otherwise
+    the slots changed since the last Flush() may have reached the
+    disk while the records they point to did not, so the index is
+    rebuilt from the log. */
+void LogStore::Recover()
+{
+    const boost::uint64_t fileSize = m_logSize;
+    const bool clean = m_index->m_header->m_clean != 0;
+    boost::uint64_t validEnd;
+    if (clean)
+        validEnd = Replay(m_index->m_header->m_indexedSize);
+    else
+    {
+        LogWarning() << "LogStore: '" << m_filename << "' was not closed"
+                     << " cleanly; rebuilding index\n";
+        validEnd = RebuildIndex(fileSize);
+    }
+    if (validEnd < fileSize)
+    {
+        LogWarning() << "LogStore: '" << m_filename << "' has a torn record"
+                     << " at offset " << validEnd << "; truncating "
+                     << (fileSize - validEnd) << " bytes\n";
+        if (ftruncate(m_logFd, static_cast<off_t>(validEnd)) != 0)
+            throw BenzeneException() << "LogStore: cannot truncate '"
+                                     << m_filename << "': " << ErrorString();
+        if (clean)
+            RebuildIndex(validEnd);
+    }
+    m_logSize = validEnd;
+    m_index->m_header->m_logSize = validEnd;
+    m_index->m_header->m_indexedSize = validEnd;
+    m_index->m_header->m_clean = 0;
+    msync(m_index->m_map, m_index->m_mapSize, MS_SYNC);
+}
+
+/** Called after the final Flush(), so the index covers the log. */
+void LogStore::MarkClean()
+{
+    boost::mutex::scoped_lock lock(m_writeMutex);
+    m_index->m_header->m_clean = 1;
+    msync(m_index->m_map, INDEX_HEADER_SIZE, MS_SYNC);
+}
+
+//----------------------------------------------------------------------------
+
+bool LogStore::Exists(const void* key, std::size_t keySize) const
+{
+    std::vector<byte> record;
+    return Find(*m_index, Fingerprint(key, keySize), key, keySize, record)
+        != 0;
+}
+
+bool LogStore::Get(const void* key, std::size_t keySize,
+                   std::vector<byte>& data) const
+{
+    std::vector<byte> record;
+    if (Find(*m_index, Fingerprint(key, keySize), key, keySize, record) == 0)
+        return false;
+    data.assign(record.begin() + sizeof(boost::uint32_t) + keySize,
+                record.end());
+    return true;
+}
+
+void LogStore::Put(const void* key, std::size_t keySize,
+                   const void* data, std::size_t dataSize)
+{
+    if (keySize > MAX_KEY_SIZE || dataSize > MAX_DATA_SIZE)
+        throw BenzeneException() << "LogStore: record too large";
+    boost::mutex::scoped_lock lock(m_writeMutex);
+    RecordHeader header;
+    header.m_magic = RECORD_MAGIC;
+    header.m_keySize = static_cast<boost::uint32_t>(keySize);
+    header.m_dataSize = static_cast<boost::uint32_t>(dataSize);
+    header.m_crc = RecordCrc(header.m_keySize, header.m_dataSize, key, data);
+    std::vector<byte> buffer(sizeof(header) + keySize + dataSize);
+    std::memcpy(&buffer[0], &header, sizeof(header));
+    std::memcpy(&buffer[sizeof(header)], key, keySize);
+    if (dataSize > 0)
+        std::memcpy(&buffer[sizeof(header) + keySize], data, dataSize);
+    const boost::uint64_t offset = m_logSize;
+    WriteAt(m_logFd, offset, &buffer[0], buffer.size());
+    m_logSize += buffer.size();
+    if ((m_index->m_header->m_count + 1) * 2 > m_index->m_mask + 1)
+        Grow();
+    Insert(*m_index, Fingerprint(key, keySize), key, keySize, offset);
+    ++m_index->m_header->m_records;
+    m_index->m_header->m_logSize = m_logSize;
+}
+
+void LogStore::Flush()
+{
+    boost::mutex::scoped_lock lock(m_writeMutex);
+    if (m_index == 0 || m_index->m_header->m_indexedSize == m_logSize)
+        return;
+    if (fsync(m_logFd) != 0)
+        throw BenzeneException() << "LogStore: cannot sync '" << m_filename
+                                 << "': " << ErrorString();
+    msync(m_index->m_map, m_index->m_mapSize, MS_SYNC);
+    // Checkpoint only after the slots pointing into the log are on disk
+    m_index->m_header->m_indexedSize = m_logSize;
+    msync(m_index->m_map, INDEX_HEADER_SIZE, MS_SYNC);
+}
+
+std::size_t LogStore::Count() const
+{
+    return static_cast<std::size_t>(m_index->m_header->m_count);
+}
+
+std::string LogStore::Statistics() const
+{
+    const Index& index = *m_index;
+    std::ostringstream os;
+    os << "[\n"
+       << "keys=" << index.m_header->m_count << '\n'
+       << "records=" << index.m_header->m_records << '\n'
+       << "logbytes=" << m_logSize << '\n'
+       << "slots=" << (index.m_mask + 1) << '\n'
+       << ']';
+    return os.str();
+}
+
+//----------------------------------------------------------------------------
+
+LogStore::Visitor::~Visitor()
+{
+}
+
+void LogStore::ForEach(Visitor& visitor) const
+{
+    const Index& index = *m_index;
+    std::vector<byte> record;
+    for (boost::uint64_t i = 0; i <= index.m_mask; ++i)
+    {
+        const Slot& slot = index.m_slots[i];
+        boost::uint64_t next;
+        if (slot.m_fingerprint == 0)
+            continue;
+        if (!ReadRecord(slot.m_offset, record, next))
+            throw BenzeneException() << "LogStore: bad record in '"
+                                     << m_filename << "'";
+        std::size_t keySize = RecordKeySize(record);
+        const byte* key = RecordKey(record);
+        visitor.Visit(key, keySize, key + keySize,
+                      record.size() - sizeof(boost::uint32_t) - keySize);
+    }
+}
+
+namespace {
+
+/** Copies every entry to another store. */
+class CopyVisitor : public LogStore::Visitor
+{
+public:
+    explicit CopyVisitor(LogStore& target)
+        : m_target(target)
+    { }
+
+    void Visit(const void* key, std::size_t keySize,
+               const void* data, std::size_t dataSize)
+    {
+        m_target.Put(key, keySize, data, dataSize);
+    }
+
+private:
+    LogStore& m_target;
+};
+
+} // namespace
+
+void LogStore::Compact(const std::string& filename)
+{
+    const std::string tmpName = filename + ".compact";
+    std::remove(tmpName.c_str());
+    std::remove((tmpName + ".idx").c_str());
+    std::size_t before;
+    std::size_t after;
+    {
+        LogStore source(filename);
+        LogStore target(tmpName);
+        CopyVisitor copy(target);
+        source.ForEach(copy);
+        target.Flush();
+        before = static_cast<std::size_t>
+            (source.m_index->m_header->m_records);
+        after = static_cast<std::size_t>(target.m_index->m_header->m_records);
+    }
+    // Without an index, a crash between the renames only costs a
+    // rebuild of the index
+    std::remove((filename + ".idx").c_str());
+    if (std::rename(tmpName.c_str(), filename.c_str()) != 0
+        || std::rename((tmpName + ".idx").c_str(),
+                       (filename + ".idx").c_str()) != 0)
+        throw BenzeneException() << "LogStore: cannot replace '" << filename
+                                 << "': " << ErrorString();
+    LogInfo() << "LogStore: compacted '" << filename << "' from " << before
+              << " to " << after << " records\n";
+}
+
+bool LogStore::IsLogStoreName(const std::string& filename)
+{
+    const std::string suffix = ".lsdb";
+    return filename.size() >= suffix.size()
+        && filename.compare(filename.size() - suffix.size(),
+                            suffix.size(), suffix) == 0;
+}
+
+//----------------------------------------------------------------------------
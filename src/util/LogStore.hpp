@@ -0,0 +1,177 @@
+//----------------------------------------------------------------------------
+/** @file LogStore.hpp */
+//----------------------------------------------------------------------------
+
+#ifndef LOGSTORE_HPP
+#define LOGSTORE_HPP
+
+#include <string>
+#include <vector>
+#include <boost/cstdint.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include "Benzene.hpp"
+#include "Types.hpp"
+
+_BEGIN_BENZENE_NAMESPACE_
+
+//----------------------------------------------------------------------------
+
+/** Embedded key/value store made of an append-only log and an index.
+
+    Every Put() appends a record (key, data and a checksum) to the log
+    file. The index, a second file mapped into memory, is an open
+    addressing hash table from a 64-bit fingerprint of the key to the
+    offset of the newest record for that key. Records that are
+    replaced stay in the log until it is compacted with Compact().
+
+    Readers do not take locks: Get() and Exists() read the index
+    slots atomically and the log with positional reads, so any number
+    of threads can read while one thread writes. Writers are
+    serialized. Puts are written to the operating system right away
+    but only made durable by Flush(), so many puts share one sync
+    (group commit). This needs HAVE_GCC_ATOMIC_BUILTINS; without it
+    readers must not run concurrently with a writer.
+
+    The index records how much of the log it covers at the last
+    Flush(), and whether the store was closed cleanly. Opening a
+    store that was not closed cleanly rebuilds the index from the
+    whole log, since slots may have reached the disk without their
+    records. A torn record at the end of the log is cut off.
+
+    For a store named "file", the log is "file" and the index is
+    "file.idx". Keys can have any size, but each key must always be
+    written with the same size.
+*/
+class LogStore
+{
+public:
+    /** Receives the entries of a store from ForEach(). */
+    class Visitor
+    {
+    public:
+        virtual ~Visitor();
+
+        virtual void Visit(const void* key, std::size_t keySize,
+                           const void* data, std::size_t dataSize) = 0;
+    };
+
+    /** Opens the store, creating it if it does not exist, and
+        recovers from an unclean shutdown. Throws a BenzeneException
+        if the files cannot be used. */
+    explicit LogStore(const std::string& filename);
+
+    /** Flushes and closes the store. */
+    ~LogStore();
+
+    /** Returns true if key is in the store. */
+    bool Exists(const void* key, std::size_t keySize) const;
+
+    /** Copies the data for key into data. Returns false if key is not
+        in the store. */
+    bool Get(const void* key, std::size_t keySize,
+             std::vector<byte>& data) const;
+
+    /** Stores data under key, replacing any previous data. */
+    void Put(const void* key, std::size_t keySize,
+             const void* data, std::size_t dataSize);
+
+    /** Makes all puts so far durable and checkpoints the index. */
+    void Flush();
+
+    /** Calls visitor with the newest data of every key, in no
+        particular order. Must not run concurrently with Put(). */
+    void ForEach(Visitor& visitor) const;
+
+    /** Number of keys. */
+    std::size_t Count() const;
+
+    /** Returns a description of the store: number of keys and
+        records, size of the log and index. */
+    std::string Statistics() const;
+
+    /** Rewrites the store so that the log holds only the newest record
+        of each key. The store must not be open. */
+    static void Compact(const std::string& filename);
+
+    /** Returns true if filename names a log store rather than a
+        Berkeley DB, that is, if it ends in ".lsdb". */
+    static bool IsLogStoreName(const std::string& filename);
+
+private:
+    struct IndexHeader;
+
+    struct Slot;
+
+    /** A mapping of the index file. */
+    struct Index
+    {
+        void* m_map;
+
+        std::size_t m_mapSize;
+
+        IndexHeader* m_header;
+
+        Slot* m_slots;
+
+        boost::uint64_t m_mask;
+    };
+
+    std::string m_filename;
+
+    int m_logFd;
+
+    /** Size of the log; only changed by the writer. */
+    boost::uint64_t m_logSize;
+
+    /** Current index. Replaced when the index grows; readers load
+        it once per lookup. */
+    Index* volatile m_index;
+
+    /** Previous mappings of the index, kept until the store is closed
+        since readers may still use them. */
+    std::vector<Index*> m_oldIndexes;
+
+    boost::mutex m_writeMutex;
+
+    LogStore(const LogStore& other);
+
+    void operator=(const LogStore& other);
+
+    void OpenLog();
+
+    void OpenIndex();
+
+    Index* MapIndex(const std::string& name, int bits, bool create);
+
+    void UnmapIndex(Index* index);
+
+    void Recover();
+
+    boost::uint64_t RebuildIndex(boost::uint64_t logEnd);
+
+    void MarkClean();
+
+    boost::uint64_t Replay(boost::uint64_t from);
+
+    void Grow();
+
+    bool ReadRecord(boost::uint64_t offset, std::vector<byte>& record,
+                    boost::uint64_t& next) const;
+
+    const Slot* Find(const Index& index, boost::uint64_t fingerprint,
+                     const void* key, std::size_t keySize,
+                     std::vector<byte>& record) const;
+
+    void Insert(Index& index, boost::uint64_t fingerprint,
+                const void* key, std::size_t keySize,
+                boost::uint64_t offset);
+
+    void Close();
+};
+
+//----------------------------------------------------------------------------
+
+_END_BENZENE_NAMESPACE_
+
+#endif // LOGSTORE_HPP
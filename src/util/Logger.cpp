@@ -2,6 +2,7 @@
 /** @file Logger.cpp */
 //----------------------------------------------------------------------------
 
+#include <algorithm>
 #include <iomanip>
 #include "Logger.hpp"
 
@@ -9,17 +10,50 @@ using namespace benzene;
 
 //----------------------------------------------------------------------------
 
+Logger::ThreadBuffer::ThreadBuffer()
+    : buffer(),
+      stream(&buffer),
+      level(LOG_LEVEL_ALL),
+      id(pthread_self())
+{
+}
+
+//----------------------------------------------------------------------------
+
 Logger::Logger()
     : m_streams(),
-      m_levels()
+      m_levels(),
+      m_min_level(LOG_LEVEL_OFF),
+      m_queue(),
+      m_writing(false),
+      m_shutdown(false),
+      m_async(false)
 {
-    for (int i = 0; i < MAX_THREADS; ++i)
-        m_thread_buffer[i].id = 0;
+    pthread_mutex_init(&m_stream_mutex, 0);
+    pthread_mutex_init(&m_queue_mutex, 0);
+    pthread_cond_init(&m_queue_cond, 0);
+    pthread_cond_init(&m_empty_cond, 0);
+    pthread_key_create(&m_key, &Logger::DeleteThreadBuffer);
     AddStream(std::cerr, LOG_LEVEL_INFO);
+    m_async = (pthread_create(&m_sink, 0, &Logger::SinkThreadMain, this) 
+               == 0);
 }
 
 Logger::~Logger()
 {
+    if (m_async)
+    {
+        pthread_mutex_lock(&m_queue_mutex);
+        m_shutdown = true;
+        pthread_cond_signal(&m_queue_cond);
+        pthread_mutex_unlock(&m_queue_mutex);
+        pthread_join(m_sink, 0);
+    }
+    pthread_key_delete(m_key);
+    pthread_cond_destroy(&m_empty_cond);
+    pthread_cond_destroy(&m_queue_cond);
+    pthread_mutex_destroy(&m_queue_mutex);
+    pthread_mutex_destroy(&m_stream_mutex);
 }
 
 Logger& Logger::Global()
@@ -32,97 +66,139 @@ Logger& Logger::Global()
 
 void Logger::AddStream(std::ostream& stream, LogLevel level)
 {
+    pthread_mutex_lock(&m_stream_mutex);
     m_streams.push_back(&stream);
     m_levels.push_back(level);
+    UpdateMinLevel();
+    pthread_mutex_unlock(&m_stream_mutex);
 }
 
 void Logger::ClearStreams()
 {
+    WaitForSink();
+    pthread_mutex_lock(&m_stream_mutex);
     m_streams.clear();
     m_levels.clear();
+    UpdateMinLevel();
+    pthread_mutex_unlock(&m_stream_mutex);
 }
 
-Logger::ThreadBuffer& Logger::GetThreadBuffer()
+void Logger::UpdateMinLevel()
 {
-    int i;
-    int first_empty = -1;
-    pthread_t self = pthread_self();
-    pthread_mutex_lock(&m_buffer_mutex);
-    // look for a pre-existing buffer for this thread
-    for (i = 0; i < MAX_THREADS; ++i) 
-    {
-        if (m_thread_buffer[i].id == self)
-            break;
-        else if (m_thread_buffer[i].id == 0 && first_empty == -1)
-            first_empty = i;
-    }
-    if (i == MAX_THREADS)
-    {
-        // if one does not exist, use the first empty buffer
-        if (first_empty != -1) 
-        {
-            m_thread_buffer[first_empty].id = self;
-            i = first_empty;
-        }
-        else
-        {
-            // no free buffer... just return first buffer. This sucks!!
-            std::cerr << "####### LOG HAS NO FREE BUFFER! #######\n";
-            i = 0;
-        }
-    }
-    pthread_mutex_unlock(&m_buffer_mutex);
-    return m_thread_buffer[i];
+    int level = LOG_LEVEL_OFF;
+    for (std::size_t i = 0; i < m_levels.size(); ++i)
+        level = std::min(level, static_cast<int>(m_levels[i]));
+    m_min_level = level;
 }
 
-void Logger::SetLevel(LogLevel level)
+Logger::ThreadBuffer& Logger::CreateThreadBuffer()
 {
-    pthread_mutex_lock(&m_map_mutex);
-    m_thread_level[pthread_self()] = level;
-    pthread_mutex_unlock(&m_map_mutex);
+    ThreadBuffer* tb = new ThreadBuffer();
+    pthread_setspecific(m_key, tb);
+    return *tb;
 }
 
-LogLevel Logger::GetThreadLevel()
+void Logger::DeleteThreadBuffer(void* tb)
 {
-    LogLevel level;
-    pthread_mutex_lock(&m_map_mutex);    
-    level = m_thread_level[pthread_self()];
-    pthread_mutex_unlock(&m_map_mutex);
-    return level;
+    delete static_cast<ThreadBuffer*>(tb);
+}
+
+void Logger::Enqueue(ThreadBuffer& tb)
+{
+    Message message;
+    message.level = tb.level;
+    message.id = tb.id;
+    message.text = tb.buffer.str();
+    tb.buffer.str("");
+    if (!m_async)
+    {
+        pthread_mutex_lock(&m_stream_mutex);
+        Write(message);
+        pthread_mutex_unlock(&m_stream_mutex);
+        return;
+    }
+    pthread_mutex_lock(&m_queue_mutex);
+    m_queue.push_back(message);
+    pthread_cond_signal(&m_queue_cond);
+    pthread_mutex_unlock(&m_queue_mutex);
+    // A severe message is often the last thing logged before an
+    // abort, so it must be written before returning.
+    if (message.level >= LOG_LEVEL_SEVERE)
+        WaitForSink();
 }
 
 void Logger::Flush()
 {
-    ThreadBuffer& buffer = GetThreadBuffer();
-    if (buffer.buffer.str() == "") 
+    ThreadBuffer& tb = GetThreadBuffer();
+    if (tb.buffer.str() != "")
+        Enqueue(tb);
+    WaitForSink();
+}
+
+void Logger::WaitForSink()
+{
+    if (!m_async)
         return;
-    // dump msg to handlers of appropriate level; grab the
-    // buffer mutex so no one else can do this or change the
-    // buffers in any way. 
-    pthread_mutex_lock(&m_buffer_mutex);
+    pthread_mutex_lock(&m_queue_mutex);
+    while (!m_queue.empty() || m_writing)
+        pthread_cond_wait(&m_empty_cond, &m_queue_mutex);
+    pthread_mutex_unlock(&m_queue_mutex);
+}
+
+void Logger::Write(const Message& message)
+{
     for (std::size_t i = 0; i < m_streams.size(); ++i) 
     {
-        LogLevel level = GetThreadLevel();
-        if (level < m_levels[i]) 
+        if (message.level < m_levels[i]) 
             continue;
         std::ostream& stream = *m_streams[i];
 #ifdef __CYGWIN__
         // pthread_t is a pointer type in Cygwin
         long unsigned int self =
-            reinterpret_cast<long unsigned int>(pthread_self());
+            reinterpret_cast<long unsigned int>(message.id);
 #else
-        long unsigned int self = (long unsigned int)pthread_self();
+        long unsigned int self = (long unsigned int)message.id;
 #endif
         stream << std::hex << std::setfill('0') 
                << std::setw(5) << ((self >> 8) & 0xfffff) << " " 
-               << LogLevelUtil::toString(level) << ": " 
-               << buffer.buffer.str();
+               << LogLevelUtil::toString(message.level) << ": " 
+               << message.text;
         stream.flush();
     }
-    // clear buffer and set it to unused
-    buffer.buffer.str("");
-    buffer.id = 0;
-    pthread_mutex_unlock(&m_buffer_mutex);
+}
+
+void* Logger::SinkThreadMain(void* logger)
+{
+    static_cast<Logger*>(logger)->SinkLoop();
+    return 0;
+}
+
+void Logger::SinkLoop()
+{
+    std::vector<Message> batch;
+    pthread_mutex_lock(&m_queue_mutex);
+    while (true)
+    {
+        while (m_queue.empty() && !m_shutdown)
+            pthread_cond_wait(&m_queue_cond, &m_queue_mutex);
+        if (m_queue.empty())
+            break;
+        batch.swap(m_queue);
+        m_writing = true;
+        pthread_mutex_unlock(&m_queue_mutex);
+
+        pthread_mutex_lock(&m_stream_mutex);
+        for (std::size_t i = 0; i < batch.size(); ++i)
+            Write(batch[i]);
+        pthread_mutex_unlock(&m_stream_mutex);
+        batch.clear();
+
+        pthread_mutex_lock(&m_queue_mutex);
+        m_writing = false;
+        if (m_queue.empty())
+            pthread_cond_broadcast(&m_empty_cond);
+    }
+    pthread_mutex_unlock(&m_queue_mutex);
 }
 
 //----------------------------------------------------------------------------
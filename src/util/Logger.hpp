@@ -8,8 +8,8 @@
 #include <fstream>
 #include <iostream>
 #include <sstream>
+#include <string>
 #include <vector>
-#include <map>
 #include <pthread.h>
 #include "Benzene.hpp"
 
@@ -80,12 +80,15 @@ namespace LogLevelUtil
     When the Logger receives a message at level L, all streams with level 
     at least L will be sent a copy of the message.
 
-    Logger handles messages coming from multiple threads internally. A
-    LogLevel for each thread is maintained, and separate buffers are
-    used for messages being formed simulataneously in different
-    threads.  Blocking is used to grant a thread exclusive access to
-    the streams when printing; this potentially could cause slowdown
-    if several threads are dumping lots of text simultaneously.
+    Each thread has its own buffer and LogLevel, found through
+    thread-specific data, so forming a message takes no locks.  Text
+    sent at a level below that of every stream is dropped before it is
+    formatted.  Completed lines are queued and written to the streams
+    by a background thread; only the short queue operation is
+    serialized between threads.  Flush() waits until the queue has
+    been written.  A severe message is written, together with all
+    messages queued before it, before the line that completes it
+    returns.
 */
 class Logger
 {
@@ -95,7 +98,7 @@ public:
         at LOG_LEVEL_INFO. */
     Logger();
 
-    /** Destructor. */
+    /** Destructor. Writes all queued messages. */
     ~Logger();
 
     /** Returns the global Logger object. */
@@ -104,68 +107,151 @@ public:
     /** Adds a handler to this logger at the given level. */
     void AddStream(std::ostream& stream, LogLevel level);
 
-    /** Removes all output streams. */
+    /** Removes all output streams. Queued messages are written to
+        the old streams first. */
     void ClearStreams();
     
     /** Sets the level of all messages this logger receives from now
         on. */
     void SetLevel(LogLevel level);
 
-    /** Flushes the log. */
+    /** Queues the current thread's pending text and blocks until all
+        queued messages have been written to the streams. */
     void Flush();
 
-    /** Pipes text into the log. If text ends in a '\n', log is
-        flushed. */
+    /** Pipes text into the log. If text ends in a '\n', the line is
+        queued for output. */
     template<typename TYPE>
     Logger& operator<<(const TYPE& type);
 
 private:
 
-    /** Maximum number of threads handled at once. */
-    static const int MAX_THREADS = 16;
+    /** String buffer that can tell if its last character is a
+        newline without copying its contents. */
+    class LineBuffer : public std::stringbuf
+    {
+    public:
+        bool EndsWithNewline() const;
+    };
 
     /** Buffer for a thread of execution. */
     struct ThreadBuffer
     {
-        std::ostringstream buffer;
+        LineBuffer buffer;
+
+        std::ostream stream;
+
+        LogLevel level;
+
+        pthread_t id;
+
+        ThreadBuffer();
+    };
+
+    /** A completed line waiting for the sink thread. */
+    struct Message
+    {
+        LogLevel level;
+
         pthread_t id;
+
+        std::string text;
     };
 
     /** Returns the buffer for the current thread. */
     ThreadBuffer& GetThreadBuffer();
 
-    /** Returns the current loglevel for the thread. */
-    LogLevel GetThreadLevel();
+    /** Allocates the buffer for the current thread. */
+    ThreadBuffer& CreateThreadBuffer();
+
+    /** Moves the thread's pending text to the output queue. */
+    void Enqueue(ThreadBuffer& tb);
+
+    /** Blocks until the output queue is empty and written. */
+    void WaitForSink();
+
+    /** Writes message to all streams of appropriate level. Caller
+        must hold m_stream_mutex. */
+    void Write(const Message& message);
+
+    /** Recomputes m_min_level. Caller must hold m_stream_mutex. */
+    void UpdateMinLevel();
+
+    /** Main loop of the sink thread. */
+    void SinkLoop();
+
+    static void* SinkThreadMain(void* logger);
+
+    static void DeleteThreadBuffer(void* tb);
 
     /** Streams for this log. */
     std::vector<std::ostream*> m_streams;
 
     /** Level for each stream. */
     std::vector<LogLevel> m_levels;
-   
-    /** Threads must grab this mutex before modifying m_thread_buffer
-        or printing output. */
-    pthread_mutex_t m_buffer_mutex;
 
-    /** Buffers for up to MAX_THREADS active threads. */
-    ThreadBuffer m_thread_buffer[MAX_THREADS];
+    /** Lowest level of all streams; messages below it are dropped
+        without formatting. */
+    volatile int m_min_level;
+
+    /** Guards m_streams, m_levels and writing to the streams. */
+    pthread_mutex_t m_stream_mutex;
+
+    /** Key for the per-thread ThreadBuffer. */
+    pthread_key_t m_key;
+
+    /** Guards m_queue, m_writing and m_shutdown. */
+    pthread_mutex_t m_queue_mutex;
+
+    /** Signalled when messages are added to the queue or on
+        shutdown. */
+    pthread_cond_t m_queue_cond;
+
+    /** Signalled when the sink has written all queued messages. */
+    pthread_cond_t m_empty_cond;
+
+    /** Lines waiting to be written. */
+    std::vector<Message> m_queue;
+
+    /** True while the sink writes a batch taken from the queue. */
+    bool m_writing;
+
+    bool m_shutdown;
 
-    /** Threads must grab this mutex before modifying
-        m_thread_level. */
-    pthread_mutex_t m_map_mutex;
+    /** False if the sink thread could not be started; messages are
+        then written by the logging thread. */
+    bool m_async;
 
-    /** Current log level for each thread. */
-    std::map<pthread_t, LogLevel> m_thread_level;
+    pthread_t m_sink;
 };
 
+inline bool Logger::LineBuffer::EndsWithNewline() const
+{
+    return pptr() != pbase() && *(pptr() - 1) == '\n';
+}
+
+inline Logger::ThreadBuffer& Logger::GetThreadBuffer()
+{
+    void* tb = pthread_getspecific(m_key);
+    if (tb == 0)
+        return CreateThreadBuffer();
+    return *static_cast<ThreadBuffer*>(tb);
+}
+
+inline void Logger::SetLevel(LogLevel level)
+{
+    GetThreadBuffer().level = level;
+}
+
 template<typename TYPE>
 Logger& Logger::operator<<(const TYPE& type)
 {
     ThreadBuffer& tb = GetThreadBuffer();
-    tb.buffer << type;
-    std::string str(tb.buffer.str());
-    if (!str.empty() && str[str.size() - 1] == '\n')
-        Flush();
+    if (tb.level < m_min_level)
+        return *this;
+    tb.stream << type;
+    if (tb.buffer.EndsWithNewline())
+        Enqueue(tb);
     return *this;
 }
 
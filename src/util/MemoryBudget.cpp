@@ -0,0 +1,213 @@
+//----------------------------------------------------------------------------
+/** @file MemoryBudget.cpp */
+//----------------------------------------------------------------------------
+
+#include <iomanip>
+#include <ostream>
+#include <sstream>
+
+#include "BenzeneAssert.hpp"
+#include "BenzeneException.hpp"
+#include "MemoryBudget.hpp"
+
+using namespace benzene;
+
+//----------------------------------------------------------------------------
+
+namespace {
+
+const std::size_t NOT_FOUND = static_cast<std::size_t>(-1);
+
+/** Writes bytes in megabytes with one decimal. */
+std::string Megabytes(std::size_t bytes)
+{
+    std::ostringstream os;
+    os << std::fixed << std::setprecision(1)
+       << static_cast<double>(bytes) / (1024.0 * 1024.0) << "M";
+    return os.str();
+}
+
+} // namespace
+
+//----------------------------------------------------------------------------
+
+MemoryBudget::MemoryBudget()
+    : m_total(0)
+{
+}
+
+/** Never destroyed, so components registered by static objects can
+    unregister at exit. */
+MemoryBudget& MemoryBudget::Get()
+{
+    static MemoryBudget* s_budget = new MemoryBudget();
+    return *s_budget;
+}
+
+std::size_t MemoryBudget::Total() const
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    return m_total;
+}
+
+void MemoryBudget::SetTotal(std::size_t bytes)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    m_total = bytes;
+    ResizeAll();
+}
+
+std::string MemoryBudget::Register(const std::string& name, double share,
+                                   const UsageFunction& usage,
+                                   const ResizeFunction& resize)
+{
+    if (share < 0.0)
+        throw BenzeneException() << "MemoryBudget: negative share for "
+                                 << name;
+    boost::mutex::scoped_lock lock(m_mutex);
+    Component component;
+    component.m_name = name;
+    for (int i = 2; Find(component.m_name) != NOT_FOUND; ++i)
+    {
+        std::ostringstream os;
+        os << name << '_' << i;
+        component.m_name = os.str();
+    }
+    component.m_share = share;
+    component.m_usage = usage;
+    component.m_resize = resize;
+    m_components.push_back(component);
+    // Shares are relative, so a new component changes every allowance
+    ResizeAll();
+    return component.m_name;
+}
+
+void MemoryBudget::Unregister(const std::string& name)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    std::size_t index = Find(name);
+    if (index != NOT_FOUND)
+        m_components.erase(m_components.begin() + index);
+}
+
+bool MemoryBudget::Contains(const std::string& name) const
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    return Find(name) != NOT_FOUND;
+}
+
+std::vector<std::string> MemoryBudget::Names() const
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    std::vector<std::string> names;
+    for (std::size_t i = 0; i < m_components.size(); ++i)
+        names.push_back(m_components[i].m_name);
+    return names;
+}
+
+double MemoryBudget::Share(const std::string& name) const
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    std::size_t index = Find(name);
+    if (index == NOT_FOUND)
+        throw BenzeneException() << "MemoryBudget: no component " << name;
+    return m_components[index].m_share;
+}
+
+void MemoryBudget::SetShare(const std::string& name, double share)
+{
+    if (share < 0.0)
+        throw BenzeneException() << "MemoryBudget: negative share for "
+                                 << name;
+    boost::mutex::scoped_lock lock(m_mutex);
+    std::size_t index = Find(name);
+    if (index == NOT_FOUND)
+        throw BenzeneException() << "MemoryBudget: no component " << name;
+    m_components[index].m_share = share;
+    ResizeAll();
+}
+
+std::size_t MemoryBudget::Allowance(const std::string& name) const
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    std::size_t index = Find(name);
+    if (index == NOT_FOUND)
+        throw BenzeneException() << "MemoryBudget: no component " << name;
+    return AllowanceOf(index);
+}
+
+std::size_t MemoryBudget::Used() const
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    std::size_t used = 0;
+    for (std::size_t i = 0; i < m_components.size(); ++i)
+        used += m_components[i].m_usage();
+    return used;
+}
+
+void MemoryBudget::Write(std::ostream& os) const
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    std::size_t used = 0;
+    os << std::left << std::setw(12) << "component"
+       << std::right << std::setw(8) << "share"
+       << std::setw(12) << "allowance"
+       << std::setw(12) << "used" << '\n';
+    for (std::size_t i = 0; i < m_components.size(); ++i)
+    {
+        const Component& c = m_components[i];
+        std::size_t bytes = c.m_usage();
+        used += bytes;
+        os << std::left << std::setw(12) << c.m_name
+           << std::right << std::setw(8) << c.m_share
+           << std::setw(12)
+           << (m_total == 0 ? std::string("-") : Megabytes(AllowanceOf(i)))
+           << std::setw(12) << Megabytes(bytes) << '\n';
+    }
+    os << std::left << std::setw(12) << "total"
+       << std::right << std::setw(8) << ""
+       << std::setw(12)
+       << (m_total == 0 ? std::string("-") : Megabytes(m_total))
+       << std::setw(12) << Megabytes(used) << '\n';
+}
+
+int MemoryBudget::TableBits(std::size_t bytes, std::size_t slotSize,
+                            int maxBits)
+{
+    BenzeneAssert(slotSize > 0);
+    int bits = 1;
+    while (bits < maxBits && (static_cast<std::size_t>(2) << bits) <= 
+           bytes / slotSize)
+        ++bits;
+    return bits;
+}
+
+std::size_t MemoryBudget::Find(const std::string& name) const
+{
+    for (std::size_t i = 0; i < m_components.size(); ++i)
+        if (m_components[i].m_name == name)
+            return i;
+    return NOT_FOUND;
+}
+
+std::size_t MemoryBudget::AllowanceOf(std::size_t index) const
+{
+    double sum = 0.0;
+    for (std::size_t i = 0; i < m_components.size(); ++i)
+        sum += m_components[i].m_share;
+    if (m_total == 0 || sum == 0.0)
+        return 0;
+    return static_cast<std::size_t>
+        (static_cast<double>(m_total) * m_components[index].m_share / sum);
+}
+
+void MemoryBudget::ResizeAll()
+{
+    if (m_total == 0)
+        return;
+    for (std::size_t i = 0; i < m_components.size(); ++i)
+        if (m_components[i].m_resize)
+            m_components[i].m_resize(AllowanceOf(i));
+}
+
+//----------------------------------------------------------------------------
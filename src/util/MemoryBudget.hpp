@@ -0,0 +1,138 @@
+//----------------------------------------------------------------------------
+/** @file MemoryBudget.hpp */
+//----------------------------------------------------------------------------
+
+#ifndef MEMORYBUDGET_HPP
+#define MEMORYBUDGET_HPP
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+#include <boost/bind.hpp>
+#include <boost/function.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include "Benzene.hpp"
+
+_BEGIN_BENZENE_NAMESPACE_
+
+//----------------------------------------------------------------------------
+
+/** Memory budget of the process and accounting of the large
+    components that use it.
+
+    Each component (UCT tree, fill-in map, solver transposition
+    tables, VCs, database caches) registers under a name with a share
+    of the budget, a function that returns the bytes it uses, and a
+    function that resizes it to a given number of bytes. When the
+    total is set, every component is resized to its share of the
+    total: shares are weights over the registered components, so the
+    budget is split only among the components that exist in this
+    program.
+
+    The total is zero by default, meaning there is no budget and each
+    component is sized by its own parameters (max_nodes, tt_bits,
+    ...), as before. Components are not resized if their own
+    parameters are changed afterwards. */
+class MemoryBudget
+{
+public:
+    /** Returns the bytes used by a component. */
+    typedef boost::function<std::size_t()> UsageFunction;
+
+    /** Resizes a component to use at most the given bytes. */
+    typedef boost::function<void(std::size_t)> ResizeFunction;
+
+    /** Returns the budget of the process. */
+    static MemoryBudget& Get();
+
+    /** Total budget in bytes; zero if there is no budget. */
+    std::size_t Total() const;
+
+    /** Sets the total and resizes all components. */
+    void SetTotal(std::size_t bytes);
+
+    /** Adds a component. If name is taken, for example by another
+        engine in the same process, a suffix "_2", "_3", ... makes it
+        unique. Returns the name the component is registered under.
+        It is resized right away if there is a budget. The resize
+        function may be empty for components that are only accounted
+        for; their share is still kept free for them. */
+    std::string Register(const std::string& name, double share,
+                         const UsageFunction& usage,
+                         const ResizeFunction& resize = ResizeFunction());
+
+    /** Removes the component registered under name, as returned by
+        Register(). Must be called before the objects bound in its
+        functions are destroyed. */
+    void Unregister(const std::string& name);
+
+    /** Returns true if a component is registered under name. */
+    bool Contains(const std::string& name) const;
+
+    /** Returns the names of the components in order of registration. */
+    std::vector<std::string> Names() const;
+
+    /** Throws if there is no component called name. */
+    double Share(const std::string& name) const;
+
+    /** Changes the share of a component and resizes all
+        components. */
+    void SetShare(const std::string& name, double share);
+
+    /** Bytes of the total given to the component; zero if there is no
+        budget. */
+    std::size_t Allowance(const std::string& name) const;
+
+    /** Returns the bytes used by all components. */
+    std::size_t Used() const;
+
+    /** Writes the allowance and use of each component. */
+    void Write(std::ostream& os) const;
+
+    /** Largest number of bits such that a table with 2^bits slots of
+        slotSize bytes fits in bytes; at least one and at most
+        maxBits. */
+    static int TableBits(std::size_t bytes, std::size_t slotSize,
+                         int maxBits = 30);
+
+private:
+    struct Component
+    {
+        std::string m_name;
+
+        double m_share;
+
+        UsageFunction m_usage;
+
+        ResizeFunction m_resize;
+    };
+
+    /** Guards the components. Resize and usage functions are called
+        with it held, so they must not call back into the budget. */
+    mutable boost::mutex m_mutex;
+
+    std::size_t m_total;
+
+    std::vector<Component> m_components;
+
+    MemoryBudget();
+
+    std::size_t Find(const std::string& name) const;
+
+    std::size_t AllowanceOf(std::size_t index) const;
+
+    void ResizeAll();
+
+    /** Not implemented */
+    MemoryBudget(const MemoryBudget& other);
+
+    /** Not implemented */
+    void operator=(const MemoryBudget& other);
+};
+
+//----------------------------------------------------------------------------
+
+_END_BENZENE_NAMESPACE_
+
+#endif // MEMORYBUDGET_HPP
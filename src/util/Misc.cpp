@@ -20,6 +20,9 @@ namespace
     MiscUtil::OpenFile() */
 path programDir;
 
+/** See MiscUtil::CacheDir() */
+std::string cacheDir;
+
 }
 
 //----------------------------------------------------------------------------
@@ -97,5 +100,15 @@ std::string MiscUtil::OpenFile(std::string name, std::ifstream& f)
                              << "\t'" << dataFile << "'.";
 }
 
+const std::string& MiscUtil::CacheDir()
+{
+    return cacheDir;
+}
+
+void MiscUtil::SetCacheDir(const std::string& dir)
+{
+    cacheDir = dir;
+}
+
 //----------------------------------------------------------------------------
 
@@ -8,6 +8,7 @@
 #include <sstream>
 #include <string>
 #include <vector>
+#include <boost/cstdint.hpp>
 #include "Benzene.hpp"
 #include "Types.hpp"
 
@@ -41,6 +42,32 @@ namespace MiscUtil
     void FindProgramDir(int argc, char* argv[]);
 
     std::string OpenFile(std::string name, std::ifstream& f);
+
+    /** Directory used to cache data derived from the files in the
+        data directories, such as the per-boardsize VC pattern
+        tables. Caching is disabled if this is empty (the
+        default). */
+    const std::string& CacheDir();
+
+    /** See CacheDir() */
+    void SetCacheDir(const std::string& dir);
+
+    /** Returns the processor's time stamp counter. 
+        Cheap enough to be called around hot code paths. Returns 0 on
+        platforms without a supported counter, so differences of
+        readings are always 0 there. */
+    boost::uint64_t ReadCycleCounter();
+}
+
+inline boost::uint64_t MiscUtil::ReadCycleCounter()
+{
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+    boost::uint32_t lo, hi;
+    __asm__ __volatile__ ("rdtsc" : "=a" (lo), "=d" (hi));
+    return (static_cast<boost::uint64_t>(hi) << 32) | lo;
+#else
+    return 0;
+#endif
 }
 
 /** Prints a vector with a space between elements. */
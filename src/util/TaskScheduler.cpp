@@ -0,0 +1,281 @@
+//----------------------------------------------------------------------------
+/** @file TaskScheduler.cpp */
+//----------------------------------------------------------------------------
+
+#include <exception>
+#include <boost/thread/once.hpp>
+#include <boost/thread/tss.hpp>
+
+#include "BenzeneException.hpp"
+#include "TaskScheduler.hpp"
+
+using namespace benzene;
+
+//----------------------------------------------------------------------------
+
+namespace {
+
+TaskScheduler* g_scheduler = 0;
+
+boost::once_flag g_schedulerOnce = BOOST_ONCE_INIT;
+
+/** Index plus one of the pool thread running this; unset on other
+    threads. */
+boost::thread_specific_ptr<int> g_workerIndex;
+
+} // namespace
+
+//----------------------------------------------------------------------------
+
+std::size_t TaskScheduler::s_defaultNumThreads = 0;
+
+TaskScheduler::Job::Job()
+    : m_group(0)
+{
+}
+
+TaskScheduler::Job::Job(const boost::shared_ptr<GroupTasks>& tasks,
+                        TaskGroup* group)
+    : m_tasks(tasks),
+      m_group(group)
+{
+}
+
+TaskScheduler::TaskScheduler(std::size_t numThreads)
+    : m_queued(0)
+{
+    for (std::size_t i = 0; i < numThreads; ++i)
+        m_queues.push_back(boost::shared_ptr<Queue>(new Queue()));
+    for (std::size_t i = 0; i < numThreads; ++i)
+        m_threads.create_thread(boost::bind(&TaskScheduler::WorkerLoop,
+                                            this, static_cast<int>(i)));
+}
+
+void TaskScheduler::Create()
+{
+    std::size_t numThreads = s_defaultNumThreads;
+    if (numThreads == 0)
+        numThreads = boost::thread::hardware_concurrency();
+    if (numThreads == 0)
+        numThreads = 1;
+    g_scheduler = new TaskScheduler(numThreads);
+}
+
+TaskScheduler& TaskScheduler::Get()
+{
+    boost::call_once(&TaskScheduler::Create, g_schedulerOnce);
+    return *g_scheduler;
+}
+
+void TaskScheduler::SetDefaultNumThreads(std::size_t numThreads)
+{
+    if (g_scheduler != 0)
+        throw BenzeneException("TaskScheduler: pool already started");
+    s_defaultNumThreads = numThreads;
+}
+
+int TaskScheduler::WorkerIndex()
+{
+    const int* index = g_workerIndex.get();
+    return index ? *index - 1 : -1;
+}
+
+void TaskScheduler::Submit(const Job& job)
+{
+    const int self = WorkerIndex();
+    Queue& queue = (self >= 0) ? *m_queues[self] : m_shared;
+    {
+        boost::mutex::scoped_lock lock(queue.m_mutex);
+        queue.m_jobs.push_back(job);
+    }
+    boost::mutex::scoped_lock lock(m_idleMutex);
+    ++m_queued;
+    m_wakeup.notify_one();
+}
+
+/** Takes from the back of the own queue, then from the shared queue,
+    then from the front of the other queues. */
+bool TaskScheduler::TakeJob(int self, Job& job)
+{
+    bool found = false;
+    if (self >= 0)
+    {
+        Queue& own = *m_queues[self];
+        boost::mutex::scoped_lock lock(own.m_mutex);
+        if (!own.m_jobs.empty())
+        {
+            job = own.m_jobs.back();
+            own.m_jobs.pop_back();
+            found = true;
+        }
+    }
+    if (!found)
+    {
+        boost::mutex::scoped_lock lock(m_shared.m_mutex);
+        if (!m_shared.m_jobs.empty())
+        {
+            job = m_shared.m_jobs.front();
+            m_shared.m_jobs.pop_front();
+            found = true;
+        }
+    }
+    const int n = static_cast<int>(m_queues.size());
+    for (int i = 1; !found && i <= n; ++i)
+    {
+        Queue& victim = *m_queues[(self + i + n) % n];
+        boost::mutex::scoped_lock lock(victim.m_mutex);
+        if (!victim.m_jobs.empty())
+        {
+            job = victim.m_jobs.front();
+            victim.m_jobs.pop_front();
+            found = true;
+        }
+    }
+    if (found)
+    {
+        boost::mutex::scoped_lock lock(m_idleMutex);
+        --m_queued;
+    }
+    return found;
+}
+
+bool TaskScheduler::TakeTask(GroupTasks& tasks,
+                             boost::function<void()>& task)
+{
+    boost::mutex::scoped_lock lock(tasks.m_mutex);
+    if (tasks.m_tasks.empty())
+        return false;
+    task = tasks.m_tasks.front();
+    tasks.m_tasks.pop_front();
+    return true;
+}
+
+/** The group of a job is only used if the job still has a task; the
+    group cannot be destroyed before that task is finished. */
+bool TaskScheduler::RunOne(int self)
+{
+    Job job;
+    if (!TakeJob(self, job))
+        return false;
+    boost::function<void()> task;
+    if (TakeTask(*job.m_tasks, task))
+        job.m_group->Execute(task);
+    return true;
+}
+
+void TaskScheduler::WorkerLoop(int self)
+{
+    g_workerIndex.reset(new int(self + 1));
+    while (true)
+    {
+        if (RunOne(self))
+            continue;
+        boost::mutex::scoped_lock lock(m_idleMutex);
+        while (m_queued <= 0)
+            m_wakeup.wait(lock);
+    }
+}
+
+//----------------------------------------------------------------------------
+
+TaskGroup::TaskGroup(TaskScheduler& scheduler)
+    : m_scheduler(scheduler),
+      m_tasks(new TaskScheduler::GroupTasks()),
+      m_pending(0),
+      m_failed(false)
+{
+}
+
+TaskGroup::TaskGroup(const CancelToken& token, TaskScheduler& scheduler)
+    : m_scheduler(scheduler),
+      m_token(token),
+      m_tasks(new TaskScheduler::GroupTasks()),
+      m_pending(0),
+      m_failed(false)
+{
+}
+
+TaskGroup::~TaskGroup()
+{
+    WaitPending();
+}
+
+/** The task is queued with m_mutex held, so that a waiting thread
+    either sees it or is woken up. */
+void TaskGroup::Run(const boost::function<void()>& task)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    ++m_pending;
+    {
+        boost::mutex::scoped_lock tasksLock(m_tasks->m_mutex);
+        m_tasks->m_tasks.push_back(task);
+    }
+    TaskScheduler::Job job(m_tasks, this);
+    m_done.notify_all();
+    lock.unlock();
+    m_scheduler.Submit(job);
+}
+
+void TaskGroup::Execute(const boost::function<void()>& task)
+{
+    std::string error;
+    bool failed = false;
+    if (!m_token.IsCancelled())
+    {
+        try
+        {
+            task();
+        }
+        catch (const std::exception& e)
+        {
+            error = e.what();
+            failed = true;
+        }
+        catch (...)
+        {
+            error = "unknown exception";
+            failed = true;
+        }
+    }
+    boost::mutex::scoped_lock lock(m_mutex);
+    if (failed && !m_failed)
+    {
+        m_failed = true;
+        m_error = error;
+    }
+    if (--m_pending == 0)
+        m_done.notify_all();
+}
+
+/** Runs the tasks of this group that no other thread has taken, then
+    blocks until the running ones are finished. Tasks added meanwhile
+    by the running tasks wake the waiting thread up. */
+void TaskGroup::WaitPending()
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    while (m_pending > 0)
+    {
+        boost::function<void()> task;
+        if (!TaskScheduler::TakeTask(*m_tasks, task))
+        {
+            m_done.wait(lock);
+            continue;
+        }
+        lock.unlock();
+        Execute(task);
+        lock.lock();
+    }
+}
+
+void TaskGroup::Wait()
+{
+    WaitPending();
+    boost::mutex::scoped_lock lock(m_mutex);
+    if (m_failed)
+    {
+        m_failed = false;
+        throw BenzeneException() << "TaskGroup: " << m_error;
+    }
+}
+
+//----------------------------------------------------------------------------
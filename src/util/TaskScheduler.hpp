@@ -0,0 +1,338 @@
+//----------------------------------------------------------------------------
+/** @file TaskScheduler.hpp */
+//----------------------------------------------------------------------------
+
+#ifndef TASKSCHEDULER_HPP
+#define TASKSCHEDULER_HPP
+
+#include <deque>
+#include <string>
+#include <utility>
+#include <vector>
+#include <boost/bind.hpp>
+#include <boost/function.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/condition.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+
+#include "Benzene.hpp"
+
+_BEGIN_BENZENE_NAMESPACE_
+
+class TaskGroup;
+
+//----------------------------------------------------------------------------
+
+/** Flag that tells tasks to stop.
+    Copies share the same flag. */
+class CancelToken
+{
+public:
+    CancelToken();
+
+    /** Asks every holder of this token to stop. Cannot be undone. */
+    void Cancel() const;
+
+    bool IsCancelled() const;
+
+private:
+    boost::shared_ptr<volatile bool> m_cancelled;
+};
+
+inline CancelToken::CancelToken()
+    : m_cancelled(new bool(false))
+{
+}
+
+inline void CancelToken::Cancel() const
+{
+    *m_cancelled = true;
+}
+
+inline bool CancelToken::IsCancelled() const
+{
+    return *m_cancelled;
+}
+
+//----------------------------------------------------------------------------
+
+/** Pool of worker threads shared by all parallel code in the process.
+
+    There is one pool, with one thread per core by default, so that
+    subsystems running at the same time (the player and the solver in
+    PlayAndSolve, for example) share the cores instead of each
+    starting its own threads. Work is submitted through a TaskGroup.
+
+    Each worker has its own queue. A task spawned by a worker goes to
+    the back of that worker's queue and the worker takes tasks from
+    the back; idle workers steal from the front of the other queues.
+    Tasks spawned by other threads go to a shared queue.
+
+    A thread that waits for a TaskGroup runs the tasks of that group
+    that have not started, so tasks can wait for tasks they spawned
+    without deadlocking the pool. It never runs tasks of other groups,
+    which could take much longer than the group it waits for. */
+class TaskScheduler
+{
+public:
+    /** Returns the pool, starting it on first use. */
+    static TaskScheduler& Get();
+
+    /** Sets the number of threads of the pool. Must be called before
+        the first call to Get(). Zero means one per core. */
+    static void SetDefaultNumThreads(std::size_t numThreads);
+
+    std::size_t NumThreads() const;
+
+    /** Index of the calling thread in the pool, in [0, NumThreads()),
+        or -1 if it is not a thread of the pool. */
+    static int WorkerIndex();
+
+private:
+    friend class TaskGroup;
+
+    /** Tasks of a TaskGroup that have not started. Shared by the
+        group and its jobs, since a job can outlive its group if the
+        waiting thread ran the task itself. */
+    struct GroupTasks
+    {
+        boost::mutex m_mutex;
+
+        std::deque<boost::function<void()> > m_tasks;
+    };
+
+    /** Runs one task of a group, if there is still one not started. */
+    struct Job
+    {
+        boost::shared_ptr<GroupTasks> m_tasks;
+
+        TaskGroup* m_group;
+
+        Job();
+
+        Job(const boost::shared_ptr<GroupTasks>& tasks, TaskGroup* group);
+    };
+
+    /** Queue of one worker. */
+    struct Queue
+    {
+        boost::mutex m_mutex;
+
+        std::deque<Job> m_jobs;
+    };
+
+    std::vector<boost::shared_ptr<Queue> > m_queues;
+
+    /** Jobs spawned by threads outside the pool. */
+    Queue m_shared;
+
+    boost::thread_group m_threads;
+
+    /** Guards m_queued; idle workers sleep on m_wakeup. */
+    boost::mutex m_idleMutex;
+
+    boost::condition m_wakeup;
+
+    /** Number of queued jobs. May be briefly negative, since a job
+        is counted after it is put in a queue. */
+    int m_queued;
+
+    static std::size_t s_defaultNumThreads;
+
+    explicit TaskScheduler(std::size_t numThreads);
+
+    /** Not implemented. The pool lives until the program exits. */
+    ~TaskScheduler();
+
+    static void Create();
+
+    void Submit(const Job& job);
+
+    /** Runs one queued job, if there is one. */
+    bool RunOne(int self);
+
+    /** Takes the first task of tasks, if there is one. */
+    static bool TakeTask(GroupTasks& tasks, boost::function<void()>& task);
+
+    bool TakeJob(int self, Job& job);
+
+    void WorkerLoop(int self);
+
+    /** Not implemented */
+    TaskScheduler(const TaskScheduler& other);
+
+    /** Not implemented */
+    void operator=(const TaskScheduler& other);
+};
+
+inline std::size_t TaskScheduler::NumThreads() const
+{
+    return m_queues.size();
+}
+
+//----------------------------------------------------------------------------
+
+/** Set of tasks run by the TaskScheduler that can be waited for and
+    cancelled together.
+    Tasks that have not started when the group is cancelled are
+    skipped; running tasks can poll Token() to stop early. If a task
+    throws, Wait() throws a BenzeneException with its message. The
+    destructor waits for all tasks. The waiting thread runs tasks of
+    the group that have not started yet. */
+class TaskGroup
+{
+public:
+    explicit TaskGroup(TaskScheduler& scheduler = TaskScheduler::Get());
+
+    /** Same as above, with a token shared with other code. */
+    TaskGroup(const CancelToken& token,
+              TaskScheduler& scheduler = TaskScheduler::Get());
+
+    ~TaskGroup();
+
+    /** Queues task. */
+    void Run(const boost::function<void()>& task);
+
+    /** Returns once all tasks have finished or were skipped. */
+    void Wait();
+
+    void Cancel();
+
+    const CancelToken& Token() const;
+
+private:
+    friend class TaskScheduler;
+
+    TaskScheduler& m_scheduler;
+
+    CancelToken m_token;
+
+    boost::mutex m_mutex;
+
+    boost::condition m_done;
+
+    /** Tasks not started yet; see TaskScheduler::Job. */
+    boost::shared_ptr<TaskScheduler::GroupTasks> m_tasks;
+
+    /** Number of tasks not finished or skipped yet. */
+    std::size_t m_pending;
+
+    /** Message of the first exception thrown by a task. */
+    std::string m_error;
+
+    bool m_failed;
+
+    void Execute(const boost::function<void()>& task);
+
+    void WaitPending();
+
+    /** Not implemented */
+    TaskGroup(const TaskGroup& other);
+
+    /** Not implemented */
+    void operator=(const TaskGroup& other);
+};
+
+inline const CancelToken& TaskGroup::Token() const
+{
+    return m_token;
+}
+
+inline void TaskGroup::Cancel()
+{
+    m_token.Cancel();
+}
+
+//----------------------------------------------------------------------------
+
+/** Runs a list of work items on a vector of workers using the
+    TaskScheduler.
+
+    Same interface as SgThreadedWorker: a worker is called as
+    <tt>O operator()(const I&)</tt> and each worker is used by one
+    task at a time, so it can keep scratch data such as its own
+    HexBoard. At most workers.size() items are processed at the same
+    time, by the pool and by the thread calling DoWork(). */
+template<typename I, typename O, typename W>
+class TaskWorker
+{
+public:
+    explicit TaskWorker(std::vector<W>& workers);
+
+    /** Processes all items and puts the results in output, in no
+        particular order. Items not started when cancel is cancelled
+        are left out of output. */
+    void DoWork(const std::vector<I>& work,
+                std::vector<std::pair<I, O> >& output,
+                const CancelToken& cancel = CancelToken());
+
+private:
+    std::vector<W>& m_workers;
+
+    const std::vector<I>* m_work;
+
+    std::vector<std::vector<std::pair<I, O> > > m_output;
+
+    boost::mutex m_nextMutex;
+
+    std::size_t m_next;
+
+    void Process(std::size_t workerIndex, const CancelToken& cancel);
+};
+
+template<typename I, typename O, typename W>
+TaskWorker<I, O, W>::TaskWorker(std::vector<W>& workers)
+    : m_workers(workers),
+      m_work(0),
+      m_next(0)
+{
+}
+
+template<typename I, typename O, typename W>
+void TaskWorker<I, O, W>::DoWork(const std::vector<I>& work,
+                                 std::vector<std::pair<I, O> >& output,
+                                 const CancelToken& cancel)
+{
+    output.clear();
+    m_work = &work;
+    m_next = 0;
+    std::size_t numTasks = std::min(m_workers.size(), work.size());
+    m_output.assign(numTasks, std::vector<std::pair<I, O> >());
+    {
+        TaskGroup group(cancel);
+        for (std::size_t i = 0; i < numTasks; ++i)
+            group.Run(boost::bind(&TaskWorker::Process, this, i,
+                                  boost::cref(group.Token())));
+        group.Wait();
+    }
+    for (std::size_t i = 0; i < m_output.size(); ++i)
+        output.insert(output.end(), m_output[i].begin(), m_output[i].end());
+    m_output.clear();
+    m_work = 0;
+}
+
+template<typename I, typename O, typename W>
+void TaskWorker<I, O, W>::Process(std::size_t workerIndex,
+                                  const CancelToken& cancel)
+{
+    W& worker = m_workers[workerIndex];
+    while (!cancel.IsCancelled())
+    {
+        std::size_t index;
+        {
+            boost::mutex::scoped_lock lock(m_nextMutex);
+            if (m_next == m_work->size())
+                break;
+            index = m_next++;
+        }
+        const I& item = (*m_work)[index];
+        m_output[workerIndex].push_back(std::make_pair(item, worker(item)));
+    }
+}
+
+//----------------------------------------------------------------------------
+
+_END_BENZENE_NAMESPACE_
+
+#endif // TASKSCHEDULER_HPP
@@ -0,0 +1,236 @@
+//---------------------------------------------------------------------------
+/** @file LogStoreTest.cpp */
+//---------------------------------------------------------------------------
+
+#include <boost/test/auto_unit_test.hpp>
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
+
+#include "LogStore.hpp"
+
+using namespace benzene;
+
+//---------------------------------------------------------------------------
+
+namespace {
+
+const char* TEST_FILE = "logstore-unittest.lsdb";
+
+void RemoveFiles()
+{
+    std::remove(TEST_FILE);
+    std::remove((std::string(TEST_FILE) + ".idx").c_str());
+}
+
+std::vector<byte> Data(int value, std::size_t size)
+{
+    std::vector<byte> data(size);
+    for (std::size_t i = 0; i < size; ++i)
+        data[i] = static_cast<byte>(value + i);
+    return data;
+}
+
+BOOST_AUTO_TEST_CASE(LogStore_PutGet)
+{
+    RemoveFiles();
+    {
+        LogStore store(TEST_FILE);
+        BOOST_CHECK_EQUAL(store.Count(), 0u);
+        for (int i = 0; i < 1000; ++i)
+        {
+            std::vector<byte> data = Data(i, 1 + i % 37);
+            store.Put(&i, sizeof(i), &data[0], data.size());
+        }
+        BOOST_CHECK_EQUAL(store.Count(), 1000u);
+        int key = 17;
+        std::vector<byte> data;
+        BOOST_CHECK(store.Exists(&key, sizeof(key)));
+        BOOST_CHECK(store.Get(&key, sizeof(key), data));
+        BOOST_CHECK(data == Data(17, 18));
+        key = 1000;
+        BOOST_CHECK(!store.Exists(&key, sizeof(key)));
+        BOOST_CHECK(!store.Get(&key, sizeof(key), data));
+        // Replace a key
+        key = 5;
+        std::vector<byte> newData = Data(100, 3);
+        store.Put(&key, sizeof(key), &newData[0], newData.size());
+        BOOST_CHECK_EQUAL(store.Count(), 1000u);
+        BOOST_CHECK(store.Get(&key, sizeof(key), data));
+        BOOST_CHECK(data == newData);
+    }
+    {
+        // Contents survive reopening
+        LogStore store(TEST_FILE);
+        BOOST_CHECK_EQUAL(store.Count(), 1000u);
+        std::vector<byte> data;
+        int key = 5;
+        BOOST_CHECK(store.Get(&key, sizeof(key), data));
+        BOOST_CHECK(data == Data(100, 3));
+        key = 999;
+        BOOST_CHECK(store.Get(&key, sizeof(key), data));
+        BOOST_CHECK(data == Data(999, 1 + 999 % 37));
+    }
+    RemoveFiles();
+}
+
+BOOST_AUTO_TEST_CASE(LogStore_Grow)
+{
+    RemoveFiles();
+    const int n = 100000;
+    {
+        LogStore store(TEST_FILE);
+        for (int i = 0; i < n; ++i)
+            store.Put(&i, sizeof(i), &i, sizeof(i));
+        BOOST_CHECK_EQUAL(store.Count(), static_cast<std::size_t>(n));
+    }
+    {
+        LogStore store(TEST_FILE);
+        BOOST_CHECK_EQUAL(store.Count(), static_cast<std::size_t>(n));
+        int found = 0;
+        std::vector<byte> data;
+        for (int i = 0; i < n; ++i)
+        {
+            int value = -1;
+            if (store.Get(&i, sizeof(i), data) && data.size() == sizeof(i))
+                std::memcpy(&value, &data[0], sizeof(value));
+            if (value == i)
+                ++found;
+        }
+        BOOST_CHECK_EQUAL(found, n);
+    }
+    RemoveFiles();
+}
+
+BOOST_AUTO_TEST_CASE(LogStore_Compact)
+{
+    RemoveFiles();
+    {
+        LogStore store(TEST_FILE);
+        for (int round = 0; round < 3; ++round)
+            for (int i = 0; i < 100; ++i)
+            {
+                std::vector<byte> data = Data(round + i, 10);
+                store.Put(&i, sizeof(i), &data[0], data.size());
+            }
+    }
+    LogStore::Compact(TEST_FILE);
+    {
+        LogStore store(TEST_FILE);
+        BOOST_CHECK_EQUAL(store.Count(), 100u);
+        std::vector<byte> data;
+        int key = 42;
+        BOOST_CHECK(store.Get(&key, sizeof(key), data));
+        BOOST_CHECK(data == Data(2 + 42, 10));
+    }
+    RemoveFiles();
+}
+
+BOOST_AUTO_TEST_CASE(LogStore_TornRecord)
+{
+    RemoveFiles();
+    {
+        LogStore store(TEST_FILE);
+        for (int i = 0; i < 10; ++i)
+        {
+            std::vector<byte> data = Data(i, 20);
+            store.Put(&i, sizeof(i), &data[0], data.size());
+        }
+    }
+    // Cut the last record in half, as if the program crashed while
+    // writing it.
+    FILE* f = std::fopen(TEST_FILE, "rb");
+    BOOST_REQUIRE(f != 0);
+    std::fseek(f, 0, SEEK_END);
+    long size = std::ftell(f);
+    std::fclose(f);
+    BOOST_REQUIRE(truncate(TEST_FILE, size - 10) == 0);
+    {
+        LogStore store(TEST_FILE);
+        BOOST_CHECK_EQUAL(store.Count(), 9u);
+        std::vector<byte> data;
+        int key = 9;
+        BOOST_CHECK(!store.Exists(&key, sizeof(key)));
+        key = 8;
+        BOOST_CHECK(store.Get(&key, sizeof(key), data));
+        BOOST_CHECK(data == Data(8, 20));
+        // The store can be written after recovering
+        key = 9;
+        store.Put(&key, sizeof(key), &data[0], data.size());
+        BOOST_CHECK_EQUAL(store.Count(), 10u);
+    }
+    RemoveFiles();
+}
+
+/** Copies the first size bytes of from to to. */
+void CopyFile(const std::string& from, const std::string& to, long size)
+{
+    std::vector<char> buffer(size);
+    FILE* f = std::fopen(from.c_str(), "rb");
+    BOOST_REQUIRE(f != 0);
+    BOOST_REQUIRE(std::fread(&buffer[0], 1, size, f) == std::size_t(size));
+    std::fclose(f);
+    f = std::fopen(to.c_str(), "wb");
+    BOOST_REQUIRE(f != 0);
+    std::fwrite(&buffer[0], 1, size, f);
+    std::fclose(f);
+}
+
+long FileSize(const std::string& name)
+{
+    FILE* f = std::fopen(name.c_str(), "rb");
+    BOOST_REQUIRE(f != 0);
+    std::fseek(f, 0, SEEK_END);
+    long size = std::ftell(f);
+    std::fclose(f);
+    return size;
+}
+
+/** A copy taken while the store is open looks like a crash: its index
+    has slots for puts after the last Flush() whose records are not in
+    the copied log. */
+BOOST_AUTO_TEST_CASE(LogStore_DirtyOpenRebuildsIndex)
+{
+    const std::string copy = "logstore-unittest-copy.lsdb";
+    RemoveFiles();
+    {
+        LogStore store(TEST_FILE);
+        long flushedSize = 0;
+        for (int i = 0; i < 20; ++i)
+        {
+            std::vector<byte> data = Data(i, 20);
+            store.Put(&i, sizeof(i), &data[0], data.size());
+            if (i == 9)
+            {
+                store.Flush();
+                flushedSize = FileSize(TEST_FILE);
+            }
+        }
+        CopyFile(TEST_FILE, copy, flushedSize);
+        const std::string index = std::string(TEST_FILE) + ".idx";
+        CopyFile(index, copy + ".idx", FileSize(index));
+    }
+    {
+        LogStore store(copy);
+        BOOST_CHECK_EQUAL(store.Count(), 10u);
+        std::vector<byte> data;
+        for (int i = 0; i < 20; ++i)
+        {
+            BOOST_CHECK_EQUAL(store.Get(&i, sizeof(i), data), i < 10);
+            if (i < 10)
+                BOOST_CHECK(data == Data(i, 20));
+        }
+    }
+    // Closed cleanly this time, so the index is kept
+    {
+        LogStore store(copy);
+        BOOST_CHECK_EQUAL(store.Count(), 10u);
+    }
+    std::remove(copy.c_str());
+    std::remove((copy + ".idx").c_str());
+    RemoveFiles();
+}
+
+} // namespace
+
+//---------------------------------------------------------------------------
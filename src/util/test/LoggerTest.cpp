@@ -54,6 +54,49 @@ BOOST_AUTO_TEST_CASE(Logger_LogLevelUtil)
     BOOST_CHECK_EQUAL(LogLevelUtil::fromString("random string!!"), LOG_LEVEL_OFF);
 }
 
+BOOST_AUTO_TEST_CASE(Logger_StreamLevels)
+{
+    Logger log;
+    std::ostringstream info;
+    std::ostringstream fine;
+    log.ClearStreams();
+    log.AddStream(info, LOG_LEVEL_INFO);
+    log.AddStream(fine, LOG_LEVEL_FINE);
+
+    log.SetLevel(LOG_LEVEL_INFO);
+    log << "abc" << 1 << '\n';
+    log.SetLevel(LOG_LEVEL_FINE);
+    log << "def\n";
+    log.SetLevel(LOG_LEVEL_FINER);
+    log << "ghi\n";
+    log.Flush();
+    BOOST_CHECK(info.str().find("info: abc1\n") != std::string::npos);
+    BOOST_CHECK(info.str().find("def") == std::string::npos);
+    BOOST_CHECK(fine.str().find("info: abc1\n") != std::string::npos);
+    BOOST_CHECK(fine.str().find("fine: def\n") != std::string::npos);
+    BOOST_CHECK(fine.str().find("ghi") == std::string::npos);
+
+    // Unterminated text is written by Flush()
+    log.SetLevel(LOG_LEVEL_INFO);
+    log << "jkl";
+    log.Flush();
+    BOOST_CHECK(info.str().find("info: jkl") != std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(Logger_SevereWrittenWithoutFlush)
+{
+    Logger log;
+    std::ostringstream os;
+    log.ClearStreams();
+    log.AddStream(os, LOG_LEVEL_INFO);
+    log.SetLevel(LOG_LEVEL_INFO);
+    log << "abc\n";
+    log.SetLevel(LOG_LEVEL_SEVERE);
+    log << "def\n";
+    BOOST_CHECK(os.str().find("info: abc\n") != std::string::npos);
+    BOOST_CHECK(os.str().find("severe: def\n") != std::string::npos);
+}
+
 }
 
 //---------------------------------------------------------------------------
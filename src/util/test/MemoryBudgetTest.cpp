@@ -0,0 +1,107 @@
+//---------------------------------------------------------------------------
+/** @file MemoryBudgetTest.cpp */
+//---------------------------------------------------------------------------
+
+#include <boost/bind.hpp>
+#include <boost/test/auto_unit_test.hpp>
+
+#include "BenzeneException.hpp"
+#include "MemoryBudget.hpp"
+
+using namespace benzene;
+
+//---------------------------------------------------------------------------
+
+namespace {
+
+/** Component that uses what it is given. */
+struct Component
+{
+    std::size_t m_bytes;
+
+    Component()
+        : m_bytes(0)
+    {
+    }
+
+    std::size_t Usage() const
+    {
+        return m_bytes;
+    }
+
+    void Resize(std::size_t bytes)
+    {
+        m_bytes = bytes;
+    }
+};
+
+std::string Register(MemoryBudget& budget, const std::string& name,
+                     double share, Component& c)
+{
+    return budget.Register(name, share, boost::bind(&Component::Usage, &c),
+                           boost::bind(&Component::Resize, &c, _1));
+}
+
+BOOST_AUTO_TEST_CASE(MemoryBudget_Shares)
+{
+    MemoryBudget& budget = MemoryBudget::Get();
+    Component a;
+    Component b;
+    Register(budget, "test_a", 3.0, a);
+    BOOST_CHECK_EQUAL(budget.Total(), 0u);
+    BOOST_CHECK_EQUAL(a.m_bytes, 0u);
+    BOOST_CHECK_EQUAL(budget.Allowance("test_a"), 0u);
+
+    // Components other tests left registered take part in the split,
+    // so compare allowances rather than absolute sizes.
+    budget.SetTotal(1 << 20);
+    Register(budget, "test_b", 1.0, b);
+    BOOST_CHECK_EQUAL(a.m_bytes, budget.Allowance("test_a"));
+    BOOST_CHECK_EQUAL(b.m_bytes, budget.Allowance("test_b"));
+    BOOST_CHECK(a.m_bytes > 0);
+    BOOST_CHECK(a.m_bytes / 3 >= b.m_bytes - 1);
+    BOOST_CHECK(a.m_bytes / 3 <= b.m_bytes + 1);
+    BOOST_CHECK(budget.Used() >= a.m_bytes + b.m_bytes);
+    BOOST_CHECK(budget.Used() <= budget.Total());
+
+    budget.SetShare("test_b", 3.0);
+    BOOST_CHECK_EQUAL(a.m_bytes, b.m_bytes);
+    BOOST_CHECK_THROW(budget.SetShare("test_none", 1.0), BenzeneException);
+    BOOST_CHECK_THROW(budget.SetShare("test_a", -1.0), BenzeneException);
+
+    budget.Unregister("test_a");
+    budget.Unregister("test_b");
+    BOOST_CHECK_THROW(budget.Allowance("test_a"), BenzeneException);
+    budget.SetTotal(0);
+}
+
+BOOST_AUTO_TEST_CASE(MemoryBudget_SameName)
+{
+    MemoryBudget& budget = MemoryBudget::Get();
+    Component a;
+    Component b;
+    BOOST_CHECK_EQUAL(Register(budget, "test_c", 1.0, a), "test_c");
+    BOOST_CHECK_EQUAL(Register(budget, "test_c", 1.0, b), "test_c_2");
+    budget.SetTotal(1 << 20);
+    BOOST_CHECK(a.m_bytes > 0);
+    BOOST_CHECK_EQUAL(a.m_bytes, b.m_bytes);
+
+    // Removing one instance leaves the other
+    budget.Unregister("test_c");
+    BOOST_CHECK(!budget.Contains("test_c"));
+    BOOST_CHECK(budget.Contains("test_c_2"));
+    budget.Unregister("test_c_2");
+    budget.SetTotal(0);
+}
+
+BOOST_AUTO_TEST_CASE(MemoryBudget_TableBits)
+{
+    BOOST_CHECK_EQUAL(MemoryBudget::TableBits(1024, 16), 6);
+    BOOST_CHECK_EQUAL(MemoryBudget::TableBits(1023, 16), 5);
+    BOOST_CHECK_EQUAL(MemoryBudget::TableBits(0, 16), 1);
+    BOOST_CHECK_EQUAL(MemoryBudget::TableBits(1 << 30, 1, 20), 20);
+}
+
+} // namespace
+
+//---------------------------------------------------------------------------
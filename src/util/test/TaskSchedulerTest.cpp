@@ -0,0 +1,189 @@
+//---------------------------------------------------------------------------
+/** @file TaskSchedulerTest.cpp */
+//---------------------------------------------------------------------------
+
+#include <boost/test/auto_unit_test.hpp>
+#include <algorithm>
+
+#include "BenzeneException.hpp"
+#include "TaskScheduler.hpp"
+
+using namespace benzene;
+
+//---------------------------------------------------------------------------
+
+namespace {
+
+void Add(boost::mutex& mutex, int& sum, int value)
+{
+    boost::mutex::scoped_lock lock(mutex);
+    sum += value;
+}
+
+/** Sums [from, to) by splitting the range into nested groups. */
+void SumRange(boost::mutex& mutex, int& sum, int from, int to)
+{
+    if (to - from <= 4)
+    {
+        for (int i = from; i < to; ++i)
+            Add(mutex, sum, i);
+        return;
+    }
+    int mid = (from + to) / 2;
+    TaskGroup group;
+    group.Run(boost::bind(SumRange, boost::ref(mutex), boost::ref(sum),
+                          from, mid));
+    group.Run(boost::bind(SumRange, boost::ref(mutex), boost::ref(sum),
+                          mid, to));
+    group.Wait();
+}
+
+void Throw()
+{
+    throw BenzeneException("task failed");
+}
+
+/** Squares its input and notes if it is used by two tasks at once.
+    Boost.Test checks cannot be used from other threads. */
+class SquareWorker
+{
+public:
+    SquareWorker()
+        : m_busy(new boost::mutex()),
+          m_overlap(new bool(false))
+    {
+    }
+
+    int operator()(const int& value)
+    {
+        boost::mutex::scoped_try_lock lock(*m_busy);
+        if (!lock.owns_lock())
+            *m_overlap = true;
+        boost::this_thread::yield();
+        return value * value;
+    }
+
+    bool Overlap() const
+    {
+        return *m_overlap;
+    }
+
+private:
+    boost::shared_ptr<boost::mutex> m_busy;
+
+    boost::shared_ptr<bool> m_overlap;
+};
+
+/** Notes if a task runs on the thread that waits in
+    WaitForOwnTask(). */
+struct WaitingThread
+{
+    boost::mutex m_mutex;
+
+    boost::thread::id m_id;
+
+    bool m_ranOtherTask;
+
+    WaitingThread()
+        : m_ranOtherTask(false)
+    { }
+};
+
+void Sleep()
+{
+    boost::this_thread::sleep(boost::posix_time::milliseconds(10));
+}
+
+void OtherTask(WaitingThread& waiting)
+{
+    boost::mutex::scoped_lock lock(waiting.m_mutex);
+    if (waiting.m_id == boost::this_thread::get_id())
+        waiting.m_ranOtherTask = true;
+}
+
+/** Queues tasks of others after its own task, so they are the first
+    ones a worker would take from its queue. */
+void WaitForOwnTask(WaitingThread& waiting, TaskGroup& others)
+{
+    {
+        boost::mutex::scoped_lock lock(waiting.m_mutex);
+        waiting.m_id = boost::this_thread::get_id();
+    }
+    TaskGroup group;
+    group.Run(Sleep);
+    for (int i = 0; i < 10; ++i)
+        others.Run(boost::bind(OtherTask, boost::ref(waiting)));
+    group.Wait();
+    boost::mutex::scoped_lock lock(waiting.m_mutex);
+    waiting.m_id = boost::thread::id();
+}
+
+BOOST_AUTO_TEST_CASE(TaskScheduler_NestedGroups)
+{
+    BOOST_CHECK(TaskScheduler::Get().NumThreads() >= 1u);
+    BOOST_CHECK_EQUAL(TaskScheduler::WorkerIndex(), -1);
+    boost::mutex mutex;
+    int sum = 0;
+    SumRange(mutex, sum, 0, 1000);
+    BOOST_CHECK_EQUAL(sum, 999 * 1000 / 2);
+}
+
+BOOST_AUTO_TEST_CASE(TaskScheduler_WaitRunsOnlyOwnTasks)
+{
+    WaitingThread waiting;
+    TaskGroup others;
+    TaskGroup group;
+    group.Run(boost::bind(WaitForOwnTask, boost::ref(waiting),
+                          boost::ref(others)));
+    group.Wait();
+    others.Wait();
+    BOOST_CHECK(!waiting.m_ranOtherTask);
+}
+
+BOOST_AUTO_TEST_CASE(TaskScheduler_Exception)
+{
+    TaskGroup group;
+    group.Run(Throw);
+    BOOST_CHECK_THROW(group.Wait(), BenzeneException);
+}
+
+BOOST_AUTO_TEST_CASE(TaskScheduler_Cancel)
+{
+    boost::mutex mutex;
+    int sum = 0;
+    CancelToken token;
+    token.Cancel();
+    TaskGroup group(token);
+    for (int i = 0; i < 10; ++i)
+        group.Run(boost::bind(Add, boost::ref(mutex), boost::ref(sum), 1));
+    group.Wait();
+    BOOST_CHECK_EQUAL(sum, 0);
+}
+
+BOOST_AUTO_TEST_CASE(TaskScheduler_TaskWorker)
+{
+    std::vector<SquareWorker> workers;
+    for (int i = 0; i < 3; ++i)
+        workers.push_back(SquareWorker());
+    std::vector<int> work;
+    for (int i = 0; i < 100; ++i)
+        work.push_back(i);
+    std::vector<std::pair<int, int> > output;
+    TaskWorker<int, int, SquareWorker> taskWorker(workers);
+    taskWorker.DoWork(work, output);
+    BOOST_CHECK_EQUAL(output.size(), work.size());
+    std::vector<bool> seen(work.size(), false);
+    for (std::size_t i = 0; i < output.size(); ++i)
+    {
+        BOOST_CHECK_EQUAL(output[i].second,
+                          output[i].first * output[i].first);
+        seen[output[i].first] = true;
+    }
+    BOOST_CHECK(std::find(seen.begin(), seen.end(), false) == seen.end());
+    for (std::size_t i = 0; i < workers.size(); ++i)
+        BOOST_CHECK(!workers[i].Overlap());
+}
+
+} // namespace
+
+//---------------------------------------------------------------------------
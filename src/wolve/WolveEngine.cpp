@@ -5,6 +5,7 @@
 #include "SgSystem.h"
 
 #include "BitsetIterator.hpp"
+#include "MemoryBudget.hpp"
 #include "Misc.hpp"
 #include "PlayAndSolve.hpp"
 #include "SwapCheck.hpp"
@@ -47,10 +48,16 @@ WolveEngine::WolveEngine(int boardsize, WolvePlayer& player)
     RegisterCmd("wolve-scores", &WolveEngine::CmdScores);
     RegisterCmd("wolve-data", &WolveEngine::CmdData);
     RegisterCmd("wolve-clear-hash", &WolveEngine::CmdClearHash);
+
+    m_memoryComponent = MemoryBudget::Get().Register
+        ("wolve_tt", 8.0,
+         boost::bind(&WolveEngine::HashTableMemory, this),
+         boost::bind(&WolveEngine::ResizeHashTable, this, _1));
 }
 
 WolveEngine::~WolveEngine()
 {
+    MemoryBudget::Get().Unregister(m_memoryComponent);
 }
 
 //----------------------------------------------------------------------------
@@ -63,6 +70,25 @@ void WolveEngine::RegisterCmd(const std::string& name,
 
 //----------------------------------------------------------------------------
 
+std::size_t WolveEngine::HashTableMemory() const
+{
+    const SgSearchHashTable* hashTable = m_player.HashTable();
+    if (hashTable == 0)
+        return 0;
+    return hashTable->MaxHash() * sizeof(SgHashEntry<SgSearchHashData>);
+}
+
+/** Keeps the table if its size does not change. */
+void WolveEngine::ResizeHashTable(std::size_t bytes)
+{
+    int bits = MemoryBudget::TableBits
+        (bytes, sizeof(SgHashEntry<SgSearchHashData>));
+    const SgSearchHashTable* hashTable = m_player.HashTable();
+    if (hashTable != 0 && hashTable->MaxHash() == 1 << bits)
+        return;
+    m_player.SetHashTable(new SgSearchHashTable(1 << bits));
+}
+
 double WolveEngine::TimeForMove(HexColor c)
 {
     if (m_player.UseTimeManagement())
@@ -76,14 +102,21 @@ HexPoint WolveEngine::GenMove(HexColor color, bool useGameClock)
     SG_UNUSED(useGameClock);
     if (SwapCheck::PlaySwap(m_game, color))
         return SWAP_PIECES;
-    HexState state(m_game.Board(), color);
+    HexPoint bookMove = BookMove(HexState(m_game.Board(), color));
+    if (bookMove != INVALID_POINT)
+        return bookMove;
+    double maxTime = TimeForMove(color);
+    return DoSearch(color, maxTime);
+}
+
+HexPoint WolveEngine::BookMove(const HexState& state)
+{
     if (m_useCacheBook && m_cacheBook.Exists(state))
     {
         LogInfo() << "Playing move from cache book.\n";
         return m_cacheBook[state];
     }
-    double maxTime = TimeForMove(color);
-    return DoSearch(color, maxTime);
+    return INVALID_POINT;
 }
 
 HexPoint WolveEngine::DoSearch(HexColor color, double maxTime)
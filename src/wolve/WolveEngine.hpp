@@ -46,6 +46,11 @@ public:
     virtual void StopPonder();
 #endif
 
+    /** Returns the move from the cache book for state, or
+        INVALID_POINT if the cache book is not used or state is not
+        in it. */
+    HexPoint BookMove(const HexState& state);
+
 private:
     WolvePlayer& m_player;
 
@@ -53,12 +58,19 @@ private:
 
     bool m_useCacheBook;
 
+    /** Name of the hashtable in the MemoryBudget. */
+    std::string m_memoryComponent;
+
     double TimeForMove(HexColor color);
 
     HexPoint GenMove(HexColor color, bool useGameClock);
 
     HexPoint DoSearch(HexColor color, double maxTime);
 
+    std::size_t HashTableMemory() const;
+
+    void ResizeHashTable(std::size_t bytes);
+
     void RegisterCmd(const std::string& name,
                      GtpCallback<WolveEngine>::Method method);
 };
@@ -10,6 +10,7 @@
 #include "BoardUtil.hpp"
 #include "VCSet.hpp"
 #include "HexEval.hpp"
+#include "MemoryBudget.hpp"
 #include "Misc.hpp"
 #include "SequenceHash.hpp"
 #include "WolvePlayer.hpp"
@@ -55,6 +56,31 @@ WolvePlayer::~WolvePlayer()
 {
 }
 
+void WolvePlayer::CopySettingsFrom(const WolvePlayer& other,
+                                   std::size_t numCopies)
+{
+    const WolveSearch& search = other.m_search;
+    m_search.SetBackupIceInfo(search.BackupIceInfo());
+    m_search.SetPlyWidth(search.PlyWidth());
+    m_search.SetSpecificPlyWidths(search.SpecificPlyWidths());
+    SetSearchSingleton(other.SearchSingleton());
+    SetMaxTime(other.MaxTime());
+    SetMinDepth(other.MinDepth());
+    SetMaxDepth(other.MaxDepth());
+    SetUseTimeManagement(other.UseTimeManagement());
+    SetUseEarlyAbort(other.UseEarlyAbort());
+    if (other.m_hashTable)
+    {
+        int maxHash = other.m_hashTable->MaxHash();
+        if (MemoryBudget::Get().Total() > 0)
+            for (std::size_t n = 1; n < numCopies && maxHash > 1; n *= 2)
+                maxHash /= 2;
+        SetHashTable(new SgSearchHashTable(maxHash));
+    }
+    else
+        SetHashTable(0);
+}
+
 //----------------------------------------------------------------------------
 
 /** Generates a move using WolveSearch. */
@@ -27,6 +27,13 @@ public:
     /** Returns the search. */
     WolveSearch& Search();
 
+    /** Copies the parameters of other, including the size of its
+        hashtable. If the MemoryBudget has a total, the hashtable is
+        halved for each doubling of numCopies, the number of players
+        copying other. Pondering and gfx output are not copied. */
+    void CopySettingsFrom(const WolvePlayer& other,
+                          std::size_t numCopies = 1);
+
     //-----------------------------------------------------------------------
 
     /** @name Parameters */
@@ -8,28 +8,46 @@
 
     Usage:
 
-    mergesgf [-output merged.sgf] game.sgf [...]
+    mergesgf [-output merged.sgf] [-threads n] [-max-memory mb]
+             [-spill-dir dir] game.sgf [...]
 
     Description:
     Statistics about the game results are computed and stored as a
     comment in the nodes.
 
+    Files are parsed in batches on a pool of threads and added to the
+    tree in the order given, so the output does not depend on the
+    number of threads. The tree is kept in a single arena. If it grows
+    beyond the memory limit, the games it holds are written to one
+    spill file per first move and the tree is cleared; the subtree of
+    each first move is then rebuilt from its spill file when the
+    merged file is written.
+
     NEED TO DO THE FOLLOWING: Merges SGF files to a single tree. The
     game-moves are transformed into a normalized forms to merge
     rotated/mirrored openings into the same subtree.
 
     Options:
-    -output Filename for the resulting merged SGF file (default merged.sgf)
-    -help   Print help and exit
+    -output     Filename for the resulting merged SGF file (default merged.sgf)
+    -threads    Number of parsing threads (default: number of cores)
+    -max-memory Size of the tree in MB before spilling to disk (default 1024)
+    -spill-dir  Directory for spill files (default .)
+    -help       Print help and exit
  */
 //----------------------------------------------------------------------------
 
 #include "SgSystem.h"
 
 #include <algorithm>
+#include <cstdio>
 #include <fstream>
+#include <set>
+#include <sstream>
 #include <string>
 #include <vector>
+#include <boost/cstdint.hpp>
+#include <boost/thread/thread.hpp>
+#include <unistd.h>
 #include "SgCmdLineOpt.h"
 #include "SgDebug.h"
 #include "SgException.h"
@@ -37,7 +55,7 @@
 #include "SgInit.h"
 #include "SgNode.h"
 #include "SgPoint.h"
-#include "SgStatistics.h"
+#include "SgThreadedWorker.h"
 
 #include "Hex.hpp"
 #include "HexProp.hpp"
@@ -51,37 +69,301 @@ namespace {
 
 //----------------------------------------------------------------------------
 
+/** Index of a node in a Tree. The root has index 0, which is never a
+    child or sibling, so 0 also stands for "no node". */
+typedef boost::uint32_t NodeIndex;
+
+const NodeIndex NO_NODE = 0;
+
+/** Node of the merged tree.
+    Children are linked through m_firstChild and m_sibling, so a node
+    takes a fixed 20 bytes in its tree's arena. */
 struct Node
 {
     SgPoint m_move;
 
-    SgStatisticsBase<float,size_t> m_blackWins;
+    /** Number of games through this node. */
+    boost::uint32_t m_count;
+
+    /** Number of those games won by black. */
+    boost::uint32_t m_blackWins;
+
+    NodeIndex m_firstChild;
+
+    NodeIndex m_sibling;
+};
+
+/** Tree of games stored in a single arena. */
+class Tree
+{
+public:
+    /** Creates a tree whose root has the given move. */
+    explicit Tree(SgPoint rootMove);
+
+    /** Adds count games, blackWins of them won by black, that follow
+        the root with moves. */
+    void Add(const vector<SgPoint>& moves, boost::uint32_t count,
+             boost::uint32_t blackWins);
+
+    /** Removes all nodes but the root, which is reset. */
+    void Clear();
+
+    const Node& GetNode(NodeIndex index) const;
+
+    /** Children of a node, most played first. */
+    vector<NodeIndex> SortedChildren(NodeIndex index) const;
+
+    /** Bytes allocated by the arena. */
+    size_t MemoryUsed() const;
+
+private:
+    vector<Node> m_nodes;
+
+    NodeIndex NewNode(SgPoint move);
+};
+
+Tree::Tree(SgPoint rootMove)
+{
+    NewNode(rootMove);
+}
+
+NodeIndex Tree::NewNode(SgPoint move)
+{
+    Node node;
+    node.m_move = move;
+    node.m_count = 0;
+    node.m_blackWins = 0;
+    node.m_firstChild = NO_NODE;
+    node.m_sibling = NO_NODE;
+    m_nodes.push_back(node);
+    return static_cast<NodeIndex>(m_nodes.size() - 1);
+}
+
+void Tree::Add(const vector<SgPoint>& moves, boost::uint32_t count,
+               boost::uint32_t blackWins)
+{
+    NodeIndex index = 0;
+    m_nodes[index].m_count += count;
+    m_nodes[index].m_blackWins += blackWins;
+    for (vector<SgPoint>::const_iterator it = moves.begin();
+         it != moves.end(); ++it)
+    {
+        SgPoint move = *it;
+        NodeIndex child = m_nodes[index].m_firstChild;
+        while (child != NO_NODE && m_nodes[child].m_move != move)
+            child = m_nodes[child].m_sibling;
+        if (child == NO_NODE)
+        {
+            child = NewNode(move);
+            m_nodes[child].m_sibling = m_nodes[index].m_firstChild;
+            m_nodes[index].m_firstChild = child;
+        }
+        m_nodes[child].m_count += count;
+        m_nodes[child].m_blackWins += blackWins;
+        index = child;
+    }
+}
+
+void Tree::Clear()
+{
+    SgPoint rootMove = m_nodes[0].m_move;
+    // Release the arena; clear() alone would keep its capacity
+    vector<Node>().swap(m_nodes);
+    NewNode(rootMove);
+}
+
+const Node& Tree::GetNode(NodeIndex index) const
+{
+    return m_nodes[index];
+}
+
+/** Orders children by decreasing count, then by move so that the
+    output does not depend on the order of the files. */
+class IsCountGreater
+{
+public:
+    explicit IsCountGreater(const Tree& tree)
+        : m_tree(&tree)
+    { }
+
+    bool operator()(NodeIndex a, NodeIndex b) const
+    {
+        const Node& nodeA = m_tree->GetNode(a);
+        const Node& nodeB = m_tree->GetNode(b);
+        if (nodeA.m_count != nodeB.m_count)
+            return nodeA.m_count > nodeB.m_count;
+        return nodeA.m_move < nodeB.m_move;
+    }
+
+private:
+    const Tree* m_tree;
+};
+
+vector<NodeIndex> Tree::SortedChildren(NodeIndex index) const
+{
+    vector<NodeIndex> children;
+    for (NodeIndex child = m_nodes[index].m_firstChild; child != NO_NODE;
+         child = m_nodes[child].m_sibling)
+        children.push_back(child);
+    sort(children.begin(), children.end(), IsCountGreater(*this));
+    return children;
+}
+
+size_t Tree::MemoryUsed() const
+{
+    return m_nodes.capacity() * sizeof(Node);
+}
+
+//----------------------------------------------------------------------------
+
+/** Games moved out of memory, in one file per first move.
+    The file names contain the process id, so several runs can share
+    a spill directory. A record holds the number of games ending at a node, how many of
+    them black won, and the moves after the first move leading to
+    the node. */
+class Spill
+{
+public:
+    explicit Spill(const string& dir);
+
+    /** Removes the spill files. */
+    ~Spill();
 
-    vector<Node*> m_children;
+    bool IsEmpty() const;
 
-    Node();
+    /** Writes the games in tree to the spill files and clears it. */
+    void Write(Tree& tree);
 
-    Node(SgPoint move);
+    /** Adds the games that started with firstMove to tree, whose root
+        stands for firstMove. */
+    void Read(SgPoint firstMove, Tree& tree) const;
 
-    void DeleteTree();
+private:
+    string m_dir;
+
+    set<SgPoint> m_files;
+
+    string FileName(SgPoint firstMove) const;
+
+    void WriteNode(ostream& out, const Tree& tree, NodeIndex index,
+                   vector<SgPoint>& moves) const;
 };
 
-Node::Node()
-    : m_move(SG_NULLMOVE)
+Spill::Spill(const string& dir)
+    : m_dir(dir)
+{
+}
+
+Spill::~Spill()
+{
+    for (set<SgPoint>::const_iterator it = m_files.begin();
+         it != m_files.end(); ++it)
+        remove(FileName(*it).c_str());
+}
+
+bool Spill::IsEmpty() const
+{
+    return m_files.empty();
+}
+
+string Spill::FileName(SgPoint firstMove) const
+{
+    ostringstream os;
+    os << m_dir << "/mergesgf-spill-" << getpid() << '-' << firstMove
+       << ".tmp";
+    return os.str();
+}
+
+template<typename T>
+void WriteValue(ostream& out, T value)
+{
+    out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template<typename T>
+bool ReadValue(istream& in, T& value)
+{
+    in.read(reinterpret_cast<char*>(&value), sizeof(value));
+    return ! in.fail();
+}
+
+void Spill::Write(Tree& tree)
 {
+    const Node& root = tree.GetNode(0);
+    if (m_files.empty())
+        SgDebug() << "Spilling games to " << m_dir << '\n';
+    for (NodeIndex child = root.m_firstChild; child != NO_NODE;
+         child = tree.GetNode(child).m_sibling)
+    {
+        SgPoint firstMove = tree.GetNode(child).m_move;
+        string name = FileName(firstMove);
+        // Truncate a file left behind by another run on the first
+        // write, append on later ones
+        ios::openmode mode = ios::binary
+            | (m_files.count(firstMove) > 0 ? ios::app : ios::trunc);
+        ofstream out(name.c_str(), mode);
+        vector<SgPoint> moves;
+        WriteNode(out, tree, child, moves);
+        if (! out)
+            throw SgException("Could not write spill file " + name);
+        m_files.insert(firstMove);
+    }
+    tree.Clear();
 }
 
-Node::Node(SgPoint move)
-    : m_move(move)
+void Spill::WriteNode(ostream& out, const Tree& tree, NodeIndex index,
+                      vector<SgPoint>& moves) const
 {
+    const Node& node = tree.GetNode(index);
+    boost::uint32_t count = node.m_count;
+    boost::uint32_t blackWins = node.m_blackWins;
+    for (NodeIndex child = node.m_firstChild; child != NO_NODE;
+         child = tree.GetNode(child).m_sibling)
+    {
+        count -= tree.GetNode(child).m_count;
+        blackWins -= tree.GetNode(child).m_blackWins;
+    }
+    if (count > 0)
+    {
+        WriteValue(out, count);
+        WriteValue(out, blackWins);
+        WriteValue(out, static_cast<boost::uint32_t>(moves.size()));
+        for (size_t i = 0; i < moves.size(); ++i)
+            WriteValue(out, static_cast<boost::int32_t>(moves[i]));
+    }
+    for (NodeIndex child = node.m_firstChild; child != NO_NODE;
+         child = tree.GetNode(child).m_sibling)
+    {
+        moves.push_back(tree.GetNode(child).m_move);
+        WriteNode(out, tree, child, moves);
+        moves.pop_back();
+    }
 }
 
-void Node::DeleteTree()
+void Spill::Read(SgPoint firstMove, Tree& tree) const
 {
-    for (vector<Node*>::iterator it = m_children.begin();
-         it != m_children.end(); ++it)
-        (*it)->DeleteTree();
-    delete this;
+    string name = FileName(firstMove);
+    ifstream in(name.c_str(), ios::binary);
+    if (! in)
+        throw SgException("Could not read spill file " + name);
+    boost::uint32_t count;
+    boost::uint32_t blackWins;
+    boost::uint32_t length;
+    vector<SgPoint> moves;
+    while (ReadValue(in, count))
+    {
+        if (! ReadValue(in, blackWins) || ! ReadValue(in, length))
+            throw SgException("Truncated spill file " + name);
+        moves.resize(length);
+        for (boost::uint32_t i = 0; i < length; ++i)
+        {
+            boost::int32_t move;
+            if (! ReadValue(in, move))
+                throw SgException("Truncated spill file " + name);
+            moves[i] = move;
+        }
+        tree.Add(moves, count, blackWins);
+    }
 }
 
 //----------------------------------------------------------------------------
@@ -103,81 +385,146 @@ TreeHolder::TreeHolder(SgNode* root)
 
 TreeHolder::~TreeHolder()
 {
-    m_root->DeleteTree();
+    if (m_root != 0)
+        m_root->DeleteTree();
     m_root = 0;
 }
 
 //----------------------------------------------------------------------------
 
+/** Game parsed from a file. */
+struct GameRecord
+{
+    int m_boardSize;
+
+    bool m_blackWin;
+
+    vector<SgPoint> m_moves;
+
+    /** Reason the file could not be used; empty if none. */
+    string m_error;
+};
+
+//----------------------------------------------------------------------------
+
 string g_output;
 
 vector<string> g_files;
 
 int g_boardSize = -1;
 
+size_t g_numThreads;
+
+size_t g_maxMemory;
+
+string g_spillDir;
+
+/** Number of files handed to the threads at a time. */
+const size_t FILES_PER_THREAD = 256;
+
 //----------------------------------------------------------------------------
 
-void AddMoves(Node* root, const vector<SgPoint>& moves, bool blackWin);
 bool GetBlackWin(const SgNode* node);
 int GetBoardSize(const SgNode* node);
 vector<SgPoint> GetMoves(const SgNode* node);
 vector<SgPoint> Normalize(const vector<SgPoint>& moves);
 string PointToSgfString(SgPoint p);
 
-void AddFile(Node* root, const string& filename)
+GameRecord ReadFile(const string& filename)
+{
+    GameRecord game;
+    try
+    {
+        ifstream in(filename.c_str());
+        if (! in)
+            throw SgException("Could not read file");
+        SgGameReader reader(in);
+        TreeHolder tree(reader.ReadGame());
+        const SgNode* gameRoot = tree.m_root;
+        if (gameRoot == 0)
+            throw SgException("No game in file");
+        game.m_boardSize = GetBoardSize(gameRoot);
+        game.m_blackWin = GetBlackWin(gameRoot);
+        game.m_moves = GetMoves(gameRoot);
+        // TODO: ACTUALLY DO THIS!!
+        //game.m_moves = Normalize(game.m_moves);
+    }
+    catch (const SgException& e)
+    {
+        game.m_error = e.what();
+    }
+    return game;
+}
+
+/** Parses files for SgThreadedWorker. */
+class ReadWorker
+{
+public:
+    GameRecord operator()(const size_t& index)
+    {
+        return ReadFile(g_files[index]);
+    }
+};
+
+void AddGame(Tree& tree, Tree& firstMoves, const string& filename,
+             const GameRecord& game)
 {
     SgDebug() << "Adding file " << filename << '\n';
-    ifstream in(filename.c_str());
-    if (! in)
-        throw SgException("Could not read file");
-    SgGameReader reader(in);
-    TreeHolder tree(reader.ReadGame());
-    const SgNode* gameRoot = tree.m_root;
-    if (gameRoot == 0)
-        throw SgException("No game in file");
-    int boardSize = GetBoardSize(gameRoot);
+    if (! game.m_error.empty())
+        throw SgException(game.m_error);
     if (g_boardSize < 0)
-        g_boardSize = boardSize;
-    else if (boardSize != g_boardSize)
+        g_boardSize = game.m_boardSize;
+    else if (game.m_boardSize != g_boardSize)
         throw SgException("Games have different board sizes");
-    bool blackWin = GetBlackWin(gameRoot);
-    vector<SgPoint> moves = GetMoves(gameRoot);
-    // TODO: ACTUALLY DO THIS!!
-    //moves = Normalize(moves);
-    AddMoves(root, moves, blackWin);
+    boost::uint32_t blackWin = game.m_blackWin ? 1 : 0;
+    tree.Add(game.m_moves, 1, blackWin);
+    vector<SgPoint> firstMove;
+    if (! game.m_moves.empty())
+        firstMove.push_back(game.m_moves[0]);
+    firstMoves.Add(firstMove, 1, blackWin);
 }
 
-void AddMoves(Node* root, const vector<SgPoint>& moves, bool blackWin)
+bool IsFileBefore(const pair<size_t, GameRecord>& a,
+                  const pair<size_t, GameRecord>& b)
 {
-    Node* node = root;
-    node->m_blackWins.Add(blackWin);
-    for (vector<SgPoint>::const_iterator it = moves.begin();
-         it != moves.end(); ++it)
+    return a.first < b.first;
+}
+
+/** Adds all files to tree, moving it to spill whenever it grows
+    beyond the memory limit. firstMoves gets the games cut after their
+    first move, to write the top of the tree after spilling. */
+void AddFiles(Tree& tree, Tree& firstMoves, Spill& spill)
+{
+    vector<ReadWorker> workers(g_numThreads);
+    SgThreadedWorker<size_t, GameRecord, ReadWorker> threadedWorker(workers);
+    const size_t batchSize = FILES_PER_THREAD * g_numThreads;
+    for (size_t first = 0; first < g_files.size(); first += batchSize)
     {
-        SgPoint move = *it;
-        Node* child = 0;
-        for (vector<Node*>::const_iterator it2 = node->m_children.begin();
-             it2 != node->m_children.end(); ++it2)
-            if ((*it2)->m_move == move)
-            {
-                child = *it2;
-                break;
-            }
-        if (child == 0)
+        vector<size_t> work;
+        for (size_t i = first;
+             i < min(first + batchSize, g_files.size()); ++i)
+            work.push_back(i);
+        vector<pair<size_t, GameRecord> > output;
+        threadedWorker.DoWork(work, output);
+        sort(output.begin(), output.end(), IsFileBefore);
+        for (size_t i = 0; i < output.size(); ++i)
         {
-            child = new Node(move);
-            node->m_children.push_back(child);
+            AddGame(tree, firstMoves, g_files[output[i].first],
+                    output[i].second);
+            if (tree.MemoryUsed() > g_maxMemory)
+                spill.Write(tree);
         }
-        child->m_blackWins.Add(blackWin);
-        node = child;
     }
 }
 
-string BlackWinsString(const Node* node)
+string BlackWinsString(const Node& node)
 {
     ostringstream out;
-    size_t count = node->m_blackWins.Count();
-    float mean = node->m_blackWins.Mean();
+    size_t count = node.m_count;
+    float mean = 0;
+    if (count > 0)
+        mean = static_cast<float>(node.m_blackWins)
+            / static_cast<float>(count);
     out << static_cast<int>(100 * mean) << "% (" << count << ')';
     return out.str();
 }
@@ -246,11 +593,6 @@ string GetLabel(size_t i)
     }
 }
 
-bool IsCountGreater(const Node* node1, const Node* node2)
-{
-    return (node1->m_blackWins.Count() > node2->m_blackWins.Count());
-}
-
 vector<SgPoint> Normalize(const vector<SgPoint>& moves)
 {
     // TODO: Convert this function to Hex!!
@@ -278,6 +620,9 @@ void ParseOptions(int argc, char** argv)
     SgCmdLineOpt cmdLineOpt;
     vector<string> specs;
     specs.push_back("output:");
+    specs.push_back("threads:");
+    specs.push_back("max-memory:");
+    specs.push_back("spill-dir:");
     specs.push_back("help");
     cmdLineOpt.Parse(argc, argv, specs);
     if (cmdLineOpt.Contains("help"))
@@ -285,11 +630,20 @@ void ParseOptions(int argc, char** argv)
         cout <<
             "Usage: mergesgf [Options] game.sgf [...]\n"
             "Options:\n"
-            "  -output  Filename for merged file (default merged.sgf)\n"
-            "  -help    print usage and exit\n";
+            "  -output      Filename for merged file (default merged.sgf)\n"
+            "  -threads     Number of parsing threads (default: cores)\n"
+            "  -max-memory  MB for the tree before spilling (default 1024)\n"
+            "  -spill-dir   Directory for spill files (default .)\n"
+            "  -help        print usage and exit\n";
         exit(0);
     }
     g_output = cmdLineOpt.GetString("output", "merged.sgf");
+    int cores = static_cast<int>(boost::thread::hardware_concurrency());
+    int numThreads = cmdLineOpt.GetInteger("threads", cores);
+    g_numThreads = static_cast<size_t>(max(numThreads, 1));
+    int maxMemory = cmdLineOpt.GetInteger("max-memory", 1024);
+    g_maxMemory = static_cast<size_t>(max(maxMemory, 1)) * 1024 * 1024;
+    g_spillDir = cmdLineOpt.GetString("spill-dir", ".");
     g_files = cmdLineOpt.GetArguments();
     if (g_files.size() == 0)
         throw SgException("No filename given");
@@ -303,30 +657,29 @@ string PointToSgfString(SgPoint p)
     return benzene::HexPointUtil::ToString(hp);
 }
 
-void SaveNode(ostream& out, const Node* node, SgBlackWhite toPlay,
-              bool isRoot)
+/** Writes the properties of a node: its move, the labels of its
+    children and the comment with the statistics. */
+void SaveNodeProperties(ostream& out, const Node& node,
+                        const Tree& childTree,
+                        const vector<NodeIndex>& children,
+                        SgBlackWhite toPlay, bool isRoot)
 {
-    SgPoint move = node->m_move;
+    SgPoint move = node.m_move;
     if (! isRoot)
         out << ";";
     if (move != SG_NULLMOVE)
-    {
         out << (toPlay == SG_BLACK ? 'B' : 'W') << '['
             << PointToSgfString(move) << ']';
-        toPlay = SgOppBW(toPlay);
-    }
-    vector<Node*> children = node->m_children;
-    sort(children.begin(), children.end(), IsCountGreater);
     bool hasNonPassMoves =
         (children.size() > 1
-         || (children.size() == 1 && children[0]->m_move != SG_PASS));
+         || (children.size() == 1
+             && childTree.GetNode(children[0]).m_move != SG_PASS));
     if (hasNonPassMoves)
     {
         out << "LB";
         for (size_t i = 0; i < children.size(); ++i)
         {
-            const Node* childNode = children[i];
-            SgPoint childMove = childNode->m_move;
+            SgPoint childMove = childTree.GetNode(children[i]).m_move;
             if (childMove != SG_PASS)
                 out << '[' << PointToSgfString(childMove) << ':'
                     << GetLabel(i) << "]";
@@ -337,26 +690,60 @@ void SaveNode(ostream& out, const Node* node, SgBlackWhite toPlay,
     out << "C[" << BlackWinsString(node) << "\n\n";
     for (size_t i = 0; i < children.size(); ++i)
     {
-        const Node* childNode = children[i];
+        const Node& childNode = childTree.GetNode(children[i]);
         out << GetLabel(i) << " (" 
-            << PointToSgfString(childNode->m_move) << "): "
+            << PointToSgfString(childNode.m_move) << "): "
             << BlackWinsString(childNode) << '\n';
     }
     out << "]\n";
-    for (vector<Node*>::const_iterator it = children.begin();
+}
+
+void SaveNode(ostream& out, const Tree& tree, NodeIndex index,
+              SgBlackWhite toPlay, bool isRoot)
+{
+    const Node& node = tree.GetNode(index);
+    vector<NodeIndex> children = tree.SortedChildren(index);
+    SaveNodeProperties(out, node, tree, children, toPlay, isRoot);
+    if (node.m_move != SG_NULLMOVE)
+        toPlay = SgOppBW(toPlay);
+    for (vector<NodeIndex>::const_iterator it = children.begin();
          it != children.end(); ++it)
     {
         out << "(\n";
-        SaveNode(out, *it, toPlay, false);
+        SaveNode(out, tree, *it, toPlay, false);
         out << ")\n";
     }
 }
 
-void SaveTree(const Node* root)
+void SaveTree(const Tree& tree)
 {
     ofstream out(g_output.c_str());
     out << "(;FF[4]SZ[" << g_boardSize << "]AP[mergesgf]\n";
-    SaveNode(out, root, SG_BLACK, true);
+    SaveNode(out, tree, 0, SG_BLACK, true);
+    out << ")\n";
+    if (! out)
+        throw SgException("Write error");
+}
+
+/** Writes the merged file after spilling. The root and its children
+    come from firstMoves; the subtree below each first move is rebuilt
+    from its spill file, one at a time. */
+void SaveSpilledTree(const Tree& firstMoves, const Spill& spill)
+{
+    ofstream out(g_output.c_str());
+    out << "(;FF[4]SZ[" << g_boardSize << "]AP[mergesgf]\n";
+    vector<NodeIndex> children = firstMoves.SortedChildren(0);
+    SaveNodeProperties(out, firstMoves.GetNode(0), firstMoves, children,
+                       SG_BLACK, true);
+    for (vector<NodeIndex>::const_iterator it = children.begin();
+         it != children.end(); ++it)
+    {
+        Tree subtree(firstMoves.GetNode(*it).m_move);
+        spill.Read(subtree.GetNode(0).m_move, subtree);
+        out << "(\n";
+        SaveNode(out, subtree, 0, SG_BLACK, false);
+        out << ")\n";
+    }
     out << ")\n";
     if (! out)
         throw SgException("Write error");
@@ -375,12 +762,17 @@ int main(int argc, char** argv)
         ParseOptions(argc, argv);
         SgInit();
         benzene::HexProp::Init();
-        Node* root = new Node();
-        for (vector<string>::const_iterator it = g_files.begin();
-             it != g_files.end(); ++it)
-            AddFile(root, *it);
-        SaveTree(root);
-        root->DeleteTree();
+        Tree tree(SG_NULLMOVE);
+        Tree firstMoves(SG_NULLMOVE);
+        Spill spill(g_spillDir);
+        AddFiles(tree, firstMoves, spill);
+        if (spill.IsEmpty())
+            SaveTree(tree);
+        else
+        {
+            spill.Write(tree);
+            SaveSpilledTree(firstMoves, spill);
+        }
         SgFini();
     }
     catch (const SgException& e)